@@ -477,6 +477,9 @@ int main(int argc, char** argv)
     calibration.setInitialParameters(
         initParams, buildNormalizationCoef());
     calibration.setUserFunctions(evaluateParameters, boundParameters, initModel);
+    //Same noise realization for all
+    //evaluations of the optimization
+    calibration.setCommonRandomNumbers(true);
     //Add observations data
     for (size_t i=0;i<logs.size();i++) {
         Eigen::VectorXd obs(2);
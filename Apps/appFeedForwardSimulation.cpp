@@ -179,7 +179,7 @@ int main(int argc, char** argv)
                 simFeed.setPos(name, modelGoal.get().getDOF(name));
                 //Compute feed forward
                 size_t indexDOF = modelGoal.get().getDOFIndex(name);
-                double offset = simFeed.jointModel(name).computeFeedForward(
+                double offset = simFeed.computeFeedForward(name,
                     dqGoal(indexDOF), ddqGoal(indexDOF), torquesGoal(indexDOF));
                 simFeed.setGoal(name, modelGoal.get().getDOF(name) + offset);
                 simGoal.setPos(name, modelGoal.get().getDOF(name));
@@ -221,7 +221,7 @@ int main(int argc, char** argv)
             simCorrected.setGoal(name, modelCorrected.get().getDOF(name));
             //Compute feed forward
             size_t indexDOF = modelGoal.get().getDOFIndex(name);
-            double offset = simFeed.jointModel(name).computeFeedForward(
+            double offset = simFeed.computeFeedForward(name,
                 dqGoal(indexDOF), ddqGoal(indexDOF), torquesGoal(indexDOF));
             simFeed.setGoal(name, modelGoal.get().getDOF(name) + offset);
             simGoal.setGoal(name, modelGoal.get().getDOF(name));
@@ -2,6 +2,11 @@
 #include <string>
 #include <iomanip>
 #include <cmath>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <libcmaes/cmaes.h>
 #include "Model/HumanoidModel.hpp"
 #include "Model/HumanoidFixedModel.hpp"
@@ -11,6 +16,7 @@
 #include "Utils/Angle.h"
 #include "Model/NamesModel.h"
 #include "Utils/FileModelParameters.h"
+#include "Utils/EvaluationFarm.hpp"
 
 #ifdef LEPH_VIEWER_ENABLED
 #include "Viewer/ModelViewer.hpp"
@@ -58,18 +64,193 @@ static const unsigned int cmaesRestarts = 5;
 static const unsigned int cmaesLambda = 100;
 static const double cmaesSigma = -1.0;
 
+/**
+ * Fitness candidates batch size and
+ * timeout in seconds sent to each
+ * evaluation worker process
+ */
+static const unsigned int workersBatchSize = 4;
+static const double workersTimeout = -1.0;
+
 /**
  * Global weighting ratio 
  * on trunk orientation errors
  */
 static const double trunkOrientationCoef = 0.5;
 
+/**
+ * Logs resampling period in seconds
+ * and number of simulation steps
+ * of 0.001s per period
+ */
+static const double incrStep = 0.01;
+static const int incrLoop = 10;
+
+/**
+ * Log sequence resampled once on the
+ * replay time grid. Column k holds the
+ * values at times[k]. DOF rows follow 
+ * NamesDOF order. Read rows are followed by 
+ * base_roll and base_pitch. Imu rows are
+ * imu_roll and imu_pitch.
+ */
+struct LogSequence {
+    std::vector<double> times;
+    Eigen::VectorXd init;
+    Eigen::MatrixXd goals;
+    Eigen::MatrixXd reads;
+    Eigen::MatrixXd imu;
+};
+
+/**
+ * Build and return the resampled 
+ * sequence of given logs
+ */
+static LogSequence buildSequence(const Leph::MapSeries& logs)
+{
+    LogSequence seq;
+    double minTime = logs.timeMin();
+    double maxTime = logs.timeMax();
+    for (double t=minTime;t<maxTime;t+=incrStep) {
+        seq.times.push_back(t);
+    }
+    size_t sizeDOF = Leph::NamesDOF.size();
+    size_t length = seq.times.size();
+    seq.init.resize(sizeDOF);
+    seq.goals.resize(sizeDOF, length);
+    seq.reads.resize(sizeDOF + 2, length);
+    seq.imu.resize(2, length);
+    for (size_t i=0;i<sizeDOF;i++) {
+        const std::string& name = Leph::NamesDOF[i];
+        seq.init(i) = logs.get("read:" + name, minTime);
+        for (size_t k=0;k<length;k++) {
+            seq.goals(i, k) = logs.get("goal:" + name, seq.times[k]);
+            seq.reads(i, k) = logs.get("read:" + name, seq.times[k]);
+        }
+    }
+    for (size_t k=0;k<length;k++) {
+        double t = seq.times[k];
+        seq.reads(sizeDOF + 0, k) = logs.get("read:base_roll", t);
+        seq.reads(sizeDOF + 1, k) = logs.get("read:base_pitch", t);
+        seq.imu(0, k) = logs.get("read:imu_roll", t);
+        seq.imu(1, k) = logs.get("read:imu_pitch", t);
+    }
+
+    return seq;
+}
+
+/**
+ * Simulation built with given inertia and
+ * geometry data, its state just after
+ * construction and the simulation DOF 
+ * indexes in NamesDOF order.
+ * Contexts are reset to their initial state
+ * instead of being rebuilt when the model 
+ * data is unchanged.
+ */
+struct ReplayContext {
+    Eigen::MatrixXd inertiaData;
+    Eigen::MatrixXd geometryData;
+    std::unique_ptr<Leph::HumanoidSimulation> sim;
+    Leph::HumanoidSimulation::State initState;
+    std::vector<size_t> indexesDOF;
+};
+
+/**
+ * Pool of all built replay contexts and 
+ * currently unused ones. The pool grows up to 
+ * the number of concurrent log evaluations.
+ */
+static std::mutex contextsMutex;
+static std::vector<std::unique_ptr<ReplayContext>> contextsAll;
+static std::vector<ReplayContext*> contextsFree;
+
+/**
+ * Return true if given matrices are equal
+ */
+static bool isSameData(
+    const Eigen::MatrixXd& mat1, const Eigen::MatrixXd& mat2)
+{
+    return 
+        mat1.rows() == mat2.rows() && 
+        mat1.cols() == mat2.cols() &&
+        mat1 == mat2;
+}
+
+/**
+ * Retrieve an unused context reset to its 
+ * initial state with a simulation built with
+ * given inertia and geometry data. 
+ * A context with same model data is preferred,
+ * else an unused one is rebuilt or a new one 
+ * is created. The context is given back 
+ * with releaseContext().
+ */
+static ReplayContext* acquireContext(
+    const Eigen::MatrixXd& inertiaData,
+    const std::map<std::string, size_t>& inertiaName,
+    const Eigen::MatrixXd& geometryData,
+    const std::map<std::string, size_t>& geometryName)
+{
+    ReplayContext* context = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(contextsMutex);
+        for (size_t i=0;i<contextsFree.size();i++) {
+            if (
+                isSameData(contextsFree[i]->inertiaData, inertiaData) &&
+                isSameData(contextsFree[i]->geometryData, geometryData)
+            ) {
+                context = contextsFree[i];
+                contextsFree.erase(contextsFree.begin() + i);
+                break;
+            }
+        }
+        if (context == nullptr && contextsFree.size() > 0) {
+            context = contextsFree.back();
+            contextsFree.pop_back();
+            context->sim.reset();
+        }
+    }
+    //Build a new context outside the lock
+    //since URDF parsing is expensive
+    if (context == nullptr) {
+        std::unique_ptr<ReplayContext> newContext(new ReplayContext());
+        context = newContext.get();
+        std::lock_guard<std::mutex> lock(contextsMutex);
+        contextsAll.push_back(std::move(newContext));
+    }
+    //Build or reset the simulation
+    if (context->sim == nullptr) {
+        context->inertiaData = inertiaData;
+        context->geometryData = geometryData;
+        context->sim.reset(new Leph::HumanoidSimulation(
+            Leph::SigmabanModel, 
+            inertiaData, inertiaName,
+            geometryData, geometryName));
+        context->sim->saveState(context->initState);
+        context->indexesDOF.clear();
+        for (const std::string& name : Leph::NamesDOF) {
+            context->indexesDOF.push_back(
+                context->sim->model().getDOFIndex(name));
+        }
+    } else {
+        context->sim->restoreState(context->initState);
+    }
+
+    return context;
+}
+static void releaseContext(ReplayContext* context)
+{
+    std::lock_guard<std::mutex> lock(contextsMutex);
+    contextsFree.push_back(context);
+}
+
 /**
  * Simulate and compute the error between given logs
  * sequence and simulated model with given parameters.
  */
 static double scoreFitness(
-    const Leph::MapSeries& logs, 
+    const LogSequence& seq, 
     const Eigen::VectorXd& parameters, 
     size_t indexStartCommon,
     size_t indexStartJoints,
@@ -91,8 +272,11 @@ static double scoreFitness(
     Eigen::VectorXd* maxAllError = nullptr)
 {
     //Retrieve log time bounds
-    double minTime = logs.timeMin();
-    double maxTime = logs.timeMax();
+    if (seq.times.size() == 0) {
+        return 0.0;
+    }
+    double minTime = seq.times.front();
+    size_t sizeDOF = Leph::NamesDOF.size();
 
     //Build used inertia data
     Eigen::MatrixXd currentInertiaData = defaultInertiaData;
@@ -119,177 +303,193 @@ static double scoreFitness(
         }
     }
     
-    //Initialize full humanoid model
+    //Retrieve full humanoid model
     //simulation with overrided 
     //inertia and geometry data
-    Leph::HumanoidSimulation sim(
-        Leph::SigmabanModel, 
-        currentInertiaData, 
-        defaultInertiaName,
-        currentGeometryData,
-        defaultGeometryName);
-    Leph::HumanoidModel modelRead(
-        Leph::SigmabanModel, 
-        "left_foot_tip", true,
+    ReplayContext* context = acquireContext(
         currentInertiaData, 
         defaultInertiaName,
         currentGeometryData,
         defaultGeometryName);
-
-    //Assign common joint parameters
-    if (indexStartCommon != (size_t)-1) {
-        sim.setJointModelParameters(
-            parameters.segment(indexStartCommon, sizeJointParameters));
-    } else {
-        for (const std::string& name : namesDOFJoint) {
-            sim.jointModel(name).setParameters(
-                defaultJointData.row(defaultJointName.at(name)).transpose());
-        }
-    }
-    //Assign joint parameters to uniquely optimized DOF
-    if (indexStartJoints != (size_t)-1) {
-        size_t index = 0;
-        for (const std::string& name : namesDOFJoint) {
-            sim.jointModel(name).setParameters(
-                parameters.segment(indexStartJoints + index*sizeJointParameters, sizeJointParameters));
-            index++;
-        }
-    }
-
-    //State initialization
-    for (const std::string& name : Leph::NamesDOF) {
-        //Initialization pos, vel and goal
-        sim.setPos(name, logs.get("read:" + name, minTime));
-        sim.setGoal(name, logs.get("read:" + name, minTime));
-        sim.setVel(name, 0.0);
-        //Reset backlash and goal state
-        sim.jointModel(name).resetHiddenState();
-    }
-    for (const std::string& name : Leph::NamesBase) {
-        //Init base vel
-        sim.setVel(name, 0.0); 
-    }
-    //Init model state
-    sim.putOnGround(
-        Leph::HumanoidFixedModel::LeftSupportFoot);
-    sim.putFootAt(0.0, 0.0, 
-        Leph::HumanoidFixedModel::LeftSupportFoot);
-    //Run small time 0.5s for 
-    //waiting stabilization (backlash)
-    for (int k=0;k<500;k++) {
-        sim.update(0.001);
-    }
+    Leph::HumanoidSimulation& sim = *(context->sim);
+    const std::vector<size_t>& indexesDOF = context->indexesDOF;
     
     //Main loop
     double tmpMax = -1.0;
     double tmpCount = 0.0;
     double tmpSum = 0.0;
     double tmpMaxTime = 0.0;
-    Eigen::VectorXd tmpMaxAll(Leph::NamesDOF.size() + 2);
-    for (size_t i=0;i<Leph::NamesDOF.size() + 2;i++) {
+    Eigen::VectorXd tmpMaxAll(sizeDOF + 2);
+    for (size_t i=0;i<sizeDOF + 2;i++) {
         tmpMaxAll(i) = -1.0;
     }
     std::string tmpMaxName = "";
 #ifdef LEPH_VIEWER_ENABLED
     Leph::ModelViewer* viewer = nullptr;
+    Leph::HumanoidModel* modelRead = nullptr;
     if (verbose >= 3) {
         viewer = new Leph::ModelViewer(1200, 900);
+        modelRead = new Leph::HumanoidModel(
+            Leph::SigmabanModel, 
+            "left_foot_tip", true,
+            currentInertiaData, 
+            defaultInertiaName,
+            currentGeometryData,
+            defaultGeometryName);
     }
     Leph::Plot plot;
 #endif
-    double incrStep = 0.01;
-    int incrLoop = 10;
-    for (double t=minTime;t<maxTime;t+=incrStep) {
-#ifdef LEPH_VIEWER_ENABLED
-        if (verbose >= 3) {
-            if (!viewer->update()) {
-                break;
+    try {
+        //Assign common joint parameters
+        if (indexStartCommon != (size_t)-1) {
+            sim.setJointModelParameters(
+                parameters.segment(indexStartCommon, sizeJointParameters));
+        } else {
+            for (const std::string& name : namesDOFJoint) {
+                sim.jointModel(name).setParameters(
+                    defaultJointData.row(defaultJointName.at(name)).transpose());
             }
         }
-#endif
-        //Assign motor goal
-        for (const std::string& name : Leph::NamesDOF) {
-            sim.setGoal(name, logs.get("goal:" + name, t));
-            modelRead.setDOF(name, logs.get("read:" + name, t));
+        //Assign joint parameters to uniquely optimized DOF
+        if (indexStartJoints != (size_t)-1) {
+            size_t index = 0;
+            for (const std::string& name : namesDOFJoint) {
+                sim.jointModel(name).setParameters(
+                    parameters.segment(indexStartJoints + index*sizeJointParameters, sizeJointParameters));
+                index++;
+            }
+        }
+
+        //State initialization
+        for (size_t i=0;i<sizeDOF;i++) {
+            const std::string& name = Leph::NamesDOF[i];
+            //Initialization pos, vel and goal
+            sim.setPos(name, seq.init(i));
+            sim.setGoal(name, seq.init(i));
+            sim.setVel(name, 0.0);
+            //Reset backlash and goal state
+            sim.jointModel(name).resetHiddenState();
         }
-        modelRead.setDOF("base_roll", logs.get("read:base_roll", t));
-        modelRead.setDOF("base_pitch", logs.get("read:base_pitch", t));
-        //Run simulation
-        for (int k=0;k<incrLoop;k++) {
+        for (const std::string& name : Leph::NamesBase) {
+            //Init base vel
+            sim.setVel(name, 0.0); 
+        }
+        //Init model state
+        sim.putOnGround(
+            Leph::HumanoidFixedModel::LeftSupportFoot);
+        sim.putFootAt(0.0, 0.0, 
+            Leph::HumanoidFixedModel::LeftSupportFoot);
+        //Run small time 0.5s for 
+        //waiting stabilization (backlash)
+        for (int k=0;k<500;k++) {
             sim.update(0.001);
         }
-        //Compute DOF error
-        size_t index = 0;
-        for (const std::string& name : Leph::NamesDOF) {
-            double error = pow(
-                180.0/M_PI*Leph::AngleDistance(sim.getPos(name), modelRead.getDOF(name)), 
-                2);  
-            tmpSum += error;
-            tmpCount += 1.0;
-            if (tmpMax < 0.0 || tmpMax < error) {
-                tmpMax = error;
+        
+        for (size_t k=0;k<seq.times.size();k++) {
+            double t = seq.times[k];
+#ifdef LEPH_VIEWER_ENABLED
+            if (verbose >= 3) {
+                if (!viewer->update()) {
+                    break;
+                }
+            }
+#endif
+            //Assign motor goal
+            for (size_t i=0;i<sizeDOF;i++) {
+                sim.goals()(indexesDOF[i]) = seq.goals(i, k);
+            }
+            //Run simulation
+            for (int l=0;l<incrLoop;l++) {
+                sim.update(0.001);
+            }
+            //Compute DOF error
+            size_t index = 0;
+            for (size_t i=0;i<sizeDOF;i++) {
+                double error = pow(
+                    180.0/M_PI*Leph::AngleDistance(
+                        sim.positions()(indexesDOF[i]), seq.reads(i, k)), 
+                    2);  
+                tmpSum += error;
+                tmpCount += 1.0;
+                if (tmpMax < 0.0 || tmpMax < error) {
+                    tmpMax = error;
+                    tmpMaxTime = t-minTime;
+                    tmpMaxName = Leph::NamesDOF[i];
+                }
+                if (tmpMaxAll(index) < 0.0 || tmpMaxAll(index) < error) {
+                    tmpMaxAll(index) = error;
+                }
+                index++;
+            }
+            //Compute trunk orientation error
+            Eigen::Vector3d simTrunkAngles = sim.model().trunkSelfOrientation();
+            double errorTrunkRoll = pow(
+                trunkOrientationCoef*180.0/M_PI*Leph::AngleDistance(
+                    simTrunkAngles.x(), seq.imu(0, k)),
+                2);
+            double errorTrunkPitch = pow(
+                trunkOrientationCoef*180.0/M_PI*Leph::AngleDistance(
+                    simTrunkAngles.y(), seq.imu(1, k)),
+                2);
+            tmpSum += errorTrunkRoll;
+            tmpSum += errorTrunkPitch;
+            tmpCount += 2.0;
+            if (tmpMax < 0.0 || tmpMax < errorTrunkRoll) {
+                tmpMax = errorTrunkRoll;
                 tmpMaxTime = t-minTime;
-                tmpMaxName = name;
+                tmpMaxName = "trunk_roll";
             }
-            if (tmpMaxAll(index) < 0.0 || tmpMaxAll(index) < error) {
-                tmpMaxAll(index) = error;
+            if (tmpMaxAll(index) < 0.0 || tmpMaxAll(index) < errorTrunkRoll) {
+                tmpMaxAll(index) = errorTrunkRoll;
             }
             index++;
-        }
-        //Compute trunk orientation error
-        Eigen::Vector3d simTrunkAngles = sim.model().trunkSelfOrientation();
-        double errorTrunkRoll = pow(
-            trunkOrientationCoef*180.0/M_PI*Leph::AngleDistance(
-                simTrunkAngles.x(), logs.get("read:imu_roll", t)),
-            2);
-        double errorTrunkPitch = pow(
-            trunkOrientationCoef*180.0/M_PI*Leph::AngleDistance(
-                simTrunkAngles.y(), logs.get("read:imu_pitch", t)),
-            2);
-        tmpSum += errorTrunkRoll;
-        tmpSum += errorTrunkPitch;
-        tmpCount += 2.0;
-        if (tmpMax < 0.0 || tmpMax < errorTrunkRoll) {
-            tmpMax = errorTrunkRoll;
-            tmpMaxTime = t-minTime;
-            tmpMaxName = "trunk_roll";
-        }
-        if (tmpMaxAll(index) < 0.0 || tmpMaxAll(index) < errorTrunkRoll) {
-            tmpMaxAll(index) = errorTrunkRoll;
-        }
-        index++;
-        if (tmpMax < 0.0 || tmpMax < errorTrunkPitch) {
-            tmpMax = errorTrunkPitch;
-            tmpMaxTime = t-minTime;
-            tmpMaxName = "trunk_pitch";
-        }
-        if (tmpMaxAll(index) < 0.0 || tmpMaxAll(index) < errorTrunkPitch) {
-            tmpMaxAll(index) = errorTrunkPitch;
-        }
-        index++;
-        //Verbose Plot
+            if (tmpMax < 0.0 || tmpMax < errorTrunkPitch) {
+                tmpMax = errorTrunkPitch;
+                tmpMaxTime = t-minTime;
+                tmpMaxName = "trunk_pitch";
+            }
+            if (tmpMaxAll(index) < 0.0 || tmpMaxAll(index) < errorTrunkPitch) {
+                tmpMaxAll(index) = errorTrunkPitch;
+            }
+            index++;
+            //Verbose Plot
 #ifdef LEPH_VIEWER_ENABLED
-        Leph::VectorLabel vect;
-        if (verbose >= 2) {
-            for (const std::string& name : Leph::NamesDOF) {
-                vect.setOrAppend("t", t);
-                vect.setOrAppend("read:" + name, 180.0/M_PI*logs.get("read:" + name, t));
-                vect.setOrAppend("goal:" + name, 180.0/M_PI*logs.get("goal:" + name, t));
-                vect.setOrAppend("sim:" + name, 180.0/M_PI*sim.getPos(name));
+            Leph::VectorLabel vect;
+            if (verbose >= 2) {
+                for (size_t i=0;i<sizeDOF;i++) {
+                    const std::string& name = Leph::NamesDOF[i];
+                    vect.setOrAppend("t", t);
+                    vect.setOrAppend("read:" + name, 180.0/M_PI*seq.reads(i, k));
+                    vect.setOrAppend("goal:" + name, 180.0/M_PI*seq.goals(i, k));
+                    vect.setOrAppend("sim:" + name, 180.0/M_PI*sim.getPos(name));
+                }
+                vect.setOrAppend("read:trunk_pitch", 180.0/M_PI*seq.imu(1, k));
+                vect.setOrAppend("read:trunk_roll", 180.0/M_PI*seq.imu(0, k));
+                vect.setOrAppend("sim:trunk_roll", 180.0/M_PI*simTrunkAngles.x());
+                vect.setOrAppend("sim:trunk_pitch", 180.0/M_PI*simTrunkAngles.y());
+                plot.add(vect);
             }
-            vect.setOrAppend("read:trunk_pitch", 180.0/M_PI*logs.get("read:imu_pitch", t));
-            vect.setOrAppend("read:trunk_roll", 180.0/M_PI*logs.get("read:imu_roll", t));
-            vect.setOrAppend("sim:trunk_roll", 180.0/M_PI*simTrunkAngles.x());
-            vect.setOrAppend("sim:trunk_pitch", 180.0/M_PI*simTrunkAngles.y());
-            plot.add(vect);
-        }
-        if (verbose >= 3) {
-            Leph::CleatsDraw(sim, *viewer);
-            Leph::ModelDraw(sim.model(), *viewer, 1.0);
-            Leph::ModelDraw(modelRead, *viewer, 0.5);
+            if (verbose >= 3) {
+                for (size_t i=0;i<sizeDOF;i++) {
+                    modelRead->setDOF(Leph::NamesDOF[i], seq.reads(i, k));
+                }
+                modelRead->setDOF("base_roll", seq.reads(sizeDOF + 0, k));
+                modelRead->setDOF("base_pitch", seq.reads(sizeDOF + 1, k));
+                Leph::CleatsDraw(sim, *viewer);
+                Leph::ModelDraw(sim.model(), *viewer, 1.0);
+                Leph::ModelDraw(*modelRead, *viewer, 0.5);
+            }
+#endif
         }
+    } catch (...) {
+#ifdef LEPH_VIEWER_ENABLED
+        delete viewer;
+        delete modelRead;
 #endif
+        releaseContext(context);
+        throw;
     }
+    releaseContext(context);
     
     if (verbose >= 1) {
         std::cout << "MeanError: " << sqrt(tmpSum/tmpCount) << std::endl;
@@ -350,6 +550,7 @@ static double scoreFitness(
     }
     if (verbose >= 3) {
         delete viewer;
+        delete modelRead;
     }
 #endif
     if (sumError != nullptr) {
@@ -451,7 +652,7 @@ static void saveModelParameters(
 static void printUsage()
 {
     std::cout << "Usage: " <<
-        "./app output.modelparams mode ... " <<
+        "./app output.modelparams mode ... [WORKERS=count] " <<
         "LEARNING logfile.mapseries ... " <<
         "VALIDATION logfile.mapseries ... " << 
         "SEED inputSeed.modelparams" << std::endl;
@@ -460,6 +661,8 @@ static void printUsage()
     std::cout << "-- JOINTS" << std::endl;
     std::cout << "-- INERTIAS" << std::endl;
     std::cout << "-- GEOMETRIES" << std::endl;
+    std::cout << "WORKERS dispatches fitness evaluations "
+        << "to given number of forked processes" << std::endl;
 }
 
 /**
@@ -483,6 +686,7 @@ int main(int argc, char** argv)
     bool isIdentificationJoints = false;
     bool isIdentificationInertias = false;
     bool isIdentificationGeometries = false;
+    unsigned int workersCount = 0;
     while (argIndex < argc && std::string(argv[argIndex]) != "LEARNING") {
         if (std::string(argv[argIndex]) == "COMMON") {
             isIdentificationCommon = true;
@@ -492,6 +696,8 @@ int main(int argc, char** argv)
             isIdentificationInertias = true;
         } else if (std::string(argv[argIndex]) == "GEOMETRIES") {
             isIdentificationGeometries = true;
+        } else if (std::string(argv[argIndex]).find("WORKERS=") == 0) {
+            workersCount = std::stoi(std::string(argv[argIndex]).substr(8));
         } else {
             std::cout << "Invalid optimization option." << std::endl;
             printUsage();
@@ -520,31 +726,35 @@ int main(int argc, char** argv)
         inputParamsFilename = argv[argIndex];
     }
 
-    //Load learning data logs into MapSeries
-    std::vector<Leph::MapSeries> logsData;
+    //Load learning data logs and resample them
+    //once on the replay time grid
+    std::vector<LogSequence> logsData;
     for (size_t i=0;i<filenames.size();i++) {
-        logsData.push_back(Leph::MapSeries());
-        logsData.back().importData(filenames[i]);
+        Leph::MapSeries logs;
+        logs.importData(filenames[i]);
         std::cout << "Loaded learning " 
             << filenames[i] << ": "
-            << logsData.back().dimension() << " series from " 
-            << logsData.back().timeMin() << "s to " 
-            << logsData.back().timeMax() << "s with length "
-            << logsData.back().timeMax()-logsData.back().timeMin() 
+            << logs.dimension() << " series from " 
+            << logs.timeMin() << "s to " 
+            << logs.timeMax() << "s with length "
+            << logs.timeMax()-logs.timeMin() 
             << "s" << std::endl;
+        logsData.push_back(buildSequence(logs));
     }
-    //Load validation data logs into MapSeries
-    std::vector<Leph::MapSeries> logsValidation;
+    //Load validation data logs and resample them
+    //once on the replay time grid
+    std::vector<LogSequence> logsValidation;
     for (size_t i=0;i<filenamesValidation.size();i++) {
-        logsValidation.push_back(Leph::MapSeries());
-        logsValidation.back().importData(filenamesValidation[i]);
+        Leph::MapSeries logs;
+        logs.importData(filenamesValidation[i]);
         std::cout << "Loaded validation " 
             << filenamesValidation[i] << ": "
-            << logsValidation.back().dimension() << " series from " 
-            << logsValidation.back().timeMin() << "s to " 
-            << logsValidation.back().timeMax() << "s with length "
-            << logsValidation.back().timeMax()-logsValidation.back().timeMin() 
+            << logs.dimension() << " series from " 
+            << logs.timeMin() << "s to " 
+            << logs.timeMax() << "s with length "
+            << logs.timeMax()-logs.timeMin() 
             << "s" << std::endl;
+        logsValidation.push_back(buildSequence(logs));
     }
 
     //Inertia default data and name
@@ -706,6 +916,12 @@ int main(int argc, char** argv)
     Eigen::VectorXd bestParams = initParams;
     double bestScore = -1.0;
     int iteration = 1;
+    //Fitness evaluations count and wall
+    //time since last progress report
+    std::atomic<unsigned long> countEvaluations(0);
+    unsigned long countLastReport = 0;
+    std::chrono::steady_clock::time_point timeLastReport = 
+        std::chrono::steady_clock::now();
     
     //Fitness function
     libcmaes::FitFuncEigen fitness = 
@@ -799,9 +1015,28 @@ int main(int argc, char** argv)
         for (size_t i=0;i<Leph::NamesDOF.size() + 2;i++) {
             maxAllError(i) = -1.0;
         }
-        for (size_t i=0;i<logsData.size();i++) {
+        //Logs are evaluated concurrently (when not
+        //already inside a fitness thread) and their 
+        //errors are merged in logs order.
+        //SimulationEnsemble is not used here: logs have
+        //different lengths and per step error checks, and
+        //simulations are reused across candidates through
+        //the contexts pool keyed by model data while the
+        //ensemble rebuilds its members on new model data.
+        size_t sizeLogs = logsData.size();
+        std::vector<char> logsFailed(sizeLogs, 0);
+        std::vector<double> logsSum(sizeLogs, 0.0);
+        std::vector<double> logsCount(sizeLogs, 0.0);
+        std::vector<double> logsMax(sizeLogs, -1.0);
+        std::vector<Eigen::VectorXd> logsMaxAll(sizeLogs, maxAllError);
+        //Exceptions must not escape the OpenMP region.
+        //Other than numerical instabilities, the first
+        //one is kept and rethrown after.
+        std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic)
+        for (size_t i=0;i<sizeLogs;i++) {
             try {
-                cost += scoreFitness(
+                scoreFitness(
                     logsData[i], coef.array() * params.array(),
                     indexStartCommon, indexStartJoints, 
                     indexStartInertias, indexStartGeometries,
@@ -810,9 +1045,33 @@ int main(int argc, char** argv)
                     defaultInertiaData, defaultInertiaName, 
                     defaultGeometryData, defaultGeometryName, 
                     0,
-                    &sumError, &countError, &maxError, &maxAllError);
+                    &logsSum[i], &logsCount[i], &logsMax[i], &logsMaxAll[i]);
             } catch (const std::runtime_error& e) {
+                logsFailed[i] = 1;
+            } catch (...) {
+#pragma omp critical(IdentificationLogsError)
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        for (size_t i=0;i<sizeLogs;i++) {
+            if (logsFailed[i]) {
                 cost += 10000.0;
+                continue;
+            }
+            sumError += logsSum[i];
+            countError += logsCount[i];
+            if (maxError < 0.0 || maxError < logsMax[i]) {
+                maxError = logsMax[i];
+            }
+            for (size_t j=0;j<Leph::NamesDOF.size() + 2;j++) {
+                if (logsMaxAll[i](j) > maxAllError(j)) {
+                    maxAllError(j) = logsMaxAll[i](j);
+                }
             }
         }
         if (countError > 0.0 && maxError > 0.0) {
@@ -830,6 +1089,7 @@ int main(int argc, char** argv)
     libcmaes::ProgressFunc<
         libcmaes::CMAParameters<>, libcmaes::CMASolutions> progress = 
         [&bestParams, &bestScore, &iteration, &coef, 
+        &countEvaluations, &countLastReport, &timeLastReport, 
         &logsData, &filenames, &outputParamsFilename,
         &logsValidation, &filenamesValidation,
         &indexStartCommon, &indexStartJoints, 
@@ -857,6 +1117,18 @@ int main(int argc, char** argv)
             std::cout << "BestScore: " << bestScore << std::endl;
             //Show current optimization state
             std::cout << "Score: " << score<< std::endl;
+            //Show evaluations throughput
+            std::chrono::steady_clock::time_point timeNow = 
+                std::chrono::steady_clock::now();
+            unsigned long countNow = countEvaluations.load();
+            double elapsed = std::chrono::duration<double>(
+                timeNow - timeLastReport).count();
+            if (elapsed > 0.0) {
+                std::cout << "EvaluationsPerSecond: " 
+                    << (countNow - countLastReport)/elapsed << std::endl;
+            }
+            countLastReport = countNow;
+            timeLastReport = timeNow;
             //Saving
             saveModelParameters(
                 outputParamsFilename,
@@ -905,6 +1177,31 @@ int main(int argc, char** argv)
             ::_defaultPFunc(cmaparams, cmasols);
     };
     
+    //Dispatch fitness evaluations to forked
+    //worker processes holding their own copy 
+    //of loaded logs (before any fitness thread)
+    std::unique_ptr<Leph::EvaluationFarm> farm;
+    libcmaes::FitFuncEigen fitnessDispatch = fitness;
+    if (workersCount > 0) {
+        farm.reset(new Leph::EvaluationFarm(
+            fitness, workersBatchSize, workersTimeout));
+        //Spare workers replace crashed ones
+        //since no process is forked afterwards
+        farm->addLocalWorkers(workersCount, workersCount);
+        std::cout << "Evaluation workers: " << farm->size() << std::endl;
+        fitnessDispatch = [&farm](const Eigen::VectorXd& params) {
+            return farm->evaluate(params);
+        };
+    }
+    //Count all dispatched evaluations
+    libcmaes::FitFuncEigen fitnessCounted = 
+        [&fitnessDispatch, &countEvaluations]
+        (const Eigen::VectorXd& params) 
+    {
+        countEvaluations++;
+        return fitnessDispatch(params);
+    };
+    
     //CMAES initialization
     libcmaes::CMAParameters<> cmaparams(
         initParams, cmaesSigma, cmaesLambda);
@@ -918,7 +1215,7 @@ int main(int argc, char** argv)
     
     //Run optimization
     libcmaes::CMASolutions cmasols = 
-        libcmaes::cmaes<>(fitness, cmaparams, progress);
+        libcmaes::cmaes<>(fitnessCounted, cmaparams, progress);
     
     //Retrieve best Trajectories and score
     bestParams = cmasols.get_best_seen_candidate().get_x_dvec();
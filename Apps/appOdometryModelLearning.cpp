@@ -441,6 +441,9 @@ int main(int argc, char** argv)
             //cartesian distance
             return vect.segment(0, 2); 
         });
+    //Same noise realization for all
+    //evaluations of the optimization
+    calibration.setCommonRandomNumbers(true);
     //Add observations data
     for (size_t i=0;i<logs.size();i++) {
         Eigen::VectorXd obs(3);
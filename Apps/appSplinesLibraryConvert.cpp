@@ -0,0 +1,57 @@
+#include <iostream>
+#include <string>
+#include "Spline/SplineContainer.hpp"
+#include "Spline/SplineLibrary.hpp"
+
+/**
+ * Convert text splines container files
+ * (Trajectories, kicks and walk outputs)
+ * into a single binary memory mappable 
+ * spline library or list the content 
+ * of a binary library
+ */
+int main(int argc, char** argv)
+{
+    //Check command line
+    if (argc == 3 && std::string(argv[1]) == "LIST") {
+        Leph::SplineLibrary library;
+        library.open(argv[2]);
+        for (const std::string& setName : library.setNames()) {
+            std::cout << "Set: " << setName << std::endl;
+            for (const std::string& name : library.splineNames(setName)) {
+                Leph::SplineLibrary::View view = 
+                    library.view(setName, name);
+                std::cout << "    " << name 
+                    << " parts=" << view.size()
+                    << " min=" << view.min() 
+                    << " max=" << view.max() << std::endl;
+            }
+        }
+        return 0;
+    }
+    if (argc < 4 || argc%2 != 0) {
+        std::cout << "Usage: ./app [output.splib] [name1] [file1.splines] [name2] [file2.splines] ..." << std::endl;
+        std::cout << "Usage: ./app LIST [input.splib]" << std::endl;
+        return 1;
+    }
+    std::string outputFile = argv[1];
+
+    //Load all text splines files
+    Leph::SplineLibrary library;
+    for (int i=2;i<argc;i+=2) {
+        std::string setName = argv[i];
+        std::string fileName = argv[i+1];
+        Leph::SplineContainer<Leph::Spline> container;
+        container.importData(fileName);
+        library.add(setName, container);
+        std::cout << "Loaded set " << setName 
+            << " with " << container.size() 
+            << " splines from " << fileName << std::endl;
+    }
+
+    //Write binary library
+    library.write(outputFile);
+    std::cout << "Written library: " << outputFile << std::endl;
+
+    return 0;
+}
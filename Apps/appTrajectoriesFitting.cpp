@@ -1,5 +1,6 @@
 #include <iostream>
 #include <vector>
+#include <map>
 #include "Spline/SplineContainer.hpp"
 #include "Spline/FittedSpline.hpp"
 #include "TrajectoryGeneration/TrajectoryUtils.h"
@@ -68,12 +69,26 @@ int main(int argc, char** argv)
         }
     }
 
-    //Compute fitting
+    //Compute fitting of all channels concurrently
+    std::map<std::string, double> maxErrorsDOF;
+    std::map<std::string, double> maxErrorsTorque;
     for (const std::string& name : Leph::NamesDOFLeg) {
-        double maxError1 = trajDOF.get(name).fittingPolynomPieces(4, 0.25, 1.0);
-        double maxError2 = trajTorque.get(name).fittingPolynomPieces(4, 0.25, 1.0);
-        std::cout << "Position " << name << " max fitting error: " << maxError1 << std::endl;
-        std::cout << "Torque " << name << " max fitting error: " << maxError2 << std::endl;
+        maxErrorsDOF[name] = 0.0;
+        maxErrorsTorque[name] = 0.0;
+    }
+    trajDOF.applyParallel([&maxErrorsDOF]
+        (const std::string& name, Leph::FittedSpline& spline) {
+            maxErrorsDOF.at(name) = 
+                spline.fittingPolynomPieces(4, 0.25, 1.0);
+        });
+    trajTorque.applyParallel([&maxErrorsTorque]
+        (const std::string& name, Leph::FittedSpline& spline) {
+            maxErrorsTorque.at(name) = 
+                spline.fittingPolynomPieces(4, 0.25, 1.0);
+        });
+    for (const std::string& name : Leph::NamesDOFLeg) {
+        std::cout << "Position " << name << " max fitting error: " << maxErrorsDOF.at(name) << std::endl;
+        std::cout << "Torque " << name << " max fitting error: " << maxErrorsTorque.at(name) << std::endl;
     }
 
     //Display retulting fitting
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <sstream>
 #include <unistd.h>
 #include "TrajectoryGeneration/TrajectoryParameters.hpp"
 #include "TrajectoryGeneration/TrajectoryGeneration.hpp"
@@ -26,6 +27,14 @@ int main(int argc, char** argv)
         std::cout << 
             "Usage: ./app SEED trajectoryName outputPrefix seed.params [paramName=value] ... " << 
             "[MODEL] [path.modelparams]" << std::endl;
+        std::cout << 
+            "Usage: ./app WARMRESTART trajectoryName outputPrefix state.checkpoint [paramName=value] ... " << 
+            "[MODEL] [path.modelparams]" << std::endl;
+        std::cout << 
+            "Usage: ./app WORKER trajectoryName port [paramName=value] ... " << 
+            "[MODEL] [path.modelparams]" << std::endl;
+        std::cout << 
+            "Remote evaluation workers are given with [REMOTE=host:port] ..." << std::endl;
         std::cout << "Available trajectories:" << std::endl;
         std::cout << "-- staticpose" << std::endl;
         std::cout << "-- kicksingle" << std::endl;
@@ -36,13 +45,17 @@ int main(int argc, char** argv)
         return 1;
     }
     std::string mode = argv[1];
-    if (mode != "RUN" && mode != "SEED") {
+    if (
+        mode != "RUN" && mode != "SEED" && 
+        mode != "WARMRESTART" && mode != "WORKER"
+    ) {
         std::cout << "Invalid mode: " << mode << std::endl;
         return 1;
     }
     std::string trajName = argv[2];
     std::string outputPrefix = argv[3];
     std::string seedParametersFile = "";
+    std::string checkpointFile = "";
     size_t startInputIndex = 4;
     if (mode == "SEED") {
         if (argc < 5) {
@@ -52,8 +65,17 @@ int main(int argc, char** argv)
         startInputIndex = 5;
         seedParametersFile = argv[4];
     }
+    if (mode == "WARMRESTART") {
+        if (argc < 5) {
+            std::cout << "WARMRESTART mode but no checkpoint file" << std::endl;
+            return 1;
+        }
+        startInputIndex = 5;
+        checkpointFile = argv[4];
+    }
     //Parse parameters
     std::vector<std::pair<std::string, double>> inputParameters;
+    std::vector<std::string> remoteWorkers;
     std::string modelParametersPath;
     for (size_t i=startInputIndex;i<(size_t)argc;i++) {
         std::string part = argv[i];
@@ -63,6 +85,10 @@ int main(int argc, char** argv)
                 << modelParametersPath << std::endl;
             break;
         }
+        if (part.find("REMOTE=") == 0) {
+            remoteWorkers.push_back(part.substr(7));
+            continue;
+        }
         size_t pos = part.find("=");
         if (pos == std::string::npos) {
             std::cout << "Error format: " << part << std::endl;
@@ -161,6 +187,10 @@ int main(int argc, char** argv)
         }
     }
     
+    //Freeze parameters layout used
+    //by generation functions
+    trajParams.freeze();
+
     //Build initial parameters
     Eigen::VectorXd initParams = trajParams.buildVector();
     //Build normalization coefficents
@@ -182,12 +212,55 @@ int main(int argc, char** argv)
         << " lambda=" << (unsigned int)trajParams.get("cmaes_lambda")
         << " sigma=" << trajParams.get("cmaes_sigma")
         << " elitism=" << trajParams.get("cmaes_elitism")
+        << " cost_bounding=" << trajParams.get("cmaes_cost_bounding")
+        << " workers=" << trajParams.get("cmaes_workers")
+        << " remote_workers=" << remoteWorkers.size()
+        << " surrogate=" << trajParams.get("cmaes_surrogate")
+        << " archive=" << trajParams.get("cmaes_archive")
+        << " refine_iterations=" << trajParams.get("cmaes_refine_iterations")
         << std::endl;
 
     //Set initial parameters
     generator.setInitialParameters(initParams);
     //Set normalization coefficients
     generator.setNormalizationCoefs(normCoefs);
+    //Run remote evaluation worker if WORKER mode
+    if (mode == "WORKER") {
+        unsigned int port = std::stoi(outputPrefix);
+        std::cout << "Evaluation worker on port: " << port << std::endl;
+        generator.serveEvaluations(port);
+        return 0;
+    }
+    //Dispatch evaluations to worker processes
+    generator.setEvaluationWorkers(
+        (unsigned int)trajParams.get("cmaes_workers"),
+        remoteWorkers,
+        (unsigned int)trajParams.get("cmaes_workers_batch"),
+        trajParams.get("cmaes_workers_timeout"));
+    //Surrogate pre-screening of candidates
+    generator.setSurrogate(trajParams.get("cmaes_surrogate") > 0.5);
+    //Memoization of evaluations bound to the
+    //trajectory and its (non CMA-ES) parameters
+    if (trajParams.get("cmaes_archive") > 0.5) {
+        std::ostringstream paramsPrint;
+        trajParams.print(paramsPrint);
+        std::istringstream paramsLines(paramsPrint.str());
+        std::string configName = trajName;
+        std::string line;
+        while (std::getline(paramsLines, line)) {
+            if (line.find("cmaes") == std::string::npos) {
+                configName += line;
+            }
+        }
+        generator.setFitnessArchive(filename + ".archive", configName);
+    }
+    //Periodically save the CMA-ES state
+    //and warm restart from it if WARMRESTART mode
+    generator.setCheckpoint(filename + ".checkpoint");
+    if (mode == "WARMRESTART") {
+        generator.warmRestartFromCheckpoint(checkpointFile);
+        std::cout << "Warm restart CMA-ES from: " << checkpointFile << std::endl;
+    }
     
 #ifdef LEPH_VIEWER_ENABLED
     //Display initial trajectory
@@ -205,7 +278,15 @@ int main(int argc, char** argv)
         (unsigned int)trajParams.get("cmaes_lambda"), 
         trajParams.get("cmaes_sigma"),
         (unsigned int)trajParams.get("cmaes_elitism"),
-        100, false);
+        100, false,
+        trajParams.get("cmaes_cost_bounding") > 0.5);
+    //Gradient based refinement 
+    //of the final convergence
+    if (trajParams.get("cmaes_refine_iterations") > 0.5) {
+        generator.runRefinement(
+            (unsigned int)trajParams.get("cmaes_refine_iterations"),
+            filename);
+    }
 
 #ifdef LEPH_VIEWER_ENABLED
     //Display found trajectory
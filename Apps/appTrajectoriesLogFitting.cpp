@@ -467,6 +467,10 @@ int main(int argc, char** argv)
     //Assign trajectory length
     trajParams.set("time_length") = goalTimeLength;
 
+    //Freeze parameters layout used
+    //by generation functions
+    trajParams.freeze();
+
     //Build initial parameters
     Eigen::VectorXd initParams = trajParams.buildVector();
     //Build normalization coefficents
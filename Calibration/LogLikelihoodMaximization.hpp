@@ -4,11 +4,17 @@
 #include <vector>
 #include <functional>
 #include <random>
+#include <memory>
+#include <string>
 #include <Eigen/Dense>
 #include <stdexcept>
+#include <exception>
 #include <libcmaes/cmaes.h>
 #include "Model/HumanoidFixedModel.hpp"
 #include "Utils/GaussianDistribution.hpp"
+#include "Utils/CMAESCheckpoint.hpp"
+#include "Utils/EvaluationFarm.hpp"
+#include "Utils/FitnessArchive.hpp"
 #include "Plot/Plot.hpp"
 
 namespace Leph {
@@ -91,7 +97,18 @@ class LogLikelihoodMaximization
             _transformFunc(),
             _samplingNumber(2),
             _indexesLearning(),
-            _indexesTesting()
+            _indexesTesting(),
+            _checkpointFileName(),
+            _checkpointIterations(100),
+            _checkpoint(),
+            _isWarmRestart(false),
+            _farmLocalWorkers(0),
+            _farmBatchSize(1),
+            _farmTimeout(-1.0),
+            _isSerialEvaluation(false),
+            _archive(),
+            _isCommonRandom(false),
+            _randomSeed(0)
         {
         }
 
@@ -121,6 +138,8 @@ class LogLikelihoodMaximization
          * Assign the user evaluation function,
          * the user bounding patameters function and 
          * the model initialization function.
+         * A model is initialized for each scored
+         * observation and is shared by all its samples.
          */
         void setUserFunctions(
             EvalFunc func1, 
@@ -157,6 +176,109 @@ class LogLikelihoodMaximization
             _dataContainer.push_back(data);
         }
 
+        /**
+         * Enable the periodic saving of CMA-ES
+         * state into given checkpoint file every
+         * given iterations during runOptimization()
+         */
+        void setCheckpoint(
+            const std::string& fileName,
+            unsigned int iterations = 100)
+        {
+            if (iterations == 0) {
+                throw std::logic_error(
+                    "LogLikelihoodMaximization invalid checkpoint iterations");
+            }
+            _checkpointFileName = fileName;
+            _checkpointIterations = iterations;
+        }
+
+        /**
+         * Load the CMA-ES state from given checkpoint
+         * file. Next runOptimization() call is warm
+         * restarted from the saved mean, folded step
+         * size, restart counter, best found parameters
+         * and learning/testing observations split with
+         * a new seed. Covariance shape, evolution paths
+         * and random engine state are not restored.
+         */
+        void warmRestartFromCheckpoint(const std::string& fileName)
+        {
+            _checkpoint = CMAESCheckpoint();
+            _checkpoint.importBinary(fileName);
+            if (
+                _params.size() > 0 && 
+                _checkpoint.mean().size() != _params.size()
+            ) {
+                throw std::logic_error(
+                    "LogLikelihoodMaximization invalid checkpoint dimension");
+            }
+            _isWarmRestart = true;
+        }
+
+        /**
+         * Dispatch the fitness evaluations of
+         * runOptimization() to given number of forked
+         * local worker processes (0 is disabled) by 
+         * batches of given size. Evaluations longer than
+         * given timeout in seconds (negative is infinite)
+         * are aborted and given a large cost. Each local
+         * worker has a forked spare replacing it once.
+         * Workers score observations single threaded
+         * since they may be forked after OpenMP threads
+         * have run (libgomp is not fork safe).
+         * Workers are forked after the observations
+         * split and hold their own copy of the data.
+         */
+        void setEvaluationWorkers(
+            unsigned int localWorkers,
+            unsigned int batchSize = 1,
+            double timeout = -1.0)
+        {
+            if (batchSize == 0) {
+                throw std::logic_error(
+                    "LogLikelihoodMaximization invalid worker batch size");
+            }
+            _farmLocalWorkers = localWorkers;
+            _farmBatchSize = batchSize;
+            _farmTimeout = timeout;
+        }
+
+        /**
+         * Enable or disable the memoization of 
+         * fitness and testParameters() evaluations
+         * (see FitnessArchive). The archive is
+         * cleared when observations are split again.
+         * Since evaluations are sampled, repeated
+         * parameters reuse the first sample.
+         */
+        void setFitnessArchive(
+            bool isEnabled, double quantum = 1e-9)
+        {
+            if (isEnabled) {
+                _archive = std::make_shared<FitnessArchive>(quantum);
+            } else {
+                _archive.reset();
+            }
+        }
+
+        /**
+         * Enable or disable common random numbers.
+         * If enabled, the random engine used for each
+         * observation is seeded from given seed and the
+         * observation index, so that fitness evaluations
+         * of identical parameters are identical.
+         * Else, a new seed is drawn at each evaluation.
+         * In both cases, the score does not depend on 
+         * the number of threads.
+         */
+        void setCommonRandomNumbers(
+            bool isEnabled, unsigned int seed = 0)
+        {
+            _isCommonRandom = isEnabled;
+            _randomSeed = seed;
+        }
+
         /**
          * Start and run CMA-ES parameters
          * optimization with given configuration
@@ -191,19 +313,87 @@ class LogLikelihoodMaximization
             while (_observations.size() - learningSize < 2) {
                 learningSize--;
             }
-            dataDispatch(learningSize); 
+            //Warm restart from loaded checkpoint
+            //mean with the same data split.
+            //Best normalized parameters found 
+            //before warm restart are kept.
+            unsigned long long seed = 0;
+            Eigen::VectorXd warmRestartBestParams;
+            double warmRestartBestScore = 0.0;
+            if (_isWarmRestart) {
+                const Eigen::VectorXd& split = _checkpoint.userData();
+                if ((size_t)split.size() != _observations.size()) {
+                    throw std::logic_error(
+                        "LogLikelihoodMaximization invalid checkpoint split");
+                }
+                _indexesLearning.clear();
+                _indexesTesting.clear();
+                for (size_t i=0;i<(size_t)split.size();i++) {
+                    if (split(i) > 0.5) {
+                        _indexesLearning.push_back(i);
+                    } else {
+                        _indexesTesting.push_back(i);
+                    }
+                }
+                _params = _checkpoint.mean().array() * _normCoef.array();
+                sigma = _checkpoint.warmRestartSigma();
+                if (_checkpoint.seed() != 0) {
+                    seed = _checkpoint.seed() 
+                        + _checkpoint.totalIterations();
+                }
+                restart = (restart > _checkpoint.restart()) ? 
+                    restart - _checkpoint.restart() : 0;
+                warmRestartBestParams = _checkpoint.bestParams();
+                warmRestartBestScore = _checkpoint.bestScore();
+                std::cout << "Warm restart from checkpoint:"
+                    << " iteration=" << _checkpoint.totalIterations()
+                    << " restart=" << _checkpoint.restart()
+                    << " sigma=" << sigma 
+                    << std::endl;
+                _isWarmRestart = false;
+            } else {
+                dataDispatch(learningSize); 
+                if (_archive) {
+                    _archive->clear();
+                }
+                _checkpoint = CMAESCheckpoint();
+                Eigen::VectorXd split = 
+                    Eigen::VectorXd::Zero(_observations.size());
+                for (size_t index : _indexesLearning) {
+                    split(index) = 1.0;
+                }
+                _checkpoint.setUserData(split);
+            }
             
             //Assign sampling number
             _samplingNumber = samplingNumber;
 
             //Iteration counter
             unsigned long iterations = 1;
+
+            //Fork evaluation workers before
+            //any CMA-ES fitness thread
+            std::unique_ptr<EvaluationFarm> farm;
+            if (_farmLocalWorkers > 0) {
+                farm.reset(new EvaluationFarm(
+                    [this](const Eigen::VectorXd& params) {
+                        //Only run in forked workers
+                        this->_isSerialEvaluation = true;
+                        return this->scoreFitness(params, false);
+                    }, _farmBatchSize, _farmTimeout));
+                farm->addLocalWorkers(
+                    _farmLocalWorkers, _farmLocalWorkers);
+            }
             
             //Fitness function
             libcmaes::FitFuncEigen fitness = 
-                [this]
+                [this, &farm]
                 (const Eigen::VectorXd& params) 
                 {
+                    if (farm) {
+                        return farm->evaluate(Eigen::VectorXd(
+                            params.array() * this->_normCoef.array()));
+                    }
                     return this->scoreFitness(
                         params.array() * this->_normCoef.array(), 
                         false);
@@ -212,7 +402,8 @@ class LogLikelihoodMaximization
             //Progress function
             libcmaes::ProgressFunc<
                 libcmaes::CMAParameters<>, libcmaes::CMASolutions> progress = 
-                [this, &iterations, plot]
+                [this, &iterations, plot, 
+                &warmRestartBestParams, &warmRestartBestScore]
                 (const libcmaes::CMAParameters<>& cmaparams, 
                  const libcmaes::CMASolutions& cmasols)
                 {
@@ -227,6 +418,29 @@ class LogLikelihoodMaximization
                     //Retrieve current best parameters
                     Eigen::VectorXd params = this->_normCoef.array() * 
                         cmasols.get_best_seen_candidate().get_x_dvec().array();
+                    //Save the CMA-ES state periodically
+                    if (this->_checkpointFileName != "") {
+                        Eigen::VectorXd bestParams = 
+                            cmasols.get_best_seen_candidate().get_x_dvec();
+                        double bestScore = 
+                            cmasols.get_best_seen_candidate().get_fvalue();
+                        if (
+                            warmRestartBestParams.size() > 0 &&
+                            warmRestartBestScore < bestScore
+                        ) {
+                            bestParams = warmRestartBestParams;
+                            bestScore = warmRestartBestScore;
+                        }
+                        this->_checkpoint.update(cmaparams, cmasols);
+                        this->_checkpoint.setBest(bestParams, bestScore);
+                        if (
+                            this->_checkpoint.totalIterations() 
+                            % this->_checkpointIterations == 0
+                        ) {
+                            this->_checkpoint.exportBinary(
+                                this->_checkpointFileName);
+                        }
+                    }
                     if (iterations%10 == 0) {
                         double meanLearn;
                         double varLearn;
@@ -289,7 +503,7 @@ class LogLikelihoodMaximization
             //CMAES initialization
             libcmaes::CMAParameters<> cmaparams(
                 _params.array() / _normCoef.array(),
-                sigma, populationSize);
+                sigma, populationSize, seed);
             cmaparams.set_quiet(false);
             cmaparams.set_mt_feval(true);
             cmaparams.set_str_algo("abipop");
@@ -304,6 +518,21 @@ class LogLikelihoodMaximization
             //Retrieve best Trajectories and score
             _params = cmasols.get_best_seen_candidate().get_x_dvec()
                 .array() * _normCoef.array();
+            double bestScore = 
+                cmasols.get_best_seen_candidate().get_fvalue();
+            if (
+                warmRestartBestParams.size() > 0 &&
+                warmRestartBestScore < bestScore
+            ) {
+                _params = warmRestartBestParams.array() * _normCoef.array();
+                bestScore = warmRestartBestScore;
+            }
+            //Save final state
+            if (_checkpointFileName != "") {
+                _checkpoint.setBest(
+                    _params.array() / _normCoef.array(), bestScore);
+                _checkpoint.exportBinary(_checkpointFileName);
+            }
             std::cout << "Iterations: " << iterations << std::endl;
             std::cout << "Dimensions: " << _params.size() << std::endl;
             std::cout 
@@ -366,6 +595,22 @@ class LogLikelihoodMaximization
             double& meanTest, double& varTest,
             double& minTest, double& maxTest) const
         {
+            //Lookup memoized errors
+            Eigen::VectorXd key(params.size() + 1);
+            key << 2.0, params;
+            double score;
+            Eigen::VectorXd errors;
+            if (_archive && _archive->get(key, score, errors)) {
+                meanLearn = errors(0);
+                varLearn = errors(1);
+                minLearn = errors(2);
+                maxLearn = errors(3);
+                meanTest = errors(4);
+                varTest = errors(5);
+                minTest = errors(6);
+                maxTest = errors(7);
+                return;
+            }
             //Random device initialization
             std::random_device rd;
             std::default_random_engine engine(rd());
@@ -449,6 +694,13 @@ class LogLikelihoodMaximization
             varTest = 
                 sum2ErrorTest/(double)_indexesTesting.size() 
                 - pow(meanTest, 2);
+            if (_archive) {
+                errors.resize(8);
+                errors << 
+                    meanLearn, varLearn, minLearn, maxLearn,
+                    meanTest, varTest, minTest, maxTest;
+                _archive->set(key, meanLearn, errors);
+            }
         }
 
     private:
@@ -501,12 +753,53 @@ class LogLikelihoodMaximization
         std::vector<size_t> _indexesLearning;
         std::vector<size_t> _indexesTesting;
 
+        /**
+         * Checkpoint file name (empty if disabled), 
+         * saving period, CMA-ES state and whether
+         * the state is loaded to be warm restarted
+         */
+        std::string _checkpointFileName;
+        unsigned int _checkpointIterations;
+        CMAESCheckpoint _checkpoint;
+        bool _isWarmRestart;
+
+        /**
+         * Evaluation farm local workers
+         * count, batch size and timeout
+         */
+        unsigned int _farmLocalWorkers;
+        unsigned int _farmBatchSize;
+        double _farmTimeout;
+
+        /**
+         * True in forked farm workers
+         * where observations are
+         * scored single threaded
+         */
+        bool _isSerialEvaluation;
+
+        /**
+         * Fitness archive (null if disabled).
+         * Parameters are prefixed by 0 for learning,
+         * 1 for testing and 2 for testParameters().
+         */
+        std::shared_ptr<FitnessArchive> _archive;
+
+        /**
+         * If true, observations random engines are
+         * seeded from the fixed random seed
+         */
+        bool _isCommonRandom;
+        unsigned int _randomSeed;
+
         /**
          * Sample the user evaluation function 
          * samplingNumber times using given parameters.
          * Estimate the resulting multivariate gaussian
          * distribution and compute the log maginal 
          * likelihood with respect to the given observation.
+         * Samples are accumulated on the fly 
+         * (see GaussianAccumulator) and not stored.
          */
         double scoreParametersLogLikelihood(
             const Eigen::VectorXd& params,
@@ -515,9 +808,14 @@ class LogLikelihoodMaximization
             TypeModel& model,
             std::default_random_engine& engine) const
         {
-            //Sample user function and store
+            //Check sampling number
+            if (_samplingNumber < 2) {
+                throw std::logic_error(
+                    "LogLikelihoodMaximization not enough samples");
+            }
+            //Sample user function and accumulate
             //the computed estimations
-            std::vector<Eigen::VectorXd> estimations;
+            Leph::GaussianAccumulator accumulator(obs.size());
             for (unsigned int k=0;k<_samplingNumber;k++) {
                 //Call user function
                 Eigen::VectorXd estimate = _evalFunc(
@@ -528,13 +826,13 @@ class LogLikelihoodMaximization
                         "LogLikelihoodMaximization " +
                         std::string("user function invalid size"));
                 }
-                //Save it
-                estimations.push_back(estimate);
+                //Accumulate it
+                accumulator.add(estimate);
             }
             
             //Estimate the gaussian distribution
             Leph::GaussianDistribution dist;
-            dist.fit(estimations);
+            dist.fit(accumulator);
 
             //Compute the log likelihood
             return dist.logProbability(obs);
@@ -545,12 +843,24 @@ class LogLikelihoodMaximization
          * the user observations.
          * If useTestData is true, the testing set
          * is used instead of learning set.
+         * Observations are evaluated concurrently 
+         * (OpenMP, unless in a farm worker) with one
+         * model and one random engine per observation
+         * so that the score does not depend on the
+         * threads scheduling.
          */
         double scoreFitness(
             const Eigen::VectorXd& params, bool useTestData) const
         {
             const std::vector<size_t>& usedSet = 
                 useTestData ? _indexesTesting : _indexesLearning;
+            //Lookup memoized score
+            Eigen::VectorXd key(params.size() + 1);
+            key << (useTestData ? 1.0 : 0.0), params;
+            double score;
+            if (_archive && _archive->get(key, score)) {
+                return score;
+            }
             //Check size
             if (usedSet.size() < 2) {
                 throw std::logic_error(
@@ -564,26 +874,58 @@ class LogLikelihoodMaximization
                 return costBound;
             }
             
-            //Random device initialization
-            std::random_device rd;
-            std::default_random_engine engine(rd());
-            
-            //Model initialization
-            TypeModel model = _initFunc(params);
+            //Random seed of this evaluation
+            unsigned int seed = _randomSeed;
+            if (!_isCommonRandom) {
+                std::random_device rd;
+                seed = rd();
+            }
     
             //Iterate over all observations
+            //(the first failed observation
+            //exception is forwarded)
+            std::vector<double> scores(usedSet.size(), 0.0);
+            std::exception_ptr error;
+            size_t errorIndex = usedSet.size();
+#pragma omp parallel for schedule(dynamic) if(!_isSerialEvaluation)
+            for (size_t i=0;i<usedSet.size();i++) {
+                try {
+                    //Model initialization and random engine
+                    //depending only on the seed and observation
+                    TypeModel model = _initFunc(params);
+                    size_t indexSet = usedSet[i];
+                    std::seed_seq seq{
+                        seed, (unsigned int)indexSet};
+                    std::default_random_engine engine(seq);
+                    scores[i] = scoreParametersLogLikelihood(
+                        params, _observations[indexSet], 
+                        _dataContainer[indexSet], model, engine);
+                } catch (...) {
+#pragma omp critical
+                    {
+                        if (i < errorIndex) {
+                            error = std::current_exception();
+                            errorIndex = i;
+                        }
+                    }
+                }
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            //Sum in observations order
             double logLikelihood = 0.0;
             for (size_t i=0;i<usedSet.size();i++) {
-                size_t indexSet = usedSet[i];
-                double tmpScore = scoreParametersLogLikelihood(
-                    params, _observations[indexSet], 
-                    _dataContainer[indexSet], model, engine);
-                logLikelihood += tmpScore;
+                logLikelihood += scores[i];
             }
 
             //Return normalized inversed score
             //(minimization)
-            return -logLikelihood/(double)usedSet.size();
+            score = -logLikelihood/(double)usedSet.size();
+            if (_archive) {
+                _archive->set(key, score);
+            }
+            return score;
         }
 
         /**
@@ -1,5 +1,6 @@
 #include <stdexcept>
 #include <algorithm>
+#include <cstdint>
 #include "DMP/DMPSpline.hpp"
 
 namespace Leph {
@@ -464,6 +465,74 @@ void DMPSpline::importData(std::istream& is)
     }
 }
 
+void DMPSpline::exportBinary(std::ostream& os) const
+{
+    uint64_t kernelNum = _kernelNum;
+    uint64_t pointSize = _points.size();
+    os.write((const char*)&kernelNum, sizeof(kernelNum));
+    os.write((const char*)&pointSize, sizeof(pointSize));
+    os.write((const char*)&_overlap, sizeof(double));
+    os.write((const char*)&_maxTimeStep, sizeof(double));
+    for (size_t i=0;i<_points.size();i++) {
+        os.write((const char*)&_points[i].time, sizeof(double));
+        os.write((const char*)&_points[i].position, sizeof(double));
+        os.write((const char*)&_points[i].velocity, sizeof(double));
+        os.write((const char*)&_points[i].acceleration, sizeof(double));
+    }
+    Eigen::VectorXd weights = getKernelWeights();
+    Eigen::VectorXd widths = getKernelWidths();
+    for (size_t i=0;i<_kernelNum;i++) {
+        os.write((const char*)&widths(i), sizeof(double));
+        os.write((const char*)&weights(i), sizeof(double));
+    }
+}
+void DMPSpline::importBinary(std::istream& is)
+{
+    //Cleaning
+    _points.clear();
+    _parts.clear();
+    //Load spline conf
+    uint64_t kernelNum = 0;
+    uint64_t pointSize = 0;
+    is.read((char*)&kernelNum, sizeof(kernelNum));
+    is.read((char*)&pointSize, sizeof(pointSize));
+    is.read((char*)&_overlap, sizeof(double));
+    is.read((char*)&_maxTimeStep, sizeof(double));
+    if (!is.good()) {
+        throw std::logic_error(
+            "DMPSpline binary import format invalid");
+    }
+    _kernelNum = kernelNum;
+    //Load via points
+    for (size_t i=0;i<pointSize;i++) {
+        Point point;
+        is.read((char*)&point.time, sizeof(double));
+        is.read((char*)&point.position, sizeof(double));
+        is.read((char*)&point.velocity, sizeof(double));
+        is.read((char*)&point.acceleration, sizeof(double));
+        _points.push_back(point);
+    }
+    if (!is.good()) {
+        throw std::logic_error(
+            "DMPSpline binary import format invalid");
+    }
+    //Rebuilt all DMP
+    computeSplines();
+    //Load kernel withs and weights
+    for (size_t i=0;i<_kernelNum;i++) {
+        double weight;
+        double width;
+        is.read((char*)&width, sizeof(double));
+        is.read((char*)&weight, sizeof(double));
+        setKernelWidth(i, width);
+        setKernelWeight(i, weight);
+    }
+    if (!is.good()) {
+        throw std::logic_error(
+            "DMPSpline binary import format invalid");
+    }
+}
+
 void DMPSpline::plot(
     Plot& plot, const std::string& name)
 {
@@ -145,6 +145,14 @@ class DMPSpline
          */
         void exportData(std::ostream& os) const;
         void importData(std::istream& is);
+
+        /**
+         * Write and read splines data into given
+         * iostream in compact binary format
+         * (native endianness, exact double values)
+         */
+        void exportBinary(std::ostream& os) const;
+        void importBinary(std::istream& is);
         
         /**
          * Return or update given a Plot instance 
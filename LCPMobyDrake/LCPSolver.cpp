@@ -90,10 +90,51 @@ const double NEAR_ZERO = std::sqrt(std::numeric_limits<double>::epsilon());
 // Sole constructor
 MobyLCPSolver::MobyLCPSolver()
     : 
-      log_enabled_(false) {}
+      log_enabled_(false), pivots_(0) {}
 
 void MobyLCPSolver::SetLoggingEnabled(bool enabled) { log_enabled_ = enabled; }
 
+void MobyLCPSolver::SetWarmStartBasis(const std::vector<unsigned>& basis) {
+  warm_basis_ = basis;
+}
+
+void MobyLCPSolver::ClearWarmStartBasis() { warm_basis_.clear(); }
+
+const std::vector<unsigned>& MobyLCPSolver::GetSolutionBasis() const {
+  return solution_basis_;
+}
+
+unsigned MobyLCPSolver::GetPivots() const { return pivots_; }
+
+bool MobyLCPSolver::IsWarmStartBasisValid(unsigned n) const {
+  if (warm_basis_.empty()) {
+    return false;
+  }
+  for (size_t i = 0; i < warm_basis_.size(); i++) {
+    if (warm_basis_[i] >= n ||
+        (i > 0 && warm_basis_[i] <= warm_basis_[i - 1])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void MobyLCPSolver::SetupWarmStartIndices(unsigned n,
+                                          std::vector<unsigned>* in,
+                                          std::vector<unsigned>* out) const {
+  // indices of the warm start basis and their complement
+  in->clear();
+  out->clear();
+  for (unsigned i = 0, j = 0; i < n; i++) {
+    if (j < warm_basis_.size() && warm_basis_[j] == i) {
+      in->push_back(i);
+      j++;
+    } else {
+      out->push_back(i);
+    }
+  }
+}
+
 std::ostream& MobyLCPSolver::Log() const {
   if (log_enabled_) {
     return std::cerr;
@@ -115,12 +156,33 @@ void MobyLCPSolver::ClearIndexVectors() const {
 bool MobyLCPSolver::SolveLcpFast(const Eigen::MatrixXd& M,
                                  const Eigen::VectorXd& q, Eigen::VectorXd* z,
                                  double zero_tol) const {
+  if (!IsWarmStartBasisValid(q.size())) {
+    return SolveLcpFastFromBasis(M, q, z, zero_tol, false);
+  }
+  if (SolveLcpFastFromBasis(M, q, z, zero_tol, true)) {
+    return true;
+  }
+
+  // restart without warm start basis, counting all pivots
+  Log() << "MobyLCPSolver::SolveLcpFast() - warm start failed" << std::endl;
+  const unsigned warm_piv = pivots_;
+  const bool result = SolveLcpFastFromBasis(M, q, z, zero_tol, false);
+  pivots_ += warm_piv;
+  return result;
+}
+
+bool MobyLCPSolver::SolveLcpFastFromBasis(const Eigen::MatrixXd& M,
+                                          const Eigen::VectorXd& q,
+                                          Eigen::VectorXd* z, double zero_tol,
+                                          bool warm_start) const {
   const unsigned N = q.rows();
   const unsigned UINF = std::numeric_limits<unsigned>::max();
 
   Log() << "MobyLCPSolver::SolveLcpFast() entered" << std::endl;
 
   // look for trivial solution
+  pivots_ = 0;
+  solution_basis_.clear();
   if (N == 0) {
     Log() << "MobyLCPSolver::SolveLcpFast() - empty problem" << std::endl;
     z->resize(0);
@@ -138,7 +200,13 @@ bool MobyLCPSolver::SolveLcpFast(const Eigen::MatrixXd& M,
   bas_.clear();
 
   // see whether to warm-start
-  if (z->size() == q.size()) {
+  if (warm_start) {
+    Log() << "MobyLCPSolver::SolveLcpFast() - warm starting from basis"
+          << std::endl;
+
+    // z variables of the basis are the nonbasic indices here
+    SetupWarmStartIndices(N, &nonbas_, &bas_);
+  } else if (z->size() == q.size()) {
     Log() << "MobyLCPSolver::SolveLcpFast() - warm starting activated"
           << std::endl;
 
@@ -227,6 +295,8 @@ bool MobyLCPSolver::SolveLcpFast(const Eigen::MatrixXd& M,
         for (unsigned i = 0, j = 0; j < nonbas_.size(); i++, j++) {
           (*z)[nonbas_[j]] = z_[i];
         }
+        solution_basis_ = nonbas_;
+        std::sort(solution_basis_.begin(), solution_basis_.end());
 
         Log() << "MobyLCPSolver::SolveLcpFast() - solution found!" << std::endl;
         return true;
@@ -431,9 +501,15 @@ void MobyLCPSolver::FinishLemkeSolution(const MatrixType& M,
                                         Eigen::VectorXd* z) const {
   std::vector<unsigned>::iterator iiter;
   int idx;
+  const unsigned n = q.size();
+  solution_basis_.clear();
   for (idx = 0, iiter = bas_.begin(); iiter != bas_.end(); iiter++, idx++) {
     (*z)(*iiter) = x_(idx);
+    if (*iiter < n) {
+      solution_basis_.push_back(*iiter);
+    }
   }
+  std::sort(solution_basis_.begin(), solution_basis_.end());
 
   // TODO(sammy-tri) Is there a more efficient way to resize and
   // preserve the data?
@@ -459,6 +535,27 @@ void MobyLCPSolver::FinishLemkeSolution(const MatrixType& M,
 bool MobyLCPSolver::SolveLcpLemke(const Eigen::MatrixXd& M,
                                   const Eigen::VectorXd& q, Eigen::VectorXd* z,
                                   double piv_tol, double zero_tol) const {
+  if (!IsWarmStartBasisValid(q.size())) {
+    return SolveLcpLemkeFromBasis(M, q, z, piv_tol, zero_tol, false);
+  }
+  if (SolveLcpLemkeFromBasis(M, q, z, piv_tol, zero_tol, true)) {
+    return true;
+  }
+
+  // restart from the trivial basis, counting all pivots
+  Log() << "MobyLCPSolver::SolveLcpLemke() - warm start failed" << std::endl;
+  const unsigned warm_piv = pivots_;
+  const bool result =
+      SolveLcpLemkeFromBasis(M, q, z, piv_tol, zero_tol, false);
+  pivots_ += warm_piv;
+  return result;
+}
+
+bool MobyLCPSolver::SolveLcpLemkeFromBasis(const Eigen::MatrixXd& M,
+                                           const Eigen::VectorXd& q,
+                                           Eigen::VectorXd* z, double piv_tol,
+                                           double zero_tol,
+                                           bool warm_start) const {
   if (log_enabled_) {
     Log() << "MobyLCPSolver::SolveLcpLemke() entered" << std::endl;
     Log() << "  M: " << std::endl << M;
@@ -470,6 +567,7 @@ bool MobyLCPSolver::SolveLcpLemke(const Eigen::MatrixXd& M,
 
   // update the pivots
   pivots_ = 0;
+  solution_basis_.clear();
 
   // look for immediate exit
   if (n == 0) {
@@ -489,15 +587,6 @@ bool MobyLCPSolver::SolveLcpLemke(const Eigen::MatrixXd& M,
     return true;
   }
 
-  // Lemke's algorithm doesn't seem to like warmstarting
-  //
-  // TODO(sammy-tri) this is not present in the sparse solver, and it
-  // causes subtle dead code below.
-  z->fill(0);
-
-  // copy z to z0
-  z0_ = *z;
-
   ClearIndexVectors();
 
   // initialize variables
@@ -514,17 +603,11 @@ bool MobyLCPSolver::SolveLcpLemke(const Eigen::MatrixXd& M,
   std::vector<unsigned>::iterator iiter;
 
   // determine initial basis
-  if (z0_.size() != n) {
+  if (!warm_start) {
     // setup the nonbasic indices
     for (unsigned i = 0; i < n; i++) nonbas_.push_back(i);
   } else {
-    for (unsigned i = 0; i < n; i++) {
-      if (z0_[i] > 0) {
-        bas_.push_back(i);
-      } else {
-        nonbas_.push_back(i);
-      }
-    }
+    SetupWarmStartIndices(n, &bas_, &nonbas_);
   }
 
   // determine initial values
@@ -552,10 +635,15 @@ bool MobyLCPSolver::SolveLcpLemke(const Eigen::MatrixXd& M,
     //
     // The original version of this code from Moby could handle the
     // case where the colver failed (though only in this dense
-    // implementation).  It's not obvious how to do this from Eigen,
-    // so we've (sam.creasey) assumed that the solve succeeds.
+    // implementation). A singular basis is detected from non finite
+    // values and the caller restarts from the trivial basis.
     Al_ = Bl_;
     x_ = Al_.lu().solve(q);
+    x_ *= -1;
+    if (!x_.allFinite()) {
+      Log() << "-- singular warm start basis" << std::endl;
+      return false;
+    }
   } else {
     Log() << "-- using basis of -1 (no warmstarting)" << std::endl;
 
@@ -28,6 +28,22 @@ class MobyLCPSolver {
 
   void SetLoggingEnabled(bool enabled);
 
+  /// Sets the basis SolveLcpLemke() and SolveLcpFast() start from,
+  /// given as the sorted indices of the z variables in the basis
+  /// (typically the solution basis of the previous, similar problem).
+  /// An empty basis, or a basis not matching the problem size,
+  /// starts from the trivial basis. If pivoting from the given
+  /// basis fails, the solve is restarted without it.
+  void SetWarmStartBasis(const std::vector<unsigned>& basis);
+  void ClearWarmStartBasis();
+
+  /// Returns the sorted indices of the z variables in the basis
+  /// of the last solution found by SolveLcpLemke() or SolveLcpFast()
+  const std::vector<unsigned>& GetSolutionBasis() const;
+
+  /// Returns the number of pivots of the last solve
+  unsigned GetPivots() const;
+
   bool SolveLcpFast(const Eigen::MatrixXd& M, const Eigen::VectorXd& q,
                     Eigen::VectorXd* z, double zero_tol = -1.0) const;
   bool SolveLcpFastRegularized(const Eigen::MatrixXd& M,
@@ -53,6 +69,16 @@ class MobyLCPSolver {
 
  private:
   void ClearIndexVectors() const;
+  bool IsWarmStartBasisValid(unsigned n) const;
+  void SetupWarmStartIndices(unsigned n, std::vector<unsigned>* in,
+                             std::vector<unsigned>* out) const;
+  bool SolveLcpFastFromBasis(const Eigen::MatrixXd& M,
+                             const Eigen::VectorXd& q, Eigen::VectorXd* z,
+                             double zero_tol, bool warm_start) const;
+  bool SolveLcpLemkeFromBasis(const Eigen::MatrixXd& M,
+                              const Eigen::VectorXd& q, Eigen::VectorXd* z,
+                              double piv_tol, double zero_tol,
+                              bool warm_start) const;
   bool CheckLemkeTrivial(int n, double zero_tol, const Eigen::VectorXd& q,
                          Eigen::VectorXd* z) const;
   template <typename MatrixType>
@@ -67,6 +93,10 @@ class MobyLCPSolver {
   // TODO(sammy-tri) why is this a member variable?
   mutable unsigned pivots_;
 
+  // warm start basis and basis of the last solution (z indices)
+  std::vector<unsigned> warm_basis_;
+  mutable std::vector<unsigned> solution_basis_;
+
   // NOTE:  The temporaries below are stored in the class to minimize
   // allocations; all are marked 'mutable' as they do not affect the
   // semantic const'ness of the class under its methods.
@@ -0,0 +1,177 @@
+#include "Model/DynamicsContext.hpp"
+
+namespace Leph {
+
+DynamicsContext::DynamicsContext() :
+    _position(),
+    _velocity(),
+    _inertiaOffset(),
+    _isH(false),
+    _isDecomposition(false),
+    _isC(false),
+    _H(),
+    _decomposition(),
+    _C(),
+    _version(1),
+    _G(),
+    _computeCount(0),
+    _reuseCount(0)
+{
+}
+
+void DynamicsContext::setState(
+    const Eigen::VectorXd& position,
+    const Eigen::VectorXd& velocity,
+    const Eigen::VectorXd& inertiaOffset)
+{
+    if (
+        _position.size() != position.size() ||
+        _position != position
+    ) {
+        _position = position;
+        _isH = false;
+        _isDecomposition = false;
+        _isC = false;
+        _version++;
+    }
+    if (
+        _velocity.size() != velocity.size() ||
+        _velocity != velocity
+    ) {
+        _velocity = velocity;
+        _isC = false;
+    }
+    if (
+        _inertiaOffset.size() != inertiaOffset.size() ||
+        _inertiaOffset != inertiaOffset
+    ) {
+        _inertiaOffset = inertiaOffset;
+        _isH = false;
+        _isDecomposition = false;
+    }
+}
+
+void DynamicsContext::clear()
+{
+    _isH = false;
+    _isDecomposition = false;
+    _isC = false;
+    _version++;
+}
+
+const RBDLMath::MatrixNd& DynamicsContext::H(RBDL::Model& model)
+{
+    if (_isH) {
+        _reuseCount++;
+        return _H;
+    }
+    _computeCount++;
+    size_t sizeDOF = _position.size();
+    _H.setZero(sizeDOF, sizeDOF);
+    RBDL::CompositeRigidBodyAlgorithm(
+        model, _position, _H, true);
+    //Add inertial diagonal offsets
+    for (size_t i=0;i<(size_t)_inertiaOffset.size();i++) {
+        _H(i, i) += _inertiaOffset(i);
+    }
+    _isH = true;
+    return _H;
+}
+const Eigen::FullPivHouseholderQR<RBDLMath::MatrixNd>&
+    DynamicsContext::decompositionH(RBDL::Model& model)
+{
+    if (_isDecomposition) {
+        _reuseCount++;
+        return _decomposition;
+    }
+    _computeCount++;
+    _decomposition.compute(H(model));
+    _isDecomposition = true;
+    return _decomposition;
+}
+const RBDLMath::VectorNd& DynamicsContext::C(RBDL::Model& model)
+{
+    if (_isC) {
+        _reuseCount++;
+        return _C;
+    }
+    _computeCount++;
+    _C.setZero(_position.size());
+    RBDL::NonlinearEffects(model, _position, _velocity, _C);
+    _isC = true;
+    return _C;
+}
+
+void DynamicsContext::assignH(
+    RBDL::Model& model, RBDL::ConstraintSet& set)
+{
+    set.H = H(model);
+}
+void DynamicsContext::assignC(
+    RBDL::Model& model, RBDL::ConstraintSet& set)
+{
+    set.C = C(model);
+}
+void DynamicsContext::assignG(
+    RBDL::Model& model, RBDL::ConstraintSet& set)
+{
+    auto& cached = _G[&set];
+    if (cached.first == _version) {
+        _reuseCount++;
+        set.G = cached.second;
+        return;
+    }
+    _computeCount++;
+    set.G.setZero(set.size(), _position.size());
+    RBDL::UpdateKinematicsCustom(
+        model, &_position, NULL, NULL);
+    RBDL::CalcContactJacobian(
+        model, _position, set, set.G, false);
+    cached.first = _version;
+    cached.second = set.G;
+}
+void DynamicsContext::assignGamma(
+    RBDL::Model& model, RBDL::ConstraintSet& set)
+{
+    //Contact points acceleration with zero
+    //joint acceleration (as RBDL does, only
+    //computed for successive different points)
+    RBDLMath::VectorNd zero =
+        RBDLMath::VectorNd::Zero(_position.size());
+    RBDL::UpdateKinematicsCustom(
+        model, &_position, &_velocity, &zero);
+    unsigned int prevBody = 0;
+    RBDLMath::Vector3d prevPoint = RBDLMath::Vector3d::Zero();
+    RBDLMath::Vector3d acc = RBDLMath::Vector3d::Zero();
+    for (size_t i=0;i<set.size();i++) {
+        if (
+            i == 0 ||
+            set.body[i] != prevBody ||
+            set.point[i] != prevPoint
+        ) {
+            acc = RBDL::CalcPointAcceleration(
+                model, _position, _velocity, zero,
+                set.body[i], set.point[i], false);
+            prevBody = set.body[i];
+            prevPoint = set.point[i];
+        }
+        set.gamma(i) = set.acceleration(i) - set.normal[i].dot(acc);
+    }
+}
+
+unsigned long DynamicsContext::computeCount() const
+{
+    return _computeCount;
+}
+unsigned long DynamicsContext::reuseCount() const
+{
+    return _reuseCount;
+}
+void DynamicsContext::resetCounters()
+{
+    _computeCount = 0;
+    _reuseCount = 0;
+}
+
+}
+
@@ -0,0 +1,124 @@
+#ifndef LEPH_DYNAMICSCONTEXT_HPP
+#define LEPH_DYNAMICSCONTEXT_HPP
+
+#include <map>
+#include <utility>
+#include <rbdl/rbdl.h>
+#include <Eigen/Dense>
+
+namespace Leph {
+
+namespace RBDL = RigidBodyDynamics;
+namespace RBDLMath = RigidBodyDynamics::Math;
+
+/**
+ * DynamicsContext
+ *
+ * Cache of the dynamics terms of a RBDL
+ * model at a given state shared by all the
+ * dynamics solves done on this state (forward
+ * dynamics, impulses and contact LCP) in order to
+ * compute them only once per simulation step.
+ * Cached terms are the inertia matrix H (with
+ * joint inertia offsets) and its decomposition,
+ * the bias vector C and the contact jacobian G
+ * of each given constraint set.
+ * Terms are computed lazily and dropped when
+ * the assigned state changes. Given constraint
+ * sets must not be modified while cached
+ * (see clear()).
+ */
+class DynamicsContext
+{
+    public:
+
+        /**
+         * Empty initialization
+         */
+        DynamicsContext();
+
+        /**
+         * Assign the current position, velocity
+         * and inertia offsets (added to H diagonal).
+         * Cached terms depending on changed
+         * values are dropped.
+         */
+        void setState(
+            const Eigen::VectorXd& position,
+            const Eigen::VectorXd& velocity,
+            const Eigen::VectorXd& inertiaOffset);
+
+        /**
+         * Drop all cached terms
+         * (buffers are kept allocated)
+         */
+        void clear();
+
+        /**
+         * Return H (with inertia offsets),
+         * its full pivoting Householder QR
+         * decomposition and C for current state
+         */
+        const RBDLMath::MatrixNd& H(RBDL::Model& model);
+        const Eigen::FullPivHouseholderQR<RBDLMath::MatrixNd>&
+            decompositionH(RBDL::Model& model);
+        const RBDLMath::VectorNd& C(RBDL::Model& model);
+
+        /**
+         * Assign H, C, G or gamma of given
+         * constraint set for current state (same
+         * as RBDL CalcContactSystemVariables()
+         * with inertia offsets added to H).
+         * Gamma is never cached.
+         */
+        void assignH(RBDL::Model& model, RBDL::ConstraintSet& set);
+        void assignC(RBDL::Model& model, RBDL::ConstraintSet& set);
+        void assignG(RBDL::Model& model, RBDL::ConstraintSet& set);
+        void assignGamma(RBDL::Model& model, RBDL::ConstraintSet& set);
+
+        /**
+         * Return the number of computed
+         * and reused terms (H, decomposition, C, G)
+         * and reset them
+         */
+        unsigned long computeCount() const;
+        unsigned long reuseCount() const;
+        void resetCounters();
+
+    private:
+
+        /**
+         * Current state
+         */
+        RBDLMath::VectorNd _position;
+        RBDLMath::VectorNd _velocity;
+        RBDLMath::VectorNd _inertiaOffset;
+
+        /**
+         * Cached terms and validity flags.
+         * Contact jacobians are indexed by
+         * constraint set address and are valid
+         * if computed at current position version
+         * (starting at one).
+         */
+        bool _isH;
+        bool _isDecomposition;
+        bool _isC;
+        RBDLMath::MatrixNd _H;
+        Eigen::FullPivHouseholderQR<RBDLMath::MatrixNd> _decomposition;
+        RBDLMath::VectorNd _C;
+        unsigned long _version;
+        std::map<const RBDL::ConstraintSet*, 
+            std::pair<unsigned long, RBDLMath::MatrixNd>> _G;
+
+        /**
+         * Counters
+         */
+        unsigned long _computeCount;
+        unsigned long _reuseCount;
+};
+
+}
+
+#endif
+
@@ -1,3 +1,5 @@
+#include <cmath>
+#include <algorithm>
 #include "Model/ForwardSimulation.hpp"
 
 namespace Leph {
@@ -13,7 +15,16 @@ ForwardSimulation::ForwardSimulation(Model& model) :
     _jointTorques(Eigen::VectorXd::Zero(_model->sizeDOF())),
     _frictionTorques(Eigen::VectorXd::Zero(_model->sizeDOF())),
     _controlTorques(Eigen::VectorXd::Zero(_model->sizeDOF())),
-    _inertiaOffsets(Eigen::VectorXd::Zero(_model->sizeDOF()))
+    _inertiaOffsets(Eigen::VectorXd::Zero(_model->sizeDOF())),
+    _integrator(SemiEulerIntegrator),
+    _adaptiveTolerance(1e-6),
+    _adaptiveMinStep(1e-6),
+    _adaptiveStep(-1.0),
+    _stepCount(0),
+    _rejectedCount(0),
+    _evaluationCount(0),
+    _isDynamicsContext(true),
+    _dynamicsContext()
 {
     //Init joint models
     for (size_t i=0;i<_model->sizeDOF();i++) {
@@ -64,6 +75,24 @@ JointModel& ForwardSimulation::jointModel(const std::string& name)
 {
     return jointModel(_model->getDOFIndex(name));
 }
+
+double ForwardSimulation::computeFeedForward(
+    size_t index,
+    double velGoal,
+    double accGoal,
+    double torqueGoal) const
+{
+    if (index >= _jointModels.size()) {
+        throw std::logic_error(
+            "ForwardSimulation invalid index");
+    }
+    if (!_isJointActuated[index]) {
+        throw std::logic_error(
+            "ForwardSimulation not actuated joint model");
+    }
+    return _jointModels[index].computeFeedForward(
+        velGoal, accGoal, torqueGoal);
+}
         
 void ForwardSimulation::setJointModelParameters(
     const Eigen::VectorXd& params)
@@ -116,11 +145,221 @@ const Eigen::VectorXd& ForwardSimulation::accelerations() const
     return _accelerations;
 }
 
+void ForwardSimulation::setIntegrator(Integrator integrator)
+{
+    _integrator = integrator;
+    _adaptiveStep = -1.0;
+}
+ForwardSimulation::Integrator ForwardSimulation::getIntegrator() const
+{
+    return _integrator;
+}
+
+void ForwardSimulation::setAdaptiveTolerance(
+    double tolerance, double minStep)
+{
+    if (tolerance <= 0.0 || minStep <= 0.0) {
+        throw std::logic_error(
+            "ForwardSimulation invalid adaptive tolerance");
+    }
+    _adaptiveTolerance = tolerance;
+    _adaptiveMinStep = minStep;
+}
+
+unsigned long ForwardSimulation::integrationStepCount() const
+{
+    return _stepCount;
+}
+unsigned long ForwardSimulation::rejectedStepCount() const
+{
+    return _rejectedCount;
+}
+unsigned long ForwardSimulation::dynamicsEvaluationCount() const
+{
+    return _evaluationCount;
+}
+void ForwardSimulation::resetIntegrationCounters()
+{
+    _stepCount = 0;
+    _rejectedCount = 0;
+    _evaluationCount = 0;
+}
+        
+const DynamicsContext& ForwardSimulation::dynamicsContext() const
+{
+    return _dynamicsContext;
+}
+DynamicsContext& ForwardSimulation::dynamicsContext()
+{
+    return _dynamicsContext;
+}
+void ForwardSimulation::setDynamicsContext(bool isEnabled)
+{
+    _isDynamicsContext = isEnabled;
+    _dynamicsContext.clear();
+}
+
 void ForwardSimulation::update(double dt,
     RBDL::ConstraintSet* constraints)
 {
-    size_t size = _model->sizeDOF();
+    if (_integrator == SemiEulerIntegrator) {
+        integrateSemiEuler(dt, constraints);
+        finishStep(dt);
+    } else if (_integrator == SymplecticEulerIntegrator) {
+        integrateSymplecticEuler(dt, constraints);
+        finishStep(dt);
+    } else if (_integrator == RungeKutta4Integrator) {
+        integrateRungeKutta4(dt, constraints);
+        finishStep(dt);
+    } else {
+        //Error controlled sub steps over dt.
+        //The sub step is kept across updates.
+        if (_adaptiveStep <= 0.0) {
+            _adaptiveStep = dt;
+        }
+        Eigen::VectorXd nextPos;
+        Eigen::VectorXd nextVel;
+        double time = 0.0;
+        while (dt - time > 1e-9*dt) {
+            double step = std::min(_adaptiveStep, dt - time);
+            double error = stepRK23(
+                step, constraints, nextPos, nextVel);
+            //Step size update (bounded growth and shrink)
+            double factor = 5.0;
+            if (error > 0.0) {
+                factor = std::min(5.0, std::max(0.2, 
+                    0.9*std::pow(error, -1.0/3.0)));
+            }
+            if (error <= 1.0 || step <= _adaptiveMinStep) {
+                _positions = nextPos;
+                _velocities = nextVel;
+                projectVelocities(constraints);
+                finishStep(step);
+                time += step;
+                //Do not adapt on the final
+                //truncated sub step
+                if (step >= _adaptiveStep || factor < 1.0) {
+                    _adaptiveStep = step*factor;
+                }
+            } else {
+                _rejectedCount++;
+                _adaptiveStep = step*factor;
+            }
+            _adaptiveStep = std::max(_adaptiveStep, _adaptiveMinStep);
+        }
+    }
+    //The model may change between steps
+    _dynamicsContext.clear();
+}
+
+void ForwardSimulation::computeImpulses(
+    RBDL::ConstraintSet& constraints)
+{
+    _velocities = _model->impulseContactsCustom(
+        constraints,
+        _positions,
+        _velocities,
+        _inertiaOffsets,
+        RBDLMath::LinearSolverFullPivHouseholderQR,
+        usedDynamicsContext());
+}
+
+void ForwardSimulation::computeContactLCP(
+    RBDL::ConstraintSet& constraints,
+    const Eigen::VectorXi& isBilateralConstraint,
+    std::vector<unsigned>* warmBasis,
+    unsigned long* pivots)
+{
+    _model->resolveContactConstraintLCP(
+        constraints, 
+        isBilateralConstraint,
+        _positions, 
+        _velocities, 
+        _jointTorques,
+        _inertiaOffsets,
+        warmBasis,
+        pivots,
+        usedDynamicsContext());
+}
+
+void ForwardSimulation::saveState(State& state) const
+{
+    state.positions = _positions;
+    state.velocities = _velocities;
+    state.goals = _goals;
+    state.accelerations = _accelerations;
+    state.jointTorques = _jointTorques;
+    state.frictionTorques = _frictionTorques;
+    state.controlTorques = _controlTorques;
+    state.inertiaOffsets = _inertiaOffsets;
+    state.adaptiveStep = _adaptiveStep;
+    state.joints.resize(_jointModels.size());
+    for (size_t i=0;i<_jointModels.size();i++) {
+        _jointModels[i].saveState(state.joints[i]);
+    }
+}
+void ForwardSimulation::restoreState(const State& state)
+{
+    if (state.joints.size() != _jointModels.size()) {
+        throw std::logic_error(
+            "ForwardSimulation invalid state size");
+    }
+    _positions = state.positions;
+    _velocities = state.velocities;
+    _goals = state.goals;
+    _accelerations = state.accelerations;
+    _jointTorques = state.jointTorques;
+    _frictionTorques = state.frictionTorques;
+    _controlTorques = state.controlTorques;
+    _inertiaOffsets = state.inertiaOffsets;
+    _adaptiveStep = state.adaptiveStep;
+    for (size_t i=0;i<_jointModels.size();i++) {
+        _jointModels[i].restoreState(state.joints[i]);
+    }
+    //Assign model position state
+    _model->setDOFVect(_positions);
+}
+
+
+void ForwardSimulation::computeTorques(
+    const Eigen::VectorXd& pos,
+    const Eigen::VectorXd& vel,
+    Eigen::VectorXd& torque) const
+{
+    torque.setZero(pos.size());
+    for (size_t i=0;i<_jointModels.size();i++) {
+        if (_isJointActuated[i]) {
+            torque(i) = 
+                _jointModels[i].frictionTorque(vel(i)) +
+                _jointModels[i].controlTorque(pos(i), vel(i));
+        }
+    }
+}
 
+Eigen::VectorXd ForwardSimulation::computeAccelerations(
+    const Eigen::VectorXd& pos,
+    const Eigen::VectorXd& vel,
+    RBDL::ConstraintSet* constraints)
+{
+    Eigen::VectorXd torque;
+    computeTorques(pos, vel, torque);
+    _evaluationCount++;
+    if (constraints == nullptr) {
+        return _model->forwardDynamicsCustom(
+            pos, vel, torque, _inertiaOffsets,
+            RBDLMath::LinearSolverFullPivHouseholderQR,
+        usedDynamicsContext());
+    } else {
+        return _model->forwardDynamicsContactsCustom(
+            *constraints, pos, vel, torque, _inertiaOffsets,
+            RBDLMath::LinearSolverFullPivHouseholderQR,
+        usedDynamicsContext());
+    }
+}
+
+void ForwardSimulation::integrateSemiEuler(double dt,
+    RBDL::ConstraintSet* constraints)
+{
     //Compute partial (with fixed DOF 
     //for static friction) Forward Dynamics
     if (constraints == nullptr) {
@@ -129,7 +368,8 @@ void ForwardSimulation::update(double dt,
             _velocities,
             _jointTorques,
             _inertiaOffsets,
-            RBDLMath::LinearSolverFullPivHouseholderQR);
+            RBDLMath::LinearSolverFullPivHouseholderQR,
+        usedDynamicsContext());
     } else {
         /* TODO
         _accelerations = 
@@ -139,7 +379,8 @@ void ForwardSimulation::update(double dt,
             _velocities,
             _jointTorques,
             _inertiaOffsets,
-            RBDLMath::LinearSolverFullPivHouseholderQR);
+            RBDLMath::LinearSolverFullPivHouseholderQR,
+        usedDynamicsContext());
         */
     }
     
@@ -154,8 +395,10 @@ void ForwardSimulation::update(double dt,
             _velocities,
             _jointTorques,
             _inertiaOffsets,
-            RBDLMath::LinearSolverFullPivHouseholderQR);
+            RBDLMath::LinearSolverFullPivHouseholderQR,
+        usedDynamicsContext());
     }
+    _evaluationCount++;
     
     //Compute next state with 
     //Euler integration.
@@ -168,6 +411,159 @@ void ForwardSimulation::update(double dt,
         _velocities = tmpNextVel;
         _positions = _positions + dt*_velocities;
     }
+}
+
+void ForwardSimulation::integrateSymplecticEuler(double dt,
+    RBDL::ConstraintSet* constraints)
+{
+    Eigen::VectorXd nextVel;
+    if (constraints == nullptr) {
+        _accelerations = computeAccelerations(
+            _positions, _velocities, nullptr);
+        nextVel = _velocities + dt*_accelerations;
+    } else {
+        //Velocity level constrained dynamics
+        Eigen::VectorXd torque;
+        computeTorques(_positions, _velocities, torque);
+        nextVel = _model->forwardImpulseDynamicsContactsCustom(
+            dt, 
+            *constraints,
+            _positions,
+            _velocities,
+            torque,
+            _inertiaOffsets,
+            RBDLMath::LinearSolverFullPivHouseholderQR,
+        usedDynamicsContext());
+        _evaluationCount++;
+        _accelerations = (nextVel - _velocities)/dt;
+    }
+    _velocities = nextVel;
+    _positions = _positions + dt*_velocities;
+}
+
+void ForwardSimulation::integrateRungeKutta4(double dt,
+    RBDL::ConstraintSet* constraints)
+{
+    //Stages on (position, velocity) state
+    Eigen::VectorXd acc1 = computeAccelerations(
+        _positions, _velocities, constraints);
+    //Forces at step start are kept
+    Eigen::VectorXd force;
+    if (constraints != nullptr) {
+        force = constraints->force;
+    }
+    Eigen::VectorXd vel2 = _velocities + 0.5*dt*acc1;
+    Eigen::VectorXd acc2 = computeAccelerations(
+        _positions + 0.5*dt*_velocities, vel2, constraints);
+    Eigen::VectorXd vel3 = _velocities + 0.5*dt*acc2;
+    Eigen::VectorXd acc3 = computeAccelerations(
+        _positions + 0.5*dt*vel2, vel3, constraints);
+    Eigen::VectorXd vel4 = _velocities + dt*acc3;
+    Eigen::VectorXd acc4 = computeAccelerations(
+        _positions + dt*vel3, vel4, constraints);
+    _positions = _positions + (dt/6.0)*(
+        _velocities + 2.0*vel2 + 2.0*vel3 + vel4);
+    _velocities = _velocities + (dt/6.0)*(
+        acc1 + 2.0*acc2 + 2.0*acc3 + acc4);
+    _accelerations = acc1;
+    if (constraints != nullptr) {
+        constraints->force = force;
+    }
+    projectVelocities(constraints);
+}
+
+double ForwardSimulation::stepRK23(double dt,
+    RBDL::ConstraintSet* constraints,
+    Eigen::VectorXd& nextPos,
+    Eigen::VectorXd& nextVel)
+{
+    //Bogacki-Shampine stages. The last stage is
+    //not reused as first one of next step (FSAL)
+    //since joint models state and constraints
+    //projection change between steps.
+    Eigen::VectorXd acc1 = computeAccelerations(
+        _positions, _velocities, constraints);
+    Eigen::VectorXd force;
+    if (constraints != nullptr) {
+        force = constraints->force;
+    }
+    Eigen::VectorXd vel2 = _velocities + 0.5*dt*acc1;
+    Eigen::VectorXd acc2 = computeAccelerations(
+        _positions + 0.5*dt*_velocities, vel2, constraints);
+    Eigen::VectorXd vel3 = _velocities + 0.75*dt*acc2;
+    Eigen::VectorXd acc3 = computeAccelerations(
+        _positions + 0.75*dt*vel2, vel3, constraints);
+    //Third order solution
+    nextPos = _positions + dt*(
+        (2.0/9.0)*_velocities + (1.0/3.0)*vel2 + (4.0/9.0)*vel3);
+    nextVel = _velocities + dt*(
+        (2.0/9.0)*acc1 + (1.0/3.0)*acc2 + (4.0/9.0)*acc3);
+    Eigen::VectorXd acc4 = computeAccelerations(
+        nextPos, nextVel, constraints);
+    //Embedded second order error
+    Eigen::VectorXd errorPos = dt*(
+        (2.0/9.0 - 7.0/24.0)*_velocities 
+        + (1.0/3.0 - 1.0/4.0)*vel2 
+        + (4.0/9.0 - 1.0/3.0)*vel3 
+        - (1.0/8.0)*nextVel);
+    Eigen::VectorXd errorVel = dt*(
+        (2.0/9.0 - 7.0/24.0)*acc1 
+        + (1.0/3.0 - 1.0/4.0)*acc2 
+        + (4.0/9.0 - 1.0/3.0)*acc3 
+        - (1.0/8.0)*acc4);
+    _accelerations = acc1;
+    if (constraints != nullptr) {
+        constraints->force = force;
+    }
+
+    //Scaled infinity norm
+    double error = 0.0;
+    for (size_t i=0;i<(size_t)_positions.size();i++) {
+        double scalePos = _adaptiveTolerance*(1.0 + 
+            std::max(fabs(_positions(i)), fabs(nextPos(i))));
+        double scaleVel = _adaptiveTolerance*(1.0 + 
+            std::max(fabs(_velocities(i)), fabs(nextVel(i))));
+        error = std::max(error, fabs(errorPos(i))/scalePos);
+        error = std::max(error, fabs(errorVel(i))/scaleVel);
+    }
+    //Non finite state is rejected
+    if (!std::isfinite(error)) {
+        error = 1e6;
+    }
+
+    return error;
+}
+
+void ForwardSimulation::projectVelocities(
+    RBDL::ConstraintSet* constraints)
+{
+    if (constraints == nullptr) {
+        return;
+    }
+    Eigen::VectorXd force = constraints->force;
+    _velocities = _model->impulseContactsCustom(
+        *constraints,
+        _positions,
+        _velocities,
+        _inertiaOffsets,
+        RBDLMath::LinearSolverFullPivHouseholderQR,
+        usedDynamicsContext());
+    constraints->force = force;
+}
+
+DynamicsContext* ForwardSimulation::usedDynamicsContext()
+{
+    if (_isDynamicsContext) {
+        return &_dynamicsContext;
+    } else {
+        return nullptr;
+    }
+}
+
+void ForwardSimulation::finishStep(double dt)
+{
+    size_t size = _model->sizeDOF();
+    _stepCount++;
 
     //Assign model position state
     _model->setDOFVect(_positions);
@@ -219,29 +615,4 @@ void ForwardSimulation::update(double dt,
     }
 }
 
-void ForwardSimulation::computeImpulses(
-    RBDL::ConstraintSet& constraints)
-{
-    _velocities = _model->impulseContactsCustom(
-        constraints,
-        _positions,
-        _velocities,
-        _inertiaOffsets,
-        RBDLMath::LinearSolverFullPivHouseholderQR);
-}
-
-void ForwardSimulation::computeContactLCP(
-    RBDL::ConstraintSet& constraints,
-    const Eigen::VectorXi& isBilateralConstraint)
-{
-    _model->resolveContactConstraintLCP(
-        constraints, 
-        isBilateralConstraint,
-        _positions, 
-        _velocities, 
-        _jointTorques,
-        _inertiaOffsets);
 }
-
-}
-
@@ -5,6 +5,7 @@
 #include <Eigen/Dense>
 #include "Model/Model.hpp"
 #include "Model/JointModel.hpp"
+#include "Model/DynamicsContext.hpp"
 
 namespace Leph {
 
@@ -12,13 +13,53 @@ namespace Leph {
  * ForwardSimulation
  *
  * Model simulation using forward
- * dynamics and classic Runge Kutta 
- * integration.
+ * dynamics and selectable integration.
  */
 class ForwardSimulation
 {
     public:
 
+        /**
+         * Integration schemes.
+         * SemiEuler: historical averaged Euler step
+         * (default, used for joint models identification).
+         * SymplecticEuler: velocity then position update.
+         * RungeKutta4: classic fourth order.
+         * AdaptiveRK23: Bogacki-Shampine 3(2) embedded
+         * pair with error controlled sub steps.
+         * Joint models hidden state (delayed goal, 
+         * backlash) is held during a (sub) step and 
+         * updated once it is accepted.
+         * With contact constraints, Runge Kutta stages
+         * use constrained forward dynamics and velocities
+         * are then projected on the constraints with
+         * impulses. SymplecticEuler use impulse
+         * (velocity level) constrained dynamics.
+         */
+        enum Integrator {
+            SemiEulerIntegrator,
+            SymplecticEulerIntegrator,
+            RungeKutta4Integrator,
+            AdaptiveRK23Integrator,
+        };
+
+        /**
+         * Complete dynamic simulation state.
+         * Joint models parameters are not included.
+         */
+        struct State {
+            Eigen::VectorXd positions;
+            Eigen::VectorXd velocities;
+            Eigen::VectorXd goals;
+            Eigen::VectorXd accelerations;
+            Eigen::VectorXd jointTorques;
+            Eigen::VectorXd frictionTorques;
+            Eigen::VectorXd controlTorques;
+            Eigen::VectorXd inertiaOffsets;
+            std::vector<JointModel::State> joints;
+            double adaptiveStep;
+        };
+
         /**
          * Initialization with Model instance.
          * The given model is used for kinematcis
@@ -34,6 +75,16 @@ class ForwardSimulation
         JointModel& jointModel(size_t index);
         const JointModel& jointModel(const std::string& name) const;
         JointModel& jointModel(const std::string& name);
+
+        /**
+         * Return JointModel::computeFeedForward()
+         * of given joint
+         */
+        double computeFeedForward(
+            size_t index,
+            double velGoal,
+            double accGoal,
+            double torqueGoal) const;
         
         /**
          * Assign given joints parameters to all 
@@ -55,6 +106,46 @@ class ForwardSimulation
         const Eigen::VectorXd& controlTorques() const;
         const Eigen::VectorXd& accelerations() const;
 
+        /**
+         * Set and get the integration scheme
+         */
+        void setIntegrator(Integrator integrator);
+        Integrator getIntegrator() const;
+
+        /**
+         * Set the AdaptiveRK23 error tolerance
+         * (both absolute and relative on positions
+         * and velocities) and minimum sub step
+         */
+        void setAdaptiveTolerance(
+            double tolerance, double minStep = 1e-6);
+
+        /**
+         * Return the number of (accepted) integration
+         * sub steps, rejected adaptive sub steps and
+         * forward dynamics evaluations since last reset
+         */
+        unsigned long integrationStepCount() const;
+        unsigned long rejectedStepCount() const;
+        unsigned long dynamicsEvaluationCount() const;
+        void resetIntegrationCounters();
+
+        /**
+         * Access to the dynamics terms context
+         * shared by all dynamics solves of a step
+         * (impulses, contact LCP and integration).
+         * It is cleared at the end of each update().
+         */
+        const DynamicsContext& dynamicsContext() const;
+        DynamicsContext& dynamicsContext();
+
+        /**
+         * Enable or disable the dynamics terms
+         * context (enabled by default). If disabled,
+         * each solve computes its own terms.
+         */
+        void setDynamicsContext(bool isEnabled);
+
         /**
          * Update the position/velocity state
          * from current goal position over
@@ -84,10 +175,24 @@ class ForwardSimulation
          * The computed contact force lambda (with zero
          * and non zero elements) is assigned in force
          * field of constraint set.
+         * If not null, warmBasis is the LCP warm start
+         * basis updated with the solution basis and 
+         * pivots is assigned the number of LCP pivots.
          */
         void computeContactLCP(
             RBDL::ConstraintSet& constraints,
-            const Eigen::VectorXi& isBilateralConstraint);
+            const Eigen::VectorXi& isBilateralConstraint,
+            std::vector<unsigned>* warmBasis = nullptr,
+            unsigned long* pivots = nullptr);
+
+        /**
+         * Copy the simulation state into given state
+         * or assign it (and underlying model position)
+         * from given state. No allocation is done once
+         * given state is sized by a first save.
+         */
+        void saveState(State& state) const;
+        void restoreState(const State& state);
         
     private:
 
@@ -133,6 +238,94 @@ class ForwardSimulation
          * the diagonal of inertia matrix
          */
         Eigen::VectorXd _inertiaOffsets;
+
+        /**
+         * Integration scheme, adaptive scheme
+         * tolerance, minimum and current sub step
+         * (non positive before the first update)
+         */
+        Integrator _integrator;
+        double _adaptiveTolerance;
+        double _adaptiveMinStep;
+        double _adaptiveStep;
+
+        /**
+         * Integration counters
+         */
+        unsigned long _stepCount;
+        unsigned long _rejectedCount;
+        unsigned long _evaluationCount;
+
+        /**
+         * Is the dynamics context enabled and
+         * dynamics terms shared by solves
+         * on the same state
+         */
+        bool _isDynamicsContext;
+        DynamicsContext _dynamicsContext;
+
+        /**
+         * Compute into given torque the joint 
+         * torques at given position and velocity
+         * with current joint models hidden state
+         */
+        void computeTorques(
+            const Eigen::VectorXd& pos,
+            const Eigen::VectorXd& vel,
+            Eigen::VectorXd& torque) const;
+
+        /**
+         * Compute and return the accelerations at
+         * given position and velocity with optional
+         * constraints (whose force is assigned)
+         */
+        Eigen::VectorXd computeAccelerations(
+            const Eigen::VectorXd& pos,
+            const Eigen::VectorXd& vel,
+            RBDL::ConstraintSet* constraints);
+
+        /**
+         * Integrate position and velocity over given
+         * time step with each fixed step scheme
+         */
+        void integrateSemiEuler(double dt,
+            RBDL::ConstraintSet* constraints);
+        void integrateSymplecticEuler(double dt,
+            RBDL::ConstraintSet* constraints);
+        void integrateRungeKutta4(double dt,
+            RBDL::ConstraintSet* constraints);
+
+        /**
+         * Compute a Bogacki-Shampine step of given 
+         * length from current state into given next
+         * position and velocity and return the scaled 
+         * error norm (accepted if lower than one)
+         */
+        double stepRK23(double dt,
+            RBDL::ConstraintSet* constraints,
+            Eigen::VectorXd& nextPos,
+            Eigen::VectorXd& nextVel);
+
+        /**
+         * Project current velocities on given 
+         * constraints with impulses keeping the
+         * constraints force unchanged
+         */
+        void projectVelocities(
+            RBDL::ConstraintSet* constraints);
+
+        /**
+         * Assign model position, check numerical
+         * validity, bound joints state and update
+         * joint models over given accepted time step
+         */
+        void finishStep(double dt);
+
+        /**
+         * Return the dynamics context given
+         * to solves or null if disabled
+         */
+        DynamicsContext* usedDynamicsContext();
 };
 
 }
@@ -1,5 +1,6 @@
 #include <stdexcept>
 #include "Model/HumanoidFixedModel.hpp"
+#include "Model/RevoluteChain.h"
 
 namespace Leph {
 
@@ -13,8 +14,31 @@ HumanoidFixedModel::HumanoidFixedModel(
     _modelLeft(type, "left_foot_tip", true,
         inertiaData, inertiaName, geometryData, geometryName),
     _modelRight(type, "right_foot_tip", true,
-        inertiaData, inertiaName, geometryData, geometryName)
+        inertiaData, inertiaName, geometryData, geometryName),
+    _indexSupportLeg(),
+    _indexFlyingLeg(),
+    _indexFrameTrunk(),
+    _indexFrameSupport()
 {
+    //Build DOF and frame index tables
+    //for each support foot
+    const std::vector<std::string> legNames = {
+        "ankle_roll", "ankle_pitch", "knee", 
+        "hip_pitch", "hip_roll", "hip_yaw"};
+    for (size_t i=0;i<6;i++) {
+        _indexSupportLeg[0][i] = _modelLeft
+            .getDOFIndex("left_" + legNames[i]);
+        _indexFlyingLeg[0][i] = _modelLeft
+            .getDOFIndex("right_" + legNames[5-i]);
+        _indexSupportLeg[1][i] = _modelRight
+            .getDOFIndex("right_" + legNames[i]);
+        _indexFlyingLeg[1][i] = _modelRight
+            .getDOFIndex("left_" + legNames[5-i]);
+    }
+    _indexFrameTrunk[0] = _modelLeft.getFrameIndex("trunk");
+    _indexFrameSupport[0] = _modelLeft.getFrameIndex("left_foot_tip");
+    _indexFrameTrunk[1] = _modelRight.getFrameIndex("trunk");
+    _indexFrameSupport[1] = _modelRight.getFrameIndex("right_foot_tip");
 }
         
 HumanoidFixedModel::~HumanoidFixedModel()
@@ -370,122 +394,53 @@ Eigen::VectorXd HumanoidFixedModel::trunkFootIKVel(
     const Eigen::Vector3d& flyingFootPosVel,
     const Eigen::Vector3d& flyingFootAxisAnglesVel)
 {
-    //Support foot selection
-    std::string supportName;
-    std::string flyingName;
-    std::string supportPrefix;
-    std::string flyingPrefix;
-    if (getSupportFoot() == LeftSupportFoot) {
-        supportName = "left_foot_tip";
-        flyingName = "right_foot_tip";
-        supportPrefix = "left_";
-        flyingPrefix = "right_";
-    } else if (getSupportFoot() == RightSupportFoot) {
-        supportName = "right_foot_tip";
-        flyingName = "left_foot_tip";
-        supportPrefix = "right_";
-        flyingPrefix = "left_";
-    }
+    size_t indexSupport = (_supportFoot == LeftSupportFoot) ? 0 : 1;
 
-    //Compute trunk and flying foot 
-    //jacobian in support foot frame
-    Eigen::MatrixXd jacTrunk = get()
-        .pointJacobian("trunk", supportName);
-    Eigen::MatrixXd jacFoot = get()
-        .pointJacobian(flyingName, supportName);
-
-    //Retrieve DOF internal index
-    size_t indexSupportAnkleRoll = get()
-        .getDOFIndex(supportPrefix + "ankle_roll");
-    size_t indexSupportAnklePitch = get()
-        .getDOFIndex(supportPrefix + "ankle_pitch");
-    size_t indexSupportKnee = get()
-        .getDOFIndex(supportPrefix + "knee");
-    size_t indexSupportHipPitch = get()
-        .getDOFIndex(supportPrefix + "hip_pitch");
-    size_t indexSupportHipRoll = get()
-        .getDOFIndex(supportPrefix + "hip_roll");
-    size_t indexSupportHipYaw = get()
-        .getDOFIndex(supportPrefix + "hip_yaw");
-    size_t indexFlyingAnkleRoll = get()
-        .getDOFIndex(flyingPrefix + "ankle_roll");
-    size_t indexFlyingAnklePitch = get()
-        .getDOFIndex(flyingPrefix + "ankle_pitch");
-    size_t indexFlyingKnee = get()
-        .getDOFIndex(flyingPrefix + "knee");
-    size_t indexFlyingHipPitch = get()
-        .getDOFIndex(flyingPrefix + "hip_pitch");
-    size_t indexFlyingHipRoll = get()
-        .getDOFIndex(flyingPrefix + "hip_roll");
-    size_t indexFlyingHipYaw = get()
-        .getDOFIndex(flyingPrefix + "hip_yaw");
-
-    //Restrict both jacobian to support 
-    //and flying foot degrees of freedom
-    Eigen::MatrixXd subJacTrunk(6, 6);
-    subJacTrunk.col(0) = jacTrunk.col(indexSupportAnkleRoll);
-    subJacTrunk.col(1) = jacTrunk.col(indexSupportAnklePitch);
-    subJacTrunk.col(2) = jacTrunk.col(indexSupportKnee);
-    subJacTrunk.col(3) = jacTrunk.col(indexSupportHipPitch);
-    subJacTrunk.col(4) = jacTrunk.col(indexSupportHipRoll);
-    subJacTrunk.col(5) = jacTrunk.col(indexSupportHipYaw);
-    Eigen::MatrixXd subJacFoot(6, 6);
-    subJacFoot.col(0) = jacFoot.col(indexFlyingHipYaw);
-    subJacFoot.col(1) = jacFoot.col(indexFlyingHipRoll);
-    subJacFoot.col(2) = jacFoot.col(indexFlyingHipPitch);
-    subJacFoot.col(3) = jacFoot.col(indexFlyingKnee);
-    subJacFoot.col(4) = jacFoot.col(indexFlyingAnklePitch);
-    subJacFoot.col(5) = jacFoot.col(indexFlyingAnkleRoll);
-    //Check for near singular jacobian
-    if (
-        fabs(subJacTrunk.fullPivLu().determinant()) < 1e-10 ||
-        fabs(subJacFoot.fullPivLu().determinant()) < 1e-10
-    ) {
+    //Compute and factorize trunk and flying 
+    //foot jacobians in trunk frame
+    LegsChains chains;
+    if (!computeLegsChains(chains)) {
         //Return null velocity (no other good choice ?)
         return Eigen::VectorXd::Zero(get().sizeDOF());
     }
+    //Rotation from support foot frame to trunk frame
+    Eigen::Matrix3d rotationT = get().orientation(
+        _indexFrameTrunk[indexSupport], 
+        _indexFrameSupport[indexSupport]);
 
-    //Build spatial vector of 
-    //the trunk velocity in support foot frame
-    Eigen::VectorXd trunkVel(6);
-    trunkVel.segment(0, 3) = trunkAxisAnglesVel;
-    trunkVel.segment(3, 3) = trunkPosVel;
+    //Build spatial vector of the trunk velocity 
+    //in support foot frame converted in trunk frame
+    Vector6d trunkVel;
+    trunkVel.segment<3>(0) = rotationT*trunkAxisAnglesVel;
+    trunkVel.segment<3>(3) = rotationT*trunkPosVel;
 
     //Build spatial vector of the relative velocity of
     //flying foot with respect the the trunk in support foot frame 
-    Eigen::VectorXd footVel(6);
-    footVel.segment(0, 3) = flyingFootAxisAnglesVel - trunkAxisAnglesVel;
+    //converted in trunk frame
+    Vector6d footVel;
+    footVel.segment<3>(0) = rotationT*
+        (flyingFootAxisAnglesVel - trunkAxisAnglesVel);
     //Compute relative linear translation velocity
     //of the trunk in support frame.
     //T (trunk), F (foot), O (support)
     //vel(F/T) = vel(F/O) - vel(T/O) - w(O/T) cross TF
-    Eigen::Vector3d relPos = 
-        get().position(flyingName, supportName)
-        - get().position("trunk", supportName);
-    footVel.segment(3, 3) = 
+    Eigen::Vector3d relPos = rotationT.transpose()*chains.tipFlying;
+    footVel.segment<3>(3) = rotationT*(
         flyingFootPosVel 
         - trunkPosVel 
-        - trunkAxisAnglesVel.cross(relPos);
+        - trunkAxisAnglesVel.cross(relPos));
 
     //Compute support leg joint velocities
-    Eigen::VectorXd dqSupport = subJacTrunk.fullPivLu().solve(trunkVel);
+    Vector6d dqSupport = chains.luSupport.solve(trunkVel);
     //Compute flying leg joint velocities
-    Eigen::VectorXd dqFlying = subJacFoot.fullPivLu().solve(footVel);
+    Vector6d dqFlying = chains.luFlying.solve(footVel);
 
     //Assign and return computed velocities
     Eigen::VectorXd dofVel = Eigen::VectorXd::Zero(get().sizeDOF());
-    dofVel(indexSupportAnkleRoll) = dqSupport(0);
-    dofVel(indexSupportAnklePitch) = dqSupport(1);
-    dofVel(indexSupportKnee) = dqSupport(2);
-    dofVel(indexSupportHipPitch) = dqSupport(3);
-    dofVel(indexSupportHipRoll) = dqSupport(4);
-    dofVel(indexSupportHipYaw) = dqSupport(5);
-    dofVel(indexFlyingHipYaw) = dqFlying(0);
-    dofVel(indexFlyingHipRoll) = dqFlying(1);
-    dofVel(indexFlyingHipPitch) = dqFlying(2);
-    dofVel(indexFlyingKnee) = dqFlying(3);
-    dofVel(indexFlyingAnklePitch) = dqFlying(4);
-    dofVel(indexFlyingAnkleRoll) = dqFlying(5);
+    for (size_t i=0;i<6;i++) {
+        dofVel(_indexSupportLeg[indexSupport][i]) = dqSupport(i);
+        dofVel(_indexFlyingLeg[indexSupport][i]) = dqFlying(i);
+    }
     return dofVel;
 }
         
@@ -500,155 +455,76 @@ Eigen::VectorXd HumanoidFixedModel::trunkFootIKAcc(
     const Eigen::Vector3d& flyingFootPosAcc,
     const Eigen::Vector3d& flyingFootAxisAnglesAcc)
 {
-    //Support foot selection
-    std::string supportName;
-    std::string flyingName;
-    std::string supportPrefix;
-    std::string flyingPrefix;
-    if (getSupportFoot() == LeftSupportFoot) {
-        supportName = "left_foot_tip";
-        flyingName = "right_foot_tip";
-        supportPrefix = "left_";
-        flyingPrefix = "right_";
-    } else if (getSupportFoot() == RightSupportFoot) {
-        supportName = "right_foot_tip";
-        flyingName = "left_foot_tip";
-        supportPrefix = "right_";
-        flyingPrefix = "left_";
-    }
+    size_t indexSupport = (_supportFoot == LeftSupportFoot) ? 0 : 1;
 
-    //Compute trunk and flying foot 
-    //jacobian in support foot frame
-    Eigen::MatrixXd jacTrunk = get()
-        .pointJacobian("trunk", supportName);
-    Eigen::MatrixXd jacFoot = get()
-        .pointJacobian(flyingName, supportName);
-
-    //Retrieve DOF internal index
-    size_t indexSupportAnkleRoll = get()
-        .getDOFIndex(supportPrefix + "ankle_roll");
-    size_t indexSupportAnklePitch = get()
-        .getDOFIndex(supportPrefix + "ankle_pitch");
-    size_t indexSupportKnee = get()
-        .getDOFIndex(supportPrefix + "knee");
-    size_t indexSupportHipPitch = get()
-        .getDOFIndex(supportPrefix + "hip_pitch");
-    size_t indexSupportHipRoll = get()
-        .getDOFIndex(supportPrefix + "hip_roll");
-    size_t indexSupportHipYaw = get()
-        .getDOFIndex(supportPrefix + "hip_yaw");
-    size_t indexFlyingAnkleRoll = get()
-        .getDOFIndex(flyingPrefix + "ankle_roll");
-    size_t indexFlyingAnklePitch = get()
-        .getDOFIndex(flyingPrefix + "ankle_pitch");
-    size_t indexFlyingKnee = get()
-        .getDOFIndex(flyingPrefix + "knee");
-    size_t indexFlyingHipPitch = get()
-        .getDOFIndex(flyingPrefix + "hip_pitch");
-    size_t indexFlyingHipRoll = get()
-        .getDOFIndex(flyingPrefix + "hip_roll");
-    size_t indexFlyingHipYaw = get()
-        .getDOFIndex(flyingPrefix + "hip_yaw");
-
-    //Restrict both jacobian to support 
-    //and flying foot degrees of freedom
-    Eigen::MatrixXd subJacTrunk(6, 6);
-    subJacTrunk.col(0) = jacTrunk.col(indexSupportAnkleRoll);
-    subJacTrunk.col(1) = jacTrunk.col(indexSupportAnklePitch);
-    subJacTrunk.col(2) = jacTrunk.col(indexSupportKnee);
-    subJacTrunk.col(3) = jacTrunk.col(indexSupportHipPitch);
-    subJacTrunk.col(4) = jacTrunk.col(indexSupportHipRoll);
-    subJacTrunk.col(5) = jacTrunk.col(indexSupportHipYaw);
-    Eigen::MatrixXd subJacFoot(6, 6);
-    subJacFoot.col(0) = jacFoot.col(indexFlyingHipYaw);
-    subJacFoot.col(1) = jacFoot.col(indexFlyingHipRoll);
-    subJacFoot.col(2) = jacFoot.col(indexFlyingHipPitch);
-    subJacFoot.col(3) = jacFoot.col(indexFlyingKnee);
-    subJacFoot.col(4) = jacFoot.col(indexFlyingAnklePitch);
-    subJacFoot.col(5) = jacFoot.col(indexFlyingAnkleRoll);
-    //Check for near singular jacobian
-    if (
-        fabs(subJacTrunk.fullPivLu().determinant()) < 1e-10 ||
-        fabs(subJacFoot.fullPivLu().determinant()) < 1e-10
-    ) {
+    //Compute and factorize trunk and flying 
+    //foot jacobians in trunk frame
+    LegsChains chains;
+    if (!computeLegsChains(chains)) {
         //Return null acceleration (no other good choice ?)
         return Eigen::VectorXd::Zero(get().sizeDOF());
     }
+    //Rotation from support foot frame to trunk frame
+    Eigen::Matrix3d rotationT = get().orientation(
+        _indexFrameTrunk[indexSupport], 
+        _indexFrameSupport[indexSupport]);
     
-    //Build spatial vector of the trunk 
-    //acceleration in support foot frame
-    Eigen::VectorXd trunkAcc(6);
-    trunkAcc.segment(0, 3) = trunkAxisAnglesAcc;
-    trunkAcc.segment(3, 3) = trunkPosAcc;
+    //Build spatial vector of the trunk acceleration 
+    //in support foot frame converted in trunk frame
+    Vector6d trunkAcc;
+    trunkAcc.segment<3>(0) = rotationT*trunkAxisAnglesAcc;
+    trunkAcc.segment<3>(3) = rotationT*trunkPosAcc;
 
     //Build spatial vector of the relative acceleration of
     //flying foot with respect the the trunk in support foot frame 
-    Eigen::VectorXd footAcc(6);
-    footAcc.segment(0, 3) = flyingFootAxisAnglesAcc - trunkAxisAnglesAcc;
+    //converted in trunk frame
+    Vector6d footAcc;
+    footAcc.segment<3>(0) = rotationT*
+        (flyingFootAxisAnglesAcc - trunkAxisAnglesAcc);
     //Compute relative linear translation acceleration
     //of the trunk in support frame. 
     //T (trunk), F (foot), O (support)
     //acc(F/T) = acc(F/O) - acc(T/O) - dw/dt(T/O) cross TF 
     //-w(T/O) cross w(T/O) cross TF - 2*w(T/O) cross vel(F/T)
-    Eigen::Vector3d relPos = 
-        get().position(flyingName, supportName)
-        - get().position("trunk", supportName);
+    Eigen::Vector3d relPos = rotationT.transpose()*chains.tipFlying;
     Eigen::Vector3d relVel =
         flyingFootPosVel - trunkPosVel 
         - trunkAxisAnglesVel.cross(relPos);
-    footAcc.segment(3, 3) = 
+    footAcc.segment<3>(3) = rotationT*(
         flyingFootPosAcc
         - trunkPosAcc
         - trunkAxisAnglesAcc.cross(relPos)
         - trunkAxisAnglesVel.cross(trunkAxisAnglesVel.cross(relPos))
-        - 2.0*trunkAxisAnglesVel.cross(relVel);
-
-    //Build partial joint velocity vectors
-    Eigen::VectorXd dqSupport = Eigen::VectorXd::Zero(get().sizeDOF());
-    Eigen::VectorXd dqFlying = Eigen::VectorXd::Zero(get().sizeDOF());
-    dqSupport(indexSupportAnkleRoll) = dq(indexSupportAnkleRoll);
-    dqSupport(indexSupportAnklePitch) = dq(indexSupportAnklePitch);
-    dqSupport(indexSupportKnee) = dq(indexSupportKnee);
-    dqSupport(indexSupportHipPitch) = dq(indexSupportHipPitch);
-    dqSupport(indexSupportHipRoll) = dq(indexSupportHipRoll);
-    dqSupport(indexSupportHipYaw) = dq(indexSupportHipYaw);
-    dqFlying(indexFlyingAnkleRoll) = dq(indexFlyingAnkleRoll);
-    dqFlying(indexFlyingAnklePitch) = dq(indexFlyingAnklePitch);
-    dqFlying(indexFlyingKnee) = dq(indexFlyingKnee);
-    dqFlying(indexFlyingHipPitch) = dq(indexFlyingHipPitch);
-    dqFlying(indexFlyingHipRoll) = dq(indexFlyingHipRoll);
-    dqFlying(indexFlyingHipYaw) = dq(indexFlyingHipYaw);
+        - 2.0*trunkAxisAnglesVel.cross(relVel));
+
+    //Retrieve legs joint velocities
+    Vector6d dqSupport;
+    Vector6d dqFlying;
+    for (size_t i=0;i<6;i++) {
+        dqSupport(i) = dq(_indexSupportLeg[indexSupport][i]);
+        dqFlying(i) = dq(_indexFlyingLeg[indexSupport][i]);
+    }
 
     //Compute joint acceleration
     //acc = J(q)*ddq + dJ(q, dq)*dq
     //=> ddq = J(q)^-1*(acc - dJ*dq)
-    //dJ*dq can be computed using pointAcceleration and setting 
-    //ddq to zero (thanks Martin Felis !).
+    //dJ*dq is computed analytically from 
+    //the legs chains (null joint accelerations)
     //Compute support leg joint accelerations
-    Eigen::VectorXd J_dot_q_dot_Trunk = get().pointAcceleration("trunk", 
-        supportName, dqSupport, Eigen::VectorXd::Zero(get().sizeDOF()));
-    Eigen::VectorXd ddqSupport = subJacTrunk.fullPivLu()
-        .solve(trunkAcc - J_dot_q_dot_Trunk);
+    Vector6d ddqSupport = chains.luSupport.solve(
+        trunkAcc - RevoluteChainBias(chains.axesSupport, 
+            chains.centersSupport, Eigen::Vector3d::Zero(), dqSupport));
     //Compute flying leg joint accelerations
-    Eigen::VectorXd J_dot_q_dot_Foot = get().pointAcceleration(flyingName, 
-        supportName, dqFlying, Eigen::VectorXd::Zero(get().sizeDOF()));
-    Eigen::VectorXd ddqFlying = subJacFoot.fullPivLu()
-        .solve(footAcc - J_dot_q_dot_Foot);
+    Vector6d ddqFlying = chains.luFlying.solve(
+        footAcc - RevoluteChainBias(chains.axesFlying, 
+            chains.centersFlying, chains.tipFlying, dqFlying));
 
     //Assign and return computed accelerations
     Eigen::VectorXd dofAcc = Eigen::VectorXd::Zero(get().sizeDOF());
-    dofAcc(indexSupportAnkleRoll) = ddqSupport(0);
-    dofAcc(indexSupportAnklePitch) = ddqSupport(1);
-    dofAcc(indexSupportKnee) = ddqSupport(2);
-    dofAcc(indexSupportHipPitch) = ddqSupport(3);
-    dofAcc(indexSupportHipRoll) = ddqSupport(4);
-    dofAcc(indexSupportHipYaw) = ddqSupport(5);
-    dofAcc(indexFlyingHipYaw) = ddqFlying(0);
-    dofAcc(indexFlyingHipRoll) = ddqFlying(1);
-    dofAcc(indexFlyingHipPitch) = ddqFlying(2);
-    dofAcc(indexFlyingKnee) = ddqFlying(3);
-    dofAcc(indexFlyingAnklePitch) = ddqFlying(4);
-    dofAcc(indexFlyingAnkleRoll) = ddqFlying(5);
+    for (size_t i=0;i<6;i++) {
+        dofAcc(_indexSupportLeg[indexSupport][i]) = ddqSupport(i);
+        dofAcc(_indexFlyingLeg[indexSupport][i]) = ddqFlying(i);
+    }
     return dofAcc;
 }
 
@@ -666,5 +542,49 @@ Eigen::Vector3d HumanoidFixedModel::computeZMP(
     return Eigen::Vector3d(Px, Py, Pz);
 }
 
+bool HumanoidFixedModel::computeLegsChains(LegsChains& chains)
+{
+    size_t indexSupport = (_supportFoot == LeftSupportFoot) ? 0 : 1;
+    bool isLeftSupport = (_supportFoot == LeftSupportFoot);
+
+    //Retrieve legs angles from hip yaw to ankle roll
+    const Eigen::VectorXd& q = get().getDOFVect();
+    Vector6d anglesSupport;
+    Vector6d anglesFlying;
+    for (size_t i=0;i<6;i++) {
+        anglesSupport(i) = q(_indexSupportLeg[indexSupport][5-i]);
+        anglesFlying(i) = q(_indexFlyingLeg[indexSupport][i]);
+    }
+
+    //Compute legs joints axes and centers 
+    //in trunk frame from LegIK geometry
+    Matrix36d axes;
+    Matrix36d centers;
+    Eigen::Vector3d tipSupport;
+    get().legGeometry(isLeftSupport, 
+        anglesSupport, axes, centers, tipSupport);
+    get().legGeometry(!isLeftSupport, anglesFlying, 
+        chains.axesFlying, chains.centersFlying, chains.tipFlying);
+    //The support chain goes from the support foot
+    //(ankle roll) to the trunk. Joints move the trunk with
+    //respect to the support foot in reversed direction.
+    for (size_t i=0;i<6;i++) {
+        chains.axesSupport.col(i) = -axes.col(5-i);
+        chains.centersSupport.col(i) = centers.col(5-i);
+    }
+
+    //Compute and factorize the jacobians
+    chains.luSupport.compute(RevoluteChainJacobian(
+        chains.axesSupport, chains.centersSupport, 
+        Eigen::Vector3d::Zero()));
+    chains.luFlying.compute(RevoluteChainJacobian(
+        chains.axesFlying, chains.centersFlying, 
+        chains.tipFlying));
+
+    //Check for near singular jacobian
+    return 
+        fabs(chains.luSupport.determinant()) >= 1e-10 &&
+        fabs(chains.luFlying.determinant()) >= 1e-10;
+}
 }
 
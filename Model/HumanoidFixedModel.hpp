@@ -211,6 +211,30 @@ class HumanoidFixedModel
             const Eigen::Vector3d& flyingFootAxisAnglesAcc);
 
     private:
+
+        /**
+         * Fixed size typedef
+         */
+        typedef Eigen::Matrix<double, 6, 1> Vector6d;
+        typedef Eigen::Matrix<double, 6, 6> Matrix6d;
+        typedef Eigen::Matrix<double, 3, 6> Matrix36d;
+
+        /**
+         * Support leg chain from support foot
+         * (ankle roll) to trunk and flying leg chain
+         * from trunk (hip yaw) to flying foot with
+         * joints axes, centers and flying foot tip
+         * in trunk frame and jacobians factorizations
+         */
+        struct LegsChains {
+            Matrix36d axesSupport;
+            Matrix36d centersSupport;
+            Matrix36d axesFlying;
+            Matrix36d centersFlying;
+            Eigen::Vector3d tipFlying;
+            Eigen::PartialPivLU<Matrix6d> luSupport;
+            Eigen::PartialPivLU<Matrix6d> luFlying;
+        };
         
         /**
          * Current support foot
@@ -224,6 +248,18 @@ class HumanoidFixedModel
         HumanoidModel _modelLeft;
         HumanoidModel _modelRight;
 
+        /**
+         * For each support foot (left, right),
+         * DOF indexes of support leg joints (ankle roll 
+         * to hip yaw) and flying leg joints (hip yaw
+         * to ankle roll) and trunk and support foot 
+         * frame indexes
+         */
+        size_t _indexSupportLeg[2][6];
+        size_t _indexFlyingLeg[2][6];
+        size_t _indexFrameTrunk[2];
+        size_t _indexFrameSupport[2];
+
         /**
          * Compute the ZMP position given linear 
          * Z force and X/Y moment in local foot frame.
@@ -231,6 +267,14 @@ class HumanoidFixedModel
          */
         Eigen::Vector3d computeZMP(
             double Mx, double My, double Fz);
+
+        /**
+         * Compute analytically from LegIK geometry 
+         * and current legs angles the legs chains and 
+         * factorize trunk and flying foot jacobians.
+         * False is returned if a jacobian is near singular.
+         */
+        bool computeLegsChains(LegsChains& chains);
 };
 
 }
@@ -202,6 +202,51 @@ bool HumanoidModel::legIkRight(const std::string& frame,
 
     return isSucess;
 }
+
+void HumanoidModel::legGeometry(
+    bool isLeftLeg,
+    const Eigen::Matrix<double, 6, 1>& angles,
+    Eigen::Matrix<double, 3, 6>& axes,
+    Eigen::Matrix<double, 3, 6>& centers,
+    Eigen::Vector3d& footTip) const
+{
+    const Eigen::Vector3d& hipPos = isLeftLeg ? 
+        _trunkToHipLeft : _trunkToHipRight;
+    const Eigen::Vector3d& tipPos = isLeftLeg ? 
+        _trunkToFootTipLeft : _trunkToFootTipRight;
+    //Foot tip translation from ankle in zero position
+    Eigen::Vector3d ankleToTip = tipPos - hipPos 
+        + Eigen::Vector3d(0.0, 0.0, _legHipToKnee + _legKneeToAnkle);
+
+    //Legs are straight in zero position and 
+    //joints axes are successively Z, X, Y, Y, Y, X
+    Eigen::Matrix3d rot;
+    rot = Eigen::AngleAxisd(angles(0), Eigen::Vector3d::UnitZ());
+    axes.col(0) = Eigen::Vector3d::UnitZ();
+    axes.col(1) = rot.col(0);
+    rot = rot*Eigen::AngleAxisd(angles(1), Eigen::Vector3d::UnitX());
+    axes.col(2) = rot.col(1);
+    rot = rot*Eigen::AngleAxisd(angles(2), Eigen::Vector3d::UnitY());
+    axes.col(3) = rot.col(1);
+    Eigen::Vector3d kneePos = hipPos 
+        + rot*Eigen::Vector3d(0.0, 0.0, -_legHipToKnee);
+    rot = rot*Eigen::AngleAxisd(angles(3), Eigen::Vector3d::UnitY());
+    axes.col(4) = rot.col(1);
+    Eigen::Vector3d anklePos = kneePos 
+        + rot*Eigen::Vector3d(0.0, 0.0, -_legKneeToAnkle);
+    rot = rot*Eigen::AngleAxisd(angles(4), Eigen::Vector3d::UnitY());
+    axes.col(5) = rot.col(0);
+    rot = rot*Eigen::AngleAxisd(angles(5), Eigen::Vector3d::UnitX());
+
+    //Hip axes and ankle axes are concurrent
+    centers.col(0) = hipPos;
+    centers.col(1) = hipPos;
+    centers.col(2) = hipPos;
+    centers.col(3) = kneePos;
+    centers.col(4) = anklePos;
+    centers.col(5) = anklePos;
+    footTip = anklePos + rot*ankleToTip;
+}
         
 double HumanoidModel::legsLength() const
 {
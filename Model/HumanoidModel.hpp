@@ -95,6 +95,22 @@ class HumanoidModel : public Model
             const Eigen::Matrix3d& rotation = Eigen::Matrix3d::Identity(),
             double* boundIKDistance = nullptr);
 
+        /**
+         * Compute from LegIK geometry and given Left or
+         * Right leg joint angles (hip yaw, hip roll, hip pitch,
+         * knee, ankle pitch, ankle roll) the joints rotation
+         * axes and centers (one column per joint in the
+         * same order) and the foot tip position, all
+         * expressed in trunk frame.
+         * No RBDL computation is involved.
+         */
+        void legGeometry(
+            bool isLeftLeg,
+            const Eigen::Matrix<double, 6, 1>& angles,
+            Eigen::Matrix<double, 3, 6>& axes,
+            Eigen::Matrix<double, 3, 6>& centers,
+            Eigen::Vector3d& footTip) const;
+
         /**
          * Return the initial vertical distance
          * from trunk frame to foot tip frame (Z)
@@ -16,7 +16,15 @@ HumanoidSimulation::HumanoidSimulation(
         geometryData, geometryName),
     _simulation(_model),
     _isInitialized(false),
-    _constraints(),
+    _constraintsCache(),
+    _constraints(nullptr),
+    _constraintsKey(NoConstraints),
+    _isLCPWarmStart(true),
+    _lcpCount(0),
+    _lcpPivotCount(0),
+    _cacheHitCount(0),
+    _cacheMissCount(0),
+    _simulatedTime(0.0),
     _cleats(),
     _isFixedContact(false)
 {
@@ -149,8 +157,75 @@ void HumanoidSimulation::putFootAt(double x, double y,
                 count++;
             }
         }
-        _constraints = buildConstraintSet(
-            false, true, true);
+        _constraintsKey = constraintsKey(false, true);
+        _constraints = &cachedConstraintSet(
+            _constraintsKey, true).set;
+    }
+}
+
+void HumanoidSimulation::resetContacts()
+{
+    for (auto& it : _cleats) {
+        it.second.isActive = false;
+        it.second.isContact = false;
+        it.second.index = (size_t)-1;
+        it.second.force = 0.0;
+        it.second.height = 0.0;
+    }
+    _constraints = nullptr;
+    _constraintsKey = NoConstraints;
+    clearLCPBases();
+    _isInitialized = false;
+    _isFixedContact = false;
+}
+
+void HumanoidSimulation::saveState(State& state) const
+{
+    _simulation.saveState(state.simulation);
+    state.isInitialized = _isInitialized;
+    state.isFixedContact = _isFixedContact;
+    state.constraintsKey = _constraintsKey;
+    state.cleatsIsActive.resize(_cleats.size());
+    state.cleatsIsContact.resize(_cleats.size());
+    state.cleatsIndex.resize(_cleats.size());
+    state.cleatsForce.resize(_cleats.size());
+    state.cleatsHeight.resize(_cleats.size());
+    size_t index = 0;
+    for (const auto& it : _cleats) {
+        state.cleatsIsActive[index] = it.second.isActive;
+        state.cleatsIsContact[index] = it.second.isContact;
+        state.cleatsIndex[index] = it.second.index;
+        state.cleatsForce[index] = it.second.force;
+        state.cleatsHeight[index] = it.second.height;
+        index++;
+    }
+}
+void HumanoidSimulation::restoreState(const State& state)
+{
+    if (state.cleatsIsActive.size() != _cleats.size()) {
+        throw std::logic_error(
+            "HumanoidSimulation invalid state size");
+    }
+    _simulation.restoreState(state.simulation);
+    _model.updateDOFPosition();
+    _isInitialized = state.isInitialized;
+    _isFixedContact = state.isFixedContact;
+    _constraintsKey = state.constraintsKey;
+    clearLCPBases();
+    if (_constraintsKey == NoConstraints) {
+        _constraints = nullptr;
+    } else {
+        _constraints = &cachedConstraintSet(
+            _constraintsKey, false).set;
+    }
+    size_t index = 0;
+    for (auto& it : _cleats) {
+        it.second.isActive = state.cleatsIsActive[index];
+        it.second.isContact = state.cleatsIsContact[index];
+        it.second.index = state.cleatsIndex[index];
+        it.second.force = state.cleatsForce[index];
+        it.second.height = state.cleatsHeight[index];
+        index++;
     }
 }
 
@@ -236,6 +311,16 @@ JointModel& HumanoidSimulation::jointModel(
     return _simulation.jointModel(_model.getDOFIndex(name));
 }
 
+double HumanoidSimulation::computeFeedForward(
+    const std::string& name,
+    double velGoal,
+    double accGoal,
+    double torqueGoal) const
+{
+    return _simulation.computeFeedForward(
+        _model.getDOFIndex(name), velGoal, accGoal, torqueGoal);
+}
+
 void HumanoidSimulation::setJointModelParameters(
     const Eigen::VectorXd& params)
 {
@@ -253,6 +338,17 @@ double HumanoidSimulation::getCleatForce(
     return _cleats.at(name).force;
 }
 
+void HumanoidSimulation::setIntegrator(
+    ForwardSimulation::Integrator integrator)
+{
+    _simulation.setIntegrator(integrator);
+}
+void HumanoidSimulation::setAdaptiveTolerance(
+    double tolerance, double minStep)
+{
+    _simulation.setAdaptiveTolerance(tolerance, minStep);
+}
+
 void HumanoidSimulation::update(double dt)
 {
     //std::cout << "########## Step ######### " << dt << std::endl; //XXX
@@ -273,9 +369,12 @@ void HumanoidSimulation::update(double dt)
         (isNeedLCPUpdate || !_isInitialized) && 
         !_isFixedContact
     ) {
-        RBDL::ConstraintSet tmpConstraints = buildConstraintSet(true, true /*XXX*/, false);
+        //The impulse set is the same as the
+        //LCP set computed just after
+        ConstraintsCache& tmpConstraints = cachedConstraintSet(
+            constraintsKey(true, true /*XXX*/), false);
         // XXX std::cout << "Compute Impulse !" << std::endl;
-        _simulation.computeImpulses(tmpConstraints);
+        _simulation.computeImpulses(tmpConstraints.set);
 
         findActiveConstraintsLCP();
         _isInitialized = true;
@@ -296,7 +395,8 @@ void HumanoidSimulation::update(double dt)
     */
 
     //Simulation update
-    _simulation.update(dt, &_constraints);
+    _simulation.update(dt, _constraints);
+    _simulatedTime += dt;
     //Assign model position state
     _model.setDOFVect(_simulation.positions());
     
@@ -320,7 +420,7 @@ void HumanoidSimulation::update(double dt)
     //Retrieve contact active force
     for (auto& it : _cleats) {
         if (it.second.isActive) {
-            it.second.force = _constraints.force(it.second.index);
+            it.second.force = _constraints->force(it.second.index);
         } else {
             it.second.force = 0.0;
         }
@@ -344,7 +444,8 @@ void HumanoidSimulation::printCleatsStatus(bool verbose)
                 << std::endl;
         }
         std::cout << "Constraint set size=" 
-            << _constraints.force.size() << std::endl;
+            << (_constraints == nullptr ? 
+                0 : _constraints->force.size()) << std::endl;
     } else {
         for (const auto& it : _cleats) {
             std::cout 
@@ -378,9 +479,82 @@ void HumanoidSimulation::printCleatsStatus(Plot& plot)
     }
     plot.add(vect);
 }
+
+void HumanoidSimulation::setLCPWarmStart(bool isEnabled)
+{
+    _isLCPWarmStart = isEnabled;
+    clearLCPBases();
+}
+
+void HumanoidSimulation::setDynamicsContext(bool isEnabled)
+{
+    _simulation.setDynamicsContext(isEnabled);
+}
+
+unsigned long HumanoidSimulation::lcpCount() const
+{
+    return _lcpCount;
+}
+unsigned long HumanoidSimulation::lcpPivotCount() const
+{
+    return _lcpPivotCount;
+}
+unsigned long HumanoidSimulation::cacheHitCount() const
+{
+    return _cacheHitCount;
+}
+unsigned long HumanoidSimulation::cacheMissCount() const
+{
+    return _cacheMissCount;
+}
+double HumanoidSimulation::simulatedTime() const
+{
+    return _simulatedTime;
+}
+
+void HumanoidSimulation::resetCounters()
+{
+    _lcpCount = 0;
+    _lcpPivotCount = 0;
+    _cacheHitCount = 0;
+    _cacheMissCount = 0;
+    _simulatedTime = 0.0;
+    _simulation.dynamicsContext().resetCounters();
+}
+
+void HumanoidSimulation::printConstraintsStats() const
+{
+    double time = _simulatedTime;
+    if (time <= 0.0) {
+        time = 1.0;
+    }
+    std::cout 
+        << "Simulated time=" << _simulatedTime 
+        << " LCP=" << _lcpCount 
+        << " (" << _lcpCount/time << "/s)"
+        << " pivots=" << _lcpPivotCount 
+        << " (" << _lcpPivotCount/time << "/s)"
+        << " cacheHit=" << _cacheHitCount 
+        << " (" << _cacheHitCount/time << "/s)"
+        << " cacheMiss=" << _cacheMissCount 
+        << " (" << _cacheMissCount/time << "/s)"
+        << " cachedSets=" << _constraintsCache.size()
+        << " dynamicsComputed=" 
+        << _simulation.dynamicsContext().computeCount()
+        << " dynamicsReused=" 
+        << _simulation.dynamicsContext().reuseCount()
+        << std::endl;
+}
         
 void HumanoidSimulation::addCleat(const std::string& frame)
 {
+    //Selected cleats are stored
+    //in constraints cache key bitmask
+    if (_cleats.size() >= 16) {
+        throw std::logic_error(
+            "HumanoidSimulation too many cleats: " 
+            + frame);
+    }
     size_t bodyId = _model.frameIndexToBodyId(
         _model.getFrameIndex(frame));
     bool isLeftFoot = 
@@ -397,18 +571,70 @@ void HumanoidSimulation::addCleat(const std::string& frame)
         false, false, (size_t)-1, 0.0, 0.0};
 }
 
-RBDL::ConstraintSet HumanoidSimulation::buildConstraintSet(
+unsigned int HumanoidSimulation::constraintsKey(
     bool withContact, 
-    bool withLateral, 
-    bool assignCleats,
-    Eigen::VectorXi* isBilateralConstraint)
+    bool withLateral) const
+{
+    //Selected cleats bits in name order
+    //and lateral flag bit
+    unsigned int key = 0;
+    size_t index = 0;
+    for (const auto& it : _cleats) {
+        if (
+            it.second.isActive ||
+            (withContact && it.second.isContact)
+        ) {
+            key |= (1u << index);
+        }
+        index++;
+    }
+    if (withLateral) {
+        key |= (1u << 16);
+    }
+
+    return key;
+}
+
+HumanoidSimulation::ConstraintsCache& HumanoidSimulation::
+    cachedConstraintSet(
+    unsigned int key,
+    bool assignCleats)
+{
+    auto it = _constraintsCache.find(key);
+    if (it == _constraintsCache.end()) {
+        _cacheMissCount++;
+        it = _constraintsCache.insert(
+            std::make_pair(key, ConstraintsCache())).first;
+        buildConstraintSet(key, it->second);
+    } else {
+        _cacheHitCount++;
+    }
+    //Assign constraint index in set
+    if (assignCleats) {
+        size_t index = 0;
+        for (auto& itCleat : _cleats) {
+            if (it->second.cleatsIndex[index] != (size_t)-1) {
+                itCleat.second.index = it->second.cleatsIndex[index];
+            }
+            index++;
+        }
+    }
+
+    return it->second;
+}
+
+void HumanoidSimulation::buildConstraintSet(
+    unsigned int key,
+    ConstraintsCache& cache)
 {
+    bool withLateral = (key & (1u << 16));
     //Create and init the set
-    RBDL::ConstraintSet set;
+    RBDL::ConstraintSet& set = cache.set;
     set.SetSolver(RBDLMath::LinearSolverFullPivHouseholderQR);
-    if (isBilateralConstraint != nullptr) {
-        *isBilateralConstraint = Eigen::VectorXi();
-    }
+    Eigen::VectorXi* isBilateralConstraint = 
+        &cache.isBilateralConstraint;
+    *isBilateralConstraint = Eigen::VectorXi();
+    cache.cleatsIndex.assign(_cleats.size(), (size_t)-1);
 
     //State of selected lateral constraints.
     //Use to not select two constraints on the
@@ -428,12 +654,12 @@ RBDL::ConstraintSet HumanoidSimulation::buildConstraintSet(
     
     //Loop over all cleats
     size_t indexInSet = 0;
+    size_t indexCleat = 0;
     for (auto& it : _cleats) {
         //Select active or contacting cleats
         if (
             //countSelectedVertical[it.second.isLeftFoot] < 3 && //TODO XXX
-            (it.second.isActive ||
-            (withContact && it.second.isContact))
+            (key & (1u << indexCleat))
         ) {
             //Create Z constraint
             //for all selected cleat
@@ -449,9 +675,7 @@ RBDL::ConstraintSet HumanoidSimulation::buildConstraintSet(
                 (*isBilateralConstraint)(indexInSet) = 0;
             }
             //Assign constraint index in set
-            if (assignCleats) {
-                it.second.index = indexInSet;
-            }
+            cache.cleatsIndex[indexCleat] = indexInSet;
             indexInSet++;
             if (withLateral) {
                 //Create X constraints only for the first 
@@ -516,12 +740,11 @@ RBDL::ConstraintSet HumanoidSimulation::buildConstraintSet(
         //TODO assign -1 in indexInSet for 4th contacting cleat
         //and update in loop contact to active not to active
         //the 4th cleat
+        indexCleat++;
     }
     //Bind and initialize the set 
     //with the RBDL model
     set.Bind(_model.getRBDLModel());
-
-    return set;
 }
         
 void HumanoidSimulation::checkAndUpdateCleatsState(
@@ -584,12 +807,17 @@ void HumanoidSimulation::checkAndUpdateCleatsState(
         
 void HumanoidSimulation::findActiveConstraintsLCP()
 {
-    //ConstraintSet allocation
-    Eigen::VectorXi isBilateralConstraint;
-    RBDL::ConstraintSet tmpConstraints = buildConstraintSet(
-        true, true /*XXX*/, true, &isBilateralConstraint);
+    //Cached ConstraintSet retrieval
+    _lcpCount++;
+    ConstraintsCache& cache = cachedConstraintSet(
+        constraintsKey(true, true /*XXX*/), true);
+    RBDL::ConstraintSet& tmpConstraints = cache.set;
+    unsigned long pivots = 0;
     _simulation.computeContactLCP(
-        tmpConstraints, isBilateralConstraint);
+        tmpConstraints, cache.isBilateralConstraint,
+        (_isLCPWarmStart ? &cache.lcpBasis : nullptr),
+        &pivots);
+    _lcpPivotCount += pivots;
     //XXX std::cout << "HumanoidSimulation LCP lambda=" << tmpConstraints.force.transpose() << std::endl;
     
     for (auto& it : _cleats) {
@@ -605,7 +833,9 @@ void HumanoidSimulation::findActiveConstraintsLCP()
         } 
     }
     
-    _constraints = buildConstraintSet(false, true /*XXX*/, true);
+    _constraintsKey = constraintsKey(false, true /*XXX*/);
+    _constraints = &cachedConstraintSet(
+        _constraintsKey, true).set;
 
     /*
     std::cout << "Re Compute final Impulse !" << std::endl;
@@ -613,5 +843,12 @@ void HumanoidSimulation::findActiveConstraintsLCP()
     */
 }
 
+void HumanoidSimulation::clearLCPBases()
+{
+    for (auto& it : _constraintsCache) {
+        it.second.lcpBasis.clear();
+    }
+}
+
 }
 
@@ -3,6 +3,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include <Eigen/Dense>
 #include "Model/HumanoidModel.hpp"
 #include "Model/HumanoidFixedModel.hpp"
@@ -24,6 +25,24 @@ class HumanoidSimulation
 {
     public:
 
+        /**
+         * Complete simulation state with cleats
+         * flags, forces and constraint index
+         * in cleats name order. The active constraint
+         * set is stored as its cache key.
+         */
+        struct State {
+            ForwardSimulation::State simulation;
+            bool isInitialized;
+            bool isFixedContact;
+            unsigned int constraintsKey;
+            std::vector<bool> cleatsIsActive;
+            std::vector<bool> cleatsIsContact;
+            std::vector<size_t> cleatsIndex;
+            std::vector<double> cleatsForce;
+            std::vector<double> cleatsHeight;
+        };
+
         /**
          * Initialization with robot type.
          * If inertia data and name are not empty,
@@ -66,6 +85,28 @@ class HumanoidSimulation
             HumanoidFixedModel::SupportFoot foot,
             bool isContactFixed = false);
 
+        /**
+         * Reset all cleats to the free state
+         * (no contact and no active constraint)
+         * and force the active constraints set
+         * computation at next update
+         */
+        void resetContacts();
+
+        /**
+         * Copy the complete simulation state into
+         * given state or assign it from given state
+         * saved from this simulation. Used to restore
+         * a settled initial state or to branch rollouts.
+         * Cached LCP warm start bases are dropped on
+         * restore for rollouts to be reproducible.
+         * No allocation occurs once given state is sized
+         * by a first save and the active constraint set
+         * has already been cached.
+         */
+        void saveState(State& state) const;
+        void restoreState(const State& state);
+
         /**
          * Internal state access
          */
@@ -99,6 +140,17 @@ class HumanoidSimulation
          */
         const JointModel& jointModel(const std::string& name) const;
         JointModel& jointModel(const std::string& name);
+
+        /**
+         * Return the feed forward goal
+         * offset of given DOF name
+         * (see JointModel::computeFeedForward())
+         */
+        double computeFeedForward(
+            const std::string& name,
+            double velGoal,
+            double accGoal,
+            double torqueGoal) const;
         
         /**
          * Return the vertical force appling 
@@ -112,6 +164,15 @@ class HumanoidSimulation
          */
         void setJointModelParameters(const Eigen::VectorXd& params);
 
+        /**
+         * Select the internal simulation integration
+         * scheme and adaptive scheme tolerance
+         * (see ForwardSimulation)
+         */
+        void setIntegrator(ForwardSimulation::Integrator integrator);
+        void setAdaptiveTolerance(
+            double tolerance, double minStep = 1e-6);
+
         /**
          * Run the forward simulation by one step
          * of given time duration. Handle contact
@@ -126,6 +187,47 @@ class HumanoidSimulation
         void printCleatsStatus(bool verbose = true);
         void printCleatsStatus(Plot& plot);
 
+        /**
+         * Enable or disable LCP warm start from the
+         * solution basis of the previous LCP with the
+         * same constraint set (enabled by default)
+         */
+        void setLCPWarmStart(bool isEnabled);
+
+        /**
+         * Enable or disable the dynamics terms
+         * sharing between the solves of a step
+         * (see ForwardSimulation::setDynamicsContext())
+         */
+        void setDynamicsContext(bool isEnabled);
+
+        /**
+         * Return the number of active constraint
+         * set computations (LCP) and their total
+         * pivots, of constraint set cache hits 
+         * and misses (RBDL set build) and the 
+         * simulated time since last counters reset
+         */
+        unsigned long lcpCount() const;
+        unsigned long lcpPivotCount() const;
+        unsigned long cacheHitCount() const;
+        unsigned long cacheMissCount() const;
+        double simulatedTime() const;
+
+        /**
+         * Reset constraint and dynamics terms
+         * counters and simulated time
+         */
+        void resetCounters();
+
+        /**
+         * Display on standart output LCP triggers
+         * and pivots, constraint set cache hits 
+         * and misses per simulated second and
+         * computed and reused dynamics terms
+         */
+        void printConstraintsStats() const;
+
     private:
 
         /**
@@ -172,10 +274,56 @@ class HumanoidSimulation
          */
         bool _isInitialized;
 
+        /**
+         * Cached RBDL constraint set bound to the
+         * model with its bilateral constraints flags,
+         * the vertical constraint index of each
+         * cleat in name order ((size_t)-1 if the cleat
+         * is not selected) and the last LCP solution 
+         * basis used as next warm start
+         */
+        struct ConstraintsCache {
+            RBDL::ConstraintSet set;
+            Eigen::VectorXi isBilateralConstraint;
+            std::vector<size_t> cleatsIndex;
+            std::vector<unsigned> lcpBasis;
+        };
+
+        /**
+         * Key of no constraint set
+         */
+        static const unsigned int NoConstraints = (unsigned int)-1;
+
+        /**
+         * Constraint sets cache indexed by the 
+         * selected cleats bitmask (in name order)
+         * and lateral constraints flag.
+         * Map nodes are never removed and pointers
+         * to cached sets remain valid.
+         */
+        std::map<unsigned int, ConstraintsCache> _constraintsCache;
+
         /**
          * RBDL current constraint set instance
+         * inside the cache (null if none) and its key
+         */
+        RBDL::ConstraintSet* _constraints;
+        unsigned int _constraintsKey;
+
+        /**
+         * Is LCP warm start enabled
          */
-        RBDL::ConstraintSet _constraints;
+        bool _isLCPWarmStart;
+
+        /**
+         * LCP computations, pivots and cache 
+         * counters and simulated time
+         */
+        unsigned long _lcpCount;
+        unsigned long _lcpPivotCount;
+        unsigned long _cacheHitCount;
+        unsigned long _cacheMissCount;
+        double _simulatedTime;
 
         /**
          * All fot cleats current state container
@@ -195,23 +343,39 @@ class HumanoidSimulation
         void addCleat(const std::string& frame);
 
         /**
-         * Build and return a RBDL ConstraintSet
+         * Return the cache key of the ConstraintSet
          * with all vertical (Z) and active contact.
          * If withContact is true, also 
          * add contacting cleat.
          * If withLateral is true, also 
          * add lateral (X,Y) constraints.
-         * If assignCleats is true, the vertical
-         * constraint index is assign to cleats.
-         * If isBilateralConstraint is not null,
-         * the vector is assign with boolan information
-         * on the associated constraint.
          */
-        RBDL::ConstraintSet buildConstraintSet(
+        unsigned int constraintsKey(
             bool withContact, 
-            bool withLateral, 
-            bool assignCleats,
-            Eigen::VectorXi* isBilateralConstraint = nullptr);
+            bool withLateral) const;
+
+        /**
+         * Return the cached ConstraintSet
+         * with given key. The set is built
+         * and bound on cache miss.
+         * If assignCleats is true, the vertical
+         * constraint index is assign to selected cleats.
+         */
+        ConstraintsCache& cachedConstraintSet(
+            unsigned int key,
+            bool assignCleats);
+
+        /**
+         * Build and bind into given cache entry the
+         * RBDL ConstraintSet with given key selected 
+         * cleats vertical constraints and if
+         * requested lateral constraints.
+         * Bilateral flags and cleats vertical
+         * constraints index are also assigned.
+         */
+        void buildConstraintSet(
+            unsigned int key,
+            ConstraintsCache& cache);
 
         /**
          * Update cleats state (collisions detection,
@@ -225,6 +389,11 @@ class HumanoidSimulation
             bool& isNeedLCPUpdate, bool& isNeedImpulse);
 
         void findActiveConstraintsLCP();
+
+        /**
+         * Drop all cached LCP warm start bases
+         */
+        void clearLCPBases();
 };
 
 }
@@ -2,6 +2,7 @@
 #include <iomanip>
 #include <stdexcept>
 #include <cmath>
+#include <algorithm>
 #include "Model/JointModel.hpp"
 #include "Utils/Angle.h"
 
@@ -19,6 +20,8 @@ JointModel::JointModel(
     _featureOptimizationControlGain(false),
     _goalTime(0.0),
     _goalHistory(),
+    _goalHistoryBegin(0),
+    _goalHistorySize(0),
     _isInitialized(false),
     //Backlash initial state
     _stateBacklashIsEnabled(false),
@@ -294,9 +297,7 @@ void JointModel::updateState(
     //Hidden state initialization
     if (!_isInitialized) {
         _goalTime = 0.0;
-        while (!_goalHistory.empty()) {
-            _goalHistory.pop();
-        }
+        clearGoals();
         _stateBacklashIsEnabled = false;
         _stateBacklashPosition = pos;
         _stateBacklashVelocity = vel;
@@ -304,16 +305,16 @@ void JointModel::updateState(
     }
 
     //Append given goal
-    _goalHistory.push({_goalTime, goal});
+    pushGoal(_goalTime, goal);
     //Update integrated time
     _goalTime += dt;
 
     //Pop history to get current goal lag
     while (
-        _goalHistory.size() >= 2 &&
-        _goalHistory.front().first < _goalTime - _paramControlLag
+        _goalHistorySize >= 2 &&
+        frontGoal().first < _goalTime - _paramControlLag
     ) {
-        _goalHistory.pop();
+        popGoal();
     }
 
     //Update backlash model
@@ -365,10 +366,10 @@ void JointModel::updateState(
         
 double JointModel::getDelayedGoal() const
 {
-    if (_goalHistory.size() == 0) {
+    if (_goalHistorySize == 0) {
         return 0.0;
     } else {
-        return _goalHistory.front().second;
+        return frontGoal().second;
     }
 }
         
@@ -389,13 +390,41 @@ void JointModel::resetHiddenState()
 {
     _isInitialized = false;
     _goalTime = 0.0;
-    while (!_goalHistory.empty()) {
-        _goalHistory.pop();
-    }
+    clearGoals();
     _stateBacklashIsEnabled = true;
     _stateBacklashPosition = 0.0;
     _stateBacklashVelocity = 0.0;
 }
+
+void JointModel::saveState(State& state) const
+{
+    state.goalTime = _goalTime;
+    state.goalHistory.resize(_goalHistorySize);
+    for (size_t i=0;i<_goalHistorySize;i++) {
+        state.goalHistory[i] = _goalHistory[
+            (_goalHistoryBegin + i) % _goalHistory.size()];
+    }
+    state.isInitialized = _isInitialized;
+    state.backlashIsEnabled = _stateBacklashIsEnabled;
+    state.backlashPosition = _stateBacklashPosition;
+    state.backlashVelocity = _stateBacklashVelocity;
+}
+void JointModel::restoreState(const State& state)
+{
+    _goalTime = state.goalTime;
+    if (_goalHistory.size() < state.goalHistory.size()) {
+        _goalHistory.resize(state.goalHistory.size());
+    }
+    for (size_t i=0;i<state.goalHistory.size();i++) {
+        _goalHistory[i] = state.goalHistory[i];
+    }
+    _goalHistoryBegin = 0;
+    _goalHistorySize = state.goalHistory.size();
+    _isInitialized = state.isInitialized;
+    _stateBacklashIsEnabled = state.backlashIsEnabled;
+    _stateBacklashPosition = state.backlashPosition;
+    _stateBacklashVelocity = state.backlashVelocity;
+}
  
 void JointModel::boundState(double& pos, double& vel)
 {
@@ -661,5 +690,37 @@ double JointModel::computeControlTorque(
     return torque;
 }
 
+void JointModel::pushGoal(double time, double goal)
+{
+    //Grow the buffer by linearizing
+    //the history when full
+    if (_goalHistorySize == _goalHistory.size()) {
+        std::vector<std::pair<double, double>> history(
+            std::max((size_t)16, 2*_goalHistory.size()));
+        for (size_t i=0;i<_goalHistorySize;i++) {
+            history[i] = _goalHistory[
+                (_goalHistoryBegin + i) % _goalHistory.size()];
+        }
+        _goalHistory.swap(history);
+        _goalHistoryBegin = 0;
+    }
+    _goalHistory[(_goalHistoryBegin + _goalHistorySize) 
+        % _goalHistory.size()] = {time, goal};
+    _goalHistorySize++;
+}
+void JointModel::popGoal()
+{
+    _goalHistoryBegin = (_goalHistoryBegin + 1) % _goalHistory.size();
+    _goalHistorySize--;
+}
+const std::pair<double, double>& JointModel::frontGoal() const
+{
+    return _goalHistory[_goalHistoryBegin];
+}
+void JointModel::clearGoals()
+{
+    _goalHistoryBegin = 0;
+    _goalHistorySize = 0;
 }
 
+}
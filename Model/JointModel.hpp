@@ -2,8 +2,9 @@
 #define LEPH_JOINTMODEL_HPP
 
 #include <string>
+#include <vector>
+#include <utility>
 #include <Eigen/Dense>
-#include <queue>
 
 namespace Leph {
 
@@ -18,6 +19,20 @@ class JointModel
 {
     public:
 
+        /**
+         * Hidden dynamic state (goal lag
+         * history and backlash state).
+         * Model parameters are not included.
+         */
+        struct State {
+            double goalTime;
+            std::vector<std::pair<double, double>> goalHistory;
+            bool isInitialized;
+            bool backlashIsEnabled;
+            double backlashPosition;
+            double backlashVelocity;
+        };
+
         /**
          * Initialization with 
          * jont type and name
@@ -91,6 +106,15 @@ class JointModel
          */
         void resetHiddenState();
 
+        /**
+         * Copy the hidden state into given 
+         * state or assign it from given state.
+         * No allocation is done once given
+         * state and goal history are sized.
+         */
+        void saveState(State& state) const;
+        void restoreState(const State& state);
+
         /**
          * Optionnaly update given current joint
          * position and velocity to ensure constraints
@@ -130,6 +154,12 @@ class JointModel
 
     private:
 
+        /**
+         * Structure of arrays storage
+         * of multiple joints
+         */
+        friend class JointModelBank;
+
         /**
          * Joint textual name
          */
@@ -156,10 +186,13 @@ class JointModel
         /**
          * Current integrated time in seconds
          * and target goal history (for lag
-         * implementation)
+         * implementation) as a ring buffer 
+         * with its first element index and size
          */
         double _goalTime;
-        std::queue<std::pair<double, double>> _goalHistory;
+        std::vector<std::pair<double, double>> _goalHistory;
+        size_t _goalHistoryBegin;
+        size_t _goalHistorySize;
 
         /**
          * Is backlash state initialized.
@@ -241,6 +274,16 @@ class JointModel
          */
         double computeControlTorque(
             double pos, double vel) const;
+
+        /**
+         * Goal history ring buffer 
+         * push back, pop front, front 
+         * access and clear
+         */
+        void pushGoal(double time, double goal);
+        void popGoal();
+        const std::pair<double, double>& frontGoal() const;
+        void clearGoals();
 };
 
 }
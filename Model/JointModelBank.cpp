@@ -0,0 +1,446 @@
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
+#include "Model/JointModelBank.hpp"
+#include "Utils/Angle.h"
+
+namespace Leph {
+
+JointModelBank::JointModelBank(size_t size) :
+    _names(size),
+    _featureBacklash(false),
+    _featureFrictionStribeck(false),
+    _featureReadDiscretization(false),
+    _loadedCount(0),
+    _coefAnglePosToPWM(Eigen::VectorXd::Zero(size)),
+    _coefPWMBound(Eigen::VectorXd::Zero(size)),
+    _paramFrictionRegularization(Eigen::VectorXd::Zero(size)),
+    _paramFrictionVelLimit(Eigen::VectorXd::Zero(size)),
+    _paramInertiaIn(Eigen::VectorXd::Zero(size)),
+    _paramInertiaOut(Eigen::VectorXd::Zero(size)),
+    _paramElectricVoltage(Eigen::VectorXd::Zero(size)),
+    _paramElectricKe(Eigen::VectorXd::Zero(size)),
+    _paramElectricResistance(Eigen::VectorXd::Zero(size)),
+    _paramControlGainP(Eigen::VectorXd::Zero(size)),
+    _paramControlDiscretization(Eigen::VectorXd::Zero(size)),
+    _paramControlLag(Eigen::VectorXd::Zero(size)),
+    _paramBacklashThresholdDeactivation(Eigen::VectorXd::Zero(size)),
+    _paramBacklashThresholdActivation(Eigen::VectorXd::Zero(size)),
+    _paramBacklashRangeMax(Eigen::VectorXd::Zero(size)),
+    _frictionViscousOut(Eigen::VectorXd::Zero(size)),
+    _frictionBreakOut(Eigen::VectorXd::Zero(size)),
+    _frictionCoulombOut(Eigen::VectorXd::Zero(size)),
+    _frictionViscousAll(Eigen::VectorXd::Zero(size)),
+    _frictionBreakAll(Eigen::VectorXd::Zero(size)),
+    _frictionCoulombAll(Eigen::VectorXd::Zero(size)),
+    _frictionViscousIn(Eigen::VectorXd::Zero(size)),
+    _frictionBreakIn(Eigen::VectorXd::Zero(size)),
+    _frictionCoulombIn(Eigen::VectorXd::Zero(size)),
+    _maxControlLag(0.0),
+    _goalTime(Eigen::VectorXd::Zero(size)),
+    _isInitialized(size, false),
+    _stateBacklashIsEnabled(size, false),
+    _stateBacklashPosition(Eigen::VectorXd::Zero(size)),
+    _stateBacklashVelocity(Eigen::VectorXd::Zero(size)),
+    _historyTimes(16, size),
+    _historyGoals(16, size),
+    _historyBegin(size, 0),
+    _historySize(size, 0),
+    _delayedGoals(Eigen::VectorXd::Zero(size))
+{
+}
+
+size_t JointModelBank::size() const
+{
+    return _names.size();
+}
+
+void JointModelBank::load(size_t index, const JointModel& joint)
+{
+    if (index >= _names.size()) {
+        throw std::logic_error(
+            "JointModelBank invalid index: "
+            + std::to_string(index));
+    }
+    //Check shared features
+    if (_loadedCount == 0) {
+        _featureBacklash = joint._featureBacklash;
+        _featureFrictionStribeck = joint._featureFrictionStribeck;
+        _featureReadDiscretization = joint._featureReadDiscretization;
+    } else if (
+        _featureBacklash != joint._featureBacklash ||
+        _featureFrictionStribeck != joint._featureFrictionStribeck ||
+        _featureReadDiscretization != joint._featureReadDiscretization
+    ) {
+        throw std::logic_error(
+            "JointModelBank mismatched joint features: "
+            + joint._name);
+    }
+    _loadedCount++;
+
+    //Copy parameters
+    _names[index] = joint._name;
+    _coefAnglePosToPWM(index) = joint._coefAnglePosToPWM;
+    _coefPWMBound(index) = joint._coefPWMBound;
+    _paramFrictionRegularization(index) =
+        joint._paramFrictionRegularization;
+    _paramFrictionVelLimit(index) = joint._paramFrictionVelLimit;
+    _paramInertiaIn(index) = joint._paramInertiaIn;
+    _paramInertiaOut(index) = joint._paramInertiaOut;
+    _paramElectricVoltage(index) = joint._paramElectricVoltage;
+    _paramElectricKe(index) = joint._paramElectricKe;
+    _paramElectricResistance(index) = joint._paramElectricResistance;
+    _paramControlGainP(index) = joint._paramControlGainP;
+    _paramControlDiscretization(index) =
+        joint._paramControlDiscretization;
+    _paramControlLag(index) = joint._paramControlLag;
+    _paramBacklashThresholdDeactivation(index) =
+        joint._paramBacklashThresholdDeactivation;
+    _paramBacklashThresholdActivation(index) =
+        joint._paramBacklashThresholdActivation;
+    _paramBacklashRangeMax(index) = joint._paramBacklashRangeMax;
+
+    //Precompute friction coefficients in the
+    //same summation order than JointModel
+    double breakIn =
+        joint._paramFrictionBreakIn + joint._paramFrictionCoulombIn;
+    double breakOut =
+        joint._paramFrictionBreakOut + joint._paramFrictionCoulombOut;
+    _frictionViscousOut(index) = joint._paramFrictionViscousOut;
+    _frictionBreakOut(index) = breakOut;
+    _frictionCoulombOut(index) = joint._paramFrictionCoulombOut;
+    _frictionViscousIn(index) = joint._paramFrictionViscousIn;
+    _frictionBreakIn(index) = breakIn;
+    _frictionCoulombIn(index) = joint._paramFrictionCoulombIn;
+    if (_featureBacklash) {
+        _frictionViscousAll(index) =
+            joint._paramFrictionViscousIn
+            + joint._paramFrictionViscousOut;
+        _frictionBreakAll(index) = breakIn + breakOut;
+        _frictionCoulombAll(index) =
+            joint._paramFrictionCoulombIn
+            + joint._paramFrictionCoulombOut;
+    } else {
+        _frictionViscousAll(index) = _frictionViscousOut(index);
+        _frictionBreakAll(index) = _frictionBreakOut(index);
+        _frictionCoulombAll(index) = _frictionCoulombOut(index);
+    }
+    if (!_featureFrictionStribeck) {
+        _frictionBreakOut(index) = _frictionCoulombOut(index);
+        _frictionBreakAll(index) = _frictionCoulombAll(index);
+        _frictionBreakIn(index) = _frictionCoulombIn(index);
+    }
+    _maxControlLag = _paramControlLag.maxCoeff();
+
+    //Copy hidden state
+    JointModel::State state;
+    joint.saveState(state);
+    restoreState(index, state);
+}
+void JointModelBank::store(size_t index, JointModel& joint) const
+{
+    if (index >= _names.size()) {
+        throw std::logic_error(
+            "JointModelBank invalid index: "
+            + std::to_string(index));
+    }
+    JointModel::State state;
+    saveState(index, state);
+    joint.restoreState(state);
+}
+
+void JointModelBank::saveState(
+    size_t index, JointModel::State& state) const
+{
+    size_t capacity = _historyTimes.rows();
+    state.goalTime = _goalTime(index);
+    state.goalHistory.resize(_historySize[index]);
+    for (size_t i=0;i<_historySize[index];i++) {
+        size_t k = (_historyBegin[index] + i) % capacity;
+        state.goalHistory[i] = {
+            _historyTimes(k, index), _historyGoals(k, index)};
+    }
+    state.isInitialized = _isInitialized[index];
+    state.backlashIsEnabled = _stateBacklashIsEnabled[index];
+    state.backlashPosition = _stateBacklashPosition(index);
+    state.backlashVelocity = _stateBacklashVelocity(index);
+}
+void JointModelBank::restoreState(
+    size_t index, const JointModel::State& state)
+{
+    if ((size_t)_historyTimes.rows() < state.goalHistory.size()) {
+        growHistory(state.goalHistory.size());
+    }
+    _goalTime(index) = state.goalTime;
+    for (size_t i=0;i<state.goalHistory.size();i++) {
+        _historyTimes(i, index) = state.goalHistory[i].first;
+        _historyGoals(i, index) = state.goalHistory[i].second;
+    }
+    _historyBegin[index] = 0;
+    _historySize[index] = state.goalHistory.size();
+    if (_historySize[index] == 0) {
+        _delayedGoals(index) = 0.0;
+    } else {
+        _delayedGoals(index) = _historyGoals(0, index);
+    }
+    _isInitialized[index] = state.isInitialized;
+    _stateBacklashIsEnabled[index] = state.backlashIsEnabled;
+    _stateBacklashPosition(index) = state.backlashPosition;
+    _stateBacklashVelocity(index) = state.backlashVelocity;
+}
+
+void JointModelBank::reserveHistory(double dt)
+{
+    if (dt <= 0.0) {
+        return;
+    }
+    //The history holds goals younger than the
+    //lag plus one older goal and the appended one
+    size_t capacity = (size_t)std::ceil(_maxControlLag/dt) + 2;
+    if (capacity > (size_t)_historyTimes.rows()) {
+        growHistory(capacity);
+    }
+}
+
+void JointModelBank::boundState(
+    Eigen::VectorXd& pos, Eigen::VectorXd& vel) const
+{
+    for (size_t i=0;i<_names.size();i++) {
+        //Check numerical instability
+        if (fabs(pos(i)) > 1e10 || fabs(vel(i)) > 1e10) {
+            throw std::runtime_error(
+                "JointModel numerical instability:"
+                + std::string(" name=") + _names[i]
+                + std::string(" pos=") + std::to_string(pos(i))
+                + std::string(" vel=") + std::to_string(vel(i)));
+        }
+        //Bound position angle inside [-PI:PI]
+        pos(i) = AngleBound(pos(i));
+    }
+}
+
+void JointModelBank::updateState(
+    double dt,
+    const Eigen::VectorXd& goals,
+    const Eigen::VectorXd& pos,
+    const Eigen::VectorXd& vel)
+{
+    reserveHistory(dt);
+    for (size_t i=0;i<_names.size();i++) {
+        //Hidden state initialization
+        if (!_isInitialized[i]) {
+            _goalTime(i) = 0.0;
+            _historyBegin[i] = 0;
+            _historySize[i] = 0;
+            _stateBacklashIsEnabled[i] = false;
+            _stateBacklashPosition(i) = pos(i);
+            _stateBacklashVelocity(i) = vel(i);
+            _isInitialized[i] = true;
+        }
+
+        //Append given goal. The ring buffer
+        //only grows for time step larger than
+        //the one given to reserveHistory().
+        size_t capacity = _historyTimes.rows();
+        if (_historySize[i] == capacity) {
+            growHistory(2*capacity);
+            capacity = _historyTimes.rows();
+        }
+        size_t back = (_historyBegin[i] + _historySize[i]) % capacity;
+        _historyTimes(back, i) = _goalTime(i);
+        _historyGoals(back, i) = goals(i);
+        _historySize[i]++;
+        //Update integrated time
+        _goalTime(i) += dt;
+
+        //Pop history to get current goal lag
+        double minTime = _goalTime(i) - _paramControlLag(i);
+        while (
+            _historySize[i] >= 2 &&
+            _historyTimes(_historyBegin[i], i) < minTime
+        ) {
+            _historyBegin[i] = (_historyBegin[i] + 1) % capacity;
+            _historySize[i]--;
+        }
+        _delayedGoals(i) = _historyGoals(_historyBegin[i], i);
+    }
+
+    //Update backlash model
+    if (!_featureBacklash) {
+        return;
+    }
+    for (size_t i=0;i<_names.size();i++) {
+        //Compute backlash acceleration
+        double backlashControlTorque = computeControlTorque(
+            i, pos(i), vel(i));
+        double backlashFrictionTorque = computeFrictionTorque(
+            i, vel(i), _frictionViscousIn(i),
+            _frictionBreakIn(i), _frictionCoulombIn(i));
+        double backlashAcc =
+            (backlashControlTorque + backlashFrictionTorque)
+            /_paramInertiaIn(i);
+        //Update backlash velocity and position
+        double backlashNextVel =
+            _stateBacklashVelocity(i) + dt*backlashAcc;
+        _stateBacklashVelocity(i) =
+            0.5*_stateBacklashVelocity(i) + 0.5*backlashNextVel;
+        _stateBacklashPosition(i) =
+            _stateBacklashPosition(i) + dt*_stateBacklashVelocity(i);
+        //Update backlash state
+        double relativePos = fabs(
+            AngleDistance(pos(i), _stateBacklashPosition(i)));
+        //Used state transition thresholds
+        double usedThresholdDeactivation =
+            _paramBacklashThresholdDeactivation(i)
+            + _paramBacklashThresholdActivation(i);
+        double usedThresholdActivation =
+            _paramBacklashThresholdActivation(i);
+        if (
+            _stateBacklashIsEnabled[i] &&
+            relativePos > usedThresholdDeactivation
+        ) {
+            _stateBacklashIsEnabled[i] = false;
+        } else if (
+            !_stateBacklashIsEnabled[i] &&
+            relativePos < usedThresholdActivation
+        ) {
+            _stateBacklashIsEnabled[i] = true;
+        }
+        //Bound backlash position
+        double rangeMax = _paramBacklashRangeMax(i);
+        if (AngleDistance(pos(i), _stateBacklashPosition(i)) >= rangeMax) {
+            _stateBacklashPosition(i) = pos(i) + rangeMax;
+            _stateBacklashVelocity(i) = 0.0;
+        }
+        if (AngleDistance(pos(i), _stateBacklashPosition(i)) <= -rangeMax) {
+            _stateBacklashPosition(i) = pos(i) - rangeMax;
+            _stateBacklashVelocity(i) = 0.0;
+        }
+        _stateBacklashPosition(i) = AngleBound(_stateBacklashPosition(i));
+    }
+}
+
+void JointModelBank::inertias(Eigen::VectorXd& out) const
+{
+    if (!_featureBacklash) {
+        out = _paramInertiaOut;
+        return;
+    }
+    out.resize(_names.size());
+    for (size_t i=0;i<_names.size();i++) {
+        if (_stateBacklashIsEnabled[i]) {
+            out(i) = _paramInertiaOut(i);
+        } else {
+            out(i) = _paramInertiaIn(i) + _paramInertiaOut(i);
+        }
+    }
+}
+
+void JointModelBank::frictionTorques(
+    const Eigen::VectorXd& vel,
+    Eigen::VectorXd& out) const
+{
+    out.resize(_names.size());
+    for (size_t i=0;i<_names.size();i++) {
+        if (_stateBacklashIsEnabled[i]) {
+            out(i) = computeFrictionTorque(
+                i, vel(i), _frictionViscousOut(i),
+                _frictionBreakOut(i), _frictionCoulombOut(i));
+        } else {
+            out(i) = computeFrictionTorque(
+                i, vel(i), _frictionViscousAll(i),
+                _frictionBreakAll(i), _frictionCoulombAll(i));
+        }
+    }
+}
+
+void JointModelBank::controlTorques(
+    const Eigen::VectorXd& pos,
+    const Eigen::VectorXd& vel,
+    Eigen::VectorXd& out) const
+{
+    out.resize(_names.size());
+    for (size_t i=0;i<_names.size();i++) {
+        if (_stateBacklashIsEnabled[i]) {
+            out(i) = 0.0;
+        } else {
+            out(i) = computeControlTorque(i, pos(i), vel(i));
+        }
+    }
+}
+
+const Eigen::VectorXd& JointModelBank::delayedGoals() const
+{
+    return _delayedGoals;
+}
+
+void JointModelBank::growHistory(size_t capacity)
+{
+    size_t oldCapacity = _historyTimes.rows();
+    Eigen::MatrixXd times(capacity, _names.size());
+    Eigen::MatrixXd goals(capacity, _names.size());
+    for (size_t j=0;j<_names.size();j++) {
+        for (size_t i=0;i<_historySize[j];i++) {
+            size_t k = (_historyBegin[j] + i) % oldCapacity;
+            times(i, j) = _historyTimes(k, j);
+            goals(i, j) = _historyGoals(k, j);
+        }
+        _historyBegin[j] = 0;
+    }
+    _historyTimes.swap(times);
+    _historyGoals.swap(goals);
+}
+
+double JointModelBank::computeFrictionTorque(
+    size_t index, double vel,
+    double viscous, double frictionBreak,
+    double coulomb) const
+{
+    double beta = exp(-fabs(vel/_paramFrictionVelLimit(index)));
+    double forceViscous = -viscous*vel;
+    double forceStatic1 = -beta*frictionBreak;
+    double forceStatic2 = -(1.0-beta)*coulomb;
+    //Static friction regularization passing by zero
+    double forceStaticRegularized =
+        (forceStatic1 + forceStatic2)*tanh(
+            _paramFrictionRegularization(index)*vel);
+
+    return forceViscous + forceStaticRegularized;
+}
+
+double JointModelBank::computeControlTorque(
+    size_t index, double pos, double vel) const
+{
+    //Apply position discretization
+    double discretizedPos = pos;
+    if (_featureReadDiscretization) {
+        double motorStepCoef =
+            M_PI/_paramControlDiscretization(index);
+        discretizedPos =
+            std::floor(pos/motorStepCoef)*motorStepCoef;
+    }
+
+    //Angular distance in radian
+    double error = AngleDistance(_delayedGoals(index), discretizedPos);
+    //Compute and bound motor control PWM ratio
+    double controlRatio =
+        -_paramControlGainP(index)*error*_coefAnglePosToPWM(index);
+    if (controlRatio > _coefPWMBound(index)) {
+        controlRatio = _coefPWMBound(index);
+    } else if (controlRatio < -_coefPWMBound(index)) {
+        controlRatio = -_coefPWMBound(index);
+    }
+    //Compute the applied tension
+    //on the electric motor by H-bridge
+    double tension = controlRatio*_paramElectricVoltage(index);
+
+    //Compute applied electrical torque
+    double ke = _paramElectricKe(index);
+    double resistance = _paramElectricResistance(index);
+    return
+        tension*ke/resistance
+        - vel*pow(ke, 2)/resistance;
+}
+
+}
+
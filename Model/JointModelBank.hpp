@@ -0,0 +1,223 @@
+#ifndef LEPH_JOINTMODELBANK_HPP
+#define LEPH_JOINTMODELBANK_HPP
+
+#include <string>
+#include <vector>
+#include <Eigen/Dense>
+#include "Model/JointModel.hpp"
+
+namespace Leph {
+
+/**
+ * JointModelBank
+ *
+ * Structure of arrays storage of a set of
+ * JointModel parameters and hidden states
+ * (one contiguous array per field and joint
+ * index as array index) in order to update and
+ * compute the torques of all joints at once.
+ * The goal lag history of each joint is a fixed
+ * capacity ring buffer stored as a column of
+ * shared time and goal matrices. The capacity
+ * is sized from the maximum control lag and
+ * the simulation time step.
+ * Results are identical to the JointModel
+ * computations which remain the per joint
+ * parameters and state view (see load() and store()).
+ * All joints must share the same feature flags.
+ * ForwardSimulation still steps its JointModel
+ * instances since the bank was not measured
+ * faster (see testJointModelBank timings).
+ */
+class JointModelBank
+{
+    public:
+
+        /**
+         * Initialization with the number of joints
+         */
+        JointModelBank(size_t size = 0);
+
+        /**
+         * Return the number of joints
+         */
+        size_t size() const;
+
+        /**
+         * Assign the parameters and hidden state of
+         * the joint at given index from given joint
+         * model or copy them to given joint model
+         */
+        void load(size_t index, const JointModel& joint);
+        void store(size_t index, JointModel& joint) const;
+
+        /**
+         * Copy the hidden state of the joint
+         * at given index into given state or
+         * assign it from given state
+         */
+        void saveState(size_t index, JointModel::State& state) const;
+        void restoreState(size_t index, const JointModel::State& state);
+
+        /**
+         * Grow if needed the goal history capacity
+         * for the maximum control lag of all joints
+         * and given simulation time step
+         */
+        void reserveHistory(double dt);
+
+        /**
+         * Same as JointModel::boundState()
+         * for all joints
+         */
+        void boundState(
+            Eigen::VectorXd& pos, Eigen::VectorXd& vel) const;
+
+        /**
+         * Same as JointModel::updateState()
+         * for all joints
+         */
+        void updateState(
+            double dt,
+            const Eigen::VectorXd& goals,
+            const Eigen::VectorXd& pos,
+            const Eigen::VectorXd& vel);
+
+        /**
+         * Same as JointModel::getInertia(),
+         * frictionTorque() and controlTorque()
+         * for all joints. Results are assigned to
+         * given output vectors.
+         */
+        void inertias(Eigen::VectorXd& out) const;
+        void frictionTorques(
+            const Eigen::VectorXd& vel,
+            Eigen::VectorXd& out) const;
+        void controlTorques(
+            const Eigen::VectorXd& pos,
+            const Eigen::VectorXd& vel,
+            Eigen::VectorXd& out) const;
+
+        /**
+         * Return all joints current delayed goal
+         */
+        const Eigen::VectorXd& delayedGoals() const;
+
+    private:
+
+        /**
+         * Joints textual name
+         */
+        std::vector<std::string> _names;
+
+        /**
+         * Modelisation features shared
+         * by all joints (see JointModel)
+         * and loaded joints count
+         */
+        bool _featureBacklash;
+        bool _featureFrictionStribeck;
+        bool _featureReadDiscretization;
+        size_t _loadedCount;
+
+        /**
+         * Firmware related coefficients
+         */
+        Eigen::VectorXd _coefAnglePosToPWM;
+        Eigen::VectorXd _coefPWMBound;
+
+        /**
+         * Model parameters (see JointModel)
+         */
+        Eigen::VectorXd _paramFrictionRegularization;
+        Eigen::VectorXd _paramFrictionVelLimit;
+        Eigen::VectorXd _paramInertiaIn;
+        Eigen::VectorXd _paramInertiaOut;
+        Eigen::VectorXd _paramElectricVoltage;
+        Eigen::VectorXd _paramElectricKe;
+        Eigen::VectorXd _paramElectricResistance;
+        Eigen::VectorXd _paramControlGainP;
+        Eigen::VectorXd _paramControlDiscretization;
+        Eigen::VectorXd _paramControlLag;
+        Eigen::VectorXd _paramBacklashThresholdDeactivation;
+        Eigen::VectorXd _paramBacklashThresholdActivation;
+        Eigen::VectorXd _paramBacklashRangeMax;
+
+        /**
+         * Friction coefficients precomputed from
+         * parameters for external only (backlash
+         * enabled), internal and external and
+         * internal only (backlash model) friction.
+         * Break coefficients already include the
+         * Coulomb offset and the Stribeck feature.
+         */
+        Eigen::VectorXd _frictionViscousOut;
+        Eigen::VectorXd _frictionBreakOut;
+        Eigen::VectorXd _frictionCoulombOut;
+        Eigen::VectorXd _frictionViscousAll;
+        Eigen::VectorXd _frictionBreakAll;
+        Eigen::VectorXd _frictionCoulombAll;
+        Eigen::VectorXd _frictionViscousIn;
+        Eigen::VectorXd _frictionBreakIn;
+        Eigen::VectorXd _frictionCoulombIn;
+
+        /**
+         * Maximum control lag over all joints
+         */
+        double _maxControlLag;
+
+        /**
+         * Hidden states (see JointModel)
+         */
+        Eigen::VectorXd _goalTime;
+        std::vector<char> _isInitialized;
+        std::vector<char> _stateBacklashIsEnabled;
+        Eigen::VectorXd _stateBacklashPosition;
+        Eigen::VectorXd _stateBacklashVelocity;
+
+        /**
+         * Goal history ring buffers.
+         * One column per joint with
+         * history capacity rows and the first
+         * element index and size of each joint.
+         */
+        Eigen::MatrixXd _historyTimes;
+        Eigen::MatrixXd _historyGoals;
+        std::vector<size_t> _historyBegin;
+        std::vector<size_t> _historySize;
+
+        /**
+         * Current delayed goal
+         * (front of history) of all joints
+         */
+        Eigen::VectorXd _delayedGoals;
+
+        /**
+         * Grow the history capacity
+         * to given size by linearizing
+         * all ring buffers
+         */
+        void growHistory(size_t capacity);
+
+        /**
+         * Compute friction torque of joint at
+         * given index from given velocity and
+         * friction coefficients
+         */
+        double computeFrictionTorque(
+            size_t index, double vel,
+            double viscous, double frictionBreak,
+            double coulomb) const;
+
+        /**
+         * Compute control torque (without backlash
+         * model) of joint at given index
+         */
+        double computeControlTorque(
+            size_t index, double pos, double vel) const;
+};
+
+}
+
+#endif
+
@@ -3,6 +3,7 @@
 #include "Model/Model.hpp"
 #include "Model/RBDLClosedLoop.h"
 #include "Model/RBDLContactLCP.h"
+#include "Model/DynamicsContext.hpp"
 
 namespace Leph {
 
@@ -569,7 +570,8 @@ Eigen::VectorXd Model::forwardDynamicsCustom(
     const Eigen::VectorXd& velocity,
     const Eigen::VectorXd& torque,
     const Eigen::VectorXd& inertiaOffset,
-    RBDLMath::LinearSolver solver)
+    RBDLMath::LinearSolver solver,
+    DynamicsContext* context)
 {
     //Sanity check
     if (position.size() != _model.dof_count) {
@@ -596,21 +598,36 @@ Eigen::VectorXd Model::forwardDynamicsCustom(
     Eigen::VectorXd acceleration = 
         Eigen::VectorXd::Zero(sizeDOF);
 
+    //Use shared dynamics terms and
+    //H decomposition if available
+    if (context != nullptr) {
+        context->setState(position, velocity, inertiaOffset);
+        if (solver == RBDLMath::LinearSolverFullPivHouseholderQR) {
+            return context->decompositionH(_model)
+                .solve(-context->C(_model) + torque);
+        }
+    }
+
     //Compute full H anc C matrix
-    RBDLMath::MatrixNd H = RBDLMath::MatrixNd::Zero(
-        sizeDOF, sizeDOF);
-    RBDLMath::VectorNd C = RBDLMath::VectorNd::Zero(
-        sizeDOF);
-    //Compute C with inverse dynamics
-    acceleration.setZero();
-    RBDL::InverseDynamics(_model, 
-        position, velocity, acceleration, C, NULL);
-    //Compute H
-    RBDL::CompositeRigidBodyAlgorithm(
-        _model, position, H, false);
-    //Add inertial diagonal offsets
-    for (size_t i=0;i<(size_t)inertiaOffset.size();i++) {
-        H(i, i) += inertiaOffset(i);
+    RBDLMath::MatrixNd H;
+    RBDLMath::VectorNd C;
+    if (context != nullptr) {
+        H = context->H(_model);
+        C = context->C(_model);
+    } else {
+        H = RBDLMath::MatrixNd::Zero(sizeDOF, sizeDOF);
+        C = RBDLMath::VectorNd::Zero(sizeDOF);
+        //Compute C with inverse dynamics
+        acceleration.setZero();
+        RBDL::InverseDynamics(_model, 
+            position, velocity, acceleration, C, NULL);
+        //Compute H
+        RBDL::CompositeRigidBodyAlgorithm(
+            _model, position, H, false);
+        //Add inertial diagonal offsets
+        for (size_t i=0;i<(size_t)inertiaOffset.size();i++) {
+            H(i, i) += inertiaOffset(i);
+        }
     }
 
     //Solve the linear system
@@ -674,7 +691,8 @@ Eigen::VectorXd Model::forwardDynamicsContactsCustom(
     const Eigen::VectorXd& velocity,
     const Eigen::VectorXd& torque,
     const Eigen::VectorXd& inertiaOffset,
-    RBDLMath::LinearSolver solver)
+    RBDLMath::LinearSolver solver,
+    DynamicsContext* context)
 {
     //Sanity check
     if (position.size() != _model.dof_count) {
@@ -700,12 +718,20 @@ Eigen::VectorXd Model::forwardDynamicsContactsCustom(
     
     //Compute full H, G matrix and C, gamma 
     //vectors into the constraint set
-    //(actually, torque is not used by RBDL)
-    RBDL::CalcContactSystemVariables(
-        _model, position, velocity, torque, constraints);
-    //Add inertial diagonal offsets
-    for (size_t i=0;i<(size_t)inertiaOffset.size();i++) {
-        constraints.H(i, i) += inertiaOffset(i);
+    if (context != nullptr) {
+        context->setState(position, velocity, inertiaOffset);
+        context->assignH(_model, constraints);
+        context->assignC(_model, constraints);
+        context->assignG(_model, constraints);
+        context->assignGamma(_model, constraints);
+    } else {
+        //(actually, torque is not used by RBDL)
+        RBDL::CalcContactSystemVariables(
+            _model, position, velocity, torque, constraints);
+        //Add inertial diagonal offsets
+        for (size_t i=0;i<(size_t)inertiaOffset.size();i++) {
+            constraints.H(i, i) += inertiaOffset(i);
+        }
     }
 
     //Build matrices Ax = b
@@ -764,7 +790,8 @@ Eigen::VectorXd Model::forwardImpulseDynamicsContactsCustom(
     const Eigen::VectorXd& velocity,
     const Eigen::VectorXd& torque,
     const Eigen::VectorXd& inertiaOffset,
-    RBDLMath::LinearSolver solver)
+    RBDLMath::LinearSolver solver,
+    DynamicsContext* context)
 {
     //Sanity check
     if (position.size() != _model.dof_count) {
@@ -790,36 +817,21 @@ Eigen::VectorXd Model::forwardImpulseDynamicsContactsCustom(
 
     //Compute full H, G matrix and C
     //vectors into the constraint set
-    RBDL::CalcContactSystemVariables(
-        _model, position /*+ dt*velocity TODO XXX ??? usefull*/, 
-        velocity, torque, constraints);
-    //Add inertial diagonal offsets
-    for (size_t i=0;i<(size_t)inertiaOffset.size();i++) {
-        constraints.H(i, i) += inertiaOffset(i);
-    }
-    
-    //XXX TODO --->
-    //Compute H inverse
-    auto HQR = constraints.H.colPivHouseholderQr();
-    if (!HQR.isInvertible()) {
-        throw std::logic_error(
-            "RBDLContactLCP non invertible H matrix");
+    //(gamma is not needed)
+    if (context != nullptr) {
+        context->setState(position, velocity, inertiaOffset);
+        context->assignH(_model, constraints);
+        context->assignC(_model, constraints);
+        context->assignG(_model, constraints);
+    } else {
+        RBDL::CalcContactSystemVariables(
+            _model, position /*+ dt*velocity TODO XXX ??? usefull*/, 
+            velocity, torque, constraints);
+        //Add inertial diagonal offsets
+        for (size_t i=0;i<(size_t)inertiaOffset.size();i++) {
+            constraints.H(i, i) += inertiaOffset(i);
+        }
     }
-    RBDLMath::MatrixNd Hinv = HQR.inverse();
-    //Compute M matrix and d vector
-    Eigen::MatrixXd GG1 = constraints.G;
-    Eigen::VectorXd gg1 = constraints.gamma;
-    Eigen::MatrixXd M1 = GG1 * Hinv * GG1.transpose();
-    Eigen::VectorXd d1 = gg1 - GG1 * Hinv * (torque - constraints.C);
-    Eigen::VectorXd lll1 = M1.llt().solve(d1);
-    /* XXX
-    std::cout << "Solve 0 = M*l + d ---> Solve M*l = -d ###########" << std::endl;
-    std::cout << "LAMBDA MANUAL: " << lll1.transpose() << std::endl;
-    std::cout << "MANUAL gamma: " << gg1.transpose() << std::endl;
-    Eigen::VectorXd Zeta = GG1 * velocity;
-    std::cout << "ZETA: " << Zeta.transpose() << std::endl;
-    */
-    //XXX TODO <---
 
     //Build matrix system
     //|H -dt*Gt| |nextVel| = |dt*(tau - C) + H*oldVel|
@@ -956,7 +968,8 @@ Eigen::VectorXd Model::impulseContactsCustom(
     const Eigen::VectorXd& position,
     const Eigen::VectorXd& velocity,
     const Eigen::VectorXd& inertiaOffset,
-    RBDLMath::LinearSolver solver)
+    RBDLMath::LinearSolver solver,
+    DynamicsContext* context)
 {
     //Sanity check
     if (position.size() != _model.dof_count) {
@@ -977,19 +990,26 @@ Eigen::VectorXd Model::impulseContactsCustom(
     size_t sizeDOF = position.size();
     
     //Compute full H, G matrix into the 
-    //constraint set Compute H
-    RBDL::UpdateKinematicsCustom(
-        _model, &position, NULL, NULL);
-    RBDL::CompositeRigidBodyAlgorithm(
-        _model, position, constraints.H, false);
-    //Add inertial diagonal offsets
-    for (size_t i=0;i<(size_t)inertiaOffset.size();i++) {
-        constraints.H(i, i) += inertiaOffset(i);
+    //constraint set
+    if (context != nullptr) {
+        context->setState(position, velocity, inertiaOffset);
+        context->assignH(_model, constraints);
+        context->assignG(_model, constraints);
+    } else {
+        //Compute H
+        RBDL::UpdateKinematicsCustom(
+            _model, &position, NULL, NULL);
+        RBDL::CompositeRigidBodyAlgorithm(
+            _model, position, constraints.H, false);
+        //Add inertial diagonal offsets
+        for (size_t i=0;i<(size_t)inertiaOffset.size();i++) {
+            constraints.H(i, i) += inertiaOffset(i);
+        }
+        //Compute G
+        RBDL::CalcContactJacobian(
+            _model, position, constraints, 
+            constraints.G, false);
     }
-    //Compute G
-    RBDL::CalcContactJacobian(
-        _model, position, constraints, 
-        constraints.G, false);
 
     //Build matrices Ax = b
     //|H Gt| |newVel | = |H*oldVel|
@@ -1046,7 +1066,10 @@ void Model::resolveContactConstraintLCP(
     const Eigen::VectorXd& position,
     const Eigen::VectorXd& velocity,
     const Eigen::VectorXd& torque,
-    const Eigen::VectorXd& inertiaOffset)
+    const Eigen::VectorXd& inertiaOffset,
+    std::vector<unsigned>* warmBasis,
+    unsigned long* pivots,
+    DynamicsContext* context)
 {
     RBDLContactLCP(
         _model, 
@@ -1055,7 +1078,10 @@ void Model::resolveContactConstraintLCP(
         torque, 
         inertiaOffset, 
         constraints,
-        isBilateralConstraint);
+        isBilateralConstraint,
+        warmBasis,
+        pivots,
+        context);
 }
         
 void Model::boundingBox(size_t frameIndex, 
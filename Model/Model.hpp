@@ -13,6 +13,8 @@ namespace Leph {
 namespace RBDL = RigidBodyDynamics;
 namespace RBDLMath = RigidBodyDynamics::Math;
 
+class DynamicsContext;
+
 /**
  * Model
  *
@@ -304,6 +306,10 @@ class Model
          * internal inertial).
          * Eigen linear solver can be choosen.
          * (Re-implement custom RBDL function).
+         * If context is not null, dynamics terms
+         * (and the decomposition of H for full pivoting
+         * Householder QR solver) are retrieved from
+         * the given context for given state.
          */
         Eigen::VectorXd forwardDynamicsCustom(
             const Eigen::VectorXd& position,
@@ -311,7 +317,8 @@ class Model
             const Eigen::VectorXd& torque,
             const Eigen::VectorXd& inertiaOffset,
             RBDLMath::LinearSolver solver = 
-                RBDLMath::LinearSolverColPivHouseholderQR);
+                RBDLMath::LinearSolverColPivHouseholderQR,
+            DynamicsContext* context = nullptr);
 
         /**
          * Compute Forward Dynamics on the tree model
@@ -341,6 +348,7 @@ class Model
          * internal inertial).
          * Eigen linear solver can be choosen.
          * (Re-implement custom RBDL function).
+         * Optional dynamics terms context.
          */
         Eigen::VectorXd forwardDynamicsContactsCustom(
             RBDL::ConstraintSet& constraints,
@@ -349,7 +357,8 @@ class Model
             const Eigen::VectorXd& torque,
             const Eigen::VectorXd& inertiaOffset,
             RBDLMath::LinearSolver solver = 
-                RBDLMath::LinearSolverColPivHouseholderQR);
+                RBDLMath::LinearSolverColPivHouseholderQR,
+            DynamicsContext* context = nullptr);
 
         /**
          * Compute Forward Dynamics Contact 
@@ -364,6 +373,7 @@ class Model
          * inertia matrix (used to represent joint 
          * internal inertial).
          * Eigen linear solver can be chosen.
+         * Optional dynamics terms context.
          */
         Eigen::VectorXd forwardImpulseDynamicsContactsCustom(
             double dt,
@@ -373,7 +383,8 @@ class Model
             const Eigen::VectorXd& torque,
             const Eigen::VectorXd& inertiaOffset,
             RBDLMath::LinearSolver solver = 
-                RBDLMath::LinearSolverColPivHouseholderQR);
+                RBDLMath::LinearSolverColPivHouseholderQR,
+            DynamicsContext* context = nullptr);
 
         /**
          * Compute Inverse Dynamics taking into account
@@ -418,6 +429,7 @@ class Model
          * internal inertial).
          * Eigen linear solver can be choosen.
          * (Re-implement custom RBDL function).
+         * Optional dynamics terms context.
          */
         Eigen::VectorXd impulseContactsCustom(
             RBDL::ConstraintSet& constraints,
@@ -425,7 +437,8 @@ class Model
             const Eigen::VectorXd& velocity,
             const Eigen::VectorXd& inertiaOffset,
             RBDLMath::LinearSolver solver = 
-                RBDLMath::LinearSolverColPivHouseholderQR);
+                RBDLMath::LinearSolverColPivHouseholderQR,
+            DynamicsContext* context = nullptr);
 
         /**
          * Use RBDLContactLCP which use Drake-Moby
@@ -442,6 +455,9 @@ class Model
          * Computed cartesian contact forces 
          * (zeros and non zeros) are assigned 
          * to ConstraintSet force field.
+         * Optional LCP warm start basis, 
+         * pivots count and dynamics terms
+         * context (see RBDLContactLCP()).
          */
         void resolveContactConstraintLCP(
             RBDL::ConstraintSet& constraints,
@@ -449,7 +465,10 @@ class Model
             const Eigen::VectorXd& position,
             const Eigen::VectorXd& velocity,
             const Eigen::VectorXd& torque,
-            const Eigen::VectorXd& inertiaOffset);
+            const Eigen::VectorXd& inertiaOffset,
+            std::vector<unsigned>* warmBasis = nullptr,
+            unsigned long* pivots = nullptr,
+            DynamicsContext* context = nullptr);
 
         /**
          * Return optionaly non zero aligned axis bounding box
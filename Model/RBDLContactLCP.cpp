@@ -1,6 +1,7 @@
 #include <stdexcept>
 #include <sstream>
 #include "Model/RBDLContactLCP.h"
+#include "Model/DynamicsContext.hpp"
 #include "LCPMobyDrake/LCPSolver.hpp"
 
 namespace RBDL = RigidBodyDynamics;
@@ -15,7 +16,10 @@ void RBDLContactLCP(
     const RBDLMath::VectorNd& Tau,
     const RBDLMath::VectorNd& inertiaOffset,
     RBDL::ConstraintSet& CS,
-    const Eigen::VectorXi& isBilateralConstraint)
+    const Eigen::VectorXi& isBilateralConstraint,
+    std::vector<unsigned>* warmBasis,
+    unsigned long* pivots,
+    DynamicsContext* context)
 {
 
     /* XXX
@@ -37,11 +41,19 @@ void RBDLContactLCP(
     }
 
     //Compute H, C, and G matrixes.
-    RBDL::CalcContactSystemVariables(
-        model, Q, QDot, Tau, CS);
-    //Add inertial diagonal offsets
-    for (size_t i=0;i<(size_t)inertiaOffset.size();i++) {
-        CS.H(i, i) += inertiaOffset(i);
+    if (context != nullptr) {
+        context->setState(Q, QDot, inertiaOffset);
+        context->assignH(model, CS);
+        context->assignC(model, CS);
+        context->assignG(model, CS);
+        context->assignGamma(model, CS);
+    } else {
+        RBDL::CalcContactSystemVariables(
+            model, Q, QDot, Tau, CS);
+        //Add inertial diagonal offsets
+        for (size_t i=0;i<(size_t)inertiaOffset.size();i++) {
+            CS.H(i, i) += inertiaOffset(i);
+        }
     }
 
     //Count unilateral and bilateral constraints
@@ -114,30 +126,10 @@ void RBDLContactLCP(
         */
     }
     
-    //Compute H inverse
-    auto HQR = CS.H.colPivHouseholderQr();
-    if (!HQR.isInvertible()) {
-        /* XXX
-        throw std::logic_error(
-            "RBDLContactLCP non invertible H matrix");
-        */
-    }
-    RBDLMath::MatrixNd Hinv = HQR.inverse();
-
-    //Compute M matrix and d vector 
-    //for unilateral constraints
-    RBDLMath::MatrixNd MUnilateral(sizeUnilateral, sizeUnilateral);
-    RBDLMath::VectorNd dUnilateral(sizeUnilateral);
-    MUnilateral = GUnilateral * Hinv * GUnilateral.transpose();
-    dUnilateral = GUnilateral * Hinv * (Tau - CS.C) - gammaUnilateral;
-    
-    //Compute M matrix and d vector 
-    //for bilateral constraints
-    RBDLMath::MatrixNd MBilateral(sizeBilateral, sizeBilateral);
-    RBDLMath::VectorNd dBilateral(sizeBilateral);
-    MBilateral = GBilateral * Hinv * GBilateral.transpose();
-    dBilateral = GBilateral * Hinv * (Tau - CS.C) - gammaBilateral;
-
+    //The unilateral LCP is expressed on the
+    //dynamics constrained by bilateral constraints.
+    //(The H only formulation M = G*Hinv*Gt and the
+    //velocity level formulation are not computed)
     //XXX TODO XXX TODO TEST2
     Eigen::MatrixXd HHH(sizeDOF+sizeBilateral, sizeDOF+sizeBilateral);
     Eigen::MatrixXd TTT(sizeUnilateral, sizeDOF+sizeBilateral);
@@ -169,81 +161,26 @@ void RBDLContactLCP(
     MMM = TTT*HHHinv*TTT.transpose();
     DDD = TTT*HHHinv*CCC - gammaUnilateral;
     Drake::MobyLCPSolver solverTMP;
+    if (warmBasis != nullptr) {
+        solverTMP.SetWarmStartBasis(*warmBasis);
+    }
     bool isSuccessTMP = solverTMP.
         SolveLcpLemkeRegularized(MMM, DDD, &LLL);
-    (void)isSuccessTMP;
+    if (warmBasis != nullptr) {
+        if (isSuccessTMP) {
+            *warmBasis = solverTMP.GetSolutionBasis();
+        } else {
+            warmBasis->clear();
+        }
+    }
+    if (pivots != nullptr) {
+        *pivots = solverTMP.GetPivots();
+    }
     /* XXX
     std::cout << isSuccessTMP << " ?????? LAMBDA   = " << LLL.transpose() << std::endl;
     std::cout << isSuccessTMP << " ?????? ZETA_DOT = " << (MMM*LLL+DDD).transpose() << std::endl;
     */
     
-    //XXX TODO XXX TODO TEST3
-    Eigen::MatrixXd HHH_(sizeDOF+sizeBilateral, sizeDOF+sizeBilateral);
-    Eigen::MatrixXd TTT_(sizeUnilateral, sizeDOF+sizeBilateral);
-    Eigen::VectorXd CCC_(sizeDOF+sizeBilateral);
-    Eigen::MatrixXd MMM_(sizeUnilateral, sizeUnilateral);
-    Eigen::VectorXd DDD_(sizeUnilateral);
-    Eigen::VectorXd LLL_(sizeUnilateral);
-    HHH_.setZero();
-    TTT_.setZero();
-    CCC_.setZero();
-    MMM_.setZero();
-    DDD_.setZero();
-    LLL_.setZero();
-    HHH_.block(0, 0, sizeDOF, sizeDOF) = CS.H;
-    HHH_.block(sizeDOF, 0, sizeBilateral, sizeDOF) = GBilateral;
-    HHH_.block(0, sizeDOF, sizeDOF, sizeBilateral) = -0.0001*GBilateral.transpose();
-    TTT_.block(0, 0, sizeUnilateral, sizeDOF) = GUnilateral;
-    CCC_.segment(0, sizeDOF) = 0.0001*(Tau - CS.C) + CS.H*QDot;
-    auto HHH_QR = HHH_.colPivHouseholderQr();
-    if (!HHH_QR.isInvertible()) {
-        //XXX std::cout << "NOT HHH_ INVERTIBLE !!!" << std::endl;
-        /* TODO XXX
-        throw std::logic_error(
-            "RBDLContactLCP non invertible HHH matrix");
-        */
-    }
-    Eigen::MatrixXd HHH_inv = HHH_QR.inverse();
-    MMM_ = TTT_*HHH_inv*(0.0001*TTT_.transpose());
-    DDD_ = TTT_*HHH_inv*CCC_;
-    Drake::MobyLCPSolver solverTMP_;
-    bool isSuccessTMP_ = solverTMP_.
-        SolveLcpLemkeRegularized(MMM_, DDD_, &LLL_);
-    (void)isSuccessTMP_;
-    /* XXX
-    std::cout << isSuccessTMP_ << " ###### LAMBDA   = " << LLL_.transpose() << std::endl;
-    std::cout << isSuccessTMP_ << " ###### ZETA     = " << (MMM_*LLL_+DDD_).transpose() << std::endl;
-    */
-    
-    //Compute LCP solution
-    RBDLMath::VectorNd lambda(sizeUnilateral);
-    Drake::MobyLCPSolver solver;
-    bool isSuccess = solver.
-        SolveLcpLemkeRegularized(MUnilateral, dUnilateral, &lambda);
-    if (!isSuccess) {
-        std::ostringstream ss;
-        ss << std::endl;
-        ss << "size:" << sizeUnilateral << std::endl;
-        ss << "success:" << isSuccess << std::endl;
-        ss << "lambda:" << lambda.transpose() << std::endl;
-        ss << "zetaDot:" << (MUnilateral*lambda+dUnilateral).transpose() << std::endl;
-        ss << "zeta:" << (GUnilateral * QDot).transpose() << std::endl;
-        //XXX std::cout << "RBDLContactLCP LCP not success: " + ss.str() << std::endl;
-        /*
-        throw std::logic_error(
-            "RBDLContactLCP LCP not success." 
-            + ss.str());
-        */
-    }
-    /* XXX
-    std::cout << "size:" << sizeUnilateral << std::endl;
-    std::cout << "isBilateralConstraint:" << isBilateralConstraint.transpose() << std::endl;
-    std::cout << "success:" << isSuccess << std::endl;
-    std::cout << "lambda:" << lambda.transpose() << std::endl;
-    std::cout << "zetaDot:" << (MUnilateral*lambda+dUnilateral).transpose() << std::endl;
-    std::cout << "zeta:" << (GUnilateral * QDot).transpose() << std::endl;
-    */
-
     //Assign computed lambda in
     //constraint set
     indexUnilateral = 0;
@@ -251,7 +188,6 @@ void RBDLContactLCP(
     for (size_t i=0;i<(size_t)isBilateralConstraint.size();i++) {
         if (isBilateralConstraint(i) == 0) {
             CS.force(i) = LLL(indexUnilateral);
-            //CS.force(i) = lambda(indexUnilateral);
             indexUnilateral++;
         } else {
             CS.force(i) = 1.0;
@@ -1,11 +1,14 @@
 #ifndef LEPH_RBDLCONTACTLCP_H
 #define LEPH_RBDLCONTACTLCP_H
 
+#include <vector>
 #include <rbdl/rbdl.h>
 #include <Eigen/Dense>
 
 namespace Leph {
 
+class DynamicsContext;
+
 /**
  * Solve the Linear Complimentary 
  * Problem used to compute which contact
@@ -32,6 +35,14 @@ namespace Leph {
  * The computed contact force lambda (with zero
  * and non zero elements) is assigned in force
  * field of constraint set.
+ *
+ * If warmBasis is not null, the Lemke pivoting
+ * starts from the given basis (indexes of non
+ * zero unilateral forces) which is then assigned
+ * with the solution basis. If pivots is not null,
+ * it is assigned with the number of Lemke pivots.
+ * If context is not null, H, C and G are retrieved
+ * from the given dynamics terms context.
  */
 void RBDLContactLCP(
     RigidBodyDynamics::Model& model,
@@ -40,7 +51,10 @@ void RBDLContactLCP(
     const RigidBodyDynamics::Math::VectorNd& Tau,
     const RigidBodyDynamics::Math::VectorNd& inertiaOffset,
     RigidBodyDynamics::ConstraintSet& CS,
-    const Eigen::VectorXi& isBilateralConstraint);
+    const Eigen::VectorXi& isBilateralConstraint,
+    std::vector<unsigned>* warmBasis = nullptr,
+    unsigned long* pivots = nullptr,
+    DynamicsContext* context = nullptr);
 
 }
 
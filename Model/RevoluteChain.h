@@ -0,0 +1,81 @@
+#ifndef LEPH_REVOLUTECHAIN_H
+#define LEPH_REVOLUTECHAIN_H
+
+#include <Eigen/Dense>
+
+namespace Leph {
+
+/**
+ * Fixed size kinematics of a serial chain of
+ * six revolute joints given by their rotation axes
+ * and centers (one column per joint ordered from the
+ * chain base) expressed in a frame fixed with
+ * respect to the chain base.
+ * Used with HumanoidModel::legGeometry()
+ * for analytic legs jacobians.
+ */
+
+/**
+ * Compute the jacobian (angular, linear) of given
+ * point moved by the chain of revolute joints of
+ * given axes and centers (ordered from the chain base)
+ */
+inline Eigen::Matrix<double, 6, 6> RevoluteChainJacobian(
+    const Eigen::Matrix<double, 3, 6>& axes,
+    const Eigen::Matrix<double, 3, 6>& centers,
+    const Eigen::Vector3d& point)
+{
+    Eigen::Matrix<double, 6, 6> jac;
+    for (size_t i=0;i<6;i++) {
+        jac.block<3, 1>(0, i) = axes.col(i);
+        jac.block<3, 1>(3, i) =
+            axes.col(i).cross(point - centers.col(i));
+    }
+    return jac;
+}
+
+/**
+ * Compute the (angular, linear) acceleration of given point
+ * moved by the chain of revolute joints of given axes
+ * and centers (ordered from the chain base) for given
+ * joints velocities and null joints accelerations (dJ*dq)
+ */
+inline Eigen::Matrix<double, 6, 1> RevoluteChainBias(
+    const Eigen::Matrix<double, 3, 6>& axes,
+    const Eigen::Matrix<double, 3, 6>& centers,
+    const Eigen::Vector3d& point,
+    const Eigen::Matrix<double, 6, 1>& vel)
+{
+    //Point linear velocity
+    Eigen::Vector3d pointVel = Eigen::Vector3d::Zero();
+    for (size_t i=0;i<6;i++) {
+        pointVel += vel(i)*axes.col(i).cross(point - centers.col(i));
+    }
+
+    Eigen::Matrix<double, 6, 1> bias = Eigen::Matrix<double, 6, 1>::Zero();
+    //Angular velocity of the current segment
+    Eigen::Vector3d omega = Eigen::Vector3d::Zero();
+    for (size_t i=0;i<6;i++) {
+        //Joint center velocity moved by
+        //previous joints
+        Eigen::Vector3d centerVel = Eigen::Vector3d::Zero();
+        for (size_t j=0;j<i;j++) {
+            centerVel += vel(j)*axes.col(j).cross(
+                centers.col(i) - centers.col(j));
+        }
+        //Joint axis differentiation
+        Eigen::Vector3d axisVel = omega.cross(axes.col(i));
+        bias.segment<3>(0) += vel(i)*axisVel;
+        bias.segment<3>(3) += vel(i)*(
+            axisVel.cross(point - centers.col(i))
+            + axes.col(i).cross(pointVel - centerVel));
+        omega += vel(i)*axes.col(i);
+    }
+
+    return bias;
+}
+
+}
+
+#endif
+
@@ -0,0 +1,227 @@
+#include <stdexcept>
+#include <exception>
+#include <algorithm>
+#include "Model/SimulationEnsemble.hpp"
+
+namespace Leph {
+
+SimulationEnsemble::SimulationEnsemble(
+    RobotType type,
+    size_t size,
+    const Eigen::MatrixXd& inertiaData,
+    const std::map<std::string, size_t>& inertiaName,
+    const Eigen::MatrixXd& geometryData,
+    const std::map<std::string, size_t>& geometryName) :
+    _type(type),
+    _members(),
+    _isFailed(size, 0),
+    _recordCount(0),
+    _positions(),
+    _velocities()
+{
+    //URDF parsing and model building are
+    //done sequentially since their thread
+    //safety is not established
+    _members.resize(size);
+    for (size_t i=0;i<size;i++) {
+        _members[i].reset(new HumanoidSimulation(
+            type, 
+            inertiaData, inertiaName, 
+            geometryData, geometryName));
+    }
+}
+
+size_t SimulationEnsemble::size() const
+{
+    return _members.size();
+}
+
+const HumanoidSimulation& SimulationEnsemble::member(size_t index) const
+{
+    checkIndex(index);
+    return *(_members[index]);
+}
+HumanoidSimulation& SimulationEnsemble::member(size_t index)
+{
+    checkIndex(index);
+    return *(_members[index]);
+}
+
+void SimulationEnsemble::setJointModelParameters(
+    size_t index, const Eigen::VectorXd& params)
+{
+    checkIndex(index);
+    _members[index]->setJointModelParameters(params);
+}
+
+void SimulationEnsemble::setModelData(
+    size_t index,
+    const Eigen::MatrixXd& inertiaData,
+    const std::map<std::string, size_t>& inertiaName,
+    const Eigen::MatrixXd& geometryData,
+    const std::map<std::string, size_t>& geometryName)
+{
+    checkIndex(index);
+    _members[index].reset(new HumanoidSimulation(
+        _type, 
+        inertiaData, inertiaName, 
+        geometryData, geometryName));
+    _isFailed[index] = 0;
+}
+
+void SimulationEnsemble::saveState(
+    std::vector<HumanoidSimulation::State>& states) const
+{
+    states.resize(_members.size());
+    for (size_t i=0;i<_members.size();i++) {
+        _members[i]->saveState(states[i]);
+    }
+}
+void SimulationEnsemble::restoreState(
+    const std::vector<HumanoidSimulation::State>& states)
+{
+    if (states.size() != _members.size()) {
+        throw std::logic_error(
+            "SimulationEnsemble invalid states size");
+    }
+    for (size_t i=0;i<_members.size();i++) {
+        _members[i]->restoreState(states[i]);
+        _isFailed[i] = 0;
+    }
+}
+
+void SimulationEnsemble::run(
+    double dt,
+    size_t steps,
+    const ControlFunc& control,
+    size_t recordPeriod)
+{
+    size_t size = _members.size();
+    //Allocate records
+    if (recordPeriod > 0) {
+        _recordCount = (steps + recordPeriod - 1)/recordPeriod;
+    } else {
+        _recordCount = 0;
+    }
+    if (size > 0) {
+        size_t sizeDOF = _members.front()->positions().size();
+        _positions.resize(sizeDOF, size*_recordCount);
+        _velocities.resize(sizeDOF, size*_recordCount);
+    }
+
+    //Exceptions must not escape OpenMP regions.
+    //The first one is kept and rethrown after.
+    std::exception_ptr error;
+
+    //Without records, each member 
+    //is run at once
+    if (_recordCount == 0) {
+#pragma omp parallel for schedule(dynamic)
+        for (size_t i=0;i<size;i++) {
+            try {
+                if (!_isFailed[i]) {
+                    _isFailed[i] = !step(i, dt, 0, steps, control);
+                }
+            } catch (...) {
+#pragma omp critical(SimulationEnsembleError)
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return;
+    }
+
+    //Lockstep between records
+    for (size_t k=0;k<_recordCount;k++) {
+        size_t firstStep = k*recordPeriod;
+        size_t count = std::min(recordPeriod, steps - firstStep);
+#pragma omp parallel for schedule(dynamic)
+        for (size_t i=0;i<size;i++) {
+            try {
+                if (!_isFailed[i]) {
+                    _isFailed[i] = !step(i, dt, firstStep, count, control);
+                }
+            } catch (...) {
+#pragma omp critical(SimulationEnsembleError)
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            size_t col = i*_recordCount + k;
+            _positions.col(col) = _members[i]->positions();
+            _velocities.col(col) = _members[i]->velocities();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+bool SimulationEnsemble::isFailed(size_t index) const
+{
+    checkIndex(index);
+    return _isFailed[index];
+}
+
+size_t SimulationEnsemble::recordCount() const
+{
+    return _recordCount;
+}
+const Eigen::MatrixXd& SimulationEnsemble::recordedPositions() const
+{
+    return _positions;
+}
+const Eigen::MatrixXd& SimulationEnsemble::recordedVelocities() const
+{
+    return _velocities;
+}
+
+Eigen::MatrixXd::ConstColsBlockXpr SimulationEnsemble::memberPositions(
+    size_t index) const
+{
+    checkIndex(index);
+    return _positions.middleCols(index*_recordCount, _recordCount);
+}
+Eigen::MatrixXd::ConstColsBlockXpr SimulationEnsemble::memberVelocities(
+    size_t index) const
+{
+    checkIndex(index);
+    return _velocities.middleCols(index*_recordCount, _recordCount);
+}
+
+void SimulationEnsemble::checkIndex(size_t index) const
+{
+    if (index >= _members.size()) {
+        throw std::logic_error(
+            "SimulationEnsemble invalid member index");
+    }
+}
+
+bool SimulationEnsemble::step(
+    size_t index, 
+    double dt, 
+    size_t firstStep,
+    size_t count,
+    const ControlFunc& control)
+{
+    HumanoidSimulation& sim = *(_members[index]);
+    try {
+        for (size_t k=firstStep;k<firstStep+count;k++) {
+            if (control) {
+                control(index, k*dt, sim);
+            }
+            sim.update(dt);
+        }
+    } catch (const std::runtime_error& e) {
+        return false;
+    }
+
+    return true;
+}
+
+}
+
@@ -0,0 +1,198 @@
+#ifndef LEPH_SIMULATIONENSEMBLE_HPP
+#define LEPH_SIMULATIONENSEMBLE_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <Eigen/Dense>
+#include "Model/HumanoidSimulation.hpp"
+
+namespace Leph {
+
+/**
+ * SimulationEnsemble
+ *
+ * Set of independent HumanoidSimulation members
+ * of the same robot type advanced in lockstep.
+ * Members are distributed over OpenMP threads with
+ * dynamic scheduling (idle threads take the next
+ * pending member). Each member owns its model and
+ * RBDL workspace so no state is shared between threads.
+ * Members have their own joint parameters and can be
+ * rebuilt with their own inertia and geometry data.
+ * Recorded positions and velocities of all members
+ * are stored in contiguous matrices.
+ * A member whose simulation throws a numerical
+ * instability (std::runtime_error) is marked as failed
+ * and is no longer updated (its last state is recorded).
+ * Any other exception is rethrown by run() once
+ * all threads have left the parallel region.
+ * Members are built sequentially (URDF parsing
+ * is not known to be thread safe).
+ */
+class SimulationEnsemble
+{
+    public:
+
+        /**
+         * Control function called before each member
+         * step with the member index, the member
+         * time since run start and its simulation.
+         * It is called concurrently from several
+         * threads for different members: it must only
+         * modify given member simulation and must
+         * synchronize any other shared access itself.
+         * Calls for a given member are sequential
+         * and in time order.
+         */
+        typedef std::function<void(
+            size_t index,
+            double t,
+            HumanoidSimulation& sim)>
+            ControlFunc;
+
+        /**
+         * Initialization with robot type, the number
+         * of members and optional inertia and geometry 
+         * data shared by all members (see HumanoidSimulation)
+         */
+        SimulationEnsemble(
+            RobotType type,
+            size_t size,
+            const Eigen::MatrixXd& inertiaData = Eigen::MatrixXd(),
+            const std::map<std::string, size_t>& inertiaName = {},
+            const Eigen::MatrixXd& geometryData = Eigen::MatrixXd(),
+            const std::map<std::string, size_t>& geometryName = {});
+
+        /**
+         * Return the number of members
+         */
+        size_t size() const;
+
+        /**
+         * Access to given member simulation
+         */
+        const HumanoidSimulation& member(size_t index) const;
+        HumanoidSimulation& member(size_t index);
+
+        /**
+         * Assign given joints parameters 
+         * to all joint models of given member
+         */
+        void setJointModelParameters(
+            size_t index, const Eigen::VectorXd& params);
+
+        /**
+         * Rebuild given member simulation with given
+         * inertia and geometry data overriding default
+         * model data. The member state and joint 
+         * parameters are reset.
+         */
+        void setModelData(
+            size_t index,
+            const Eigen::MatrixXd& inertiaData,
+            const std::map<std::string, size_t>& inertiaName,
+            const Eigen::MatrixXd& geometryData = Eigen::MatrixXd(),
+            const std::map<std::string, size_t>& geometryName = {});
+
+        /**
+         * Save all members state or restore
+         * them from given states. Failure 
+         * flags are cleared on restore.
+         */
+        void saveState(
+            std::vector<HumanoidSimulation::State>& states) const;
+        void restoreState(
+            const std::vector<HumanoidSimulation::State>& states);
+
+        /**
+         * Run all non failed members over given number
+         * of steps of dt duration. If not null, the control
+         * function is called before each member step.
+         * If recordPeriod is not zero, members state is 
+         * recorded every recordPeriod steps (from the
+         * first step) and members are synchronized
+         * at each record.
+         * The first exception other than a numerical
+         * instability (thrown by a member or by the
+         * control function) is rethrown after the
+         * current parallel section.
+         */
+        void run(
+            double dt,
+            size_t steps,
+            const ControlFunc& control = nullptr,
+            size_t recordPeriod = 0);
+
+        /**
+         * Return true if given member
+         * simulation has failed
+         */
+        bool isFailed(size_t index) const;
+
+        /**
+         * Return the number of records per member
+         * of last run() and the recorded positions and
+         * velocities. Column index*recordCount()+k is the
+         * k-th record of given member.
+         */
+        size_t recordCount() const;
+        const Eigen::MatrixXd& recordedPositions() const;
+        const Eigen::MatrixXd& recordedVelocities() const;
+
+        /**
+         * Return recorded positions and 
+         * velocities of given member
+         */
+        Eigen::MatrixXd::ConstColsBlockXpr memberPositions(
+            size_t index) const;
+        Eigen::MatrixXd::ConstColsBlockXpr memberVelocities(
+            size_t index) const;
+
+    private:
+
+        /**
+         * Robot type
+         */
+        RobotType _type;
+
+        /**
+         * Members simulation and failure flag
+         */
+        std::vector<std::unique_ptr<HumanoidSimulation>> _members;
+        std::vector<char> _isFailed;
+
+        /**
+         * Number of records per member and
+         * contiguous recorded positions and velocities
+         */
+        size_t _recordCount;
+        Eigen::MatrixXd _positions;
+        Eigen::MatrixXd _velocities;
+
+        /**
+         * Throw exception if given 
+         * member index is not valid
+         */
+        void checkIndex(size_t index) const;
+
+        /**
+         * Advance given member by given steps count.
+         * Return false if the simulation failed
+         * (std::runtime_error). Other exceptions
+         * are propagated.
+         */
+        bool step(
+            size_t index, 
+            double dt, 
+            size_t firstStep,
+            size_t count,
+            const ControlFunc& control);
+};
+
+}
+
+#endif
+
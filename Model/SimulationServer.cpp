@@ -0,0 +1,203 @@
+#include <iostream>
+#include <stdexcept>
+#include <chrono>
+#include <algorithm>
+#include "Model/SimulationServer.hpp"
+
+namespace Leph {
+
+SimulationServer::SimulationServer(
+    HumanoidSimulation& simulation,
+    double timeStep,
+    double realTimeFactor,
+    size_t commandsCapacity,
+    size_t statsCapacity) :
+    _simulation(&simulation),
+    _timeStep(timeStep),
+    _realTimeFactor(realTimeFactor),
+    _snapshots(buildSnapshot()),
+    _commands(commandsCapacity, simulation.goals()),
+    _command(simulation.goals()),
+    _thread(),
+    _isRunning(false),
+    _error(),
+    _stepTimes(),
+    _stepCount(0),
+    _deadlineMissCount(0)
+{
+    if (timeStep <= 0.0) {
+        throw std::logic_error(
+            "SimulationServer invalid time step");
+    }
+    if (statsCapacity == 0) {
+        throw std::logic_error(
+            "SimulationServer invalid stats capacity");
+    }
+    _stepTimes.reserve(statsCapacity);
+}
+
+SimulationServer::~SimulationServer()
+{
+    _isRunning.store(false);
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void SimulationServer::start()
+{
+    if (_thread.joinable()) {
+        throw std::logic_error(
+            "SimulationServer already started");
+    }
+    _error.clear();
+    _isRunning.store(true);
+    _thread = std::thread(&SimulationServer::runLoop, this);
+}
+
+void SimulationServer::stop()
+{
+    _isRunning.store(false);
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    if (!_error.empty()) {
+        throw std::runtime_error(
+            "SimulationServer simulation failure: " + _error);
+    }
+}
+
+bool SimulationServer::isRunning() const
+{
+    return _isRunning.load();
+}
+
+bool SimulationServer::pushGoals(const Eigen::VectorXd& goals)
+{
+    if (goals.size() != _command.size()) {
+        throw std::logic_error(
+            "SimulationServer invalid goals size");
+    }
+    return _commands.push(goals);
+}
+
+bool SimulationServer::update()
+{
+    return _snapshots.update();
+}
+const SimulationServer::Snapshot& SimulationServer::snapshot() const
+{
+    return _snapshots.front();
+}
+
+double SimulationServer::stepTimePercentile(double ratio) const
+{
+    checkStopped();
+    if (_stepTimes.size() == 0) {
+        return 0.0;
+    }
+    ratio = std::min(1.0, std::max(0.0, ratio));
+    std::vector<double> times = _stepTimes;
+    size_t index = (size_t)(ratio*(times.size()-1) + 0.5);
+    std::nth_element(times.begin(), times.begin() + index, times.end());
+    return times[index];
+}
+unsigned long SimulationServer::deadlineMissCount() const
+{
+    checkStopped();
+    return _deadlineMissCount;
+}
+
+void SimulationServer::printStats() const
+{
+    checkStopped();
+    std::cout
+        << "Steps=" << _stepCount
+        << " stepTime(ms) median=" << stepTimePercentile(0.5)
+        << " p90=" << stepTimePercentile(0.9)
+        << " p99=" << stepTimePercentile(0.99)
+        << " max=" << stepTimePercentile(1.0)
+        << " deadlineMiss=" << _deadlineMissCount
+        << std::endl;
+}
+
+SimulationServer::Snapshot SimulationServer::buildSnapshot() const
+{
+    Snapshot snapshot;
+    snapshot.time = 0.0;
+    snapshot.stepCount = 0;
+    snapshot.deadlineMissCount = 0;
+    snapshot.stepTime = 0.0;
+    snapshot.positions = _simulation->positions();
+    snapshot.velocities = _simulation->velocities();
+    snapshot.goals = _simulation->goals();
+    snapshot.jointTorques = _simulation->jointTorques();
+    return snapshot;
+}
+
+void SimulationServer::runLoop()
+{
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point timeStart = Clock::now();
+    unsigned long stepStart = _stepCount;
+    while (_isRunning.load()) {
+        //Apply received goal commands
+        while (_commands.pop(_command)) {
+            _simulation->goals() = _command;
+        }
+        //Simulation step
+        Clock::time_point timeBegin = Clock::now();
+        try {
+            _simulation->update(_timeStep);
+        } catch (const std::exception& e) {
+            _error = e.what();
+            _isRunning.store(false);
+            break;
+        }
+        Clock::time_point timeEnd = Clock::now();
+        _stepCount++;
+        double stepTime = std::chrono::duration<double, std::milli>(
+            timeEnd - timeBegin).count();
+        if (_stepTimes.size() < _stepTimes.capacity()) {
+            _stepTimes.push_back(stepTime);
+        } else {
+            _stepTimes[_stepCount % _stepTimes.size()] = stepTime;
+        }
+        //Check the step deadline in paced mode
+        Clock::time_point deadline = timeStart;
+        if (_realTimeFactor > 0.0) {
+            deadline += std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(
+                    (_stepCount - stepStart)*_timeStep/_realTimeFactor));
+            if (timeEnd > deadline) {
+                _deadlineMissCount++;
+            }
+        }
+        //Publish the state
+        Snapshot& snapshot = _snapshots.back();
+        snapshot.time = _stepCount*_timeStep;
+        snapshot.stepCount = _stepCount;
+        snapshot.deadlineMissCount = _deadlineMissCount;
+        snapshot.stepTime = stepTime;
+        snapshot.positions = _simulation->positions();
+        snapshot.velocities = _simulation->velocities();
+        snapshot.goals = _simulation->goals();
+        snapshot.jointTorques = _simulation->jointTorques();
+        _snapshots.publish();
+        //Wait for wall clock
+        if (_realTimeFactor > 0.0) {
+            std::this_thread::sleep_until(deadline);
+        }
+    }
+}
+
+void SimulationServer::checkStopped() const
+{
+    if (_thread.joinable()) {
+        throw std::logic_error(
+            "SimulationServer running");
+    }
+}
+
+}
+
@@ -0,0 +1,188 @@
+#ifndef LEPH_SIMULATIONSERVER_HPP
+#define LEPH_SIMULATIONSERVER_HPP
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <Eigen/Dense>
+#include "Model/HumanoidSimulation.hpp"
+#include "Utils/TripleBuffer.hpp"
+#include "Utils/SPSCQueue.hpp"
+
+namespace Leph {
+
+/**
+ * SimulationServer
+ *
+ * Advance a HumanoidSimulation on a dedicated
+ * thread with a fixed simulation time step, either
+ * as fast as possible or paced to wall clock time.
+ * State snapshots are published after each step
+ * through a lock free triple buffer (for a viewer)
+ * and goal commands (for a controller) are received
+ * through a bounded lock free queue and applied
+ * before the next step.
+ * Step computation times and deadline misses
+ * (steps finished after their wall clock time)
+ * are recorded.
+ * The simulation must not be accessed
+ * by other threads while running.
+ */
+class SimulationServer
+{
+    public:
+
+        /**
+         * Published simulation state
+         * (vectors in simulation DOF order)
+         */
+        struct Snapshot {
+            double time;
+            unsigned long stepCount;
+            unsigned long deadlineMissCount;
+            double stepTime;
+            Eigen::VectorXd positions;
+            Eigen::VectorXd velocities;
+            Eigen::VectorXd goals;
+            Eigen::VectorXd jointTorques;
+        };
+
+        /**
+         * Initialization with the simulation,
+         * the simulation time step in seconds, the
+         * simulated time per wall clock time ratio
+         * (non positive is as fast as possible), the
+         * maximum number of queued goal commands and
+         * the number of recorded step times
+         */
+        SimulationServer(
+            HumanoidSimulation& simulation,
+            double timeStep = 0.001,
+            double realTimeFactor = 1.0,
+            size_t commandsCapacity = 64,
+            size_t statsCapacity = 100000);
+
+        /**
+         * Stop the simulation thread
+         */
+        ~SimulationServer();
+
+        /**
+         * Simulation thread is not copyable
+         */
+        SimulationServer(const SimulationServer&) = delete;
+        SimulationServer& operator=(const SimulationServer&) = delete;
+
+        /**
+         * Start the simulation thread
+         */
+        void start();
+
+        /**
+         * Stop and join the simulation thread.
+         * If the simulation has failed (numerical
+         * instability), std::runtime_error is thrown.
+         */
+        void stop();
+
+        /**
+         * Return true while the simulation
+         * thread is started and has not failed
+         */
+        bool isRunning() const;
+
+        /**
+         * Queue given goal positions (all DOF in
+         * simulation order) to be applied before the
+         * next step. Return false if the queue is full.
+         * To be called from a single thread.
+         */
+        bool pushGoals(const Eigen::VectorXd& goals);
+
+        /**
+         * Retrieve the latest published snapshot.
+         * Return true if it is newer than the one
+         * returned by previous call.
+         * To be called from a single thread.
+         */
+        bool update();
+        const Snapshot& snapshot() const;
+
+        /**
+         * Return the given percentile (between 0 and 1)
+         * of recorded step times in milliseconds and
+         * the number of deadline misses.
+         * Only valid after stop().
+         */
+        double stepTimePercentile(double ratio) const;
+        unsigned long deadlineMissCount() const;
+
+        /**
+         * Display on standard output steps count,
+         * step times percentiles and deadline misses.
+         * Only valid after stop().
+         */
+        void printStats() const;
+
+    private:
+
+        /**
+         * Simulation instance pointer
+         * and configuration
+         */
+        HumanoidSimulation* _simulation;
+        double _timeStep;
+        double _realTimeFactor;
+
+        /**
+         * Published states and
+         * received goal commands
+         */
+        TripleBuffer<Snapshot> _snapshots;
+        SPSCQueue<Eigen::VectorXd> _commands;
+
+        /**
+         * Simulation thread buffer for
+         * goal commands
+         */
+        Eigen::VectorXd _command;
+
+        /**
+         * Simulation thread, its running
+         * flag and failure message
+         */
+        std::thread _thread;
+        std::atomic<bool> _isRunning;
+        std::string _error;
+
+        /**
+         * Recorded step times (ring buffer)
+         * in milliseconds, steps and
+         * deadline misses count
+         */
+        std::vector<double> _stepTimes;
+        unsigned long _stepCount;
+        unsigned long _deadlineMissCount;
+
+        /**
+         * Build a snapshot of current
+         * simulation state
+         */
+        Snapshot buildSnapshot() const;
+
+        /**
+         * Simulation thread main loop
+         */
+        void runLoop();
+
+        /**
+         * Throw if the thread is not joined
+         */
+        void checkStopped() const;
+};
+
+}
+
+#endif
+
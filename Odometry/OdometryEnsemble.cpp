@@ -0,0 +1,440 @@
+#include <cmath>
+#include <string>
+#include <stdexcept>
+#include "Odometry/OdometryEnsemble.hpp"
+#include "Utils/Angle.h"
+
+namespace Leph {
+
+/**
+ * Return the full linear displacement
+ * coefficients equivalent to given
+ * displacement model
+ */
+static Eigen::VectorXd displacementCoefficients(
+    const OdometryDisplacementModel& model)
+{
+    const Eigen::VectorXd& p = model.getParameters();
+    //Identity by default on all components
+    Eigen::VectorXd coefs = Eigen::VectorXd::Zero(12);
+    coefs(1) = 1.0;
+    coefs(6) = 1.0;
+    coefs(11) = 1.0;
+    switch (model.getType()) {
+        case OdometryDisplacementModel::DisplacementIdentity:
+            break;
+        case OdometryDisplacementModel::DisplacementProportionalXY:
+            coefs(1) = p(0);
+            coefs(6) = p(1);
+            break;
+        case OdometryDisplacementModel::DisplacementProportionalXYA:
+            coefs(1) = p(0);
+            coefs(6) = p(1);
+            coefs(11) = p(2);
+            break;
+        case OdometryDisplacementModel::DisplacementLinearSimpleXY:
+            coefs(0) = p(0);
+            coefs(1) = p(1);
+            coefs(4) = p(2);
+            coefs(6) = p(3);
+            break;
+        case OdometryDisplacementModel::DisplacementLinearSimpleXYA:
+            coefs(0) = p(0);
+            coefs(1) = p(1);
+            coefs(4) = p(2);
+            coefs(6) = p(3);
+            coefs(8) = p(4);
+            coefs(11) = p(5);
+            break;
+        case OdometryDisplacementModel::DisplacementLinearFullXY:
+            coefs.segment(0, 8) = p;
+            break;
+        case OdometryDisplacementModel::DisplacementLinearFullXYA:
+            coefs = p;
+            break;
+        default:
+            throw std::logic_error(
+                "OdometryEnsemble invalid displacement type");
+    }
+
+    return coefs;
+}
+
+/**
+ * Return the noise coefficients
+ * columns used by given noise type
+ */
+static std::vector<size_t> noiseColumns(
+    OdometryNoiseModel::Type type)
+{
+    switch (type) {
+        case OdometryNoiseModel::NoiseDisable:
+            return {};
+        case OdometryNoiseModel::NoiseConstant:
+            return {0, 4, 8};
+        case OdometryNoiseModel::NoiseProportional:
+            return {1, 6, 11};
+        case OdometryNoiseModel::NoiseLinearSimple:
+            return {0, 1, 4, 6, 8, 11};
+        case OdometryNoiseModel::NoiseLinearFull:
+            return {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+        default:
+            throw std::logic_error(
+                "OdometryEnsemble invalid noise type");
+    }
+}
+
+/**
+ * Return the full linear noise standard
+ * deviations equivalent to given noise model
+ */
+static Eigen::VectorXd noiseCoefficients(
+    const OdometryNoiseModel& model)
+{
+    const Eigen::VectorXd& p = model.getParameters();
+    std::vector<size_t> columns = noiseColumns(model.getType());
+    Eigen::VectorXd coefs = Eigen::VectorXd::Zero(12);
+    for (size_t i=0;i<columns.size();i++) {
+        coefs(columns[i]) = p(i);
+    }
+
+    return coefs;
+}
+
+/**
+ * SplitMix64 finalizer used as
+ * counter based random generator
+ */
+static inline uint64_t hashMix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Assign two single precision uniform values
+ * in ]0:1[ uniquely defined by given key
+ * and counter
+ */
+static inline void hashUniforms(
+    uint64_t key, uint64_t counter,
+    float& u1, float& u2)
+{
+    uint64_t h = hashMix(key ^ counter);
+    u1 = ((float)(h >> 40) + 0.5f)*(1.0f/16777216.0f);
+    u2 = ((float)(h & 0xFFFFFFULL) + 0.5f)*(1.0f/16777216.0f);
+}
+
+OdometryEnsemble::OdometryEnsemble(
+    size_t size,
+    OdometryDisplacementModel::Type typeDisplacement,
+    OdometryNoiseModel::Type typeNoise,
+    uint64_t seed) :
+    _typeDisplacement(typeDisplacement),
+    _typeNoise(typeNoise),
+    _displacement(size, 12),
+    _noise(size, 12),
+    _noiseColumns(noiseColumns(typeNoise)),
+    _keys(size),
+    _counter(0),
+    _isInitialized(false),
+    _support(),
+    _last(),
+    _stateX(size),
+    _stateY(size),
+    _stateTheta(size),
+    _correctedX(size),
+    _correctedY(size),
+    _correctedTheta(size),
+    _diffX(size),
+    _diffY(size),
+    _diffTheta(size),
+    _noiseX(size),
+    _noiseY(size),
+    _noiseTheta(size),
+    _normal(size),
+    _uniform1(size),
+    _uniform2(size),
+    _cos(size),
+    _sin(size)
+{
+    if (size == 0) {
+        throw std::logic_error(
+            "OdometryEnsemble empty ensemble");
+    }
+    //Default models parameters
+    OdometryDisplacementModel modelDisplacement(_typeDisplacement);
+    OdometryNoiseModel modelNoise(_typeNoise);
+    _displacement = displacementCoefficients(modelDisplacement)
+        .transpose().array().replicate(size, 1);
+    _noise = noiseCoefficients(modelNoise)
+        .transpose().array().replicate(size, 1);
+    //Particles generator keys
+    setSeed(seed);
+    //Ask reset
+    reset();
+}
+
+size_t OdometryEnsemble::size() const
+{
+    return _stateX.size();
+}
+
+double OdometryEnsemble::setParameters(
+    size_t index, const Eigen::VectorXd& params)
+{
+    checkIndex(index);
+    return assignParameters(index, index+1, params);
+}
+double OdometryEnsemble::setParameters(
+    const Eigen::VectorXd& params)
+{
+    return assignParameters(0, size(), params);
+}
+
+void OdometryEnsemble::setSeed(uint64_t seed)
+{
+    for (size_t i=0;i<_keys.size();i++) {
+        _keys[i] = hashMix(seed + 0x9E3779B97F4A7C15ULL*(i+1));
+    }
+    _counter = 0;
+}
+
+void OdometryEnsemble::reset()
+{
+    reset(Eigen::Vector3d(0.0, 0.0, 0.0));
+}
+void OdometryEnsemble::reset(const Eigen::Vector3d& pose)
+{
+    _isInitialized = false;
+    _stateX.setConstant(pose.x());
+    _stateY.setConstant(pose.y());
+    _stateTheta.setConstant(pose.z());
+    _correctedX = _stateX;
+    _correctedY = _stateY;
+    _correctedTheta = _stateTheta;
+}
+
+void OdometryEnsemble::update(
+    const Eigen::Vector3d& pose,
+    HumanoidFixedModel::SupportFoot supportFoot,
+    bool isNoise)
+{
+    if (!_isInitialized) {
+        _support = supportFoot;
+        _last = pose;
+        _isInitialized = true;
+    }
+
+    HumanoidFixedModel::SupportFoot lastSupport = _support;
+    _support = supportFoot;
+
+    //Input displacement between current state
+    //and last support swap (see Odometry::odometryDiff())
+    double vectX = pose.x() - _last.x();
+    double vectY = pose.y() - _last.y();
+    double angle = AngleDistance(_last.z(), pose.z());
+    Eigen::Vector3d diff(
+        vectX*cos(-_last.z()) - vectY*sin(-_last.z()),
+        vectX*sin(-_last.z()) + vectY*cos(-_last.z()),
+        angle);
+
+    //Update corrected odometry at support swap
+    if (
+        lastSupport == HumanoidFixedModel::RightSupportFoot &&
+        _support == HumanoidFixedModel::LeftSupportFoot
+    ) {
+        computeDisplacement(diff, isNoise);
+        integrate(_stateX, _stateY, _stateTheta);
+        _last = pose;
+        _correctedX = _stateX;
+        _correctedY = _stateY;
+        _correctedTheta = _stateTheta;
+    } else {
+        computeDisplacement(diff, false);
+        _correctedX = _stateX;
+        _correctedY = _stateY;
+        _correctedTheta = _stateTheta;
+        integrate(_correctedX, _correctedY, _correctedTheta);
+    }
+}
+
+void OdometryEnsemble::updateFullStep(
+    const Eigen::Vector3d& deltaPose,
+    bool isNoise)
+{
+    if (!_isInitialized) {
+        _support = HumanoidFixedModel::LeftSupportFoot;
+        _isInitialized = true;
+    }
+
+    computeDisplacement(deltaPose, isNoise);
+    integrate(_stateX, _stateY, _stateTheta);
+    _correctedX = _stateX;
+    _correctedY = _stateY;
+    _correctedTheta = _stateTheta;
+}
+
+Eigen::Vector3d OdometryEnsemble::state(size_t index) const
+{
+    checkIndex(index);
+    return Eigen::Vector3d(
+        _correctedX(index),
+        _correctedY(index),
+        _correctedTheta(index));
+}
+
+const Eigen::ArrayXd& OdometryEnsemble::statesX() const
+{
+    return _correctedX;
+}
+const Eigen::ArrayXd& OdometryEnsemble::statesY() const
+{
+    return _correctedY;
+}
+const Eigen::ArrayXd& OdometryEnsemble::statesTheta() const
+{
+    return _correctedTheta;
+}
+
+void OdometryEnsemble::checkIndex(size_t index) const
+{
+    if (index >= size()) {
+        throw std::logic_error(
+            "OdometryEnsemble invalid particle index: "
+            + std::to_string(index));
+    }
+}
+
+double OdometryEnsemble::assignParameters(
+    size_t indexBegin, size_t indexEnd,
+    const Eigen::VectorXd& params)
+{
+    OdometryDisplacementModel modelDisplacement(_typeDisplacement);
+    OdometryNoiseModel modelNoise(_typeNoise);
+    size_t sizeDisplacement =
+        modelDisplacement.getParameters().size();
+    size_t sizeNoise =
+        modelNoise.getParameters().size();
+
+    if (
+        (size_t)params.size() !=
+        sizeDisplacement+sizeNoise
+    ) {
+        throw std::logic_error(
+            "OdometryEnsemble invalid parameters size: "
+            + std::to_string(sizeDisplacement)
+            + std::string("+")
+            + std::to_string(sizeNoise)
+            + std::string("!=")
+            + std::to_string(params.size()));
+    }
+
+    double error = 0.0;
+    size_t count = indexEnd - indexBegin;
+    if (sizeDisplacement > 0) {
+        double errorDisplacement = modelDisplacement.setParameters(
+            params.segment(0, sizeDisplacement));
+        if (errorDisplacement == 0.0) {
+            _displacement.middleRows(indexBegin, count) =
+                displacementCoefficients(modelDisplacement)
+                .transpose().array().replicate(count, 1);
+        }
+        error += errorDisplacement;
+    }
+    if (sizeNoise > 0) {
+        double errorNoise = modelNoise.setParameters(
+            params.segment(sizeDisplacement, sizeNoise));
+        if (errorNoise == 0.0) {
+            _noise.middleRows(indexBegin, count) =
+                noiseCoefficients(modelNoise)
+                .transpose().array().replicate(count, 1);
+        }
+        error += errorNoise;
+    }
+
+    return error;
+}
+
+void OdometryEnsemble::computeDisplacement(
+    const Eigen::Vector3d& diff, bool isNoise)
+{
+    //Displacement correction with the same
+    //operations order as OdometryDisplacementModel
+    _diffX = _displacement.col(0)
+        + _displacement.col(1)*diff.x()
+        + _displacement.col(2)*diff.y()
+        + _displacement.col(3)*diff.z();
+    _diffY = _displacement.col(4)
+        + _displacement.col(5)*diff.x()
+        + _displacement.col(6)*diff.y()
+        + _displacement.col(7)*diff.z();
+    _diffTheta = _displacement.col(8)
+        + _displacement.col(9)*diff.x()
+        + _displacement.col(10)*diff.y()
+        + _displacement.col(11)*diff.z();
+
+    if (!isNoise || _noiseColumns.size() == 0) {
+        return;
+    }
+
+    //Noise generation from corrected displacement.
+    //Each particle and coefficient has its own
+    //draw at each noisy update.
+    _noiseX.setZero();
+    _noiseY.setZero();
+    _noiseTheta.setZero();
+    size_t size = this->size();
+    for (size_t k : _noiseColumns) {
+        uint64_t counter = hashMix(12*_counter + k);
+        for (size_t i=0;i<size;i++) {
+            hashUniforms(_keys[i], counter, _uniform1(i), _uniform2(i));
+        }
+        //Box-Muller transform in single precision
+        //for vectorized logarithm and cosinus
+        //(first buffer is reused for the result)
+        _uniform1 = (-2.0f*_uniform1.log()).sqrt()
+            *((float)(2.0*M_PI)*_uniform2).cos();
+        _normal = _uniform1.cast<double>();
+        Eigen::ArrayXd& noise =
+            (k < 4) ? _noiseX : ((k < 8) ? _noiseY : _noiseTheta);
+        switch (k % 4) {
+            case 0:
+                noise += _noise.col(k)*_normal;
+                break;
+            case 1:
+                noise += _noise.col(k)*_normal*_diffX;
+                break;
+            case 2:
+                noise += _noise.col(k)*_normal*_diffY;
+                break;
+            default:
+                noise += _noise.col(k)*_normal*_diffTheta;
+                break;
+        }
+    }
+    _diffX += _noiseX;
+    _diffY += _noiseY;
+    _diffTheta += _noiseTheta;
+    _counter++;
+}
+
+void OdometryEnsemble::integrate(
+    Eigen::ArrayXd& x,
+    Eigen::ArrayXd& y,
+    Eigen::ArrayXd& theta)
+{
+    //Rotation to world frame and
+    //integration (see Odometry::odometryInt())
+    _cos = theta.cos();
+    _sin = theta.sin();
+    x += _diffX*_cos - _diffY*_sin;
+    y += _diffX*_sin + _diffY*_cos;
+    theta += _diffTheta;
+    //Shrink to -PI,PI
+    theta -= 2.0*M_PI*((theta + M_PI)/(2.0*M_PI)).floor();
+}
+
+}
+
@@ -0,0 +1,237 @@
+#ifndef LEPH_ODOMETRYENSEMBLE_HPP
+#define LEPH_ODOMETRYENSEMBLE_HPP
+
+#include <vector>
+#include <cstdint>
+#include <Eigen/Dense>
+#include "Model/HumanoidFixedModel.hpp"
+#include "Odometry/OdometryDisplacementModel.hpp"
+#include "Odometry/OdometryNoiseModel.hpp"
+
+namespace Leph {
+
+/**
+ * OdometryEnsemble
+ *
+ * Set of odometry particles sharing the same
+ * input motion and model types but having their
+ * own displacement and noise parameters and
+ * integrated pose. Behaves as a set of
+ * independent Odometry instances.
+ * Particles data are stored in contiguous arrays
+ * (one array per pose component or parameter)
+ * and updated all at once. All displacement
+ * (resp. noise) model types are expressed as the
+ * full linear model with unused coefficients
+ * set to zero.
+ * Noise is drawn from a counter based generator
+ * (hashed particle key and counter, single precision
+ * Box-Muller transform): the values depend only on
+ * the seed, the particle index and the number of
+ * noisy updates, not on the number of particles.
+ * They differ from Odometry draws with
+ * std::default_random_engine.
+ */
+class OdometryEnsemble
+{
+    public:
+
+        /**
+         * Initialization with the number of
+         * particles, displacement and noise model
+         * types and the noise generator seed.
+         * Particles parameters are
+         * models default parameters.
+         */
+        OdometryEnsemble(
+            size_t size,
+            OdometryDisplacementModel::Type typeDisplacement,
+            OdometryNoiseModel::Type typeNoise
+                = OdometryNoiseModel::NoiseDisable,
+            uint64_t seed = 0);
+
+        /**
+         * Return the number of particles
+         */
+        size_t size() const;
+
+        /**
+         * Assign given displacement and noise model
+         * parameters (see Odometry::setParameters())
+         * to given particle or to all particles.
+         * If given parameters does not comply with
+         * bounds, parameters are not assigned
+         * and a positive distance is returned.
+         * Throw std::logic_error if the size
+         * does not match the models types.
+         */
+        double setParameters(
+            size_t index, const Eigen::VectorXd& params);
+        double setParameters(
+            const Eigen::VectorXd& params);
+
+        /**
+         * Assign the noise generator seed
+         * and reset its counter
+         */
+        void setSeed(uint64_t seed);
+
+        /**
+         * Reset all particles to zero or given
+         * pose and mark internal data to be
+         * re initialized
+         */
+        void reset();
+        void reset(const Eigen::Vector3d& pose);
+
+        /**
+         * Update all particles with given input
+         * pose state and support foot (see
+         * Odometry::update()). If isNoise is true,
+         * the noise model is applied.
+         */
+        void update(
+            const Eigen::Vector3d& pose,
+            HumanoidFixedModel::SupportFoot supportFoot,
+            bool isNoise);
+
+        /**
+         * Update all particles pose state by
+         * integrating given relative displacement
+         * between two right to left support foot
+         * transition (see Odometry::updateFullStep())
+         */
+        void updateFullStep(
+            const Eigen::Vector3d& deltaPose,
+            bool isNoise);
+
+        /**
+         * Return the corrected odometry state
+         * [x,y,theta] of given particle
+         */
+        Eigen::Vector3d state(size_t index) const;
+
+        /**
+         * Return the corrected odometry
+         * state components of all particles
+         */
+        const Eigen::ArrayXd& statesX() const;
+        const Eigen::ArrayXd& statesY() const;
+        const Eigen::ArrayXd& statesTheta() const;
+
+    private:
+
+        /**
+         * Models types
+         */
+        OdometryDisplacementModel::Type _typeDisplacement;
+        OdometryNoiseModel::Type _typeNoise;
+
+        /**
+         * Full linear displacement coefficients
+         * and noise standard deviations for each
+         * particle. Column 4*i+j is the coefficient
+         * of output component i (dX, dY, dA) on input
+         * j (constant, dx, dy, da).
+         */
+        Eigen::ArrayXXd _displacement;
+        Eigen::ArrayXXd _noise;
+
+        /**
+         * Noise coefficients columns used
+         * by the noise model type
+         */
+        std::vector<size_t> _noiseColumns;
+
+        /**
+         * Noise generator key of each
+         * particle (derived from the seed)
+         * and noisy updates counter
+         */
+        std::vector<uint64_t> _keys;
+        uint64_t _counter;
+
+        /**
+         * If false, the next update() will
+         * initialize internal data with
+         * input state
+         */
+        bool _isInitialized;
+
+        /**
+         * Last seen support foot
+         * and input pose at last right
+         * to left support foot swap
+         */
+        HumanoidFixedModel::SupportFoot _support;
+        Eigen::Vector3d _last;
+
+        /**
+         * Particles pose at last support
+         * foot swap and integrated at
+         * each update
+         */
+        Eigen::ArrayXd _stateX;
+        Eigen::ArrayXd _stateY;
+        Eigen::ArrayXd _stateTheta;
+        Eigen::ArrayXd _correctedX;
+        Eigen::ArrayXd _correctedY;
+        Eigen::ArrayXd _correctedTheta;
+
+        /**
+         * Particles corrected displacement,
+         * noise, random draws and heading
+         * cosinus and sinus buffers
+         */
+        Eigen::ArrayXd _diffX;
+        Eigen::ArrayXd _diffY;
+        Eigen::ArrayXd _diffTheta;
+        Eigen::ArrayXd _noiseX;
+        Eigen::ArrayXd _noiseY;
+        Eigen::ArrayXd _noiseTheta;
+        Eigen::ArrayXd _normal;
+        Eigen::ArrayXf _uniform1;
+        Eigen::ArrayXf _uniform2;
+        Eigen::ArrayXd _cos;
+        Eigen::ArrayXd _sin;
+
+        /**
+         * Throw exception if given
+         * particle index is not valid
+         */
+        void checkIndex(size_t index) const;
+
+        /**
+         * Assign given parameters to the coefficients
+         * of particles from indexBegin to indexEnd
+         * (excluded). Return the bounds distance.
+         * As in Odometry, each model coefficients are
+         * only assigned if its parameters are valid.
+         */
+        double assignParameters(
+            size_t indexBegin, size_t indexEnd,
+            const Eigen::VectorXd& params);
+
+        /**
+         * Compute in diff buffers the corrected
+         * displacement of all particles from given
+         * input displacement and add the noise
+         * if isNoise is true
+         */
+        void computeDisplacement(
+            const Eigen::Vector3d& diff, bool isNoise);
+
+        /**
+         * Integrate diff buffers into given
+         * pose arrays of all particles
+         */
+        void integrate(
+            Eigen::ArrayXd& x,
+            Eigen::ArrayXd& y,
+            Eigen::ArrayXd& theta);
+};
+
+}
+
+#endif
+
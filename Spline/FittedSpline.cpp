@@ -1,11 +1,13 @@
 #include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <Eigen/SparseCore>
+#include <Eigen/SparseCholesky>
 #include <libcmaes/cmaes.h>
 #include "Spline/FittedSpline.hpp"
 #include "Spline/PolyFit.hpp"
 #include "Spline/CubicSpline.hpp"
 #include "Spline/SmoothSpline.hpp"
-#include "LinearRegression/SimpleLinearRegression.hpp"
-#include "Utils/NewtonBinomial.hpp"
 
 namespace Leph {
 
@@ -60,35 +62,76 @@ bool FittedSpline::fittingPieces(double maxError, bool throwError)
     bool isFitSuccessful = true;
 
     //Compute linear regression for each parts
-    //to find best polynomial fit
+    //to find best polynomial fit.
+    //The normal equations of polynomial least square
+    //only depend on the moments sum(t^k) and sum(t^k.y)
+    //(Hankel structure). They are accumulated point by point
+    //and only extended when the degree is increased 
+    //instead of refitting the whole regression.
     for (size_t i=0;i<parts.size();i++) {
+        size_t indexBegin = parts[i].first;
+        size_t indexEnd = parts[i].second;
+        size_t length = indexEnd - indexBegin + 1;
+        double timeBegin = _points[indexBegin].first;
+        //Current power t^k of each point and
+        //accumulated moments
+        std::vector<double> powers(length, 1.0);
+        std::vector<double> sumT;
+        std::vector<double> sumTY;
         //Try to fit with polynom of increasing degree
         unsigned int degree = 1;
         //Best fit found for unsuccessful fit
         double bestError = 0;
         unsigned int bestDegree = 0;
-        Vector bestParams;
         while (true) {
-            //Polynomial simple linear regression
-            PolyFit fit(degree);
-            for (size_t j=parts[i].first;j<=parts[i].second;j++) {
-                fit.add(
-                    _points[j].first - _points[parts[i].first].first, 
-                    _points[j].second);
+            //Extend the moments up to 2*degree
+            while (sumT.size() < 2*degree+1) {
+                double sumPow = 0.0;
+                double sumPowY = 0.0;
+                for (size_t j=0;j<length;j++) {
+                    if (sumT.size() > 0) {
+                        powers[j] *= 
+                            _points[indexBegin+j].first - timeBegin;
+                    }
+                    sumPow += powers[j];
+                    sumPowY += powers[j]*_points[indexBegin+j].second;
+                }
+                sumT.push_back(sumPow);
+                sumTY.push_back(sumPowY);
+            }
+            //Polynomial linear regression 
+            //from the normal equations
+            Eigen::MatrixXd XtX(degree+1, degree+1);
+            Eigen::VectorXd XtY(degree+1);
+            for (size_t k=0;k<degree+1;k++) {
+                for (size_t l=0;l<degree+1;l++) {
+                    XtX(k, l) = sumT[k+l];
+                }
+                XtY(k) = sumTY[k];
+            }
+            Eigen::VectorXd params = XtX.llt().solve(XtY);
+            Polynom polynom(degree);
+            for (size_t k=0;k<degree+1;k++) {
+                polynom(k) = params(k);
             }
-            Polynom polynom = fit.fitting();
             //Compute max fitting error
-            double error = fit.regression().maxError();
+            double error = 0.0;
+            for (size_t j=indexBegin;j<=indexEnd;j++) {
+                double residual = fabs(_points[j].second 
+                    - polynom.pos(_points[j].first - timeBegin));
+                if (residual > error) {
+                    error = residual;
+                }
+            }
             //Store best fit
             if (bestDegree == 0 || bestError > error) {
                 bestDegree = degree;
                 bestError = error;
-                bestParams = fit.regression().parameters();
             }
             //Iterations are stopped if error threshold is meet
             //or degree is too high for data points available
             if (
-                degree >= parts[i].second-parts[i].first || 
+                degree >= indexEnd-indexBegin || 
                 bestError <= maxError
             ) {
                 //If the fit is non successful, we can throw
@@ -103,8 +146,8 @@ bool FittedSpline::fittingPieces(double maxError, bool throwError)
                 //Save computed fitting polynom to Splines container
                 Spline::_splines.push_back({
                     polynom, 
-                    _points[parts[i].first].first,
-                    _points[parts[i].second].first});
+                    _points[indexBegin].first,
+                    _points[indexEnd].first});
                 //Go to next spline part
                 break;
             } else {
@@ -129,78 +172,112 @@ void FittedSpline::fittingGlobal(
     //Sort data
     prepareData();
 
-    //Choose spline knots uniformally
+    //Choose spline knots uniformally.
+    //Knots have to be strictly increasing and
+    //strictly inside data abscisse range
+    double timeBegin = _points.front().first;
+    double timeEnd = _points.back().first;
     std::vector<double> knots;
     for (size_t i=1;i<_points.size()-sequenceLength/2;i++) {
         if (i%sequenceLength == 0) {
-            knots.push_back(_points[i].first);
+            double t = _points[i].first;
+            if (
+                t > timeBegin && t < timeEnd &&
+                (knots.size() == 0 || t > knots.back())
+            ) {
+                knots.push_back(t);
+            }
         }
     }
 
-    //Prepare smooth spline linear regression with position
-    //and derivatives continuity
-    //Data are: 1, x, x^2, ..., x^d, (x-knot1)^d, (x-knot2)^d, ...
-    SimpleLinearRegression regression;
+    //The spline with position and derivatives continuity
+    //is expressed in the B-spline basis of given degree.
+    //It spans the same space than the truncated power basis
+    //1, x, x^2, ..., x^d, (x-knot1)^d, (x-knot2)^d, ...
+    //but each point only excites degree+1 basis functions
+    //so that the normal equations are banded.
+    //Build B-spline knot vector with clamped ends
+    std::vector<double> knotVector;
+    for (size_t k=0;k<degree+1;k++) {
+        knotVector.push_back(timeBegin);
+    }
+    for (size_t k=0;k<knots.size();k++) {
+        knotVector.push_back(knots[k]);
+    }
+    for (size_t k=0;k<degree+1;k++) {
+        knotVector.push_back(timeEnd);
+    }
+    size_t sizeBasis = knots.size() + degree + 1;
+
+    //Assemble the banded normal equations
+    std::vector<Eigen::Triplet<double>> triplets;
+    triplets.reserve(_points.size()*(degree+1)*(degree+1));
+    Eigen::VectorXd XtY = Eigen::VectorXd::Zero(sizeBasis);
+    std::vector<double> basis;
+    size_t span = degree;
     for (size_t i=0;i<_points.size();i++) {
-        Eigen::VectorXd inputs(degree + 1 + knots.size());
-        double expT = 1.0;
-        for (size_t k=0;k<degree+1;k++) {
-            inputs(k) = expT;
-            expT *= _points[i].first - _points.front().first;
+        double t = _points[i].first;
+        //Points are sorted, find the knot span forward
+        while (span < sizeBasis-1 && t >= knotVector[span+1]) {
+            span++;
         }
-        for (size_t k=0;k<knots.size();k++) {
-            if (_points[i].first < knots[k]) {
-                inputs(degree+1+k) = 0.0;
-            } else {
-                inputs(degree+1+k) = 
-                    pow(_points[i].first - knots[k], degree);
+        bsplineBasis(knotVector, degree, span, t, basis);
+        for (size_t k=0;k<degree+1;k++) {
+            size_t indexK = span - degree + k;
+            for (size_t l=0;l<degree+1;l++) {
+                size_t indexL = span - degree + l;
+                triplets.push_back(Eigen::Triplet<double>(
+                    indexK, indexL, basis[k]*basis[l]));
             }
+            XtY(indexK) += basis[k]*_points[i].second;
         }
-        regression.add(inputs, _points[i].second);
     }
-
-    //Run regression
-    regression.regression();
-
-    //Add first spline part
-    Polynom polynomFirst(degree);
-    for (size_t i=0;i<degree+1;i++) {
-        polynomFirst(i) += regression.parameters()(i);
+    Eigen::SparseMatrix<double> XtX(sizeBasis, sizeBasis);
+    XtX.setFromTriplets(triplets.begin(), triplets.end());
+
+    //Run sparse regression
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver;
+    solver.compute(XtX);
+    if (solver.info() != Eigen::Success) {
+        throw std::runtime_error(
+            "FittedSpline global fitting decomposition failed");
     }
-    //Add the spline to the container
-    double boundMinFirst = _points.front().first;
-    double boundMaxFirst;
-    if (knots.size() > 0) {
-        boundMaxFirst = knots.front();
-    } else {
-        boundMaxFirst = _points.back().first;
-    }
-    Spline::_splines.push_back({
-        polynomFirst, boundMinFirst, boundMaxFirst});
-    //Add all remaining spline parts beginning by on a knot
-    for (size_t k=0;k<knots.size();k++) {
-        Polynom polynom(degree);
+    Eigen::VectorXd coefs = solver.solve(XtY);
+
+    //Convert each knot interval into a polynom.
+    //The B-spline is evaluated at degree+1 points on
+    //the interval and the polynom is interpolated 
+    //using normalized abscisse
+    for (size_t k=0;k<knots.size()+1;k++) {
+        double boundMin = knotVector[degree+k];
+        double boundMax = knotVector[degree+k+1];
+        double length = boundMax - boundMin;
+        Eigen::MatrixXd vandermonde(degree+1, degree+1);
+        Eigen::VectorXd values(degree+1);
         for (size_t i=0;i<degree+1;i++) {
-            polynom(i) += regression.parameters()(i);
+            double ratio = (degree == 0) ? 
+                0.0 : (double)i/(double)degree;
+            bsplineBasis(knotVector, degree, degree+k, 
+                boundMin + ratio*length, basis);
+            values(i) = 0.0;
+            for (size_t l=0;l<degree+1;l++) {
+                values(i) += basis[l]*coefs(k+l);
+            }
+            double expT = 1.0;
+            for (size_t l=0;l<degree+1;l++) {
+                vandermonde(i, l) = expT;
+                expT *= ratio;
+            }
         }
-        //Convertion from (x-knot)^d form to
-        //coefficient values
-        for (size_t i=0;i<=k;i++) {
-            Polynom tmp = NewtonBinomial::
-                expandPolynom(_points.front().first-knots[i], degree);
-            tmp *= regression.parameters()(degree+1+i);
-            polynom += tmp;
+        Eigen::VectorXd normalized = 
+            vandermonde.colPivHouseholderQr().solve(values);
+        Polynom polynom(degree);
+        double scale = 1.0;
+        for (size_t i=0;i<degree+1;i++) {
+            polynom(i) = normalized(i)/scale;
+            scale *= length;
         }
         //Add it to Spline container 
-        double boundMin = knots[k];
-        double boundMax;
-        if (k == knots.size()-1) {
-            boundMax = _points.back().first;
-        } else {
-            boundMax = knots[k+1];
-        }
-        //Shift polynom on x axis for spline interface compliance
-        polynom.shift(knots[k]-_points.front().first);
         Spline::_splines.push_back({
             polynom, boundMin, boundMax});
     }
@@ -443,29 +520,35 @@ double FittedSpline::fittingSmoothCMAES(
         size_t size = params.size();
         //Get min/max bounds
         double lengthTime = maxTime-minTime;
-        //Build the spline
+        //Build the spline. Points are all
+        //inserted before the single computation
         SmoothSpline spline;
-        spline.addPoint(minTime, 
-            params(0), params(1), params(2));
+        spline.points().push_back({minTime, 
+            params(0), params(1), params(2)});
         for (size_t i=3;i<size-3;i+=4) {
-            spline.addPoint(
+            spline.points().push_back({
                 params(i)*lengthTime + minTime, 
                 params(i+1), 
                 params(i+2), 
-                params(i+3));
+                params(i+3)});
         }
         if (isCycle) {
-            spline.addPoint(maxTime, 
-                params(0), params(1), params(2));
+            spline.points().push_back({maxTime, 
+                params(0), params(1), params(2)});
         } else {
-            spline.addPoint(maxTime, 
-                params(size-3), params(size-2), params(size-1));
+            spline.points().push_back({maxTime, 
+                params(size-3), params(size-2), params(size-1)});
         }
+        spline.computeSplines();
 
         return spline;
     };
 
-    //Lambda score parameters RMSE
+    //Lambda score parameters RMSE.
+    //Candidates are evaluated concurrently 
+    //by CMA-ES (multithreaded evaluation). 
+    //Since points are sorted, spline parts are
+    //swept forward instead of searched for each point.
     libcmaes::FitFuncEigen fitness = 
         [this, checkParams, buildSpline](const Eigen::VectorXd& params) -> double
     {
@@ -474,13 +557,30 @@ double FittedSpline::fittingSmoothCMAES(
             return check;
         }
         SmoothSpline spline = buildSpline(params);
+        if (spline.size() == 0) {
+            return 1000.0;
+        }
 
         double sumError = 0.0;
         unsigned long count = 0;
+        size_t indexPart = 0;
         for (size_t i=0;i<this->_points.size();i++) {
             double t = this->_points[i].first;
             double val = this->_points[i].second;
-            double error = spline.pos(t) - val;
+            if (t < spline.min()) {
+                t = spline.min();
+            }
+            if (t > spline.max()) {
+                t = spline.max();
+            }
+            while (
+                indexPart < spline.size()-1 && 
+                t > spline.part(indexPart).max
+            ) {
+                indexPart++;
+            }
+            const Spline::Spline_t& part = spline.part(indexPart);
+            double error = part.polynom.pos(t - part.min) - val;
             sumError += error*error;
             count++;
         }
@@ -540,6 +640,30 @@ double FittedSpline::fittingSmoothCMAES(
     return score;
 }
         
+void FittedSpline::bsplineBasis(
+    const std::vector<double>& knotVector,
+    unsigned int degree, size_t span, double t,
+    std::vector<double>& basis) const
+{
+    //Cox-de Boor recursion on the degree+1 
+    //non zero basis functions of the span
+    basis.assign(degree+1, 0.0);
+    std::vector<double> left(degree+1, 0.0);
+    std::vector<double> right(degree+1, 0.0);
+    basis[0] = 1.0;
+    for (size_t j=1;j<=degree;j++) {
+        left[j] = t - knotVector[span+1-j];
+        right[j] = knotVector[span+j] - t;
+        double saved = 0.0;
+        for (size_t r=0;r<j;r++) {
+            double tmp = basis[r]/(right[r+1] + left[j-r]);
+            basis[r] = saved + right[r+1]*tmp;
+            saved = left[j-r]*tmp;
+        }
+        basis[j] = saved;
+    }
+}
+
 void FittedSpline::prepareData()
 {
     //Clear spline
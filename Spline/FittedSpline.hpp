@@ -28,7 +28,9 @@ class FittedSpline : public Spline
          * data points. Spline knots are placed on
          * data points extremum (works only on noiseless data).
          * Each part is fitted independently by a polynom whose
-         * degree is chosen to minimize fitting point error.
+         * degree is chosen to minimize fitting point error
+         * (least square moments are updated incrementally
+         * with the degree).
          * No continuity bound are ensure.
          * maxError is maximum error allowed between given
          * data point and fitted model prediction.
@@ -46,7 +48,8 @@ class FittedSpline : public Spline
          * Knots are generated uniformally every 
          * sequenceLength data point.
          * All splines are computed alltogether ensuring bounds
-         * contraints using linear regression.
+         * contraints using linear regression expressed in 
+         * B-spline basis (banded sparse least square).
          */
         void fittingGlobal(
             unsigned int degree, unsigned int sequenceLength);
@@ -101,6 +104,17 @@ class FittedSpline : public Spline
          * registered points by time
          */
         void prepareData();
+
+        /**
+         * Compute into given basis container the
+         * degree+1 non zero B-spline basis functions
+         * value at t on given knot span index using
+         * given clamped knot vector
+         */
+        void bsplineBasis(
+            const std::vector<double>& knotVector,
+            unsigned int degree, size_t span, double t,
+            std::vector<double>& basis) const;
 };
 
 }
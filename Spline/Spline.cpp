@@ -1,5 +1,7 @@
 #include <iomanip>
 #include <stdexcept>
+#include <cstdint>
+#include <algorithm>
 #include "Spline/Spline.hpp"
 
 namespace Leph {
@@ -132,6 +134,61 @@ void Spline::importData(std::istream& is)
     importCallBack();
 }
         
+void Spline::exportBinary(std::ostream& os) const
+{
+    uint64_t partCount = _splines.size();
+    os.write((const char*)&partCount, sizeof(partCount));
+    for (size_t i=0;i<_splines.size();i++) {
+        uint64_t coefCount = _splines[i].polynom.getCoefs().size();
+        os.write((const char*)&_splines[i].min, sizeof(double));
+        os.write((const char*)&_splines[i].max, sizeof(double));
+        os.write((const char*)&coefCount, sizeof(coefCount));
+        os.write((const char*)_splines[i].polynom.getCoefs().data(), 
+            coefCount*sizeof(double));
+    }
+}
+void Spline::importBinary(std::istream& is)
+{
+    uint64_t partCount = 0;
+    is.read((char*)&partCount, sizeof(partCount));
+    if (!is.good()) {
+        throw std::logic_error(
+            "Spline binary import format invalid");
+    }
+    for (size_t i=0;i<partCount;i++) {
+        double min;
+        double max;
+        uint64_t coefCount;
+        Polynom p;
+        is.read((char*)&min, sizeof(double));
+        is.read((char*)&max, sizeof(double));
+        is.read((char*)&coefCount, sizeof(coefCount));
+        if (!is.good()) {
+            throw std::logic_error(
+                "Spline binary import format invalid");
+        }
+        //Coefficients are read by bounded chunks
+        //so that a corrupted count fails on missing
+        //data instead of allocating its size
+        const uint64_t chunkSize = 1024;
+        uint64_t readCount = 0;
+        while (readCount < coefCount) {
+            uint64_t count = std::min(chunkSize, coefCount - readCount);
+            p.getCoefs().resize(readCount + count);
+            is.read((char*)(p.getCoefs().data() + readCount), 
+                count*sizeof(double));
+            if (!is.good()) {
+                throw std::logic_error(
+                    "Spline binary import format invalid");
+            }
+            readCount += count;
+        }
+        _splines.push_back({p, min, max});
+    }
+    //Call possible post import
+    importCallBack();
+}
+        
 size_t Spline::size() const
 {
     return _splines.size();
@@ -73,6 +73,14 @@ class Spline
         void exportData(std::ostream& os) const;
         void importData(std::istream& is);
 
+        /**
+         * Write and read splines data into given
+         * iostream in compact binary format
+         * (native endianness, exact double values)
+         */
+        void exportBinary(std::ostream& os) const;
+        void importBinary(std::istream& is);
+
         /**
          * Return the number of internal polynom
          */
@@ -3,8 +3,12 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <stdexcept>
+#include <exception>
 #include <fstream>
+#include <cstdint>
+#include <cstring>
 #include "Spline/Spline.hpp"
 #include "Plot/Plot.hpp"
 
@@ -121,6 +125,40 @@ class SplineContainer
             return m;
         }
 
+        /**
+         * Call given function with the name and a reference
+         * to each contained spline. Calls are dispatched
+         * concurrently on OpenMP threads so that independent
+         * channels (for example fitting) are processed in one call.
+         * The function must only modify the given spline.
+         * The first thrown exception is forwarded.
+         */
+        template <typename Func>
+        void applyParallel(Func func)
+        {
+            std::vector<std::pair<const std::string*, T*>> entries;
+            for (auto& sp : _container) {
+                entries.push_back({&sp.first, &sp.second});
+            }
+            std::exception_ptr error = nullptr;
+            #pragma omp parallel for schedule(dynamic)
+            for (size_t i=0;i<entries.size();i++) {
+                try {
+                    func(*(entries[i].first), *(entries[i].second));
+                } catch (...) {
+                    #pragma omp critical
+                    {
+                        if (error == nullptr) {
+                            error = std::current_exception();
+                        }
+                    }
+                }
+            }
+            if (error != nullptr) {
+                std::rethrow_exception(error);
+            }
+        }
+
         /**
          * Update to return a Plot instance with
          * pos/vel/acc values for each contained splines.
@@ -200,8 +238,80 @@ class SplineContainer
             file.close();
         }
 
+        /**
+         * Export to and Import from given file name
+         * in compact binary format. Each spline is
+         * prefixed with its name.
+         */
+        void exportBinary(const std::string& fileName) const
+        {
+            if (_container.size() == 0) {
+                throw std::logic_error("SplineContainer empty");
+            }
+
+            std::ofstream file(fileName, std::ios::binary);
+            if (!file.is_open()) {
+                throw std::runtime_error(
+                    "SplineContainer unable to write file: " 
+                    + fileName);
+            }
+
+            file.write(BinaryMagic, sizeof(BinaryMagic));
+            uint64_t count = _container.size();
+            file.write((const char*)&count, sizeof(count));
+            for (const auto& sp : _container) {
+                uint64_t length = sp.first.length();
+                file.write((const char*)&length, sizeof(length));
+                file.write(sp.first.data(), length);
+                sp.second.exportBinary(file);
+            }
+
+            file.close();
+        }
+        void importBinary(const std::string& fileName)
+        {
+            std::ifstream file(fileName, std::ios::binary);
+            if (!file.is_open()) {
+                throw std::runtime_error(
+                    "SplineContainer unable to read file: " 
+                    + fileName);
+            }
+
+            char magic[sizeof(BinaryMagic)];
+            uint64_t count = 0;
+            file.read(magic, sizeof(magic));
+            file.read((char*)&count, sizeof(count));
+            if (
+                !file.good() || 
+                memcmp(magic, BinaryMagic, sizeof(magic)) != 0
+            ) {
+                throw std::logic_error(
+                    "SplineContainer invalid binary format");
+            }
+            for (size_t i=0;i<count;i++) {
+                uint64_t length = 0;
+                file.read((char*)&length, sizeof(length));
+                std::string name(length, ' ');
+                file.read(&name[0], length);
+                if (!file.good()) {
+                    throw std::logic_error(
+                        "SplineContainer invalid binary format");
+                }
+                add(name);
+                _container.at(name).importBinary(file);
+            }
+
+            file.close();
+        }
+
     private:
 
+        /**
+         * Binary file format header
+         */
+        static constexpr const char BinaryMagic[8] = 
+            {'L', 'E', 'P', 'H', 'S', 'P', 'C', '1'};
+
         /**
          * Spline container indexed 
          * by their name
@@ -209,6 +319,12 @@ class SplineContainer
         std::map<std::string, T> _container;
 };
 
+/**
+ * Binary magic definition (ODR use in C++11)
+ */
+template <class T>
+constexpr const char SplineContainer<T>::BinaryMagic[8];
+
 }
 
 #endif
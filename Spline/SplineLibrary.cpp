@@ -0,0 +1,472 @@
+#include <fstream>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Spline/SplineLibrary.hpp"
+
+namespace Leph {
+
+/**
+ * Binary file format magic and version
+ */
+static const char SplineLibraryMagic[8] =
+    {'L', 'E', 'P', 'H', 'S', 'L', 'I', 'B'};
+static const uint64_t SplineLibraryVersion = 1;
+
+SplineLibrary::View::View() :
+    _parts(nullptr),
+    _count(0),
+    _coefs(nullptr)
+{
+}
+SplineLibrary::View::View(
+    const PartRecord* parts,
+    size_t count,
+    const double* coefs) :
+    _parts(parts),
+    _count(count),
+    _coefs(coefs)
+{
+}
+
+size_t SplineLibrary::View::size() const
+{
+    return _count;
+}
+
+double SplineLibrary::View::min() const
+{
+    if (_count == 0) {
+        return 0.0;
+    } else {
+        return _parts[0].min;
+    }
+}
+double SplineLibrary::View::max() const
+{
+    if (_count == 0) {
+        return 0.0;
+    } else {
+        return _parts[_count-1].max;
+    }
+}
+
+double SplineLibrary::View::pos(double t) const
+{
+    if (_count == 0) {
+        return 0.0;
+    }
+    size_t index = partIndex(t);
+    const double* coefs = _coefs + _parts[index].coefBegin;
+    double x = t - _parts[index].min;
+    double val = 0.0;
+    for (size_t i=_parts[index].coefCount;i>0;i--) {
+        val = val*x + coefs[i-1];
+    }
+    return val;
+}
+double SplineLibrary::View::vel(double t) const
+{
+    if (_count == 0) {
+        return 0.0;
+    }
+    size_t index = partIndex(t);
+    const double* coefs = _coefs + _parts[index].coefBegin;
+    double x = t - _parts[index].min;
+    double val = 0.0;
+    for (size_t i=_parts[index].coefCount;i>1;i--) {
+        val = val*x + (i-1)*coefs[i-1];
+    }
+    return val;
+}
+double SplineLibrary::View::acc(double t) const
+{
+    if (_count == 0) {
+        return 0.0;
+    }
+    size_t index = partIndex(t);
+    const double* coefs = _coefs + _parts[index].coefBegin;
+    double x = t - _parts[index].min;
+    double val = 0.0;
+    for (size_t i=_parts[index].coefCount;i>2;i--) {
+        val = val*x + (i-2)*(i-1)*coefs[i-1];
+    }
+    return val;
+}
+double SplineLibrary::View::jerk(double t) const
+{
+    if (_count == 0) {
+        return 0.0;
+    }
+    size_t index = partIndex(t);
+    const double* coefs = _coefs + _parts[index].coefBegin;
+    double x = t - _parts[index].min;
+    double val = 0.0;
+    for (size_t i=_parts[index].coefCount;i>3;i--) {
+        val = val*x + (i-3)*(i-2)*(i-1)*coefs[i-1];
+    }
+    return val;
+}
+
+void SplineLibrary::View::copyTo(Spline& spline) const
+{
+    Spline tmp;
+    for (size_t i=0;i<_count;i++) {
+        Polynom polynom;
+        const double* coefs = _coefs + _parts[i].coefBegin;
+        polynom.getCoefs().assign(
+            coefs, coefs + _parts[i].coefCount);
+        tmp.addPart(polynom, _parts[i].min, _parts[i].max);
+    }
+    spline.copyData(tmp);
+}
+
+size_t SplineLibrary::View::partIndex(double& t) const
+{
+    //Bound asked abscisse into spline range
+    if (t <= _parts[0].min) {
+        t = _parts[0].min;
+    }
+    if (t >= _parts[_count-1].max) {
+        t = _parts[_count-1].max;
+    }
+    //Bijection spline search
+    size_t indexLow = 0;
+    size_t indexUp = _count-1;
+    while (indexLow != indexUp) {
+        size_t index = (indexUp+indexLow)/2;
+        if (t < _parts[index].min) {
+            indexUp = index-1;
+        } else if (t > _parts[index].max) {
+            indexLow = index+1;
+        } else {
+            indexUp = index;
+            indexLow = index;
+        }
+    }
+    return indexUp;
+}
+
+SplineLibrary::SplineLibrary() :
+    _pending(),
+    _data(nullptr),
+    _size(0),
+    _header(nullptr),
+    _sets(nullptr),
+    _splines(nullptr),
+    _parts(nullptr),
+    _coefs(nullptr)
+{
+}
+
+SplineLibrary::~SplineLibrary()
+{
+    close();
+}
+
+void SplineLibrary::write(const std::string& fileName) const
+{
+    //Build all records.
+    //Map containers are already sorted by name.
+    std::vector<SetRecord> sets;
+    std::vector<SplineRecord> splines;
+    std::vector<PartRecord> parts;
+    std::vector<double> coefs;
+    for (const auto& set : _pending) {
+        SetRecord setRecord;
+        memset(&setRecord, 0, sizeof(setRecord));
+        strncpy(setRecord.name, set.first.c_str(), NameLength-1);
+        setRecord.splineBegin = splines.size();
+        setRecord.splineCount = set.second.size();
+        sets.push_back(setRecord);
+        for (const auto& sp : set.second) {
+            SplineRecord splineRecord;
+            memset(&splineRecord, 0, sizeof(splineRecord));
+            strncpy(splineRecord.name, sp.first.c_str(), NameLength-1);
+            splineRecord.partBegin = parts.size();
+            splineRecord.partCount = sp.second.size();
+            splines.push_back(splineRecord);
+            for (size_t i=0;i<sp.second.size();i++) {
+                const Spline::Spline_t& part = sp.second.part(i);
+                PartRecord partRecord;
+                partRecord.min = part.min;
+                partRecord.max = part.max;
+                partRecord.coefBegin = coefs.size();
+                partRecord.coefCount = part.polynom.getCoefs().size();
+                parts.push_back(partRecord);
+                coefs.insert(coefs.end(),
+                    part.polynom.getCoefs().begin(),
+                    part.polynom.getCoefs().end());
+            }
+        }
+    }
+    HeaderRecord header;
+    memcpy(header.magic, SplineLibraryMagic, sizeof(header.magic));
+    header.version = SplineLibraryVersion;
+    header.setCount = sets.size();
+    header.splineCount = splines.size();
+    header.partCount = parts.size();
+    header.coefCount = coefs.size();
+
+    //Write records in order
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error(
+            "SplineLibrary unable to write file: " + fileName);
+    }
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)sets.data(),
+        sets.size()*sizeof(SetRecord));
+    file.write((const char*)splines.data(),
+        splines.size()*sizeof(SplineRecord));
+    file.write((const char*)parts.data(),
+        parts.size()*sizeof(PartRecord));
+    file.write((const char*)coefs.data(),
+        coefs.size()*sizeof(double));
+    if (!file.good()) {
+        throw std::runtime_error(
+            "SplineLibrary error while writing file: " + fileName);
+    }
+    file.close();
+}
+
+void SplineLibrary::open(const std::string& fileName)
+{
+    close();
+
+    //Map the whole file in read only
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(
+            "SplineLibrary unable to read file: " + fileName);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(HeaderRecord)) {
+        ::close(fd);
+        throw std::logic_error(
+            "SplineLibrary invalid file: " + fileName);
+    }
+    void* data = mmap(nullptr, info.st_size,
+        PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error(
+            "SplineLibrary unable to map file: " + fileName);
+    }
+    _data = data;
+    _size = info.st_size;
+
+    //Assign records pointers and check
+    //the index against the file size
+    const char* ptr = (const char*)_data;
+    _header = (const HeaderRecord*)ptr;
+    if (
+        memcmp(_header->magic, SplineLibraryMagic,
+            sizeof(_header->magic)) != 0 ||
+        _header->version != SplineLibraryVersion
+    ) {
+        close();
+        throw std::logic_error(
+            "SplineLibrary invalid format: " + fileName);
+    }
+    //Each count is bounded by the remaining
+    //file size before any multiplication so
+    //that corrupted counts cannot overflow
+    size_t remaining = _size - sizeof(HeaderRecord);
+    bool isValidSize = true;
+    const uint64_t counts[4] = {
+        _header->setCount, _header->splineCount,
+        _header->partCount, _header->coefCount};
+    const size_t recordSizes[4] = {
+        sizeof(SetRecord), sizeof(SplineRecord),
+        sizeof(PartRecord), sizeof(double)};
+    for (size_t i=0;i<4;i++) {
+        if (counts[i] > remaining/recordSizes[i]) {
+            isValidSize = false;
+            break;
+        }
+        remaining -= counts[i]*recordSizes[i];
+    }
+    if (!isValidSize || remaining != 0) {
+        close();
+        throw std::logic_error(
+            "SplineLibrary invalid size: " + fileName);
+    }
+    ptr += sizeof(HeaderRecord);
+    _sets = (const SetRecord*)ptr;
+    ptr += _header->setCount*sizeof(SetRecord);
+    _splines = (const SplineRecord*)ptr;
+    ptr += _header->splineCount*sizeof(SplineRecord);
+    _parts = (const PartRecord*)ptr;
+    ptr += _header->partCount*sizeof(PartRecord);
+    _coefs = (const double*)ptr;
+    for (size_t i=0;i<_header->setCount;i++) {
+        if (
+            _sets[i].name[NameLength-1] != '\0' ||
+            _sets[i].splineBegin > _header->splineCount ||
+            _sets[i].splineCount 
+            > _header->splineCount - _sets[i].splineBegin
+        ) {
+            close();
+            throw std::logic_error(
+                "SplineLibrary invalid set index: " + fileName);
+        }
+    }
+    for (size_t i=0;i<_header->splineCount;i++) {
+        if (
+            _splines[i].name[NameLength-1] != '\0' ||
+            _splines[i].partBegin > _header->partCount ||
+            _splines[i].partCount 
+            > _header->partCount - _splines[i].partBegin
+        ) {
+            close();
+            throw std::logic_error(
+                "SplineLibrary invalid spline index: " + fileName);
+        }
+    }
+    for (size_t i=0;i<_header->partCount;i++) {
+        if (
+            _parts[i].coefBegin > _header->coefCount ||
+            _parts[i].coefCount 
+            > _header->coefCount - _parts[i].coefBegin
+        ) {
+            close();
+            throw std::logic_error(
+                "SplineLibrary invalid part index: " + fileName);
+        }
+    }
+}
+
+void SplineLibrary::close()
+{
+    if (_data != nullptr) {
+        munmap(_data, _size);
+    }
+    _data = nullptr;
+    _size = 0;
+    _header = nullptr;
+    _sets = nullptr;
+    _splines = nullptr;
+    _parts = nullptr;
+    _coefs = nullptr;
+}
+
+bool SplineLibrary::isOpen() const
+{
+    return _data != nullptr;
+}
+
+std::vector<std::string> SplineLibrary::setNames() const
+{
+    std::vector<std::string> names;
+    if (!isOpen()) {
+        return names;
+    }
+    for (size_t i=0;i<_header->setCount;i++) {
+        names.push_back(std::string(_sets[i].name));
+    }
+    return names;
+}
+std::vector<std::string> SplineLibrary::splineNames(
+    const std::string& setName) const
+{
+    const SetRecord* set = findSet(setName);
+    if (set == nullptr) {
+        throw std::logic_error(
+            "SplineLibrary invalid set name: " + setName);
+    }
+    std::vector<std::string> names;
+    for (size_t i=0;i<set->splineCount;i++) {
+        names.push_back(std::string(
+            _splines[set->splineBegin + i].name));
+    }
+    return names;
+}
+
+bool SplineLibrary::exist(const std::string& setName) const
+{
+    return findSet(setName) != nullptr;
+}
+bool SplineLibrary::exist(
+    const std::string& setName,
+    const std::string& splineName) const
+{
+    const SetRecord* set = findSet(setName);
+    return
+        set != nullptr &&
+        findSpline(set, splineName) != nullptr;
+}
+
+SplineLibrary::View SplineLibrary::view(
+    const std::string& setName,
+    const std::string& splineName) const
+{
+    const SetRecord* set = findSet(setName);
+    if (set == nullptr) {
+        throw std::logic_error(
+            "SplineLibrary invalid set name: " + setName);
+    }
+    const SplineRecord* spline = findSpline(set, splineName);
+    if (spline == nullptr) {
+        throw std::logic_error(
+            "SplineLibrary invalid spline name: " + splineName);
+    }
+    return View(
+        _parts + spline->partBegin,
+        spline->partCount,
+        _coefs);
+}
+
+void SplineLibrary::checkName(const std::string& name) const
+{
+    if (name.length() == 0 || name.length() >= NameLength) {
+        throw std::logic_error(
+            "SplineLibrary invalid name length: " + name);
+    }
+}
+
+const SplineLibrary::SetRecord* SplineLibrary::findSet(
+    const std::string& setName) const
+{
+    if (!isOpen()) {
+        throw std::logic_error(
+            "SplineLibrary no file opened");
+    }
+    size_t indexLow = 0;
+    size_t indexUp = _header->setCount;
+    while (indexLow < indexUp) {
+        size_t index = (indexLow+indexUp)/2;
+        int cmp = strcmp(setName.c_str(), _sets[index].name);
+        if (cmp == 0) {
+            return _sets + index;
+        } else if (cmp < 0) {
+            indexUp = index;
+        } else {
+            indexLow = index+1;
+        }
+    }
+    return nullptr;
+}
+const SplineLibrary::SplineRecord* SplineLibrary::findSpline(
+    const SetRecord* set,
+    const std::string& splineName) const
+{
+    size_t indexLow = set->splineBegin;
+    size_t indexUp = set->splineBegin + set->splineCount;
+    while (indexLow < indexUp) {
+        size_t index = (indexLow+indexUp)/2;
+        int cmp = strcmp(splineName.c_str(), _splines[index].name);
+        if (cmp == 0) {
+            return _splines + index;
+        } else if (cmp < 0) {
+            indexUp = index;
+        } else {
+            indexLow = index+1;
+        }
+    }
+    return nullptr;
+}
+
+}
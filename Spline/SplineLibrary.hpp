@@ -0,0 +1,274 @@
+#ifndef LEPH_SPLINELIBRARY_HPP
+#define LEPH_SPLINELIBRARY_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <stdexcept>
+#include "Spline/Spline.hpp"
+#include "Spline/SplineContainer.hpp"
+
+namespace Leph {
+
+/**
+ * SplineLibrary
+ *
+ * Compact binary file holding many named
+ * sets of named splines (for example precomputed
+ * kick and walk Trajectories) with a sorted index.
+ * The file is a flat array of fixed size records
+ * so that it is loaded with mmap and splines are
+ * evaluated in place without any parsing.
+ * Values are stored in native endianness.
+ */
+class SplineLibrary
+{
+    public:
+
+        /**
+         * Binary file layout.
+         * Header, then sets, splines and parts
+         * records and finally all polynom coefficients.
+         * Sets are sorted by name as well as
+         * splines inside each set.
+         */
+        static constexpr size_t NameLength = 64;
+        struct HeaderRecord {
+            char magic[8];
+            uint64_t version;
+            uint64_t setCount;
+            uint64_t splineCount;
+            uint64_t partCount;
+            uint64_t coefCount;
+        };
+        struct SetRecord {
+            char name[NameLength];
+            uint64_t splineBegin;
+            uint64_t splineCount;
+        };
+        struct SplineRecord {
+            char name[NameLength];
+            uint64_t partBegin;
+            uint64_t partCount;
+        };
+        struct PartRecord {
+            double min;
+            double max;
+            uint64_t coefBegin;
+            uint64_t coefCount;
+        };
+
+        /**
+         * Read only spline evaluated
+         * directly on mapped memory
+         */
+        class View
+        {
+            public:
+
+                /**
+                 * Empty and records initialization
+                 */
+                View();
+                View(
+                    const PartRecord* parts,
+                    size_t count,
+                    const double* coefs);
+
+                /**
+                 * Return the number of polynom parts
+                 */
+                size_t size() const;
+
+                /**
+                 * Return minimum and maximum abscisse
+                 */
+                double min() const;
+                double max() const;
+
+                /**
+                 * Return spline interpolation at given t.
+                 * Same semantic as Spline.
+                 */
+                double pos(double t) const;
+                double vel(double t) const;
+                double acc(double t) const;
+                double jerk(double t) const;
+
+                /**
+                 * Copy the parts into given
+                 * (cleared) spline instance
+                 */
+                void copyTo(Spline& spline) const;
+
+            private:
+
+                /**
+                 * Pointers to mapped records
+                 */
+                const PartRecord* _parts;
+                size_t _count;
+                const double* _coefs;
+
+                /**
+                 * Return the part index containing
+                 * given (bounded) abscisse
+                 */
+                size_t partIndex(double& t) const;
+        };
+
+        /**
+         * Empty initialization
+         */
+        SplineLibrary();
+
+        /**
+         * Unmap the file if opened
+         */
+        ~SplineLibrary();
+
+        /**
+         * Mapped memory is not copyable
+         */
+        SplineLibrary(const SplineLibrary&) = delete;
+        SplineLibrary& operator=(const SplineLibrary&) = delete;
+
+        /**
+         * Add to the pending sets to be written
+         * the splines of given container with given name
+         */
+        template <class T>
+        void add(
+            const std::string& setName,
+            const SplineContainer<T>& container)
+        {
+            checkName(setName);
+            if (_pending.count(setName) != 0) {
+                throw std::logic_error(
+                    "SplineLibrary set already added: " + setName);
+            }
+            for (const auto& sp : container.get()) {
+                checkName(sp.first);
+                Spline spline;
+                spline.copyData(sp.second);
+                _pending[setName][sp.first] = spline;
+            }
+        }
+
+        /**
+         * Write all pending added sets
+         * into given binary file
+         */
+        void write(const std::string& fileName) const;
+
+        /**
+         * Map the given binary file in memory
+         * in read only mode and check its index.
+         * Previously opened file is closed.
+         */
+        void open(const std::string& fileName);
+
+        /**
+         * Unmap current opened file
+         */
+        void close();
+
+        /**
+         * Return true if a file is mapped
+         */
+        bool isOpen() const;
+
+        /**
+         * Return the names of sets in opened file
+         * and of splines in given set
+         */
+        std::vector<std::string> setNames() const;
+        std::vector<std::string> splineNames(
+            const std::string& setName) const;
+
+        /**
+         * Return true if given set (and spline)
+         * exist in opened file
+         */
+        bool exist(const std::string& setName) const;
+        bool exist(
+            const std::string& setName,
+            const std::string& splineName) const;
+
+        /**
+         * Return a view on given spline of
+         * given set without any copy
+         */
+        View view(
+            const std::string& setName,
+            const std::string& splineName) const;
+
+        /**
+         * Build and return a spline container
+         * from given set of opened file
+         */
+        template <class T>
+        SplineContainer<T> get(const std::string& setName) const
+        {
+            const SetRecord* set = findSet(setName);
+            if (set == nullptr) {
+                throw std::logic_error(
+                    "SplineLibrary invalid set name: " + setName);
+            }
+            SplineContainer<T> container;
+            for (size_t i=0;i<set->splineCount;i++) {
+                const SplineRecord& record =
+                    _splines[set->splineBegin + i];
+                std::string name(record.name);
+                container.add(name);
+                View(
+                    _parts + record.partBegin,
+                    record.partCount,
+                    _coefs).copyTo(container.get(name));
+            }
+            return container;
+        }
+
+    private:
+
+        /**
+         * Pending sets to write
+         */
+        std::map<std::string, std::map<std::string, Spline>> _pending;
+
+        /**
+         * Mapped file address and size
+         */
+        void* _data;
+        size_t _size;
+
+        /**
+         * Pointers to records
+         * inside mapped memory
+         */
+        const HeaderRecord* _header;
+        const SetRecord* _sets;
+        const SplineRecord* _splines;
+        const PartRecord* _parts;
+        const double* _coefs;
+
+        /**
+         * Throw logic_error if given
+         * name is too long to be stored
+         */
+        void checkName(const std::string& name) const;
+
+        /**
+         * Binary search of given set or spline.
+         * Return nullptr if not found.
+         */
+        const SetRecord* findSet(const std::string& setName) const;
+        const SplineRecord* findSpline(
+            const SetRecord* set,
+            const std::string& splineName) const;
+};
+
+}
+
+#endif
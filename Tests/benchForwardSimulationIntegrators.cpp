@@ -0,0 +1,98 @@
+#include <iostream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "Model/Model.hpp"
+#include "Model/ForwardSimulation.hpp"
+#include "Utils/Chrono.hpp"
+
+/**
+ * Simulate the triple pendulum over two seconds
+ * with given integrator and (sub) step tracking 
+ * sinusoidal goals updated at 100Hz. 
+ * Return final positions and velocities and assign
+ * integration steps and dynamics evaluations count.
+ */
+static Eigen::VectorXd simulate(
+    Leph::ForwardSimulation::Integrator integrator,
+    double dt, double tolerance,
+    unsigned long& steps, unsigned long& evaluations)
+{
+    Leph::Model model("../Data/pendulum_triple.urdf");
+    model.setDOF("roll1", M_PI/2.0);
+    model.setDOF("roll2", -0.8);
+    Leph::ForwardSimulation sim(model);
+    sim.setIntegrator(integrator);
+    if (integrator == Leph::ForwardSimulation::AdaptiveRK23Integrator) {
+        sim.setAdaptiveTolerance(tolerance);
+    }
+
+    double controlStep = 0.01;
+    size_t loop = std::max(1, (int)std::round(controlStep/dt));
+    for (double t=0.0;t<2.0;t+=controlStep) {
+        for (size_t i=0;i<model.sizeDOF();i++) {
+            sim.goals()(i) = 0.5*sin(2.0*M_PI*(i+1)*t);
+        }
+        for (size_t k=0;k<loop;k++) {
+            sim.update(controlStep/loop);
+        }
+    }
+    steps = sim.integrationStepCount();
+    evaluations = sim.dynamicsEvaluationCount();
+
+    Eigen::VectorXd state(2*model.sizeDOF());
+    state << sim.positions(), sim.velocities();
+    return state;
+}
+
+int main()
+{
+    Leph::Chrono chrono;
+    unsigned long steps;
+    unsigned long evaluations;
+
+    //Tiny step reference
+    Eigen::VectorXd reference = simulate(
+        Leph::ForwardSimulation::RungeKutta4Integrator, 
+        1e-5, 0.0, steps, evaluations);
+
+    std::vector<std::string> names = {
+        "SemiEuler", "SymplecticEuler", "RungeKutta4"};
+    std::vector<Leph::ForwardSimulation::Integrator> integrators = {
+        Leph::ForwardSimulation::SemiEulerIntegrator,
+        Leph::ForwardSimulation::SymplecticEulerIntegrator,
+        Leph::ForwardSimulation::RungeKutta4Integrator};
+    std::vector<double> timeSteps = {
+        1e-4, 2e-4, 5e-4, 1e-3, 2e-3, 5e-3, 1e-2};
+    for (size_t i=0;i<integrators.size();i++) {
+        for (double dt : timeSteps) {
+            std::string label = names[i] + " dt=" + std::to_string(dt);
+            chrono.start(label);
+            Eigen::VectorXd state = simulate(
+                integrators[i], dt, 0.0, steps, evaluations);
+            chrono.stop(label);
+            std::cout << label 
+                << " steps/s=" << steps/2.0
+                << " evaluations/s=" << evaluations/2.0
+                << " error=" << (state-reference).lpNorm<Eigen::Infinity>() 
+                << std::endl;
+        }
+    }
+    for (double tolerance : {1e-3, 1e-4, 1e-5, 1e-6, 1e-7}) {
+        std::string label = "AdaptiveRK23 tol=" + std::to_string(tolerance);
+        chrono.start(label);
+        Eigen::VectorXd state = simulate(
+            Leph::ForwardSimulation::AdaptiveRK23Integrator, 
+            0.01, tolerance, steps, evaluations);
+        chrono.stop(label);
+        std::cout << label 
+            << " steps/s=" << steps/2.0
+            << " evaluations/s=" << evaluations/2.0
+            << " error=" << (state-reference).lpNorm<Eigen::Infinity>() 
+            << std::endl;
+    }
+    chrono.print();
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include "Odometry/Odometry.hpp"
+#include "Odometry/OdometryEnsemble.hpp"
+#include "Utils/Chrono.hpp"
+
+/**
+ * Synthetic walk input pose and
+ * support foot at given update index
+ */
+static Eigen::Vector3d walkPose(size_t k)
+{
+    double t = 0.01*k;
+    return Eigen::Vector3d(
+        0.05*t, 0.01*sin(2.0*M_PI*t), 0.1*t);
+}
+static Leph::HumanoidFixedModel::SupportFoot walkSupport(size_t k)
+{
+    return ((k/25) % 2 == 0) ?
+        Leph::HumanoidFixedModel::LeftSupportFoot :
+        Leph::HumanoidFixedModel::RightSupportFoot;
+}
+
+int main()
+{
+    size_t size = 2000;
+    size_t steps = 1000;
+    Leph::OdometryDisplacementModel::Type typeDisplacement =
+        Leph::OdometryDisplacementModel::DisplacementLinearFullXYA;
+    Leph::OdometryNoiseModel::Type typeNoise =
+        Leph::OdometryNoiseModel::NoiseLinearFull;
+
+    //Particles with different parameters
+    std::vector<Leph::Odometry> odometries(
+        size, Leph::Odometry(typeDisplacement, typeNoise));
+    Leph::OdometryEnsemble ensemble(
+        size, typeDisplacement, typeNoise, 1);
+    Eigen::VectorXd params = odometries.front().getParameters();
+    for (size_t i=0;i<size;i++) {
+        Eigen::VectorXd particleParams = params;
+        particleParams(1) *= 1.0 + 0.0001*i;
+        particleParams(6) *= 1.0 - 0.0001*i;
+        odometries[i].setParameters(particleParams);
+        ensemble.setParameters(i, particleParams);
+    }
+
+    //Without noise, results match
+    //independent Odometry instances
+    for (size_t k=0;k<steps;k++) {
+        for (size_t i=0;i<size;i++) {
+            odometries[i].update(
+                walkPose(k), walkSupport(k), nullptr);
+        }
+        ensemble.update(walkPose(k), walkSupport(k), false);
+    }
+    double error = 0.0;
+    for (size_t i=0;i<size;i++) {
+        error = std::max(error, (odometries[i].state()
+            - ensemble.state(i)).lpNorm<Eigen::Infinity>());
+    }
+    std::cout << "Noiseless max error: " << error << std::endl;
+
+    //Noisy propagation throughput
+    //(ensemble draws differ from the engine ones)
+    Leph::Chrono chrono;
+    std::default_random_engine engine;
+    for (size_t i=0;i<size;i++) {
+        odometries[i].reset();
+    }
+    ensemble.reset();
+    chrono.start("Odometry");
+    for (size_t k=0;k<steps;k++) {
+        for (size_t i=0;i<size;i++) {
+            odometries[i].update(
+                walkPose(k), walkSupport(k), &engine);
+        }
+    }
+    chrono.stop("Odometry");
+    chrono.start("OdometryEnsemble");
+    for (size_t k=0;k<steps;k++) {
+        ensemble.update(walkPose(k), walkSupport(k), true);
+    }
+    chrono.stop("OdometryEnsemble");
+    chrono.start("OdometryFullStep");
+    for (size_t k=0;k<steps;k++) {
+        for (size_t i=0;i<size;i++) {
+            odometries[i].updateFullStep(
+                Eigen::Vector3d(0.05, 0.0, 0.1), &engine);
+        }
+    }
+    chrono.stop("OdometryFullStep");
+    chrono.start("OdometryEnsembleFullStep");
+    for (size_t k=0;k<steps;k++) {
+        ensemble.updateFullStep(
+            Eigen::Vector3d(0.05, 0.0, 0.1), true);
+    }
+    chrono.stop("OdometryEnsembleFullStep");
+    chrono.print();
+
+    //Particles updates per second
+    std::vector<std::string> names = {
+        "Odometry", "OdometryEnsemble",
+        "OdometryFullStep", "OdometryEnsembleFullStep"};
+    for (const std::string& name : names) {
+        std::cout << name << ": "
+            << (double)(size*steps)/(0.001*chrono.sum(name))
+            << " particle steps per second" << std::endl;
+    }
+
+    return 0;
+}
+
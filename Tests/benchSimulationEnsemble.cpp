@@ -0,0 +1,70 @@
+#include <iostream>
+#include <cmath>
+#include <omp.h>
+#include "Model/SimulationEnsemble.hpp"
+#include "Model/NamesModel.h"
+#include "Utils/Chrono.hpp"
+
+int main()
+{
+    int maxThreads = omp_get_num_procs();
+    size_t size = 2*maxThreads;
+    Leph::SimulationEnsemble ensemble(Leph::SigmabanModel, size);
+    
+    //Members with different joint parameters
+    //settled from the same initial pose
+    Eigen::VectorXd params = 
+        ensemble.member(0).jointModel("left_knee").getParameters();
+    for (size_t i=0;i<size;i++) {
+        Eigen::VectorXd memberParams = params*(1.0 + 0.01*i);
+        ensemble.setJointModelParameters(i, memberParams);
+        Leph::HumanoidSimulation& sim = ensemble.member(i);
+        for (const std::string& name : Leph::NamesDOF) {
+            sim.jointModel(name).resetHiddenState();
+        }
+        sim.putOnGround(Leph::HumanoidFixedModel::LeftSupportFoot);
+        sim.putFootAt(0.0, 0.0, Leph::HumanoidFixedModel::LeftSupportFoot);
+    }
+    ensemble.run(0.001, 500);
+    std::vector<Leph::HumanoidSimulation::State> states;
+    ensemble.saveState(states);
+
+    //Oscillating ankle goal
+    Leph::SimulationEnsemble::ControlFunc control = 
+        [](size_t index, double t, Leph::HumanoidSimulation& sim) {
+            sim.setGoal("left_ankle_roll", 0.1*sin(2.0*M_PI*t));
+        };
+
+    //Scaling from one thread to all cores
+    Leph::Chrono chrono;
+    Eigen::MatrixXd reference;
+    for (int threads=1;threads<=maxThreads;threads++) {
+        omp_set_num_threads(threads);
+        ensemble.restoreState(states);
+        std::string label = "threads " + std::to_string(threads);
+        chrono.start(label);
+        ensemble.run(0.001, 1000, control, 10);
+        chrono.stop(label);
+        //Results do not depend on threads count
+        if (threads == 1) {
+            reference = ensemble.recordedPositions();
+        } else {
+            double error = (reference 
+                - ensemble.recordedPositions()).lpNorm<Eigen::Infinity>();
+            if (error > 0.0) {
+                std::cout << "Threads result error: " 
+                    << error << std::endl;
+            }
+        }
+    }
+    size_t failed = 0;
+    for (size_t i=0;i<size;i++) {
+        failed += ensemble.isFailed(i);
+    }
+    std::cout << "Members: " << size 
+        << " records: " << ensemble.recordCount() 
+        << " failed: " << failed << std::endl;
+    chrono.print();
+
+    return 0;
+}
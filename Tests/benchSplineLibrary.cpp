@@ -0,0 +1,119 @@
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include "Spline/SmoothSpline.hpp"
+#include "Spline/SplineContainer.hpp"
+#include "Spline/SplineLibrary.hpp"
+#include "Utils/Chrono.hpp"
+
+/**
+ * Compare loading time of text, binary and
+ * memory mapped trajectories libraries
+ */
+int main()
+{
+    size_t setNumber = 50;
+    size_t splineNumber = 20;
+    size_t pointNumber = 30;
+
+    //Generate trajectories sets
+    Leph::SplineLibrary library;
+    std::vector<std::string> setNames;
+    for (size_t i=0;i<setNumber;i++) {
+        Leph::SplineContainer<Leph::SmoothSpline> container;
+        for (size_t j=0;j<splineNumber;j++) {
+            std::string name = "spline_" + std::to_string(j);
+            container.add(name);
+            for (size_t k=0;k<pointNumber;k++) {
+                double t = 0.1*k;
+                container.get(name).addPoint(
+                    t, sin(t + i + 0.1*j), cos(t), -sin(t));
+            }
+        }
+        std::string setName = "traj_" + std::to_string(i);
+        container.exportData("/tmp/benchSplineLibrary_" + setName + ".splines");
+        container.exportBinary("/tmp/benchSplineLibrary_" + setName + ".bin");
+        library.add(setName, container);
+        setNames.push_back(setName);
+    }
+    library.write("/tmp/benchSplineLibrary.splib");
+
+    Leph::Chrono chrono;
+    double sumText = 0.0;
+    double sumBinary = 0.0;
+    double sumLibrary = 0.0;
+    double sumView = 0.0;
+    //Text format
+    chrono.start("text");
+    for (const std::string& setName : setNames) {
+        Leph::SplineContainer<Leph::SmoothSpline> container;
+        container.importData("/tmp/benchSplineLibrary_" + setName + ".splines");
+        sumText += container.get("spline_0").pos(1.0);
+    }
+    chrono.stop("text");
+    //Binary format
+    chrono.start("binary");
+    for (const std::string& setName : setNames) {
+        Leph::SplineContainer<Leph::SmoothSpline> container;
+        container.importBinary("/tmp/benchSplineLibrary_" + setName + ".bin");
+        sumBinary += container.get("spline_0").pos(1.0);
+    }
+    chrono.stop("binary");
+    //Library with copy into containers
+    chrono.start("library");
+    Leph::SplineLibrary libraryCopy;
+    libraryCopy.open("/tmp/benchSplineLibrary.splib");
+    for (const std::string& setName : setNames) {
+        Leph::SplineContainer<Leph::SmoothSpline> container = 
+            libraryCopy.get<Leph::SmoothSpline>(setName);
+        sumLibrary += container.get("spline_0").pos(1.0);
+    }
+    chrono.stop("library");
+    //Library evaluated in place
+    chrono.start("view");
+    Leph::SplineLibrary libraryView;
+    libraryView.open("/tmp/benchSplineLibrary.splib");
+    for (const std::string& setName : setNames) {
+        sumView += libraryView.view(setName, "spline_0").pos(1.0);
+    }
+    chrono.stop("view");
+    chrono.print();
+
+    //Check that a corrupted count
+    //is rejected instead of overflowing
+    {
+        std::ifstream in("/tmp/benchSplineLibrary.splib", std::ios::binary);
+        std::string content(
+            (std::istreambuf_iterator<char>(in)),
+            std::istreambuf_iterator<char>());
+        uint64_t corrupted = (uint64_t)1 << 61;
+        //Overwrite the header coefCount field
+        content.replace(8 + 4*sizeof(uint64_t), 
+            sizeof(uint64_t), (const char*)&corrupted, sizeof(uint64_t));
+        std::ofstream out("/tmp/benchSplineLibrary_corrupted.splib", 
+            std::ios::binary);
+        out << content;
+        out.close();
+        bool isRejected = false;
+        try {
+            Leph::SplineLibrary libraryCorrupted;
+            libraryCorrupted.open("/tmp/benchSplineLibrary_corrupted.splib");
+        } catch (const std::logic_error&) {
+            isRejected = true;
+        }
+        std::cout << "Corrupted count rejected: " 
+            << isRejected << std::endl;
+        if (!isRejected) {
+            return 1;
+        }
+    }
+
+    std::cout << "Checks: " 
+        << sumText << " " << sumBinary << " " 
+        << sumLibrary << " " << sumView << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Utils/Chrono.hpp"
+#include "TrajectoryGeneration/TrajectoryParameters.hpp"
+#include "TrajectoryGeneration/TrajectoryGeneration.hpp"
+#include "TrajectoryDefinition/CommonTrajs.h"
+#include "TrajectoryDefinition/TrajKickSingle.hpp"
+#include "TrajectoryDefinition/TrajKickDouble.hpp"
+
+/**
+ * Run a short CMA-ES kick optimization with
+ * fixed or multi resolution scoring and return
+ * the final (full resolution) best score
+ */
+double runKick(
+    const std::string& name,
+    bool isMultiResolution,
+    Leph::Chrono& chrono)
+{
+    Leph::TrajectoryParameters trajParams =
+        Leph::DefaultTrajParameters();
+    Leph::TrajectoryGeneration generator(Leph::SigmabanModel);
+    if (name == "kicksingle") {
+        Leph::TrajKickSingle::initializeParameters(trajParams);
+        generator.setTrajectoryGenerationFunc(Leph::TrajKickSingle::funcGeneration(trajParams));
+        generator.setCheckParametersFunc(Leph::TrajKickSingle::funcCheckParams(trajParams));
+        generator.setCheckStateFunc(Leph::TrajKickSingle::funcCheckState(trajParams));
+        generator.setCheckDOFFunc(Leph::TrajKickSingle::funcCheckDOF(trajParams));
+        generator.setScoreFunc(Leph::TrajKickSingle::funcScore(trajParams));
+        generator.setEndScoreFunc(Leph::TrajKickSingle::funcEndScore(trajParams));
+        generator.setSaveFunc(Leph::TrajKickSingle::funcSave(trajParams));
+    } else {
+        Leph::TrajKickDouble::initializeParameters(trajParams);
+        generator.setTrajectoryGenerationFunc(Leph::TrajKickDouble::funcGeneration(trajParams));
+        generator.setCheckParametersFunc(Leph::TrajKickDouble::funcCheckParams(trajParams));
+        generator.setCheckStateFunc(Leph::TrajKickDouble::funcCheckState(trajParams));
+        generator.setCheckDOFFunc(Leph::TrajKickDouble::funcCheckDOF(trajParams));
+        generator.setScoreFunc(Leph::TrajKickDouble::funcScore(trajParams));
+        generator.setEndScoreFunc(Leph::TrajKickDouble::funcEndScore(trajParams));
+        generator.setSaveFunc(Leph::TrajKickDouble::funcSave(trajParams));
+    }
+    generator.setInitialParameters(trajParams.buildVector());
+    generator.setNormalizationCoefs(trajParams.buildNormalizationCoefs());
+
+    std::string label = name +
+        (isMultiResolution ? " multi" : " fixed");
+    chrono.start(label);
+    generator.runOptimization(
+        200, 1, "", 20, -1.0, 0, 1000,
+        false, false, isMultiResolution);
+    chrono.stop(label);
+
+    return generator.bestScore();
+}
+
+int main()
+{
+    Leph::Chrono chrono;
+    std::vector<std::string> names = {"kicksingle", "kickdouble"};
+    for (const std::string& name : names) {
+        double scoreFixed = runKick(name, false, chrono);
+        double scoreMulti = runKick(name, true, chrono);
+        std::cout << name
+            << " fixed step score: " << scoreFixed
+            << " multi resolution score: " << scoreMulti
+            << std::endl;
+    }
+    chrono.print();
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <iostream>
+#include "Utils/Chrono.hpp"
+#include "TrajectoryGeneration/TrajectoryParameters.hpp"
+#include "TrajectoryGeneration/TrajectoryGeneration.hpp"
+#include "TrajectoryDefinition/CommonTrajs.h"
+#include "TrajectoryDefinition/TrajKickSingle.hpp"
+
+/**
+ * Setup the kick single generator
+ */
+static void setupKick(
+    Leph::TrajectoryParameters& trajParams,
+    Leph::TrajectoryGeneration& generator)
+{
+    generator.setTrajectoryGenerationFunc(Leph::TrajKickSingle::funcGeneration(trajParams));
+    generator.setCheckParametersFunc(Leph::TrajKickSingle::funcCheckParams(trajParams));
+    generator.setCheckStateFunc(Leph::TrajKickSingle::funcCheckState(trajParams));
+    generator.setCheckDOFFunc(Leph::TrajKickSingle::funcCheckDOF(trajParams));
+    generator.setScoreFunc(Leph::TrajKickSingle::funcScore(trajParams));
+    generator.setEndScoreFunc(Leph::TrajKickSingle::funcEndScore(trajParams));
+    generator.setSaveFunc(Leph::TrajKickSingle::funcSave(trajParams));
+    generator.setNormalizationCoefs(trajParams.buildNormalizationCoefs());
+}
+
+int main()
+{
+    Leph::Chrono chrono;
+    Leph::TrajectoryParameters trajParams =
+        Leph::DefaultTrajParameters();
+    Leph::TrajKickSingle::initializeParameters(trajParams);
+    trajParams.freeze();
+
+    //Exploration phase
+    Leph::TrajectoryGeneration generator(Leph::SigmabanModel);
+    setupKick(trajParams, generator);
+    generator.setInitialParameters(trajParams.buildVector());
+    generator.runOptimization(
+        100, 0, "", 20, -1.0, 0, 1000);
+    Eigen::VectorXd explored = generator.bestParameters();
+    std::cout << "Exploration score: " 
+        << generator.bestScore() << std::endl;
+
+    //Final convergence with CMA-ES.
+    //Scorings are counted by evaluation contexts on
+    //both sides (best rescorings are included, cheap
+    //checkParameters() rejections are not). The total
+    //count is used since runOptimization() resets the
+    //statistics at each generation.
+    unsigned int iterations = 100;
+    unsigned int population = 20;
+    Leph::TrajectoryGeneration generatorCMAES(Leph::SigmabanModel);
+    setupKick(trajParams, generatorCMAES);
+    generatorCMAES.setInitialParameters(explored);
+    unsigned long startCMAES = 
+        generatorCMAES.evaluationStats().totalCount;
+    chrono.start("CMA-ES convergence");
+    generatorCMAES.runOptimization(
+        iterations, 0, "", population, 0.01, 0, 1000);
+    chrono.stop("CMA-ES convergence");
+    unsigned long countCMAES = 
+        generatorCMAES.evaluationStats().totalCount - startCMAES;
+
+    //Final convergence with L-BFGS
+    Leph::TrajectoryGeneration generatorLBFGS(Leph::SigmabanModel);
+    setupKick(trajParams, generatorLBFGS);
+    generatorLBFGS.setInitialParameters(explored);
+    unsigned long startLBFGS = 
+        generatorLBFGS.evaluationStats().totalCount;
+    chrono.start("L-BFGS convergence");
+    unsigned long count = generatorLBFGS.runRefinement(50);
+    chrono.stop("L-BFGS convergence");
+    unsigned long countLBFGS = 
+        generatorLBFGS.evaluationStats().totalCount - startLBFGS;
+
+    std::cout << "CMA-ES score: " << generatorCMAES.bestScore()
+        << " scorings: " << countCMAES << std::endl;
+    std::cout << "L-BFGS score: " << generatorLBFGS.bestScore()
+        << " scorings: " << countLBFGS 
+        << " (requested: " << count << ")" << std::endl;
+    if (countLBFGS > 0) {
+        std::cout << "Scorings reduction: " 
+            << (double)countCMAES/(double)countLBFGS << std::endl;
+    }
+    chrono.print();
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Utils/Chrono.hpp"
+#include "TrajectoryGeneration/TrajectoryParameters.hpp"
+#include "TrajectoryGeneration/TrajectoryGeneration.hpp"
+#include "TrajectoryDefinition/CommonTrajs.h"
+#include "TrajectoryDefinition/TrajKickSingle.hpp"
+#include "TrajectoryDefinition/TrajKickDouble.hpp"
+
+/**
+ * Run a short CMA-ES kick optimization with
+ * or without surrogate pre-screening and return
+ * the final best score, true evaluations
+ * and saved evaluations counts
+ */
+double runKick(
+    const std::string& name,
+    bool isSurrogate,
+    Leph::Chrono& chrono,
+    unsigned long& evaluations,
+    unsigned long& saved)
+{
+    Leph::TrajectoryParameters trajParams =
+        Leph::DefaultTrajParameters();
+    Leph::TrajectoryGeneration generator(Leph::SigmabanModel);
+    if (name == "kicksingle") {
+        Leph::TrajKickSingle::initializeParameters(trajParams);
+        generator.setTrajectoryGenerationFunc(Leph::TrajKickSingle::funcGeneration(trajParams));
+        generator.setCheckParametersFunc(Leph::TrajKickSingle::funcCheckParams(trajParams));
+        generator.setCheckStateFunc(Leph::TrajKickSingle::funcCheckState(trajParams));
+        generator.setCheckDOFFunc(Leph::TrajKickSingle::funcCheckDOF(trajParams));
+        generator.setScoreFunc(Leph::TrajKickSingle::funcScore(trajParams));
+        generator.setEndScoreFunc(Leph::TrajKickSingle::funcEndScore(trajParams));
+        generator.setSaveFunc(Leph::TrajKickSingle::funcSave(trajParams));
+    } else {
+        Leph::TrajKickDouble::initializeParameters(trajParams);
+        generator.setTrajectoryGenerationFunc(Leph::TrajKickDouble::funcGeneration(trajParams));
+        generator.setCheckParametersFunc(Leph::TrajKickDouble::funcCheckParams(trajParams));
+        generator.setCheckStateFunc(Leph::TrajKickDouble::funcCheckState(trajParams));
+        generator.setCheckDOFFunc(Leph::TrajKickDouble::funcCheckDOF(trajParams));
+        generator.setScoreFunc(Leph::TrajKickDouble::funcScore(trajParams));
+        generator.setEndScoreFunc(Leph::TrajKickDouble::funcEndScore(trajParams));
+        generator.setSaveFunc(Leph::TrajKickDouble::funcSave(trajParams));
+    }
+    generator.setInitialParameters(trajParams.buildVector());
+    generator.setNormalizationCoefs(trajParams.buildNormalizationCoefs());
+    generator.setSurrogate(isSurrogate);
+
+    std::string label = name +
+        (isSurrogate ? " surrogate" : " plain");
+    chrono.start(label);
+    generator.runOptimization(200, 1, "", 20, -1.0, 0, 1000);
+    chrono.stop(label);
+
+    evaluations = generator.surrogateEvaluationCount();
+    saved = generator.surrogateSavedCount();
+    return generator.bestScore();
+}
+
+int main()
+{
+    Leph::Chrono chrono;
+    std::vector<std::string> names = {"kicksingle", "kickdouble"};
+    for (const std::string& name : names) {
+        unsigned long evaluations;
+        unsigned long saved;
+        double scorePlain = runKick(
+            name, false, chrono, evaluations, saved);
+        double scoreSurrogate = runKick(
+            name, true, chrono, evaluations, saved);
+        std::cout << name
+            << " plain score: " << scorePlain
+            << " surrogate score: " << scoreSurrogate
+            << " true evaluations: " << evaluations
+            << " saved evaluations: " << saved
+            << std::endl;
+    }
+    chrono.print();
+
+    return 0;
+}
+
@@ -0,0 +1,213 @@
+#include <iostream>
+#include <cmath>
+#include "Utils/Chrono.hpp"
+#include "Utils/AxisAngle.h"
+#include "Model/HumanoidFixedModel.hpp"
+
+/**
+ * Reference joints velocities computed from RBDL
+ * point jacobians restricted to legs DOF
+ */
+static Eigen::VectorXd referenceIKVel(
+    Leph::HumanoidFixedModel& model,
+    const Eigen::Vector3d& trunkPosVel,
+    const Eigen::Vector3d& trunkAngularVel,
+    const Eigen::Vector3d& footPosVel,
+    const Eigen::Vector3d& footAngularVel)
+{
+    std::string supportName = "left_foot_tip";
+    std::string flyingName = "right_foot_tip";
+    std::vector<std::string> supportNames = {
+        "left_ankle_roll", "left_ankle_pitch", "left_knee",
+        "left_hip_pitch", "left_hip_roll", "left_hip_yaw"};
+    std::vector<std::string> flyingNames = {
+        "right_hip_yaw", "right_hip_roll", "right_hip_pitch",
+        "right_knee", "right_ankle_pitch", "right_ankle_roll"};
+    Eigen::MatrixXd jacTrunk = model.get()
+        .pointJacobian("trunk", supportName);
+    Eigen::MatrixXd jacFoot = model.get()
+        .pointJacobian(flyingName, supportName);
+    Eigen::MatrixXd subJacTrunk(6, 6);
+    Eigen::MatrixXd subJacFoot(6, 6);
+    for (size_t i=0;i<6;i++) {
+        subJacTrunk.col(i) = jacTrunk.col(
+            model.get().getDOFIndex(supportNames[i]));
+        subJacFoot.col(i) = jacFoot.col(
+            model.get().getDOFIndex(flyingNames[i]));
+    }
+    Eigen::VectorXd trunkVel(6);
+    trunkVel.segment(0, 3) = trunkAngularVel;
+    trunkVel.segment(3, 3) = trunkPosVel;
+    Eigen::Vector3d relPos =
+        model.get().position(flyingName, supportName)
+        - model.get().position("trunk", supportName);
+    Eigen::VectorXd footVel(6);
+    footVel.segment(0, 3) = footAngularVel - trunkAngularVel;
+    footVel.segment(3, 3) = footPosVel - trunkPosVel
+        - trunkAngularVel.cross(relPos);
+    Eigen::VectorXd dqSupport = subJacTrunk.fullPivLu().solve(trunkVel);
+    Eigen::VectorXd dqFlying = subJacFoot.fullPivLu().solve(footVel);
+    Eigen::VectorXd dq = Eigen::VectorXd::Zero(model.get().sizeDOF());
+    for (size_t i=0;i<6;i++) {
+        dq(model.get().getDOFIndex(supportNames[i])) = dqSupport(i);
+        dq(model.get().getDOFIndex(flyingNames[i])) = dqFlying(i);
+    }
+    return dq;
+}
+
+/**
+ * Reference joints accelerations computed from RBDL
+ * point jacobians and point accelerations (dJ*dq)
+ * restricted to legs DOF
+ */
+static Eigen::VectorXd referenceIKAcc(
+    Leph::HumanoidFixedModel& model,
+    const Eigen::VectorXd& dq,
+    const Eigen::Vector3d& trunkPosVel,
+    const Eigen::Vector3d& trunkAngularVel,
+    const Eigen::Vector3d& footPosVel,
+    const Eigen::Vector3d& trunkPosAcc,
+    const Eigen::Vector3d& trunkAngularAcc,
+    const Eigen::Vector3d& footPosAcc,
+    const Eigen::Vector3d& footAngularAcc)
+{
+    std::string supportName = "left_foot_tip";
+    std::string flyingName = "right_foot_tip";
+    std::vector<std::string> supportNames = {
+        "left_ankle_roll", "left_ankle_pitch", "left_knee",
+        "left_hip_pitch", "left_hip_roll", "left_hip_yaw"};
+    std::vector<std::string> flyingNames = {
+        "right_hip_yaw", "right_hip_roll", "right_hip_pitch",
+        "right_knee", "right_ankle_pitch", "right_ankle_roll"};
+    size_t sizeDOF = model.get().sizeDOF();
+    Eigen::MatrixXd jacTrunk = model.get()
+        .pointJacobian("trunk", supportName);
+    Eigen::MatrixXd jacFoot = model.get()
+        .pointJacobian(flyingName, supportName);
+    Eigen::MatrixXd subJacTrunk(6, 6);
+    Eigen::MatrixXd subJacFoot(6, 6);
+    Eigen::VectorXd dqSupport = Eigen::VectorXd::Zero(sizeDOF);
+    Eigen::VectorXd dqFlying = Eigen::VectorXd::Zero(sizeDOF);
+    for (size_t i=0;i<6;i++) {
+        size_t indexSupport = model.get().getDOFIndex(supportNames[i]);
+        size_t indexFlying = model.get().getDOFIndex(flyingNames[i]);
+        subJacTrunk.col(i) = jacTrunk.col(indexSupport);
+        subJacFoot.col(i) = jacFoot.col(indexFlying);
+        dqSupport(indexSupport) = dq(indexSupport);
+        dqFlying(indexFlying) = dq(indexFlying);
+    }
+    Eigen::VectorXd trunkAcc(6);
+    trunkAcc.segment(0, 3) = trunkAngularAcc;
+    trunkAcc.segment(3, 3) = trunkPosAcc;
+    Eigen::Vector3d relPos =
+        model.get().position(flyingName, supportName)
+        - model.get().position("trunk", supportName);
+    Eigen::Vector3d relVel = footPosVel - trunkPosVel
+        - trunkAngularVel.cross(relPos);
+    Eigen::VectorXd footAcc(6);
+    footAcc.segment(0, 3) = footAngularAcc - trunkAngularAcc;
+    footAcc.segment(3, 3) = footPosAcc - trunkPosAcc
+        - trunkAngularAcc.cross(relPos)
+        - trunkAngularVel.cross(trunkAngularVel.cross(relPos))
+        - 2.0*trunkAngularVel.cross(relVel);
+    //dJ*dq is the point acceleration with null ddq
+    Eigen::VectorXd biasTrunk = model.get().pointAcceleration(
+        "trunk", supportName, dqSupport, 
+        Eigen::VectorXd::Zero(sizeDOF));
+    Eigen::VectorXd biasFoot = model.get().pointAcceleration(
+        flyingName, supportName, dqFlying, 
+        Eigen::VectorXd::Zero(sizeDOF));
+    Eigen::VectorXd ddqSupport = 
+        subJacTrunk.fullPivLu().solve(trunkAcc - biasTrunk);
+    Eigen::VectorXd ddqFlying = 
+        subJacFoot.fullPivLu().solve(footAcc - biasFoot);
+    Eigen::VectorXd ddq = Eigen::VectorXd::Zero(sizeDOF);
+    for (size_t i=0;i<6;i++) {
+        ddq(model.get().getDOFIndex(supportNames[i])) = ddqSupport(i);
+        ddq(model.get().getDOFIndex(flyingNames[i])) = ddqFlying(i);
+    }
+    return ddq;
+}
+
+int main()
+{
+    Leph::Chrono c;
+    Leph::HumanoidFixedModel model(Leph::SigmabanModel);
+
+    size_t count = 10000;
+    double maxError = 0.0;
+    double maxErrorAcc = 0.0;
+    Eigen::VectorXd dq;
+    Eigen::VectorXd ddq;
+    for (size_t i=0;i<count;i++) {
+        double t = 0.001*i;
+        //Moving trunk and flying foot targets
+        Eigen::Vector3d trunkPos(
+            0.01*sin(t), 0.05 + 0.02*sin(2*t), 0.2 + 0.02*sin(3*t));
+        Eigen::Vector3d trunkAxis(
+            0.1*sin(t), 0.2*sin(2*t), 0.1*sin(t));
+        Eigen::Vector3d footPos(
+            0.05*sin(4*t), -0.1, 0.03 + 0.03*sin(t));
+        Eigen::Vector3d footAxis(
+            0.0, 0.2*sin(3*t), 0.1*sin(2*t));
+        Eigen::Vector3d trunkPosVel(
+            0.01*cos(t), 0.04*cos(2*t), 0.06*cos(3*t));
+        Eigen::Vector3d trunkAngularVel(
+            0.1*cos(t), 0.4*cos(2*t), 0.1*cos(t));
+        Eigen::Vector3d footPosVel(
+            0.2*cos(4*t), 0.0, 0.03*cos(t));
+        Eigen::Vector3d footAngularVel(
+            0.0, 0.6*cos(3*t), 0.2*cos(2*t));
+        Eigen::Vector3d trunkPosAcc(
+            -0.01*sin(t), -0.08*sin(2*t), -0.18*sin(3*t));
+        Eigen::Vector3d trunkAngularAcc(
+            -0.1*sin(t), -0.8*sin(2*t), -0.1*sin(t));
+        Eigen::Vector3d footPosAcc(
+            -0.8*sin(4*t), 0.0, -0.03*sin(t));
+        Eigen::Vector3d footAngularAcc(
+            0.0, -1.8*sin(3*t), -0.4*sin(2*t));
+
+        c.start("trunkFootIK");
+        model.trunkFootIK(
+            Leph::HumanoidFixedModel::LeftSupportFoot,
+            trunkPos, Leph::AxisToMatrix(trunkAxis),
+            footPos, Leph::AxisToMatrix(footAxis));
+        c.stop("trunkFootIK");
+        c.start("trunkFootIKVel");
+        dq = model.trunkFootIKVel(
+            trunkPosVel, trunkAngularVel,
+            footPosVel, footAngularVel);
+        c.stop("trunkFootIKVel");
+        c.start("trunkFootIKAcc");
+        ddq = model.trunkFootIKAcc(dq,
+            trunkPosVel, trunkAngularVel,
+            footPosVel, footAngularVel,
+            trunkPosAcc, trunkAngularAcc,
+            footPosAcc, footAngularAcc);
+        c.stop("trunkFootIKAcc");
+        c.start("referenceIKVel");
+        Eigen::VectorXd dqRef = referenceIKVel(model,
+            trunkPosVel, trunkAngularVel,
+            footPosVel, footAngularVel);
+        c.stop("referenceIKVel");
+        c.start("referenceIKAcc");
+        Eigen::VectorXd ddqRef = referenceIKAcc(model, dq,
+            trunkPosVel, trunkAngularVel, footPosVel,
+            trunkPosAcc, trunkAngularAcc,
+            footPosAcc, footAngularAcc);
+        c.stop("referenceIKAcc");
+        maxError = std::max(maxError,
+            (dq - dqRef).lpNorm<Eigen::Infinity>());
+        maxErrorAcc = std::max(maxErrorAcc,
+            (ddq - ddqRef).lpNorm<Eigen::Infinity>());
+    }
+    c.print();
+    std::cout << "Calls: " << count << std::endl;
+    std::cout << "Velocity max error from reference: "
+        << maxError << std::endl;
+    std::cout << "Acceleration max error from reference: "
+        << maxErrorAcc << std::endl;
+
+    return 0;
+}
+
@@ -112,6 +112,12 @@ int main()
     container.get("dim2").addPoint(0.0, 0.0, 0.0, 0.0);
     container.get("dim2").addPoint(2.0, 2.0, 0.0, 0.0);
     container.exportData("/tmp/testDMPSpline.container");
+    container.exportBinary("/tmp/testDMPSpline.bin");
+    Leph::SplineContainer<Leph::DMPSpline> containerBin;
+    containerBin.importBinary("/tmp/testDMPSpline.bin");
+    std::cout << "Binary import: " 
+        << container.get("dim1").pos(0.5) << " " 
+        << containerBin.get("dim1").pos(0.5) << std::endl;
     
     return 0;
 }
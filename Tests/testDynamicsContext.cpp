@@ -0,0 +1,108 @@
+#include <iostream>
+#include <cmath>
+#include "Model/HumanoidSimulation.hpp"
+#include "Model/NamesModel.h"
+#include "Utils/Chrono.hpp"
+
+/**
+ * Return the maximum absolute
+ * difference between given vectors
+ */
+static double maxError(
+    const Eigen::VectorXd& vect1,
+    const Eigen::VectorXd& vect2)
+{
+    return (vect1 - vect2).lpNorm<Eigen::Infinity>();
+}
+
+/**
+ * Assign oscillating legs goals from
+ * given initial goals at given step
+ */
+static void assignGoals(
+    Leph::HumanoidSimulation& sim,
+    const Eigen::VectorXd& goals,
+    size_t k)
+{
+    double t = 0.001*k;
+    sim.goals() = goals;
+    sim.setGoal("left_knee",
+        sim.getGoal("left_knee") + 0.4*sin(2.0*M_PI*1.0*t));
+    sim.setGoal("right_knee",
+        sim.getGoal("right_knee") + 0.4*sin(2.0*M_PI*1.0*t + 1.0));
+    sim.setGoal("left_ankle_roll",
+        sim.getGoal("left_ankle_roll") + 0.2*sin(2.0*M_PI*1.5*t));
+    sim.setGoal("right_hip_roll",
+        sim.getGoal("right_hip_roll") + 0.2*sin(2.0*M_PI*0.5*t));
+}
+
+/**
+ * Compare a contact sequence stepped with
+ * and without the dynamics terms context
+ */
+int main()
+{
+    //Same settled state for both simulations
+    Leph::HumanoidSimulation simCached(Leph::SigmabanModel);
+    Leph::HumanoidSimulation simUncached(Leph::SigmabanModel);
+    simUncached.setDynamicsContext(false);
+    for (const std::string& name : Leph::NamesDOF) {
+        simCached.jointModel(name).resetHiddenState();
+    }
+    simCached.putOnGround(Leph::HumanoidFixedModel::LeftSupportFoot);
+    simCached.putFootAt(0.0, 0.0, Leph::HumanoidFixedModel::LeftSupportFoot);
+    for (size_t k=0;k<500;k++) {
+        simCached.update(0.001);
+    }
+    Leph::HumanoidSimulation::State state;
+    simCached.saveState(state);
+    simUncached.restoreState(state);
+    simCached.restoreState(state);
+    Eigen::VectorXd goals = simCached.goals();
+
+    //Step both simulations through
+    //contact changes and compare
+    Leph::Chrono chrono;
+    Leph::HumanoidSimulation::State stateCached;
+    Leph::HumanoidSimulation::State stateUncached;
+    double errorAcc = 0.0;
+    double errorVel = 0.0;
+    double errorPos = 0.0;
+    double errorForce = 0.0;
+    size_t steps = 2000;
+    for (size_t k=0;k<steps;k++) {
+        assignGoals(simCached, goals, k);
+        assignGoals(simUncached, goals, k);
+        chrono.start("Cached");
+        simCached.update(0.001);
+        chrono.stop("Cached");
+        chrono.start("Uncached");
+        simUncached.update(0.001);
+        chrono.stop("Uncached");
+        errorAcc = std::max(errorAcc, maxError(
+            simCached.accelerations(), simUncached.accelerations()));
+        errorVel = std::max(errorVel, maxError(
+            simCached.velocities(), simUncached.velocities()));
+        errorPos = std::max(errorPos, maxError(
+            simCached.positions(), simUncached.positions()));
+        simCached.saveState(stateCached);
+        simUncached.saveState(stateUncached);
+        for (size_t i=0;i<stateCached.cleatsForce.size();i++) {
+            errorForce = std::max(errorForce, fabs(
+                stateCached.cleatsForce[i] - stateUncached.cleatsForce[i]));
+        }
+    }
+    std::cout << "Max acceleration error: " << errorAcc << std::endl;
+    std::cout << "Max velocity error: " << errorVel << std::endl;
+    std::cout << "Max position error: " << errorPos << std::endl;
+    std::cout << "Max cleat force error: " << errorForce << std::endl;
+    simCached.printConstraintsStats();
+    chrono.print();
+
+    bool isValid =
+        errorAcc < 1e-6 && errorVel < 1e-6 &&
+        errorPos < 1e-6 && errorForce < 1e-6;
+    std::cout << (isValid ? "OK" : "FAIL") << std::endl;
+
+    return isValid ? 0 : 1;
+}
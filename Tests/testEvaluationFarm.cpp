@@ -0,0 +1,106 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "Utils/EvaluationFarm.hpp"
+
+/**
+ * Evaluated test function.
+ * Sleep when the first value is large
+ * in order to trigger timeouts.
+ */
+double function(const Eigen::VectorXd& params)
+{
+    if (params(0) > 100.0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    return params.squaredNorm();
+}
+
+void checkEqual(
+    const std::string& name,
+    const std::vector<Eigen::VectorXd>& params,
+    const std::vector<double>& values)
+{
+    double maxError = 0.0;
+    for (size_t i=0;i<params.size();i++) {
+        maxError = std::max(maxError,
+            std::fabs(values[i] - function(params[i])));
+    }
+    std::cout << name << " evaluations: " << values.size()
+        << " max error: " << maxError
+        << (maxError == 0.0 ? " OK" : " FAIL") << std::endl;
+}
+
+int main()
+{
+    std::vector<Eigen::VectorXd> params;
+    for (size_t i=0;i<40;i++) {
+        params.push_back(Eigen::VectorXd::Random(5));
+    }
+
+    //Local forked workers with batching
+    //and one spare worker
+    Leph::EvaluationFarm farmLocal(function, 3, 1.0, -1.0);
+    farmLocal.addLocalWorkers(4, 1);
+    std::cout << "Local workers: " << farmLocal.size() << std::endl;
+    checkEqual("Local batch", params, farmLocal.evaluate(params));
+
+    //Concurrent single requests from OpenMP threads
+    std::vector<double> values(params.size());
+    #pragma omp parallel for
+    for (size_t i=0;i<params.size();i++) {
+        values[i] = farmLocal.evaluate(params[i]);
+    }
+    checkEqual("Local threads", params, values);
+
+    //Timed out worker is first replaced
+    //by the spare and then left dead
+    Eigen::VectorXd slow = Eigen::VectorXd::Zero(5);
+    slow(0) = 1000.0;
+    for (size_t k=0;k<2;k++) {
+        std::cout << "Timeout value: " << farmLocal.evaluate(slow)
+            << " failures: " << farmLocal.failureCount()
+            << " workers: " << farmLocal.size() << std::endl;
+    }
+    checkEqual("Local after timeout", params, farmLocal.evaluate(params));
+    farmLocal.stop();
+
+    //Evaluation throws once the
+    //last worker has timed out
+    Leph::EvaluationFarm farmSingle(function, 1, 1.0, -1.0);
+    farmSingle.addLocalWorkers(1);
+    try {
+        farmSingle.evaluate(slow);
+        std::cout << "No worker left: FAIL" << std::endl;
+    } catch (const std::runtime_error& e) {
+        std::cout << "No worker left: " << e.what() << " OK" << std::endl;
+    }
+    farmSingle.stop();
+
+    //TCP worker server in a child process
+    unsigned int port = 9731;
+    pid_t pidServer = fork();
+    if (pidServer == 0) {
+        Leph::EvaluationFarm::serveTCP(port, function);
+        _exit(0);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    Leph::EvaluationFarm farmTCP(function, 4);
+    farmTCP.addTCPWorker("127.0.0.1", port);
+    farmTCP.addTCPWorker("localhost", port);
+    std::cout << "TCP workers: " << farmTCP.size() << std::endl;
+    checkEqual("TCP batch", params, farmTCP.evaluate(params));
+    farmTCP.stop();
+    kill(pidServer, SIGTERM);
+    waitpid(pidServer, nullptr, 0);
+
+    return 0;
+}
+
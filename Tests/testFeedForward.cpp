@@ -105,7 +105,7 @@ int main()
             size_t indexGoal = modelGoal.get().getDOFIndex(name);
             size_t indexSim = modelSimNormal.getDOFIndex(name);
             //Compute feed forward target angular position offset
-            double offset = simFeed.jointModel(indexSim).computeFeedForward(
+            double offset = simFeed.computeFeedForward(indexSim,
                 dq(indexGoal), ddq(indexGoal), torques(indexGoal));
             simFeed.goals()(indexSim) = modelGoal.get().getDOF(name) + offset;
             //No feed-forward
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <cmath>
+#include <stdexcept>
+#include "Utils/FitnessArchive.hpp"
+
+double function(const Eigen::VectorXd& params)
+{
+    return params.squaredNorm();
+}
+
+int main()
+{
+    Leph::FitnessArchive archive(1e-6);
+
+    //Concurrent memoized evaluations
+    //with repeated candidates
+    std::vector<Eigen::VectorXd> params;
+    for (size_t i=0;i<50;i++) {
+        params.push_back(Eigen::VectorXd::Random(4));
+    }
+    #pragma omp parallel for
+    for (size_t i=0;i<1000;i++) {
+        const Eigen::VectorXd& p = params[i%params.size()];
+        double score;
+        if (!archive.get(p, score)) {
+            Eigen::VectorXd costs(2);
+            costs << p(0), p(1);
+            archive.set(p, function(p), costs);
+        }
+    }
+    std::cout << "Size: " << archive.size() 
+        << " hits: " << archive.hits() 
+        << " misses: " << archive.misses() << std::endl;
+
+    //Nearly identical parameters
+    double score;
+    Eigen::VectorXd costs;
+    Eigen::VectorXd near = params[0];
+    near(0) += 1e-8;
+    std::cout << "Near found: " << archive.get(near, score, costs)
+        << " score: " << score << " expected: " << function(params[0])
+        << " costs: " << costs.transpose() << std::endl;
+    near(0) += 1e-3;
+    std::cout << "Far found: " << archive.get(near, score) << std::endl;
+
+    //Persistence
+    archive.exportBinary("/tmp/testFitnessArchive.bin");
+    Leph::FitnessArchive archive2(1e-6);
+    archive2.importBinary("/tmp/testFitnessArchive.bin");
+    size_t countError = 0;
+    for (const Eigen::VectorXd& p : params) {
+        if (!archive2.get(p, score) || score != function(p)) {
+            countError++;
+        }
+    }
+    std::cout << "Loaded: " << archive2.size() 
+        << " errors: " << countError << std::endl;
+
+    //Archive of an other configuration is rejected
+    Leph::FitnessArchive archive3(1e-6, 
+        Leph::FitnessArchive::hashData("other", 5));
+    try {
+        archive3.importBinary("/tmp/testFitnessArchive.bin");
+        std::cout << "Mismatch rejected: 0 FAIL" << std::endl;
+    } catch (const std::logic_error&) {
+        std::cout << "Mismatch rejected: 1 OK" << std::endl;
+    }
+
+    return 0;
+}
@@ -3,6 +3,8 @@
 #include <cmath>
 #include <random>
 #include "Spline/FittedSpline.hpp"
+#include "Spline/SplineContainer.hpp"
+#include "Utils/Chrono.hpp"
 #include "Types/MatrixLabel.hpp"
 #include "Plot/Plot.hpp"
 
@@ -269,6 +271,54 @@ void testFittingCMAES()
         .render();
 }
 
+void testFittingParallel()
+{
+    Leph::SplineContainer<Leph::FittedSpline> serial;
+    Leph::SplineContainer<Leph::FittedSpline> parallel;
+    Leph::Chrono chrono;
+
+    //Generates many noised channels
+    for (size_t k=0;k<16;k++) {
+        std::string name = "channel_" + std::to_string(k);
+        serial.add(name);
+        parallel.add(name);
+        for (double t=0;t<10.0;t+=0.001) {
+            double f = function(0.1*t + 0.01*k) + noise(0.05);
+            serial.get(name).addPoint(t, f);
+            parallel.get(name).addPoint(t, f);
+        }
+    }
+
+    //Fit channels one by one and all at once
+    chrono.start("serial");
+    for (auto& sp : serial.get()) {
+        sp.second.fittingGlobal(4, 20);
+    }
+    chrono.stop("serial");
+    chrono.start("parallel");
+    parallel.applyParallel([]
+        (const std::string& name, Leph::FittedSpline& spline) {
+            (void)name;
+            spline.fittingGlobal(4, 20);
+        });
+    chrono.stop("parallel");
+    chrono.print();
+
+    //Check that both fitting are identical
+    double maxDiff = 0.0;
+    for (const auto& sp : serial.get()) {
+        for (double t=0;t<10.0;t+=0.01) {
+            double diff = fabs(
+                sp.second.pos(t) - parallel.get(sp.first).pos(t));
+            if (diff > maxDiff) {
+                maxDiff = diff;
+            }
+        }
+    }
+    std::cout << "Serial/parallel max difference: " 
+        << maxDiff << std::endl;
+}
+
 int main() 
 {
     testGeneratedData();
@@ -278,6 +328,7 @@ int main()
     testFittingCubic();
     testFittingSmooth();
     testFittingCMAES();
+    testFittingParallel();
    
     return 0;
 }
@@ -21,6 +21,7 @@ void testForward()
     
     //Simulator
     Leph::ForwardSimulation sim(model);
+    const Leph::ForwardSimulation& simConst = sim;
 
     Leph::ModelViewer viewer(1200, 900);
     Leph::Plot plot;
@@ -34,8 +35,8 @@ void testForward()
             count++;
             Leph::VectorLabel vect;
             for (size_t i=0;i<model.sizeDOF();i++) {
-                vect.append("backlash_pos:" + model.getDOFName(i), sim.jointModel(i).getBacklashStatePos());
-                vect.append("backlash_enabled:" + model.getDOFName(i), sim.jointModel(i).getBacklashStateEnabled());
+                vect.append("backlash_pos:" + model.getDOFName(i), simConst.jointModel(i).getBacklashStatePos());
+                vect.append("backlash_enabled:" + model.getDOFName(i), simConst.jointModel(i).getBacklashStateEnabled());
                 vect.append("goal:" + model.getDOFName(i), sim.goals()(i));
                 vect.append("acc:" + model.getDOFName(i), sim.accelerations()(i));
                 vect.append("joint:" + model.getDOFName(i), sim.jointTorques()(i));
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <cassert>
+#include <cmath>
+#include <algorithm>
 #include "Utils/GaussianDistribution.hpp"
 #include "Plot/Plot.hpp"
 
@@ -111,6 +113,98 @@ void testCircularDistribution()
     }
 }
 
+/**
+ * Compare incremental and batch fitting,
+ * batched and single log-probabilities and
+ * batched and single sampling
+ */
+void testIncrementalFit()
+{
+    Eigen::VectorXd mean(3);
+    mean << 0.5, 3.0, -1.0;
+    Eigen::MatrixXd cov(3, 3);
+    cov << 
+        0.5, 0.1, 0.0,
+        0.1, 0.2, 0.05,
+        0.0, 0.05, 0.3;
+    Eigen::VectorXi isCircular(3);
+    isCircular << 0, 1, 0;
+    Eigen::VectorXi isNotCircular = Eigen::VectorXi::Zero(3);
+    for (const Eigen::VectorXi& circular : {isNotCircular, isCircular}) {
+        Leph::GaussianDistribution dist(mean, cov, circular);
+        //Successive and batched sampling
+        std::default_random_engine engine1(42);
+        std::default_random_engine engine2(42);
+        Eigen::MatrixXd points = dist.sample(1000, engine2);
+        std::vector<Eigen::VectorXd> data;
+        Leph::GaussianAccumulator accumulator(3, circular);
+        double errorSample = 0.0;
+        for (size_t k=0;k<(size_t)points.cols();k++) {
+            Eigen::VectorXd point = dist.sample(engine1);
+            errorSample = std::max(errorSample, 
+                (point - points.col(k)).lpNorm<Eigen::Infinity>());
+            data.push_back(point);
+            accumulator.add(point);
+        }
+        //Batch and incremental fitting
+        Leph::GaussianDistribution dist1;
+        Leph::GaussianDistribution dist2;
+        dist1.fit(data, circular);
+        dist2.fit(accumulator);
+        //Single and batched log-probabilities
+        Eigen::VectorXd logProbas = dist1.logProbabilities(points);
+        double errorLogProba = 0.0;
+        for (size_t k=0;k<(size_t)points.cols();k++) {
+            errorLogProba = std::max(errorLogProba, 
+                std::fabs(logProbas(k) - dist1.logProbability(points.col(k))));
+        }
+        std::cout 
+            << "Circular=" << circular.transpose()
+            << " SampleError=" << errorSample
+            << " MeanError=" 
+            << (dist1.mean()-dist2.mean()).norm()
+            << " CovError=" 
+            << (dist1.covariance()-dist2.covariance()).norm() 
+            << " LogProbaError=" << errorLogProba
+            << std::endl;
+    }
+}
+
+/**
+ * Test incremental fitting of a circular
+ * dimension whose first point is far 
+ * from the circular mean
+ */
+void testIncrementalFitFarFirstPoint()
+{
+    Eigen::VectorXi isCircular(1);
+    isCircular << 1;
+    std::vector<double> values = {
+        2.5, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.1, -0.1, -2.5};
+    std::vector<Eigen::VectorXd> data;
+    Leph::GaussianAccumulator accumulator(1, isCircular);
+    for (double value : values) {
+        Eigen::VectorXd point(1);
+        point << value;
+        data.push_back(point);
+        accumulator.add(point);
+    }
+    Leph::GaussianDistribution dist1;
+    Leph::GaussianDistribution dist2;
+    dist1.fit(data, isCircular);
+    dist2.fit(accumulator);
+    //Expected covariance is 12.52/9
+    double error = std::max(
+        std::fabs(dist1.covariance()(0, 0) - 12.52/9.0),
+        std::fabs(dist2.covariance()(0, 0) - 12.52/9.0));
+    std::cout 
+        << "FarFirstPoint BatchCov=" << dist1.covariance()(0, 0)
+        << " IncrementalCov=" << dist2.covariance()(0, 0)
+        << " MeanError=" << (dist1.mean()-dist2.mean()).norm()
+        << (error < 1e-9 ? " OK" : " FAIL")
+        << std::endl;
+}
+
 int main()
 {
     Leph::Plot plot;
@@ -219,6 +313,8 @@ int main()
     }
 
     testCircularDistribution();
+    testIncrementalFit();
+    testIncrementalFitFarFirstPoint();
 
     return 0;
 }
@@ -64,6 +64,7 @@ void testContacts()
         //if (count >= 208) break;
         //if (count >= 3810) break;
     }
+    sim.printConstraintsStats();
     plot
         .plot("index", "left_cleat_1:force")
         .plot("index", "left_cleat_2:force")
@@ -158,6 +159,8 @@ void testWalk()
         Leph::ModelDraw(sim.model(), viewer);
         Leph::CleatsDraw(sim, viewer);
     }
+    //LCP triggers and constraint sets reuse
+    sim.printConstraintsStats();
 }
 
 int main()
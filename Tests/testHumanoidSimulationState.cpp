@@ -0,0 +1,71 @@
+#include <iostream>
+#include <cmath>
+#include "Model/HumanoidSimulation.hpp"
+#include "Model/NamesModel.h"
+#include "Utils/Chrono.hpp"
+
+/**
+ * Run given steps count with oscillating 
+ * ankle goal and return final positions
+ */
+static Eigen::VectorXd rollout(
+    Leph::HumanoidSimulation& sim, 
+    double goal, size_t steps)
+{
+    for (size_t k=0;k<steps;k++) {
+        sim.setGoal("left_ankle_roll", 
+            goal + 0.2*sin(2.0*M_PI*0.001*k));
+        sim.update(0.001);
+    }
+    return sim.positions();
+}
+
+int main()
+{
+    Leph::HumanoidSimulation sim(Leph::SigmabanModel);
+    Leph::Chrono chrono;
+
+    //Settling from initial pose
+    for (const std::string& name : Leph::NamesDOF) {
+        sim.jointModel(name).resetHiddenState();
+    }
+    sim.putOnGround(Leph::HumanoidFixedModel::LeftSupportFoot);
+    sim.putFootAt(0.0, 0.0, Leph::HumanoidFixedModel::LeftSupportFoot);
+    chrono.start("Settling");
+    for (size_t k=0;k<500;k++) {
+        sim.update(0.001);
+    }
+    chrono.stop("Settling");
+    double goal = sim.getGoal("left_ankle_roll");
+    
+    //Save settled state
+    Leph::HumanoidSimulation::State state;
+    sim.saveState(state);
+    chrono.start("Save");
+    sim.saveState(state);
+    chrono.stop("Save");
+
+    //Rollouts from restored state 
+    //are expected to be identical
+    Eigen::VectorXd pos1 = rollout(sim, goal, 300);
+    chrono.start("Restore");
+    sim.restoreState(state);
+    chrono.stop("Restore");
+    Eigen::VectorXd pos2 = rollout(sim, goal, 300);
+    std::cout << "Restored rollout error: " 
+        << (pos1 - pos2).lpNorm<Eigen::Infinity>() << std::endl;
+    
+    //Branching rollout from mid trajectory
+    sim.restoreState(state);
+    rollout(sim, goal, 150);
+    Leph::HumanoidSimulation::State mid;
+    sim.saveState(mid);
+    Eigen::VectorXd posBranch1 = rollout(sim, goal + 0.1, 150);
+    sim.restoreState(mid);
+    Eigen::VectorXd posBranch2 = rollout(sim, goal + 0.1, 150);
+    std::cout << "Branch rollout error: " 
+        << (posBranch1 - posBranch2).lpNorm<Eigen::Infinity>() << std::endl;
+    chrono.print();
+
+    return 0;
+}
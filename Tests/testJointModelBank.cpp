@@ -0,0 +1,131 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include "Model/JointModel.hpp"
+#include "Model/JointModelBank.hpp"
+#include "Utils/Chrono.hpp"
+
+/**
+ * Return the maximum absolute difference
+ * between given bank output and given
+ * per joint reference values
+ */
+static double maxError(
+    const Eigen::VectorXd& bank,
+    const std::vector<double>& ref)
+{
+    double error = 0.0;
+    for (size_t i=0;i<ref.size();i++) {
+        error = std::max(error, fabs(bank(i) - ref[i]));
+    }
+    return error;
+}
+
+int main()
+{
+    size_t size = 20;
+    std::mt19937 engine(0);
+    std::uniform_real_distribution<double> distParams(0.5, 1.5);
+    std::uniform_real_distribution<double> distState(-1.0, 1.0);
+
+    //Joints with randomly scaled parameters
+    std::vector<Leph::JointModel> joints;
+    Leph::JointModelBank bank(size);
+    for (size_t i=0;i<size;i++) {
+        joints.push_back(Leph::JointModel("joint_" + std::to_string(i)));
+        Eigen::VectorXd params = joints[i].getParameters();
+        for (size_t j=0;j<(size_t)params.size();j++) {
+            params(j) *= distParams(engine);
+        }
+        joints[i].setParameters(params);
+        bank.load(i, joints[i]);
+    }
+
+    //Compare updates and torques on random
+    //goals, positions and velocities
+    double dt = 0.001;
+    Eigen::VectorXd goals(size);
+    Eigen::VectorXd pos(size);
+    Eigen::VectorXd vel(size);
+    Eigen::VectorXd inertias;
+    Eigen::VectorXd frictions;
+    Eigen::VectorXd controls;
+    double error = 0.0;
+    for (size_t k=0;k<5000;k++) {
+        std::vector<double> refGoals(size);
+        std::vector<double> refInertias(size);
+        std::vector<double> refFrictions(size);
+        std::vector<double> refControls(size);
+        for (size_t i=0;i<size;i++) {
+            goals(i) = 0.5*sin(0.01*k + i) + 0.01*distState(engine);
+            pos(i) = 0.5*sin(0.01*k + i + 0.1) + 0.05*distState(engine);
+            vel(i) = distState(engine);
+        }
+        Eigen::VectorXd boundedPos = pos;
+        Eigen::VectorXd boundedVel = vel;
+        bank.boundState(boundedPos, boundedVel);
+        bank.updateState(dt, goals, boundedPos, boundedVel);
+        bank.inertias(inertias);
+        bank.frictionTorques(boundedVel, frictions);
+        bank.controlTorques(boundedPos, boundedVel, controls);
+        for (size_t i=0;i<size;i++) {
+            double p = pos(i);
+            double v = vel(i);
+            joints[i].boundState(p, v);
+            joints[i].updateState(dt, goals(i), p, v);
+            refGoals[i] = joints[i].getDelayedGoal();
+            refInertias[i] = joints[i].getInertia();
+            refFrictions[i] = joints[i].frictionTorque(v);
+            refControls[i] = joints[i].controlTorque(p, v);
+        }
+        error = std::max(error, maxError(bank.delayedGoals(), refGoals));
+        error = std::max(error, maxError(inertias, refInertias));
+        error = std::max(error, maxError(frictions, refFrictions));
+        error = std::max(error, maxError(controls, refControls));
+    }
+    std::cout << "Max error: " << error << std::endl;
+
+    //Check state round trip through JointModel view
+    Leph::JointModel::State stateBank;
+    Leph::JointModel::State stateJoint;
+    for (size_t i=0;i<size;i++) {
+        Leph::JointModel view("view");
+        bank.store(i, view);
+        view.saveState(stateBank);
+        joints[i].saveState(stateJoint);
+        if (
+            stateBank.goalHistory != stateJoint.goalHistory ||
+            stateBank.goalTime != stateJoint.goalTime ||
+            stateBank.backlashIsEnabled != stateJoint.backlashIsEnabled ||
+            stateBank.backlashPosition != stateJoint.backlashPosition
+        ) {
+            std::cout << "Test state error: joint " << i << std::endl;
+        }
+    }
+
+    //Timing
+    Leph::Chrono chrono;
+    for (size_t k=0;k<20000;k++) {
+        chrono.start("JointModel");
+        for (size_t i=0;i<size;i++) {
+            double p = pos(i);
+            double v = vel(i);
+            joints[i].boundState(p, v);
+            joints[i].updateState(dt, goals(i), p, v);
+            frictions(i) = joints[i].frictionTorque(v);
+            controls(i) = joints[i].controlTorque(p, v);
+        }
+        chrono.stop("JointModel");
+        chrono.start("JointModelBank");
+        bank.boundState(pos, vel);
+        bank.updateState(dt, goals, pos, vel);
+        bank.frictionTorques(vel, frictions);
+        bank.controlTorques(pos, vel, controls);
+        chrono.stop("JointModelBank");
+    }
+    chrono.print();
+
+    return (error == 0.0) ? 0 : 1;
+}
+
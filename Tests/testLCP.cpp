@@ -1,6 +1,63 @@
 #include <iostream>
+#include <cmath>
 #include "LCPMobyDrake/LCPSolver.hpp"
 
+/**
+ * Solve a sequence of slowly varying
+ * problems from trivial basis and warm
+ * started from previous solution basis
+ * and compare pivot counts and solutions
+ */
+void testWarmStart()
+{
+    std::cout << "Test warm started Lemke solver" << std::endl;
+
+    size_t size = 12;
+    Eigen::MatrixXd A = Eigen::MatrixXd::Random(size, size);
+    Eigen::MatrixXd M = A*A.transpose() 
+        + 0.1*Eigen::MatrixXd::Identity(size, size);
+    Eigen::VectorXd q0 = Eigen::VectorXd::Random(size);
+
+    Drake::MobyLCPSolver solverCold;
+    Drake::MobyLCPSolver solverWarm;
+    unsigned long pivotsCold = 0;
+    unsigned long pivotsWarm = 0;
+    double maxError = 0.0;
+    size_t count = 1000;
+    for (size_t k=0;k<count;k++) {
+        Eigen::VectorXd q = q0;
+        for (size_t i=0;i<size;i++) {
+            q(i) += 0.5*sin(0.01*k*(i+1));
+        }
+        Eigen::VectorXd zCold(size);
+        Eigen::VectorXd zWarm(size);
+        zCold.setZero();
+        zWarm.setZero();
+        bool isSuccessCold = solverCold.
+            SolveLcpLemkeRegularized(M, q, &zCold);
+        pivotsCold += solverCold.GetPivots();
+        bool isSuccessWarm = solverWarm.
+            SolveLcpLemkeRegularized(M, q, &zWarm);
+        pivotsWarm += solverWarm.GetPivots();
+        if (isSuccessWarm) {
+            solverWarm.SetWarmStartBasis(
+                solverWarm.GetSolutionBasis());
+        }
+        if (isSuccessCold != isSuccessWarm) {
+            std::cout << "Error success mismatch k=" << k << std::endl;
+        }
+        maxError = std::max(maxError, 
+            (zCold-zWarm).lpNorm<Eigen::Infinity>());
+    }
+    std::cout << "Problems: " << count 
+        << " pivots cold: " << pivotsCold 
+        << " warm: " << pivotsWarm << std::endl;
+    std::cout << "Solution max error: " << maxError << std::endl;
+    if (maxError > 1e-8) {
+        std::cout << "Error warm started solution" << std::endl;
+    }
+}
+
 /**
  * Test Linear Complimentary Problem
  * solver extracted from 
@@ -46,6 +103,8 @@ int main()
             std::cout << "Error z not positive" << std::endl;
         }
     }
+
+    testWarmStart();
     
     return 0;
 }
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include "Model/HumanoidSimulation.hpp"
+#include "Model/HumanoidFixedModel.hpp"
+#include "Model/SimulationServer.hpp"
+#include "Model/NamesModel.h"
+#include "Viewer/ModelViewer.hpp"
+#include "Viewer/ModelDraw.hpp"
+#include "Utils/AxisAngle.h"
+#include "Utils/Scheduling.hpp"
+
+/**
+ * Simulation advanced in real time on its
+ * own thread, goals sent by a controller thread
+ * and state displayed by the viewer
+ * at its own rate
+ */
+int main()
+{
+    Leph::HumanoidSimulation sim(Leph::SigmabanModel);
+    Leph::HumanoidFixedModel goalModel(Leph::SigmabanModel);
+
+    //Initial standing posture
+    bool success = goalModel.trunkFootIK(
+        Leph::HumanoidFixedModel::LeftSupportFoot,
+        Eigen::Vector3d(-0.005, -0.011, 0.28),
+        Leph::AxisToMatrix(Eigen::Vector3d::Zero()),
+        Eigen::Vector3d(0.0, -0.12, 0.02),
+        Leph::AxisToMatrix(Eigen::Vector3d::Zero()));
+    if (!success) {
+        std::cout << "IK ERROR" << std::endl;
+        return 1;
+    }
+    for (const std::string& name : Leph::NamesDOF) {
+        sim.setPos(name, goalModel.get().getDOF(name));
+        sim.setGoal(name, goalModel.get().getDOF(name));
+    }
+    sim.putOnGround();
+    sim.putFootAt(0.0, 0.0);
+
+    //Controller data retrieved
+    //before the simulation is started
+    Eigen::VectorXd goals = sim.goals();
+    size_t indexLeft = sim.model().getDOFIndex("left_ankle_roll");
+    size_t indexRight = sim.model().getDOFIndex("right_ankle_roll");
+    double initLeft = goals(indexLeft);
+    double initRight = goals(indexRight);
+
+    Leph::SimulationServer server(sim, 0.001, 1.0);
+    server.start();
+
+    //Controller thread at 100Hz
+    std::atomic<bool> isControl(true);
+    std::thread controller([&](){
+        Leph::Scheduling scheduling(100.0);
+        double t = 0.0;
+        while (isControl.load()) {
+            goals(indexLeft) = initLeft - 0.2*sin(2.0*M_PI*t*0.5);
+            goals(indexRight) = initRight - 0.2*sin(2.0*M_PI*t*0.5);
+            if (!server.pushGoals(goals)) {
+                std::cout << "Commands queue full" << std::endl;
+            }
+            t += 0.01;
+            scheduling.wait();
+        }
+    });
+
+    //Viewer at its own rate
+    Leph::ModelViewer viewer(1200, 900);
+    Leph::HumanoidModel viewModel(Leph::SigmabanModel, "trunk", true);
+    while (viewer.update() && server.isRunning()) {
+        if (server.update()) {
+            viewModel.setDOFVect(server.snapshot().positions);
+        }
+        Leph::ModelDraw(viewModel, viewer);
+    }
+
+    isControl.store(false);
+    controller.join();
+    server.stop();
+    server.printStats();
+    sim.printConstraintsStats();
+
+    return 0;
+}
+
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <vector>
+#include "Utils/Chrono.hpp"
+#include "Model/HumanoidFixedModel.hpp"
+#include "Model/NamesModel.h"
+#include "TrajectoryGeneration/TrajectoryUtils.h"
+#include "TrajectoryGeneration/TrajectoryKinematics.hpp"
+#include "TrajectoryGeneration/TrajectoryParameters.hpp"
+#include "TrajectoryDefinition/CommonTrajs.h"
+#include "TrajectoryDefinition/TrajKickSingle.hpp"
+
+/**
+ * Check given Eigen::Vector equality
+ */
+static void test(const std::string& msg,
+    const Eigen::VectorXd& v1, const Eigen::VectorXd& v2, double epsilon)
+{
+    if ((v1-v2).lpNorm<Eigen::Infinity>() > epsilon) {
+        std::cout << "Test Vector Error: " << std::endl;
+        std::cout << msg << std::endl;
+        std::cout << "error: " << (v1-v2).lpNorm<Eigen::Infinity>() << std::endl;
+        std::cout << "v1: " << v1.transpose() << std::endl;
+        std::cout << "v2: " << v2.transpose() << std::endl;
+    }
+}
+
+/**
+ * Reorder given model DOF vector
+ * in NamesDOFAll order
+ */
+static Eigen::VectorXd toNamesOrder(
+    const Leph::HumanoidFixedModel& model,
+    const Eigen::VectorXd& vect)
+{
+    Eigen::VectorXd result(Leph::NamesDOFAll.size());
+    for (size_t i=0;i<Leph::NamesDOFAll.size();i++) {
+        result(i) = vect(model.get().getDOFIndex(Leph::NamesDOFAll[i]));
+    }
+    return result;
+}
+
+int main()
+{
+    //Default kick trajectory
+    Leph::TrajectoryParameters trajParams =
+        Leph::DefaultTrajParameters();
+    Leph::TrajKickSingle::initializeParameters(trajParams);
+    Leph::Trajectories traj =
+        Leph::TrajKickSingle::funcGeneration(trajParams)(
+            trajParams.buildVector());
+    std::vector<double> times =
+        Leph::TrajectoriesTimeGrid(traj, 0.01);
+
+    Leph::HumanoidFixedModel modelRef(Leph::SigmabanModel);
+    Leph::HumanoidFixedModel model(Leph::SigmabanModel);
+    Leph::Chrono chrono;
+
+    //Compare with sample by sample computation
+    Leph::TrajectoryKinematics kinematics;
+    for (double t : times) {
+        Eigen::VectorXd dqRef;
+        Eigen::VectorXd ddqRef;
+        Eigen::VectorXd dq;
+        Eigen::VectorXd ddq;
+        bool isSuccessRef = Leph::TrajectoriesComputeKinematics(
+            t, traj, modelRef, dqRef, ddqRef);
+        bool isSuccess = kinematics.compute(
+            t, traj, model, dq, ddq);
+        if (isSuccessRef != isSuccess) {
+            std::cout << "Test IK success error t=" << t << std::endl;
+            continue;
+        }
+        if (!isSuccess) {
+            continue;
+        }
+        std::string label = " t=" + std::to_string(t);
+        test("q" + label,
+            toNamesOrder(model, model.get().getDOFVect()),
+            toNamesOrder(modelRef, modelRef.get().getDOFVect()), 1e-9);
+        test("dq" + label,
+            toNamesOrder(model, dq),
+            toNamesOrder(modelRef, dqRef), 1e-6);
+        test("ddq" + label,
+            toNamesOrder(model, ddq),
+            toNamesOrder(modelRef, ddqRef), 1e-4);
+    }
+    std::cout << "Factorizations: " << kinematics.factorizationCount()
+        << " reused: " << kinematics.reuseCount() << std::endl;
+
+    //Timing of whole trajectory computation
+    Eigen::MatrixXd q;
+    Eigen::MatrixXd dq;
+    Eigen::MatrixXd ddq;
+    std::vector<bool> isSuccess;
+    for (size_t k=0;k<100;k++) {
+        chrono.start("TrajectoriesComputeKinematics");
+        for (double t : times) {
+            Eigen::VectorXd dqRef;
+            Eigen::VectorXd ddqRef;
+            Leph::TrajectoriesComputeKinematics(
+                t, traj, modelRef, dqRef, ddqRef);
+        }
+        chrono.stop("TrajectoriesComputeKinematics");
+        chrono.start("TrajectoryKinematics");
+        kinematics.computeAll(times, traj, model,
+            q, dq, ddq, isSuccess);
+        chrono.stop("TrajectoryKinematics");
+    }
+    chrono.print();
+
+    return 0;
+}
+
@@ -1,6 +1,38 @@
 #include <iostream>
+#include <cmath>
 #include <Eigen/Dense>
+#include "Utils/Chrono.hpp"
 #include "TrajectoryGeneration/TrajectoryParameters.hpp"
+#include "TrajectoryGeneration/TrajectoryUtils.h"
+#include "TrajectoryDefinition/CommonTrajs.h"
+#include "TrajectoryDefinition/TrajKickSingle.hpp"
+
+/**
+ * Kick trajectory generation 
+ * using parameters name lookup
+ */
+static Leph::Trajectories generateByName(
+    const Leph::TrajectoryParameters& trajParams,
+    const Eigen::VectorXd& params)
+{
+    double endTime = trajParams.get("time_length", params);
+    double before1Time = trajParams.get("time_ratio_before1", params)*endTime;
+    double before2Time = trajParams.get("time_ratio_before2", params)*endTime;
+    double contactTime = trajParams.get("time_ratio_contact", params)*endTime;
+    double afterTime = trajParams.get("time_ratio_after", params)*endTime;
+    Leph::Trajectories traj = Leph::TrajectoriesInit();
+    traj.get("is_double_support").addPoint(0.0, 0.0);
+    traj.get("is_double_support").addPoint(endTime, 0.0);
+    traj.get("is_left_support_foot").addPoint(0.0, 1.0);
+    traj.get("is_left_support_foot").addPoint(endTime, 1.0);
+    trajParams.trajectoriesAssign(traj, 0.0, "static_single", params);
+    trajParams.trajectoriesAssign(traj, before1Time, "before1", params);
+    trajParams.trajectoriesAssign(traj, before2Time, "before2", params);
+    trajParams.trajectoriesAssign(traj, contactTime, "contact", params);
+    trajParams.trajectoriesAssign(traj, afterTime, "after", params);
+    trajParams.trajectoriesAssign(traj, endTime, "static_single", params);
+    return traj;
+}
 
 int main()
 {
@@ -24,6 +56,53 @@ int main()
     std::cout << params.get("test1", vect) << std::endl;
     std::cout << params.get("test3", vect) << std::endl;
 
+    //Slot accessors
+    size_t slotAlias = params.slot("alias");
+    std::cout << (slotAlias == params.slot("test_z")) << std::endl;
+    vect = params.buildVector();
+    std::cout << params.get(slotAlias, vect) << std::endl;
+    std::cout << params.get(params.slotOptional("test_w"), vect) << std::endl;
+    params.freeze();
+    params.set("test1") = 41.0;
+    std::cout << params.get(params.slot("test1"), vect) << std::endl;
+    try {
+        params.add("test4", 45.0);
+        std::cout << "Test freeze error" << std::endl;
+    } catch (const std::logic_error& e) {
+        std::cout << e.what() << std::endl;
+    }
+
+    //Compare kick trajectory construction 
+    //by name and with compiled slots
+    Leph::TrajectoryParameters trajParams = 
+        Leph::DefaultTrajParameters();
+    Leph::TrajKickSingle::initializeParameters(trajParams);
+    Leph::TrajectoryGeneration::GenerationFunc generation = 
+        Leph::TrajKickSingle::funcGeneration(trajParams);
+    trajParams.freeze();
+    Eigen::VectorXd trajVect = trajParams.buildVector();
+    Leph::Trajectories trajByName = generateByName(trajParams, trajVect);
+    Leph::Trajectories trajBySlot = generation(trajVect);
+    double maxError = 0.0;
+    for (double t=0.0;t<=trajByName.max();t+=0.01) {
+        for (const auto& it : trajByName.get()) {
+            maxError = std::max(maxError, fabs(
+                it.second.pos(t) - trajBySlot.get(it.first).pos(t)));
+        }
+    }
+    std::cout << "Trajectories max error: " << maxError << std::endl;
+
+    //Trajectory construction time per evaluation
+    Leph::Chrono chrono;
+    for (size_t k=0;k<10000;k++) {
+        chrono.start("GenerationByName");
+        generateByName(trajParams, trajVect);
+        chrono.stop("GenerationByName");
+        chrono.start("GenerationBySlot");
+        generation(trajVect);
+        chrono.stop("GenerationBySlot");
+    }
+    chrono.print();
+
     return 0;
 }
-
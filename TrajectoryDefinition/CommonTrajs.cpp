@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "TrajectoryDefinition/CommonTrajs.h"
 #include "Model/JointModel.hpp"
 #include "Utils/FileEigen.h"
@@ -5,6 +6,29 @@
 
 namespace Leph {
 
+/**
+ * Return an upper bound of the maximum over 
+ * [t0:t2] of a function given by three samples.
+ * If the samples rise then fall, the function
+ * is assumed locally concave and is bounded by 
+ * its secants extended over the next (resp. 
+ * previous) interval.
+ */
+static double peakBound(
+    double t0, double q0, 
+    double t1, double q1, 
+    double t2, double q2)
+{
+    double peak = std::max(q0, std::max(q1, q2));
+    double d01 = (q1 - q0)/(t1 - t0);
+    double d12 = (q2 - q1)/(t2 - t1);
+    if (d01 > 0.0 && d12 <= 0.0) {
+        peak = std::max(peak, q1 + d01*(t2 - t1));
+        peak = std::max(peak, q1 - d12*(t1 - t0));
+    }
+    return peak;
+}
+
 TrajectoryParameters DefaultTrajParameters()
 {
     //Default trajectory parameter initialization
@@ -16,6 +40,21 @@ TrajectoryParameters DefaultTrajParameters()
     parameters.add("cmaes_lambda", 100.0);
     parameters.add("cmaes_sigma", -1.0);
     parameters.add("cmaes_elitism", 0.0);
+    //Abort inverse dynamics scoring above
+    //the worst selected candidate cost
+    parameters.add("cmaes_cost_bounding", 0.0);
+    //Forked evaluation worker processes (0 is
+    //disabled), candidates batch size and timeout
+    parameters.add("cmaes_workers", 0.0);
+    parameters.add("cmaes_workers_batch", 1.0);
+    parameters.add("cmaes_workers_timeout", -1.0);
+    //Gaussian process surrogate pre-screening
+    parameters.add("cmaes_surrogate", 0.0);
+    //Memoization of evaluations saved along outputs
+    parameters.add("cmaes_archive", 0.0);
+    //L-BFGS refinement iterations of
+    //CMA-ES result (0 is disabled)
+    parameters.add("cmaes_refine_iterations", 0.0);
     //Fitness maximum torque yaw
     parameters.add("fitness_max_torque_yaw", 1.5);
     //Fitness maximum voltage ratio
@@ -64,8 +103,6 @@ TrajectoryGeneration::ScoreFunc DefaultFuncScore(
         HumanoidFixedModel::SupportFoot supportFoot,
         std::vector<double>& data) -> double 
     {
-        (void)t;
-
         //Init data
         if (data.size() == 0) {
             //[0] Count summed
@@ -78,6 +115,21 @@ TrajectoryGeneration::ScoreFunc DefaultFuncScore(
             data.push_back(0.0);
             //[4] Max torque yaw
             data.push_back(0.0);
+            //[5] Previous samples count
+            data.push_back(0.0);
+            //[6-7] Two previous samples time
+            data.push_back(0.0);
+            data.push_back(0.0);
+            //[8-9] Two previous ZMP
+            data.push_back(0.0);
+            data.push_back(0.0);
+            //[10-11] Two previous voltage overload
+            data.push_back(0.0);
+            data.push_back(0.0);
+            //[12-13] Two previous torque yaw
+            //(negative in double support)
+            data.push_back(-1.0);
+            data.push_back(-1.0);
         }
 
         //Penalize foot cleats under the ground
@@ -176,6 +228,7 @@ TrajectoryGeneration::ScoreFunc DefaultFuncScore(
         }
         
         //Voltage
+        double sampleVoltRatio = 0.0;
         for (const std::string& name : NamesDOF) {
             size_t index = model.get().getDOFIndex(name);
             double volt = fabs(joints.at(name).computeElectricTension(
@@ -187,19 +240,50 @@ TrajectoryGeneration::ScoreFunc DefaultFuncScore(
             if (data[3] < voltRatio) {
                 data[3] = voltRatio;
             }
+            sampleVoltRatio = std::max(sampleVoltRatio, voltRatio);
             data[0] += 1.0;
             data[1] += volt;
         }
 
         //Support torque yaw if single support
+        double torqueSupportYaw = -1.0;
         if (!isDoubleSupport) {
-            double torqueSupportYaw = fabs(
+            torqueSupportYaw = fabs(
                 torques(model.get().getDOFIndex("base_yaw")));
             //Max support yaw
             if (data[4] < torqueSupportYaw) {
                 data[4] = torqueSupportYaw;
             }
         }
+
+        //On coarse time grid, peaks between samples
+        //are missed. Maximums are conservatively raised
+        //to a peak bound computed from the last three
+        //samples. Full resolution scoring 
+        //(0.01s spacing) is not modified.
+        if (
+            data[5] >= 2.0 && 
+            (t - data[7] > 0.01 + 1e-6 || data[7] - data[6] > 0.01 + 1e-6)
+        ) {
+            data[2] = std::max(data[2], peakBound(
+                data[6], data[8], data[7], data[9], t, zmpError));
+            data[3] = std::max(data[3], peakBound(
+                data[6], data[10], data[7], data[11], t, sampleVoltRatio));
+            if (data[12] >= 0.0 && data[13] >= 0.0 && torqueSupportYaw >= 0.0) {
+                data[4] = std::max(data[4], peakBound(
+                    data[6], data[12], data[7], data[13], 
+                    t, torqueSupportYaw));
+            }
+        }
+        data[5] += 1.0;
+        data[6] = data[7];
+        data[7] = t;
+        data[8] = data[9];
+        data[9] = zmpError;
+        data[10] = data[11];
+        data[11] = sampleVoltRatio;
+        data[12] = data[13];
+        data[13] = torqueSupportYaw;
         
         return 0.0;
     };
@@ -218,7 +302,7 @@ TrajectoryGeneration::EndScoreFunc DefaultFuncEndScore(
         (void)traj;
         //Skip if the first iteration
         //has not ended (data not initialize)
-        if (data.size() != 5) {
+        if (data.size() != 14) {
             return 0.0;
         }
         //Verbose
@@ -15,7 +15,10 @@ TrajectoryParameters DefaultTrajParameters();
 
 /**
  * Return a standard fitness function from
- * given trajectory parameters
+ * given trajectory parameters.
+ * Tracked maximums (ZMP, voltage ratio and 
+ * support yaw torque) are raised to a conservative
+ * peak bound when samples are coarser than 0.01s.
  */
 TrajectoryGeneration::ScoreFunc DefaultFuncScore(
     const TrajectoryParameters& trajParams);
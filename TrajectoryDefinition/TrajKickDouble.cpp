@@ -228,14 +228,40 @@ void TrajKickDouble::initializeParameters(
 TrajectoryGeneration::GenerationFunc TrajKickDouble::funcGeneration(
     const TrajectoryParameters& trajParams)
 {
-    return [&trajParams](const Eigen::VectorXd& params) -> Trajectories {
+    //Resolve parameters slots once
+    size_t slotLength = trajParams.slot("time_length");
+    size_t slotSwap1 = trajParams.slot("time_ratio_swap1");
+    size_t slotBefore = trajParams.slot("time_ratio_before");
+    size_t slotContact = trajParams.slot("time_ratio_contact");
+    size_t slotAfter = trajParams.slot("time_ratio_after");
+    size_t slotSwap2 = trajParams.slot("time_ratio_swap2");
+    TrajectoryParameters::CartesianSlots staticSlots = 
+        trajParams.cartesianSlots("static_double");
+    TrajectoryParameters::CartesianSlots swap1Slots = 
+        trajParams.cartesianSlots("swap1");
+    TrajectoryParameters::CartesianSlots beforeSlots = 
+        trajParams.cartesianSlots("before");
+    TrajectoryParameters::CartesianSlots contactSlots = 
+        trajParams.cartesianSlots("contact");
+    TrajectoryParameters::CartesianSlots afterSlots = 
+        trajParams.cartesianSlots("after");
+    TrajectoryParameters::CartesianSlots swap2Slots = 
+        trajParams.cartesianSlots("swap2");
+
+    return [&trajParams, 
+        slotLength, slotSwap1, slotBefore, 
+        slotContact, slotAfter, slotSwap2,
+        staticSlots, swap1Slots, beforeSlots, 
+        contactSlots, afterSlots, swap2Slots]
+        (const Eigen::VectorXd& params) -> Trajectories 
+    {
         //Retrieve timing parameters
-        double endTime = trajParams.get("time_length", params);
-        double swap1Time = trajParams.get("time_ratio_swap1", params)*endTime;
-        double beforeTime = trajParams.get("time_ratio_before", params)*endTime;
-        double contactTime = trajParams.get("time_ratio_contact", params)*endTime;
-        double afterTime = trajParams.get("time_ratio_after", params)*endTime;
-        double swap2Time = trajParams.get("time_ratio_swap2", params)*endTime;
+        double endTime = trajParams.get(slotLength, params);
+        double swap1Time = trajParams.get(slotSwap1, params)*endTime;
+        double beforeTime = trajParams.get(slotBefore, params)*endTime;
+        double contactTime = trajParams.get(slotContact, params)*endTime;
+        double afterTime = trajParams.get(slotAfter, params)*endTime;
+        double swap2Time = trajParams.get(slotSwap2, params)*endTime;
         
         //Initialize state splines
         Trajectories traj = TrajectoriesInit();
@@ -253,25 +279,25 @@ TrajectoryGeneration::GenerationFunc TrajKickDouble::funcGeneration(
         
         //Starting in static double support pose
         trajParams.trajectoriesAssign(
-            traj, 0.0, "static_double", params);
+            traj, 0.0, staticSlots, params);
         //First double to single support swap
         trajParams.trajectoriesAssign(
-            traj, swap1Time, "swap1", params);
+            traj, swap1Time, swap1Slots, params);
         //Before kick (retract)
         trajParams.trajectoriesAssign(
-            traj, beforeTime, "before", params);
+            traj, beforeTime, beforeSlots, params);
         //Kick ball contact time
         trajParams.trajectoriesAssign(
-            traj, contactTime, "contact", params);
+            traj, contactTime, contactSlots, params);
         //After kick
         trajParams.trajectoriesAssign(
-            traj, afterTime, "after", params);
+            traj, afterTime, afterSlots, params);
         //Last single to double support swap
         trajParams.trajectoriesAssign(
-            traj, swap2Time, "swap2", params);
+            traj, swap2Time, swap2Slots, params);
         //Ending in double support pose
         trajParams.trajectoriesAssign(
-            traj, endTime, "static_double", params);
+            traj, endTime, staticSlots, params);
         
         return traj;
     };
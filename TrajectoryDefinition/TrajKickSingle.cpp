@@ -188,13 +188,34 @@ void TrajKickSingle::initializeParameters(
 TrajectoryGeneration::GenerationFunc TrajKickSingle::funcGeneration(
     const TrajectoryParameters& trajParams)
 {
-    return [&trajParams](const Eigen::VectorXd& params) -> Trajectories {
+    //Resolve parameters slots once
+    size_t slotLength = trajParams.slot("time_length");
+    size_t slotBefore1 = trajParams.slot("time_ratio_before1");
+    size_t slotBefore2 = trajParams.slot("time_ratio_before2");
+    size_t slotContact = trajParams.slot("time_ratio_contact");
+    size_t slotAfter = trajParams.slot("time_ratio_after");
+    TrajectoryParameters::CartesianSlots staticSlots = 
+        trajParams.cartesianSlots("static_single");
+    TrajectoryParameters::CartesianSlots before1Slots = 
+        trajParams.cartesianSlots("before1");
+    TrajectoryParameters::CartesianSlots before2Slots = 
+        trajParams.cartesianSlots("before2");
+    TrajectoryParameters::CartesianSlots contactSlots = 
+        trajParams.cartesianSlots("contact");
+    TrajectoryParameters::CartesianSlots afterSlots = 
+        trajParams.cartesianSlots("after");
+
+    return [&trajParams, 
+        slotLength, slotBefore1, slotBefore2, slotContact, slotAfter,
+        staticSlots, before1Slots, before2Slots, contactSlots, afterSlots]
+        (const Eigen::VectorXd& params) -> Trajectories 
+    {
         //Retrieve timing parameters
-        double endTime = trajParams.get("time_length", params);
-        double before1Time = trajParams.get("time_ratio_before1", params)*endTime;
-        double before2Time = trajParams.get("time_ratio_before2", params)*endTime;
-        double contactTime = trajParams.get("time_ratio_contact", params)*endTime;
-        double afterTime = trajParams.get("time_ratio_after", params)*endTime;
+        double endTime = trajParams.get(slotLength, params);
+        double before1Time = trajParams.get(slotBefore1, params)*endTime;
+        double before2Time = trajParams.get(slotBefore2, params)*endTime;
+        double contactTime = trajParams.get(slotContact, params)*endTime;
+        double afterTime = trajParams.get(slotAfter, params)*endTime;
         
         //Initialize state splines
         Trajectories traj = TrajectoriesInit();
@@ -208,22 +229,22 @@ TrajectoryGeneration::GenerationFunc TrajKickSingle::funcGeneration(
 
         //Starting in static single support pose
         trajParams.trajectoriesAssign(
-            traj, 0.0, "static_single", params);
+            traj, 0.0, staticSlots, params);
         //Pre Kick 1
         trajParams.trajectoriesAssign(
-            traj, before1Time, "before1", params);
+            traj, before1Time, before1Slots, params);
         //Pre Kick 2
         trajParams.trajectoriesAssign(
-            traj, before2Time, "before2", params);
+            traj, before2Time, before2Slots, params);
         //Kick contact
         trajParams.trajectoriesAssign(
-            traj, contactTime, "contact", params);
+            traj, contactTime, contactSlots, params);
         //Post Kick
         trajParams.trajectoriesAssign(
-            traj, afterTime, "after", params);
+            traj, afterTime, afterSlots, params);
         //Ending in single support pose
         trajParams.trajectoriesAssign(
-            traj, endTime, "static_single", params);
+            traj, endTime, staticSlots, params);
 
         return traj;
     };
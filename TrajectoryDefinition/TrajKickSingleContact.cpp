@@ -196,17 +196,44 @@ void TrajKickSingleContact::initializeParameters(
 TrajectoryGeneration::GenerationFunc TrajKickSingleContact::funcGeneration(
     const TrajectoryParameters& trajParams)
 {
-    return [&trajParams](const Eigen::VectorXd& params) -> Trajectories {
+    //Resolve parameters slots once
+    size_t slotLength = trajParams.slot("time_length");
+    size_t slotRetract = trajParams.slot("time_ratio_retract");
+    size_t slotContactEnd = trajParams.slot("time_ratio_contact_end");
+    size_t slotKickXStart = trajParams.slot("kick_x_start");
+    size_t slotKickXEnd = trajParams.slot("kick_x_end");
+    size_t slotKickVelStart = trajParams.slot("kick_vel_start");
+    size_t slotKickVelEnd = trajParams.slot("kick_vel_end");
+    size_t slotRecover = trajParams.slot("time_ratio_recover");
+    TrajectoryParameters::CartesianSlots staticSlots = 
+        trajParams.cartesianSlots("static_single");
+    TrajectoryParameters::CartesianSlots retractSlots = 
+        trajParams.cartesianSlots("retract");
+    TrajectoryParameters::CartesianSlots contactStartSlots = 
+        trajParams.cartesianSlots("contact_start");
+    TrajectoryParameters::CartesianSlots contactEndSlots = 
+        trajParams.cartesianSlots("contact_end");
+    TrajectoryParameters::CartesianSlots recoverSlots = 
+        trajParams.cartesianSlots("recover");
+
+    return [&trajParams, 
+        slotLength, slotRetract, slotContactEnd, 
+        slotKickXStart, slotKickXEnd, 
+        slotKickVelStart, slotKickVelEnd, slotRecover,
+        staticSlots, retractSlots, contactStartSlots, 
+        contactEndSlots, recoverSlots]
+        (const Eigen::VectorXd& params) -> Trajectories 
+    {
         //Retrieve timing parameters
-        double endTime = trajParams.get("time_length", params);
-        double retractTime = trajParams.get("time_ratio_retract", params)*endTime;
-        double contactEndTime = trajParams.get("time_ratio_contact_end", params)*endTime;
+        double endTime = trajParams.get(slotLength, params);
+        double retractTime = trajParams.get(slotRetract, params)*endTime;
+        double contactEndTime = trajParams.get(slotContactEnd, params)*endTime;
         double contactStartTime = contactEndTime - splineComputeTime(
-            trajParams.get("kick_x_start", params),
-            trajParams.get("kick_x_end", params),
-            trajParams.get("kick_vel_start", params),
-            trajParams.get("kick_vel_end", params));
-        double recoverTime = trajParams.get("time_ratio_recover", params)*endTime;
+            trajParams.get(slotKickXStart, params),
+            trajParams.get(slotKickXEnd, params),
+            trajParams.get(slotKickVelStart, params),
+            trajParams.get(slotKickVelEnd, params));
+        double recoverTime = trajParams.get(slotRecover, params)*endTime;
         
         //Initialize state splines
         Trajectories traj = TrajectoriesInit();
@@ -220,22 +247,22 @@ TrajectoryGeneration::GenerationFunc TrajKickSingleContact::funcGeneration(
 
         //Starting in static single support pose
         trajParams.trajectoriesAssign(
-            traj, 0.0, "static_single", params);
+            traj, 0.0, staticSlots, params);
         //Pre Kick
         trajParams.trajectoriesAssign(
-            traj, retractTime, "retract", params);
+            traj, retractTime, retractSlots, params);
         //Kick begin
         trajParams.trajectoriesAssign(
-            traj, contactStartTime, "contact_start", params);
+            traj, contactStartTime, contactStartSlots, params);
         //Kick end
         trajParams.trajectoriesAssign(
-            traj, contactEndTime, "contact_end", params);
+            traj, contactEndTime, contactEndSlots, params);
         //Post Kick
         trajParams.trajectoriesAssign(
-            traj, recoverTime, "recover", params);
+            traj, recoverTime, recoverSlots, params);
         //Ending in single support pose
         trajParams.trajectoriesAssign(
-            traj, endTime, "static_single", params);
+            traj, endTime, staticSlots, params);
 
         return traj;
     };
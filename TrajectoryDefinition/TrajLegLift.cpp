@@ -149,12 +149,33 @@ void TrajLegLift::initializeParameters(
 TrajectoryGeneration::GenerationFunc TrajLegLift::funcGeneration(
     const TrajectoryParameters& trajParams)
 {
-    return [&trajParams](const Eigen::VectorXd& params) -> Trajectories {
+    //Resolve parameters slots once
+    size_t slotLength = trajParams.slot("time_length");
+    size_t slotBefore = trajParams.slot("time_ratio_before");
+    size_t slotSwap = trajParams.slot("time_ratio_swap");
+    size_t slotAfter = trajParams.slot("time_ratio_after");
+    TrajectoryParameters::CartesianSlots staticDoubleSlots = 
+        trajParams.cartesianSlots("static_double");
+    TrajectoryParameters::CartesianSlots beforeSlots = 
+        trajParams.cartesianSlots("before");
+    TrajectoryParameters::CartesianSlots swapSlots = 
+        trajParams.cartesianSlots("swap");
+    TrajectoryParameters::CartesianSlots afterSlots = 
+        trajParams.cartesianSlots("after");
+    TrajectoryParameters::CartesianSlots staticSingleSlots = 
+        trajParams.cartesianSlots("static_single");
+
+    return [&trajParams, 
+        slotLength, slotBefore, slotSwap, slotAfter,
+        staticDoubleSlots, beforeSlots, swapSlots, 
+        afterSlots, staticSingleSlots]
+        (const Eigen::VectorXd& params) -> Trajectories 
+    {
         //Retrieve timing parameters
-        double endTime = trajParams.get("time_length", params);
-        double beforeTime = trajParams.get("time_ratio_before", params)*endTime;
-        double swapTime = trajParams.get("time_ratio_swap", params)*endTime;
-        double afterTime = trajParams.get("time_ratio_after", params)*endTime;
+        double endTime = trajParams.get(slotLength, params);
+        double beforeTime = trajParams.get(slotBefore, params)*endTime;
+        double swapTime = trajParams.get(slotSwap, params)*endTime;
+        double afterTime = trajParams.get(slotAfter, params)*endTime;
         
         //Initialize state splines
         Trajectories traj = TrajectoriesInit();
@@ -170,19 +191,19 @@ TrajectoryGeneration::GenerationFunc TrajLegLift::funcGeneration(
 
         //Starting in static double support pose
         trajParams.trajectoriesAssign(
-            traj, 0.0, "static_double", params);
+            traj, 0.0, staticDoubleSlots, params);
         //Pre swap time
         trajParams.trajectoriesAssign(
-            traj, beforeTime, "before", params);
+            traj, beforeTime, beforeSlots, params);
         //Support swap
         trajParams.trajectoriesAssign(
-            traj, swapTime, "swap", params);
+            traj, swapTime, swapSlots, params);
         //Post swap time
         trajParams.trajectoriesAssign(
-            traj, afterTime, "after", params);
+            traj, afterTime, afterSlots, params);
         //Ending in single support pose
         trajParams.trajectoriesAssign(
-            traj, endTime, "static_single", params);
+            traj, endTime, staticSingleSlots, params);
 
         return traj;
     };
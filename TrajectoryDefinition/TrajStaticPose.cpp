@@ -28,7 +28,13 @@ void TrajStaticPose::initializeParameters(
 TrajectoryGeneration::GenerationFunc TrajStaticPose::funcGeneration(
     const TrajectoryParameters& trajParams)
 {
-    return [&trajParams](const Eigen::VectorXd& params) -> Trajectories {
+    //Resolve parameters slots once
+    TrajectoryParameters::CartesianSlots poseSlots = 
+        trajParams.cartesianSlots("static_pose");
+
+    return [&trajParams, poseSlots]
+        (const Eigen::VectorXd& params) -> Trajectories 
+    {
         //Dummy time length
         double endTime = 0.1;
         
@@ -44,9 +50,9 @@ TrajectoryGeneration::GenerationFunc TrajStaticPose::funcGeneration(
 
         //Start and End in the static single support pose
         trajParams.trajectoriesAssign(
-            traj, 0.0, "static_pose", params);
+            traj, 0.0, poseSlots, params);
         trajParams.trajectoriesAssign(
-            traj, endTime, "static_pose", params);
+            traj, endTime, poseSlots, params);
 
         return traj;
     };
@@ -144,11 +144,26 @@ void TrajWalk::initializeParameters(
 TrajectoryGeneration::GenerationFunc TrajWalk::funcGeneration(
     const TrajectoryParameters& trajParams)
 {
-    return [&trajParams](const Eigen::VectorXd& params) -> Trajectories {
+    //Resolve parameters slots once
+    size_t slotLength = trajParams.slot("time_length");
+    size_t slotSwap = trajParams.slot("time_ratio_swap");
+    size_t slotApex = trajParams.slot("time_ratio_apex");
+    TrajectoryParameters::CartesianSlots dsSlots = 
+        trajParams.cartesianSlots("leftds");
+    TrajectoryParameters::CartesianSlots ssSlots = 
+        trajParams.cartesianSlots("leftss");
+    TrajectoryParameters::CartesianSlots apexSlots = 
+        trajParams.cartesianSlots("leftapex");
+
+    return [&trajParams, 
+        slotLength, slotSwap, slotApex,
+        dsSlots, ssSlots, apexSlots]
+        (const Eigen::VectorXd& params) -> Trajectories 
+    {
         //Retrieve timing parameters
-        double cycleLength = trajParams.get("time_length", params);
-        double swapRatio = trajParams.get("time_ratio_swap", params);
-        double apexRatio = trajParams.get("time_ratio_apex", params);
+        double cycleLength = trajParams.get(slotLength, params);
+        double swapRatio = trajParams.get(slotSwap, params);
+        double apexRatio = trajParams.get(slotApex, params);
         //Compute timing points
         double leftDoubleSupportTime = 0.0;
         double leftSingleSupportTime = 0.5*cycleLength*swapRatio;
@@ -178,27 +193,27 @@ TrajectoryGeneration::GenerationFunc TrajWalk::funcGeneration(
 
         //Left double support
         trajParams.trajectoriesAssign(
-            traj, leftDoubleSupportTime, "leftds", params);
+            traj, leftDoubleSupportTime, dsSlots, params);
         //Left single support
         trajParams.trajectoriesAssign(
-            traj, leftSingleSupportTime, "leftss", params);
+            traj, leftSingleSupportTime, ssSlots, params);
         //Left apex
         trajParams.trajectoriesAssign(
-            traj, leftApexTime, "leftapex", params);
+            traj, leftApexTime, apexSlots, params);
         //Right double support
         trajParams.trajectoriesAssign(
-            traj, rightDoubleSupportTime, "leftds", params, true, true);
+            traj, rightDoubleSupportTime, dsSlots, params, true, true);
         trajParams.trajectoriesAssign(
-            traj, rightDoubleSupportTime, "leftds", params, false, true);
+            traj, rightDoubleSupportTime, dsSlots, params, false, true);
         //Right single support
         trajParams.trajectoriesAssign(
-            traj, rightSingleSupportTime, "leftss", params, false, true);
+            traj, rightSingleSupportTime, ssSlots, params, false, true);
         //Right apex
         trajParams.trajectoriesAssign(
-            traj, rightApexTime, "leftapex", params, false, true);
+            traj, rightApexTime, apexSlots, params, false, true);
         //Left double support 2
         trajParams.trajectoriesAssign(
-            traj, leftDoubleSupport2Time, "leftds", params, true, false);
+            traj, leftDoubleSupport2Time, dsSlots, params, true, false);
     
         return traj;
     };
@@ -1,6 +1,15 @@
 #include <stdexcept>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
 #include <libcmaes/cmaes.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "TrajectoryGeneration/TrajectoryGeneration.hpp"
+#include "Utils/EvaluationFarm.hpp"
+#include "Utils/FitnessSurrogate.hpp"
 #include "Utils/FileModelParameters.h"
 #include "Utils/time.h"
 #include "Model/NamesModel.h"
@@ -8,10 +17,57 @@
 
 namespace Leph {
 
+/**
+ * Cost returned above the cost limit for
+ * all aborted evaluations. Greater than any
+ * finished trajectory cost so that aborted
+ * candidates are ranked last and tied.
+ */
+static const double CostLimitPenalty = 1e9;
+
+/**
+ * Version of the scoring implementation
+ * hashed into fitness archives configuration.
+ * To be incremented when scores change so
+ * that previous archives are rejected.
+ */
+static const uint64_t ScoringVersion = 2;
+
+/**
+ * Combine given matrix and names map
+ * into given configuration hash
+ */
+static uint64_t hashModelData(
+    const Eigen::MatrixXd& data,
+    const std::map<std::string, size_t>& names,
+    uint64_t hash)
+{
+    for (const auto& it : names) {
+        hash = FitnessArchive::hashData(
+            it.first.data(), it.first.size(), hash);
+        hash = FitnessArchive::hashData(
+            &(it.second), sizeof(it.second), hash);
+    }
+    for (size_t i=0;i<(size_t)data.rows();i++) {
+        for (size_t j=0;j<(size_t)data.cols();j++) {
+            double value = data(i, j);
+            hash = FitnessArchive::hashData(
+                &value, sizeof(value), hash);
+        }
+    }
+    return hash;
+}
+
 TrajectoryGeneration::TrajectoryGeneration(RobotType type,
     const std::string& modelParamsPath) :
     _type(type),
     _modelParametersPath(modelParamsPath),
+    _jointData(),
+    _jointName(),
+    _inertiaData(),
+    _inertiaName(),
+    _geometryData(),
+    _geometryName(),
     _initialParameters(),
     _normCoefs(),
     _generateFunc(),
@@ -26,8 +82,35 @@ TrajectoryGeneration::TrajectoryGeneration(RobotType type,
     _bestTraj(),
     _bestParams(),
     _bestScore(0.0),
-    _countIteration(1)
+    _countIteration(1),
+    _checkpointFileName(),
+    _checkpointIterations(100),
+    _checkpoint(),
+    _isWarmRestart(false),
+    _farmLocalWorkers(0),
+    _farmRemoteWorkers(),
+    _farmBatchSize(1),
+    _farmTimeout(-1.0),
+    _isSurrogate(false),
+    _surrogateControlRatio(0.2),
+    _surrogateMinCorrelation(0.5),
+    _surrogateEvaluationCount(0),
+    _surrogateSavedCount(0),
+    _archive(),
+    _archiveFileName(),
+    _mutexContexts(),
+    _contexts(),
+    _freeContexts(),
+    _stats({0, 0, 0, 0.0, 0.0})
 {
+    //Load model parameters
+    if (_modelParametersPath != "") {
+        ReadModelParameters(
+            _modelParametersPath,
+            _jointData, _jointName,
+            _inertiaData, _inertiaName,
+            _geometryData, _geometryName);
+    }
 }
         
 void TrajectoryGeneration::setInitialParameters(
@@ -207,62 +290,114 @@ void TrajectoryGeneration::save(
         
 double TrajectoryGeneration::scoreTrajectory(
     const Eigen::VectorXd& params,
-    bool verbose) const
+    bool verbose,
+    double costLimit,
+    double timeStep) const
 {
-    double cost = checkParameters(params);
+    //Verbose scoring is always computed
+    //for display
+    double cost;
+    if (!verbose && archiveLookup(false, params, cost)) {
+        return cost;
+    }
+    auto timeBegin = std::chrono::steady_clock::now();
+    cost = checkParameters(params);
     if (cost > 0.0) {
         if (verbose) {
             std::cout 
                 << "Error checkParameters() cost=" 
                 << cost << std::endl;
         }
-        return cost;
     } else {
         Trajectories traj = generateTrajectory(params);
-        return scoreTrajectory(params, traj, verbose);
+        cost = scoreTrajectory(params, traj, 
+            verbose, costLimit, timeStep);
     }
+    //Only full resolution and not
+    //aborted costs are archived
+    if (timeStep <= 0.01 && (costLimit < 0.0 || cost <= costLimit)) {
+        archiveStore(false, params, cost, 
+            std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - timeBegin).count());
+    }
+
+    return cost;
 }
 double TrajectoryGeneration::scoreTrajectory(
     const Eigen::VectorXd& params,
     const Trajectories& traj,
-    bool verbose) const
+    bool verbose,
+    double costLimit,
+    double timeStep) const
 {
-    //Load model parameters
-    Eigen::MatrixXd jointData;
-    std::map<std::string, size_t> jointName;
-    Eigen::MatrixXd inertiaData;
-    std::map<std::string, size_t> inertiaName;
-    Eigen::MatrixXd geometryData;
-    std::map<std::string, size_t> geometryName;
-    if (_modelParametersPath != "") {
-        ReadModelParameters(
-            _modelParametersPath,
-            jointData, jointName,
-            inertiaData, inertiaName,
-            geometryData, geometryName);
-    }
-    //Joint Model for each DOF
-    std::map<std::string, JointModel> joints;
-    for (const std::string& name : NamesDOF) {
-        joints[name] = JointModel();
-        if (
-            _modelParametersPath != "" && 
-            jointName.count(name) > 0
-        ) {
-            joints[name].setParameters(
-                jointData.row(jointName.at(name)).transpose());
-        } 
+    auto timeBegin = std::chrono::steady_clock::now();
+    EvaluationContext* context = acquireContext(false);
+    auto timeSetup = std::chrono::steady_clock::now();
+    double cost;
+    try {
+        cost = scoreTrajectoryContext(
+            *context, params, traj, 
+            verbose, costLimit, timeStep);
+    } catch (...) {
+        releaseContext(context, 0.0, 0.0);
+        throw;
     }
-    //Sigmaban fixed model
-    Leph::HumanoidFixedModel model(_type, 
-        inertiaData, inertiaName, 
-        geometryData, geometryName);
-    //Retrieve time bounds
+    auto timeEnd = std::chrono::steady_clock::now();
+    releaseContext(context, 
+        std::chrono::duration<double>(timeSetup - timeBegin).count(),
+        std::chrono::duration<double>(timeEnd - timeSetup).count());
+
+    return cost;
+}
+double TrajectoryGeneration::scoreTrajectoryContext(
+    EvaluationContext& context,
+    const Eigen::VectorXd& params,
+    const Trajectories& traj,
+    bool verbose,
+    double costLimit,
+    double timeStep) const
+{
+    HumanoidFixedModel& model = context.model;
+    const std::map<std::string, JointModel>& joints = context.joints;
+    //Build evaluation times and 
+    //associated cost weights
     double timeMin = traj.min();
     double timeMax = traj.max();
+    std::vector<double> times;
+    std::vector<double> weights;
+    if (timeStep <= 0.01) {
+        for (double t=timeMin;t<=timeMax;t+=0.01) {
+            times.push_back(t);
+            weights.push_back(1.0);
+        }
+    } else {
+        times = TrajectoriesTimeGrid(traj, timeStep);
+        for (size_t i=0;i<times.size();i++) {
+            if (i+1 < times.size()) {
+                weights.push_back((times[i+1] - times[i])/0.01);
+            } else {
+                weights.push_back(1.0);
+            }
+        }
+    }
     double cost = 0.0;
     std::vector<double> data;
-    for (double t=timeMin;t<=timeMax;t+=0.01) {
+    for (size_t i=0;i<times.size();i++) {
+        double t = times[i];
+        double weight = weights[i];
+        //Abort the evaluation if the candidate
+        //can not be better than the cost limit.
+        //The partial cost is not returned since
+        //it only depends on the abort time.
+        if (costLimit >= 0.0 && cost > costLimit) {
+            if (verbose) {
+                std::cout 
+                    << "Abort cost limit=" << costLimit 
+                    << " t=" << t << " cost=" 
+                    << cost << std::endl;
+            }
+            return costLimit + CostLimitPenalty;
+        }
         //Compute DOF targets
         Eigen::Vector3d trunkPos;
         Eigen::Vector3d trunkAxis;
@@ -281,14 +416,14 @@ double TrajectoryGeneration::scoreTrajectory(
                     << 1000.0 + costState 
                     << std::endl;
             }
-            cost += 1000.0 + costState;
+            cost += weight*(1000.0 + costState);
             continue;
         }
         //Compute kinematics
         Eigen::VectorXd dq;
         Eigen::VectorXd ddq;
         double boundIKDistance = 0.0;
-        bool isIKSuccess = TrajectoriesComputeKinematics(
+        bool isIKSuccess = context.kinematics.compute(
             t, traj, model, dq, ddq, &boundIKDistance);
         //Cost near IK bound
         double boundIKThreshold = 1e-2;
@@ -298,8 +433,8 @@ double TrajectoryGeneration::scoreTrajectory(
                     << "Warning boundIKDistance=" 
                     << boundIKDistance << std::endl;
             }
-            cost += 1000.0 
-                + 1000.0*(boundIKThreshold - boundIKDistance);
+            cost += weight*(1000.0 
+                + 1000.0*(boundIKThreshold - boundIKDistance));
         }
         if (!isIKSuccess) {
             if (verbose) {
@@ -307,7 +442,7 @@ double TrajectoryGeneration::scoreTrajectory(
                     << "Error checkIK() cost=" 
                     << 1000.0 << std::endl;
             }
-            cost += 1000.0;
+            cost += weight*1000.0;
             continue;
         }
         //Check Joint DOF
@@ -319,7 +454,7 @@ double TrajectoryGeneration::scoreTrajectory(
                     << 1000.0 + costDOF 
                     << std::endl;
             }
-            cost += 1000.0 + costDOF;
+            cost += weight*(1000.0 + costDOF);
             continue;
         }
         //Compute DOF torques
@@ -340,7 +475,7 @@ double TrajectoryGeneration::scoreTrajectory(
             torques = model.get().inverseDynamics(dq, ddq);
         }
         //Evaluate the trajectory
-        cost += score(
+        cost += weight*score(
             t, model, joints,
             torques, dq, ddq, 
             isDoubleSupport, supportFoot,
@@ -356,54 +491,60 @@ double TrajectoryGeneration::scoreSimulation(
     const Eigen::VectorXd& params,
     bool verbose) const
 {
-    double cost = checkParameters(params);
+    double cost;
+    if (!verbose && archiveLookup(true, params, cost)) {
+        return cost;
+    }
+    auto timeBegin = std::chrono::steady_clock::now();
+    cost = checkParameters(params);
     if (cost > 0.0) {
         if (verbose) {
             std::cout 
                 << "Error checkParameters() cost=" 
                 << cost << std::endl;
         }
-        return cost;
     } else {
         Trajectories traj = generateTrajectory(params);
-        return scoreSimulation(params, traj, verbose);
+        cost = scoreSimulation(params, traj, verbose);
     }
+    archiveStore(true, params, cost, 
+        std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - timeBegin).count());
+
+    return cost;
 }
 double TrajectoryGeneration::scoreSimulation(
     const Eigen::VectorXd& params,
     const Trajectories& traj,
     bool verbose) const
 {
-    //Load model parameters
-    Eigen::MatrixXd jointData;
-    std::map<std::string, size_t> jointName;
-    Eigen::MatrixXd inertiaData;
-    std::map<std::string, size_t> inertiaName;
-    Eigen::MatrixXd geometryData;
-    std::map<std::string, size_t> geometryName;
-    if (_modelParametersPath != "") {
-        ReadModelParameters(
-            _modelParametersPath,
-            jointData, jointName,
-            inertiaData, inertiaName,
-            geometryData, geometryName);
-    }
-    //Simulator and goal model initialization
-    Leph::HumanoidFixedModel modelGoal(
-        Leph::SigmabanModel,
-        inertiaData, inertiaName, 
-        geometryData, geometryName);
-    Leph::HumanoidSimulation sim(
-        Leph::SigmabanModel,
-        inertiaData, inertiaName,
-        geometryData, geometryName);
-    //Assign joint parameters
-    for (const std::string& name : Leph::NamesDOF) {
-        if (jointName.count(name) > 0) {
-            sim.jointModel(name).setParameters(
-                jointData.row(jointName.at(name)).transpose());
-        }
+    auto timeBegin = std::chrono::steady_clock::now();
+    EvaluationContext* context = acquireContext(true);
+    auto timeSetup = std::chrono::steady_clock::now();
+    double cost;
+    try {
+        cost = scoreSimulationContext(
+            *context, params, traj, verbose);
+    } catch (...) {
+        releaseContext(context, 0.0, 0.0);
+        throw;
     }
+    auto timeEnd = std::chrono::steady_clock::now();
+    releaseContext(context, 
+        std::chrono::duration<double>(timeSetup - timeBegin).count(),
+        std::chrono::duration<double>(timeEnd - timeSetup).count());
+
+    return cost;
+}
+double TrajectoryGeneration::scoreSimulationContext(
+    EvaluationContext& context,
+    const Eigen::VectorXd& params,
+    const Trajectories& traj,
+    bool verbose) const
+{
+    //Simulator and goal model
+    Leph::HumanoidFixedModel& modelGoal = *(context.modelGoal);
+    Leph::HumanoidSimulation& sim = *(context.sim);
     //Retrieve time bounds
     double timeMin = traj.min();
     double timeMax = traj.max();
@@ -588,6 +729,158 @@ double TrajectoryGeneration::scoreSimulation(
     return cost;
 }
         
+double TrajectoryGeneration::scoreRequest(
+    const Eigen::VectorXd& request) const
+{
+    if (request.size() < 3) {
+        throw std::logic_error(
+            "TrajectoryGeneration invalid evaluation request");
+    }
+    Eigen::VectorXd params = request.tail(request.size() - 3);
+    if (request(0) > 0.5) {
+        return scoreSimulation(params);
+    } else {
+        return scoreTrajectory(params, false, request(1), request(2));
+    }
+}
+        
+void TrajectoryGeneration::setCheckpoint(
+    const std::string& fileName,
+    unsigned int iterations)
+{
+    if (iterations == 0) {
+        throw std::logic_error(
+            "TrajectoryGeneration invalid checkpoint iterations");
+    }
+    _checkpointFileName = fileName;
+    _checkpointIterations = iterations;
+}
+        
+void TrajectoryGeneration::warmRestartFromCheckpoint(
+    const std::string& fileName)
+{
+    _checkpoint = CMAESCheckpoint();
+    _checkpoint.importBinary(fileName);
+    if (
+        _initialParameters.size() > 0 && 
+        _checkpoint.mean().size() != _initialParameters.size()
+    ) {
+        throw std::logic_error(
+            "TrajectoryGeneration invalid checkpoint dimension: "
+            + std::to_string(_checkpoint.mean().size()));
+    }
+    _isWarmRestart = true;
+}
+        
+void TrajectoryGeneration::setEvaluationWorkers(
+    unsigned int localWorkers,
+    const std::vector<std::string>& remoteWorkers,
+    unsigned int batchSize,
+    double timeout)
+{
+    if (batchSize == 0) {
+        throw std::logic_error(
+            "TrajectoryGeneration invalid worker batch size");
+    }
+    for (const std::string& address : remoteWorkers) {
+        size_t pos = address.rfind(':');
+        if (
+            pos == std::string::npos || 
+            pos == 0 || pos == address.size()-1
+        ) {
+            throw std::logic_error(
+                "TrajectoryGeneration invalid worker address: " 
+                + address);
+        }
+    }
+    _farmLocalWorkers = localWorkers;
+    _farmRemoteWorkers = remoteWorkers;
+    _farmBatchSize = batchSize;
+    _farmTimeout = timeout;
+}
+        
+void TrajectoryGeneration::serveEvaluations(unsigned int port) const
+{
+    EvaluationFarm::serveTCP(port, 
+        [this](const Eigen::VectorXd& request) {
+            return this->scoreRequest(request);
+        });
+}
+
+void TrajectoryGeneration::setSurrogate(
+    bool isEnabled,
+    double controlRatio,
+    double minCorrelation)
+{
+    if (controlRatio < 0.0 || controlRatio > 1.0) {
+        throw std::logic_error(
+            "TrajectoryGeneration invalid surrogate control ratio");
+    }
+    _isSurrogate = isEnabled;
+    _surrogateControlRatio = controlRatio;
+    _surrogateMinCorrelation = minCorrelation;
+}
+        
+unsigned long TrajectoryGeneration::surrogateEvaluationCount() const
+{
+    return _surrogateEvaluationCount;
+}
+unsigned long TrajectoryGeneration::surrogateSavedCount() const
+{
+    return _surrogateSavedCount;
+}
+
+void TrajectoryGeneration::setFitnessArchive(
+    const std::string& fileName,
+    const std::string& configName,
+    double quantum)
+{
+    //Evaluation configuration hash
+    uint64_t hash = FitnessArchive::hashData(
+        &ScoringVersion, sizeof(ScoringVersion));
+    int type = (int)_type;
+    hash = FitnessArchive::hashData(&type, sizeof(type), hash);
+    hash = FitnessArchive::hashData(
+        configName.data(), configName.size(), hash);
+    hash = hashModelData(_jointData, _jointName, hash);
+    hash = hashModelData(_inertiaData, _inertiaName, hash);
+    hash = hashModelData(_geometryData, _geometryName, hash);
+    _archive.reset(new FitnessArchive(quantum, hash));
+    _archiveFileName = fileName;
+    if (fileName != "" && std::ifstream(fileName).good()) {
+        _archive->importBinary(fileName);
+        std::cout << "Fitness archive loaded: " 
+            << _archive->size() << " entries" << std::endl;
+    }
+}
+        
+const FitnessArchive* TrajectoryGeneration::fitnessArchive() const
+{
+    return _archive.get();
+}
+        
+bool TrajectoryGeneration::archiveLookup(bool isSimulation,
+    const Eigen::VectorXd& params, double& cost) const
+{
+    if (!_archive) {
+        return false;
+    }
+    Eigen::VectorXd key(params.size() + 1);
+    key << (isSimulation ? 1.0 : 0.0), params;
+    return _archive->get(key, cost);
+}
+void TrajectoryGeneration::archiveStore(bool isSimulation,
+    const Eigen::VectorXd& params, 
+    double cost, double time) const
+{
+    if (!_archive) {
+        return;
+    }
+    Eigen::VectorXd key(params.size() + 1);
+    key << (isSimulation ? 1.0 : 0.0), params;
+    _archive->set(key, cost, Eigen::VectorXd(), time);
+}
+
 void TrajectoryGeneration::runOptimization(
     unsigned int maxIterations,
     unsigned int restart,
@@ -596,7 +889,9 @@ void TrajectoryGeneration::runOptimization(
     double lambda,
     unsigned int elitismLevel,
     unsigned int verboseIterations,
-    bool isForwardSimulationOptimization)
+    bool isForwardSimulationOptimization,
+    bool isCostBounding,
+    bool isMultiResolution)
 {
     //Retrieve initial parameters
     Eigen::VectorXd initParams = initialParameters();
@@ -605,25 +900,158 @@ void TrajectoryGeneration::runOptimization(
     //Initialization
     _countIteration = 1;
     _bestScore = -1.0;
+    //Warm restart from loaded checkpoint
+    //mean (not an exact state restore)
+    double sigma = lambda;
+    unsigned long long seed = 0;
+    if (_isWarmRestart) {
+        initParams = _checkpoint.mean().array() * normCoef.array();
+        sigma = _checkpoint.warmRestartSigma();
+        //A different seed is used to not
+        //replay already drawn samples
+        if (_checkpoint.seed() != 0) {
+            seed = _checkpoint.seed() + _checkpoint.totalIterations();
+        }
+        restart = (restart > _checkpoint.restart()) ? 
+            restart - _checkpoint.restart() : 0;
+        if (_checkpoint.bestParams().size() > 0) {
+            _bestParams = _checkpoint.bestParams().array() * normCoef.array();
+            _bestTraj = generateTrajectory(_bestParams);
+            _bestScore = _checkpoint.bestScore();
+        }
+        std::cout << "Warm restart from checkpoint:"
+            << " iteration=" << _checkpoint.totalIterations()
+            << " restart=" << _checkpoint.restart()
+            << " sigma=" << sigma 
+            << " bestScore=" << _checkpoint.bestScore() 
+            << std::endl;
+        _isWarmRestart = false;
+    } else {
+        _checkpoint = CMAESCheckpoint();
+    }
+    //Cost ceiling for inverse dynamics scoring.
+    //Only written by the progress function
+    //between two generation evaluations.
+    //Last seen CMA-ES iteration and population
+    //size are used to detect restarts.
+    double costLimit = -1.0;
+    long lastIteration = 0;
+    size_t lastPopulation = 0;
+    //Inverse dynamics scoring time step and 
+    //reference (maximum) CMA-ES step size for 
+    //multi resolution optimization.
+    //The coarsest time step is 
+    //maxStepFactor times the full resolution.
+    const unsigned int maxStepFactor = 5;
+    double timeStep = 0.01;
+    double sigmaRef = -1.0;
+    bool isCoarse = 
+        isMultiResolution && !isForwardSimulationOptimization;
+    if (isCoarse) {
+        timeStep = 0.01*maxStepFactor;
+    }
 
-    //Fitness function
-    libcmaes::FitFuncEigen fitness = 
-        [this, &normCoef, &isForwardSimulationOptimization]
+    //Evaluation farm and its request
+    //(flag, cost limit, time step and parameters)
+    std::unique_ptr<EvaluationFarm> farm;
+    //Surrogate pre-screening on normalized parameters
+    std::unique_ptr<FitnessSurrogate> surrogate;
+    if (_isSurrogate) {
+        surrogate.reset(new FitnessSurrogate(
+            300, 1.0, _surrogateControlRatio, 
+            _surrogateMinCorrelation));
+        //Seed with archived evaluations
+        if (_archive) {
+            double flag = isForwardSimulationOptimization ? 1.0 : 0.0;
+            for (const auto& entry : _archive->entries()) {
+                if (
+                    entry.params.size() == normCoef.size() + 1 &&
+                    entry.params(0) == flag
+                ) {
+                    surrogate->seed(
+                        entry.params.tail(normCoef.size()).array() 
+                        / normCoef.array(), entry.score);
+                }
+            }
+        }
+    }
+
+    //True evaluation function
+    libcmaes::FitFuncEigen evaluation = 
+        [this, &normCoef, &isForwardSimulationOptimization, 
+        &costLimit, &timeStep, &farm]
         (const Eigen::VectorXd& params) 
     {
-        if (isForwardSimulationOptimization) {
+        if (farm) {
+            Eigen::VectorXd request(params.size() + 3);
+            request(0) = isForwardSimulationOptimization ? 1.0 : 0.0;
+            request(1) = costLimit;
+            request(2) = timeStep;
+            request.tail(params.size()) = 
+                params.array() * normCoef.array();
+            double cost;
+            if (this->archiveLookup(isForwardSimulationOptimization, 
+                request.tail(params.size()), cost)
+            ) {
+                return cost;
+            }
+            auto timeBegin = std::chrono::steady_clock::now();
+            cost = farm->evaluate(request);
+            if (
+                isForwardSimulationOptimization ||
+                (timeStep <= 0.01 && (costLimit < 0.0 || cost <= costLimit))
+            ) {
+                this->archiveStore(isForwardSimulationOptimization,
+                    request.tail(params.size()), cost, 
+                    std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - timeBegin).count());
+            }
+            return cost;
+        } else if (isForwardSimulationOptimization) {
             return this->scoreSimulation(
                 params.array() * normCoef.array());
         } else {
             return this->scoreTrajectory(
-                params.array() * normCoef.array());
+                params.array() * normCoef.array(), 
+                false, costLimit, timeStep);
         }
     };
+    //Full resolution and not aborted true scores
+    //of current generation used to train the
+    //surrogate and to update its threshold
+    std::vector<double> surrogateScores;
+    std::mutex surrogateMutex;
+    //Fitness function
+    libcmaes::FitFuncEigen fitness = 
+        [&evaluation, &surrogate, &surrogateScores, &surrogateMutex,
+        &isForwardSimulationOptimization, &costLimit, &timeStep]
+        (const Eigen::VectorXd& params) 
+    {
+        if (!surrogate) {
+            return evaluation(params);
+        }
+        double score;
+        if (!surrogate->isPromising(params, score)) {
+            return score;
+        }
+        score = evaluation(params);
+        bool isValid = 
+            isForwardSimulationOptimization ||
+            (timeStep <= 0.01 && (costLimit < 0.0 || score <= costLimit));
+        surrogate->add(params, score, isValid);
+        if (isValid) {
+            std::lock_guard<std::mutex> lock(surrogateMutex);
+            surrogateScores.push_back(score);
+        }
+        return score;
+    };
     //Progress function
     libcmaes::ProgressFunc<
         libcmaes::CMAParameters<>, libcmaes::CMASolutions> progress = 
         [this, &filename, &normCoef, &verboseIterations,
-        &isForwardSimulationOptimization]
+        &isForwardSimulationOptimization, &isCostBounding, &costLimit,
+        &lastIteration, &lastPopulation, &isCoarse, &timeStep, &sigmaRef, &maxStepFactor, 
+        &surrogate, &surrogateScores]
         (const libcmaes::CMAParameters<>& cmaparams, 
         const libcmaes::CMASolutions& cmasols)
     {
@@ -639,11 +1067,95 @@ void TrajectoryGeneration::runOptimization(
             * normCoef.array();
         double score = 
             cmasols.get_best_seen_candidate().get_fvalue();
+        if (isCoarse) {
+            //Best seen candidates may have been scored 
+            //at coarse resolution. The generation best
+            //candidate is rescored at full resolution.
+            params = 
+                cmasols.best_candidate().get_x_dvec().array()
+                * normCoef.array();
+            score = cmasols.best_candidate().get_fvalue();
+            if (timeStep > 0.01) {
+                score = scoreTrajectory(params);
+            }
+        }
         if (_bestScore < 0.0 || _bestScore > score) {
             _bestParams = params;
             _bestTraj = generateTrajectory(params);
             _bestScore = score;
         }
+        //Save the CMA-ES state periodically
+        if (_checkpointFileName != "") {
+            _checkpoint.update(cmaparams, cmasols);
+            _checkpoint.setBest(
+                _bestParams.array() / normCoef.array(), _bestScore);
+            if (_checkpoint.totalIterations() % _checkpointIterations == 0) {
+                _checkpoint.exportBinary(_checkpointFileName);
+                if (_archive && _archiveFileName != "") {
+                    _archive->exportBinary(_archiveFileName);
+                }
+            }
+        }
+        //Refine the time step as CMA-ES 
+        //step size decreases
+        if (isCoarse) {
+            if (sigmaRef < 0.0 || sigmaRef < cmasols.sigma()) {
+                sigmaRef = cmasols.sigma();
+            }
+            double factor = std::ceil(
+                maxStepFactor*cmasols.sigma()/sigmaRef);
+            factor = std::max(1.0, 
+                std::min((double)maxStepFactor, factor));
+            if (std::fabs(0.01*factor - timeStep) > 1e-9) {
+                std::cout << "Scoring time step: " 
+                    << timeStep << " -> " << 0.01*factor 
+                    << std::endl;
+            }
+            timeStep = 0.01*factor;
+        }
+        //Update the cost limit to the worst 
+        //selected candidate of the generation.
+        //Bounding is disabled for next generation 
+        //on restart (population scale changes) or 
+        //if fewer than mu candidates have finished.
+        if (isCostBounding) {
+            bool isRestart = 
+                cmasols.niter() < lastIteration ||
+                (lastPopulation > 0 && 
+                cmasols.candidates().size() != lastPopulation);
+            lastIteration = cmasols.niter();
+            lastPopulation = cmasols.candidates().size();
+            std::vector<double> values;
+            for (const auto& candidate : cmasols.candidates()) {
+                double value = candidate.get_fvalue();
+                if (
+                    costLimit < 0.0 || 
+                    value < costLimit + CostLimitPenalty
+                ) {
+                    values.push_back(value);
+                }
+            }
+            size_t mu = (size_t)std::max(cmaparams.mu(), 1);
+            if (isRestart || values.size() < mu) {
+                costLimit = -1.0;
+            } else {
+                std::nth_element(values.begin(), 
+                    values.begin() + mu - 1, values.end());
+                costLimit = values[mu - 1];
+            }
+        }
+        //Refit the surrogate and update its
+        //threshold to the worst selected candidate.
+        //Predicted, coarse and aborted scores are
+        //not comparable and are excluded.
+        if (surrogate) {
+            surrogate->update(surrogateScores, std::max(cmaparams.mu(), 1));
+            surrogateScores.clear();
+            std::cout << "Surrogate: active=" << surrogate->isActive()
+                << " correlation=" << surrogate->correlation()
+                << " evaluations=" << surrogate->evaluationCount()
+                << " saved=" << surrogate->savedCount() << std::endl;
+        }
         //Save current best found
         if (_countIteration % verboseIterations == 0) {
             std::cout << "============" 
@@ -673,6 +1185,16 @@ void TrajectoryGeneration::runOptimization(
             std::cout << "============" 
                 << std::endl;
         }
+        //Display and reset evaluation timing
+        EvaluationStats stats = evaluationStats();
+        resetEvaluationStats();
+        if (stats.count > 0) {
+            std::cout << "Evaluations: " << stats.count 
+                << " contexts: " << stats.contexts 
+                << " setup: " << 1000.0*stats.setupTime/stats.count 
+                << "ms scoring: " << 1000.0*stats.scoringTime/stats.count
+                << "ms (mean per evaluation)" << std::endl;
+        }
         _countIteration++;
 
         //Call default CMA-ES default progress function
@@ -691,11 +1213,40 @@ void TrajectoryGeneration::runOptimization(
     std::cout << "Init Score: " << initScore << std::endl;
     std::cout << "Dimension:  " << initParams.size() << std::endl;
     std::cout << "============" << std::endl;
+    resetEvaluationStats();
+
+    //Start evaluation workers. Local workers are
+    //forked before any CMA-ES fitness thread.
+    //Enough fitness threads are used to
+    //fill all workers batches.
+#ifdef _OPENMP
+    int ompThreads = omp_get_max_threads();
+#endif
+    if (_farmLocalWorkers > 0 || _farmRemoteWorkers.size() > 0) {
+        farm.reset(new EvaluationFarm(
+            [this](const Eigen::VectorXd& request) {
+                return this->scoreRequest(request);
+            }, _farmBatchSize, _farmTimeout));
+        //One idle spare per local worker since
+        //no process can be forked afterwards
+        farm->addLocalWorkers(_farmLocalWorkers, _farmLocalWorkers);
+        for (const std::string& address : _farmRemoteWorkers) {
+            size_t pos = address.rfind(':');
+            farm->addTCPWorker(address.substr(0, pos), 
+                std::stoi(address.substr(pos+1)));
+        }
+        std::cout << "Evaluation workers: " << farm->size() 
+            << " batch: " << _farmBatchSize << std::endl;
+#ifdef _OPENMP
+        omp_set_num_threads(std::max(ompThreads, 
+            (int)(farm->size()*_farmBatchSize)));
+#endif
+    }
 
     //CMAES initialization
     libcmaes::CMAParameters<> cmaparams(
         initParams.array() / normCoef.array(), 
-        lambda, populationSize);
+        sigma, populationSize, seed);
     cmaparams.set_quiet(false);
     cmaparams.set_mt_feval(true);
     cmaparams.set_str_algo("abipop");
@@ -706,6 +1257,14 @@ void TrajectoryGeneration::runOptimization(
     //Run optimization
     libcmaes::CMASolutions cmasols = 
         libcmaes::cmaes<>(fitness, cmaparams, progress);
+    if (farm) {
+        std::cout << "Evaluation workers failures: " 
+            << farm->failureCount() << std::endl;
+        farm.reset();
+#ifdef _OPENMP
+        omp_set_num_threads(ompThreads);
+#endif
+    }
 
     //Retrieve best Trajectories and score
     Eigen::VectorXd params = 
@@ -713,6 +1272,37 @@ void TrajectoryGeneration::runOptimization(
         * normCoef.array();
     double score = 
         cmasols.get_best_seen_candidate().get_fvalue();
+    if (surrogate) {
+        //Best seen score may be predicted
+        if (isForwardSimulationOptimization) {
+            score = scoreSimulation(params);
+        } else {
+            score = scoreTrajectory(params);
+        }
+        _surrogateEvaluationCount = surrogate->evaluationCount();
+        _surrogateSavedCount = surrogate->savedCount();
+        std::cout << "Surrogate true evaluations: " 
+            << _surrogateEvaluationCount
+            << " saved: " << _surrogateSavedCount << std::endl;
+    }
+    if (isCoarse) {
+        //Final full resolution verification
+        score = scoreTrajectory(params);
+        if (_bestParams.size() > 0) {
+            _bestScore = scoreTrajectory(_bestParams);
+            if (_bestScore <= score) {
+                params = _bestParams;
+                score = _bestScore;
+            }
+        }
+    } else if (
+        _bestParams.size() > 0 && 
+        _bestScore >= 0.0 && _bestScore < score
+    ) {
+        //Keep best found before warm restart
+        params = _bestParams;
+        score = _bestScore;
+    }
     _bestParams = params;
     _bestTraj = generateTrajectory(params);
     _bestScore = score;
@@ -724,8 +1314,180 @@ void TrajectoryGeneration::runOptimization(
         << _bestScore << std::endl;
     std::cout << "****** BestParams: " 
         << _bestParams.transpose() << std::endl;
+    //Save final state
+    if (_checkpointFileName != "") {
+        _checkpoint.setBest(
+            _bestParams.array() / normCoef.array(), _bestScore);
+        _checkpoint.exportBinary(_checkpointFileName);
+    }
+    if (_archive) {
+        std::cout << "****** Archive: " << _archive->size() 
+            << " entries hits=" << _archive->hits()
+            << " misses=" << _archive->misses() << std::endl;
+        if (_archiveFileName != "") {
+            _archive->exportBinary(_archiveFileName);
+        }
+    }
+    std::cout << "############" 
+        << std::endl;
+}
+
+unsigned long TrajectoryGeneration::runRefinement(
+    unsigned int maxIterations,
+    const std::string& filename,
+    double diffStep,
+    unsigned int memorySize,
+    unsigned int verboseIterations)
+{
+    const Eigen::VectorXd normCoef = normalizationCoefs();
+    //Maximum step length in normalized space
+    const double maxStepLength = 0.1;
+    //Armijo sufficient decrease coefficient
+    const double armijoCoef = 1e-4;
+    const unsigned int maxLineSearch = 20;
+    //Starting point in normalized space
+    //The starting point is always rescored since the
+    //best score may come from the forward simulation
+    Eigen::VectorXd params;
+    if (_bestParams.size() > 0 && _bestScore >= 0.0) {
+        params = _bestParams.array() / normCoef.array();
+    } else {
+        params = initialParameters().array() / normCoef.array();
+    }
+    double score = scoreTrajectory(params.array() * normCoef.array());
+    unsigned long count = 1;
+    double initScore = score;
+    Eigen::VectorXd gradient = 
+        scoreGradient(params, score, normCoef, diffStep);
+    count += params.size();
+    
+    //L-BFGS last displacements and gradient changes
+    std::vector<Eigen::VectorXd> memDeltaParams;
+    std::vector<Eigen::VectorXd> memDeltaGradients;
+    for (unsigned int k=0;k<maxIterations;k++) {
+        //Two loop recursion for the
+        //inverse hessian approximation
+        Eigen::VectorXd direction = -gradient;
+        std::vector<double> alphas(memDeltaParams.size());
+        for (int i=(int)memDeltaParams.size()-1;i>=0;i--) {
+            double rho = 1.0/memDeltaGradients[i].dot(memDeltaParams[i]);
+            alphas[i] = rho*memDeltaParams[i].dot(direction);
+            direction -= alphas[i]*memDeltaGradients[i];
+        }
+        if (memDeltaParams.size() > 0) {
+            direction *= 
+                memDeltaParams.back().dot(memDeltaGradients.back())
+                / memDeltaGradients.back().squaredNorm();
+        }
+        for (size_t i=0;i<memDeltaParams.size();i++) {
+            double rho = 1.0/memDeltaGradients[i].dot(memDeltaParams[i]);
+            double beta = rho*memDeltaGradients[i].dot(direction);
+            direction += (alphas[i] - beta)*memDeltaParams[i];
+        }
+        //Fall back to steepest descent
+        if (direction.dot(gradient) >= 0.0) {
+            direction = -gradient;
+            memDeltaParams.clear();
+            memDeltaGradients.clear();
+        }
+        if (direction.norm() > maxStepLength) {
+            direction *= maxStepLength/direction.norm();
+        }
+        double slope = direction.dot(gradient);
+        if (slope >= 0.0) {
+            break;
+        }
+        //Backtracking line search
+        bool isFound = false;
+        Eigen::VectorXd newParams;
+        double newScore = 0.0;
+        double step = 1.0;
+        for (unsigned int i=0;i<maxLineSearch;i++) {
+            newParams = params + step*direction;
+            newScore = scoreTrajectory(
+                newParams.array() * normCoef.array());
+            count++;
+            if (newScore <= score + armijoCoef*step*slope) {
+                isFound = true;
+                break;
+            }
+            step *= 0.5;
+        }
+        if (!isFound) {
+            break;
+        }
+        //Update the approximation
+        Eigen::VectorXd newGradient = 
+            scoreGradient(newParams, newScore, normCoef, diffStep);
+        count += params.size();
+        Eigen::VectorXd deltaParams = newParams - params;
+        Eigen::VectorXd deltaGradient = newGradient - gradient;
+        if (deltaParams.dot(deltaGradient) > 1e-12) {
+            memDeltaParams.push_back(deltaParams);
+            memDeltaGradients.push_back(deltaGradient);
+            if (memDeltaParams.size() > memorySize) {
+                memDeltaParams.erase(memDeltaParams.begin());
+                memDeltaGradients.erase(memDeltaGradients.begin());
+            }
+        }
+        params = newParams;
+        score = newScore;
+        gradient = newGradient;
+        if (verboseIterations > 0 && (k+1) % verboseIterations == 0) {
+            std::cout << "Refinement iteration: " << k+1
+                << " score: " << score
+                << " gradient: " << gradient.norm()
+                << " scorings: " << count << std::endl;
+        }
+    }
+
+    //Update best found if the refinement has
+    //improved its inverse dynamics score
+    if (_bestParams.size() == 0 || _bestScore < 0.0 || score < initScore) {
+        _bestParams = params.array() * normCoef.array();
+        _bestTraj = generateTrajectory(_bestParams);
+        _bestScore = score;
+    }
+    std::cout << "############" 
+        << std::endl;
+    save(filename, _bestTraj, _bestParams);
+    std::cout << "****** Refinement InitScore: " 
+        << initScore << std::endl;
+    std::cout << "****** Refinement BestScore: " 
+        << _bestScore << std::endl;
+    std::cout << "****** Refinement Scorings: " 
+        << count << std::endl;
     std::cout << "############" 
         << std::endl;
+
+    return count;
+}
+
+Eigen::VectorXd TrajectoryGeneration::scoreGradient(
+    const Eigen::VectorXd& params,
+    double score,
+    const Eigen::VectorXd& normCoef,
+    double diffStep) const
+{
+    size_t size = params.size();
+    //One scoring per dimension. The step is
+    //reversed if it crosses parameters bounds
+    //whose penalty is not differentiable.
+    Eigen::VectorXd gradient(size);
+#pragma omp parallel for schedule(dynamic)
+    for (size_t i=0;i<size;i++) {
+        double step = diffStep;
+        Eigen::VectorXd delta = params;
+        delta(i) += step;
+        if (checkParameters(delta.array() * normCoef.array()) > 0.0) {
+            step = -diffStep;
+            delta(i) = params(i) + step;
+        }
+        gradient(i) = (scoreTrajectory(
+            delta.array() * normCoef.array()) - score)/step;
+    }
+
+    return gradient;
 }
         
 const Trajectories& TrajectoryGeneration::bestTrajectories() const
@@ -740,6 +1502,139 @@ double TrajectoryGeneration::bestScore() const
 {
     return _bestScore;
 }
+        
+TrajectoryGeneration::EvaluationStats TrajectoryGeneration::
+    evaluationStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutexContexts);
+    EvaluationStats stats = _stats;
+    stats.contexts = _contexts.size();
+    return stats;
+}
+void TrajectoryGeneration::resetEvaluationStats()
+{
+    std::lock_guard<std::mutex> lock(_mutexContexts);
+    _stats = {0, _stats.totalCount, _contexts.size(), 0.0, 0.0};
+}
+        
+TrajectoryGeneration::EvaluationContext::EvaluationContext(
+    RobotType type,
+    const Eigen::MatrixXd& inertiaData,
+    const std::map<std::string, size_t>& inertiaName,
+    const Eigen::MatrixXd& geometryData,
+    const std::map<std::string, size_t>& geometryName) :
+    model(type, 
+        inertiaData, inertiaName, 
+        geometryData, geometryName),
+    modelInitDOF(),
+    kinematics(),
+    joints(),
+    modelGoal(),
+    modelGoalInitDOF(),
+    sim(),
+    simInitState()
+{
+    modelInitDOF = model.get().getDOFVect();
+}
+        
+TrajectoryGeneration::EvaluationContext* TrajectoryGeneration::
+    acquireContext(bool isSimulation) const
+{
+    EvaluationContext* context = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_mutexContexts);
+        if (_freeContexts.size() > 0) {
+            context = _freeContexts.back();
+            _freeContexts.pop_back();
+        }
+    }
+    //Build a new context outside the lock
+    //since URDF parsing is expensive
+    if (context == nullptr) {
+        std::unique_ptr<EvaluationContext> newContext(
+            new EvaluationContext(_type,
+                _inertiaData, _inertiaName, 
+                _geometryData, _geometryName));
+        //Joint Model for each DOF
+        for (const std::string& name : NamesDOF) {
+            newContext->joints[name] = JointModel();
+            if (_jointName.count(name) > 0) {
+                newContext->joints[name].setParameters(
+                    _jointData.row(_jointName.at(name)).transpose());
+            } 
+        }
+        context = newContext.get();
+        std::lock_guard<std::mutex> lock(_mutexContexts);
+        _contexts.push_back(std::move(newContext));
+    }
+    //The context is given back to the free list
+    //if its setup fails. A partially built
+    //simulation is discarded to be rebuilt.
+    try {
+        setupContext(*context, isSimulation);
+    } catch (...) {
+        if (isSimulation) {
+            context->sim.reset();
+            context->modelGoal.reset();
+        }
+        std::lock_guard<std::mutex> lock(_mutexContexts);
+        _freeContexts.push_back(context);
+        throw;
+    }
+
+    return context;
+}
+void TrajectoryGeneration::setupContext(
+    EvaluationContext& context, bool isSimulation) const
+{
+    //Reset the fixed model state
+    context.model.setSupportFoot(
+        HumanoidFixedModel::LeftSupportFoot);
+    context.model.get().setDOFVect(context.modelInitDOF);
+    context.model.get().updateDOFPosition();
+    for (auto& it : context.joints) {
+        it.second.resetHiddenState();
+    }
+    //Build or reset the simulation
+    if (isSimulation && context.sim == nullptr) {
+        context.modelGoal.reset(new HumanoidFixedModel(
+            SigmabanModel,
+            _inertiaData, _inertiaName, 
+            _geometryData, _geometryName));
+        context.modelGoalInitDOF = 
+            context.modelGoal->get().getDOFVect();
+        context.sim.reset(new HumanoidSimulation(
+            SigmabanModel,
+            _inertiaData, _inertiaName,
+            _geometryData, _geometryName));
+        //Assign joint parameters
+        for (const std::string& name : NamesDOF) {
+            if (_jointName.count(name) > 0) {
+                context.sim->jointModel(name).setParameters(
+                    _jointData.row(_jointName.at(name)).transpose());
+            }
+        }
+        context.sim->saveState(context.simInitState);
+    } else if (isSimulation) {
+        context.modelGoal->setSupportFoot(
+            HumanoidFixedModel::LeftSupportFoot);
+        context.modelGoal->get().setDOFVect(
+            context.modelGoalInitDOF);
+        context.modelGoal->get().updateDOFPosition();
+        context.sim->restoreState(context.simInitState);
+    }
+}
+void TrajectoryGeneration::releaseContext(
+    EvaluationContext* context,
+    double setupTime, double scoringTime) const
+{
+    std::lock_guard<std::mutex> lock(_mutexContexts);
+    _freeContexts.push_back(context);
+    _stats.count++;
+    _stats.totalCount++;
+    _stats.setupTime += setupTime;
+    _stats.scoringTime += scoringTime;
+}
 
 }
 
@@ -4,12 +4,18 @@
 #include <map>
 #include <string>
 #include <functional>
+#include <vector>
+#include <memory>
+#include <mutex>
 #include <Eigen/Dense>
 #include "TrajectoryGeneration/TrajectoryUtils.h"
+#include "TrajectoryGeneration/TrajectoryKinematics.hpp"
 #include "Model/HumanoidModel.hpp"
 #include "Model/HumanoidFixedModel.hpp"
 #include "Model/JointModel.hpp"
 #include "Model/HumanoidSimulation.hpp"
+#include "Utils/CMAESCheckpoint.hpp"
+#include "Utils/FitnessArchive.hpp"
 
 namespace Leph {
 
@@ -84,10 +90,28 @@ class TrajectoryGeneration
             const Eigen::VectorXd& params)>
             SaveFunc;
 
+        /**
+         * Evaluation timing statistics.
+         * Setup is the time spent acquiring and
+         * resetting an evaluation context, scoring
+         * is the time spent evaluating the trajectory.
+         * Times are cumulated in seconds. Total count
+         * is the number of scorings since construction
+         * and is not cleared by resetEvaluationStats().
+         */
+        struct EvaluationStats {
+            unsigned long count;
+            unsigned long totalCount;
+            size_t contexts;
+            double setupTime;
+            double scoringTime;
+        };
+
         /**
          * Initialization with 
          * humanoid type and an optional 
-         * filepath to model parameters
+         * filepath to model parameters.
+         * Model parameters are loaded once here.
          */
         TrajectoryGeneration(RobotType type, 
             const std::string& modelParamsPath = "");
@@ -266,14 +290,30 @@ class TrajectoryGeneration
          * Build up the Trajectories from 
          * given parameters and evaluates it
          * from inverse dynamics.
+         * If costLimit is not negative, the evaluation
+         * is aborted as soon as the cumulated cost
+         * exceeds costLimit and the same penalty (far
+         * above costLimit and any finished cost) is
+         * returned for all aborted evaluations.
+         * Score functions are then assumed to 
+         * return non negative costs.
+         * If timeStep is greater than the default 
+         * 0.01s, the trajectory is evaluated on a coarse
+         * time grid including splines knots 
+         * (see TrajectoriesTimeGrid()) and each time cost 
+         * is weighted by its duration relative to 0.01s.
          */
         double scoreTrajectory(
             const Eigen::VectorXd& params, 
-            bool verbose = false) const;
+            bool verbose = false,
+            double costLimit = -1.0,
+            double timeStep = 0.01) const;
         double scoreTrajectory(
             const Eigen::VectorXd& params,
             const Trajectories& traj,
-            bool verbose = false) const;
+            bool verbose = false,
+            double costLimit = -1.0,
+            double timeStep = 0.01) const;
 
         /**
          * Build up the Trajectories fom
@@ -288,9 +328,116 @@ class TrajectoryGeneration
             const Trajectories& traj,
             bool verbose = false) const;
 
+        /**
+         * Enable the periodic saving of CMA-ES
+         * state into given checkpoint file every
+         * given iterations during runOptimization().
+         */
+        void setCheckpoint(
+            const std::string& fileName,
+            unsigned int iterations = 100);
+
+        /**
+         * Load the CMA-ES state from given checkpoint
+         * file. Next runOptimization() call is warm
+         * restarted from the saved mean, folded step
+         * size, restart counter and best found
+         * parameters with a new seed. Covariance shape,
+         * evolution paths and random engine state
+         * are not restored.
+         */
+        void warmRestartFromCheckpoint(const std::string& fileName);
+
+        /**
+         * Dispatch the fitness evaluations of
+         * runOptimization() to given number of forked
+         * local worker processes and to given remote 
+         * "host:port" workers (see serveEvaluations()).
+         * Concurrent candidates are sent by batches of
+         * given size and evaluations longer than given
+         * timeout in seconds (negative is infinite) 
+         * are aborted and given a large cost.
+         * Each local worker has a forked spare which
+         * replaces it once after a timeout or crash.
+         * No local and remote workers disables the farm.
+         */
+        void setEvaluationWorkers(
+            unsigned int localWorkers,
+            const std::vector<std::string>& remoteWorkers 
+                = std::vector<std::string>(),
+            unsigned int batchSize = 1,
+            double timeout = -1.0);
+
+        /**
+         * Run forever a TCP evaluation worker on 
+         * given port for remote runOptimization().
+         * The worker must be configured with the same 
+         * trajectory functions and model parameters.
+         */
+        void serveEvaluations(unsigned int port) const;
+
+        /**
+         * Enable or disable the Gaussian process
+         * surrogate pre-screening of runOptimization() 
+         * candidates (see FitnessSurrogate) with given
+         * ratio of screened out candidates still
+         * evaluated and minimum rank correlation
+         */
+        void setSurrogate(
+            bool isEnabled,
+            double controlRatio = 0.2,
+            double minCorrelation = 0.5);
+
+        /**
+         * Return the number of true evaluations and
+         * of evaluations saved by the surrogate
+         * during last runOptimization()
+         */
+        unsigned long surrogateEvaluationCount() const;
+        unsigned long surrogateSavedCount() const;
+
+        /**
+         * Enable the memoization of non verbose
+         * scoring (see FitnessArchive) shared across
+         * CMA-ES restarts and optimizations.
+         * If not empty, the archive is loaded from
+         * given file if it exists and saved into it
+         * at the end of runOptimization() and with
+         * checkpoints. The surrogate is seeded with
+         * archived evaluations.
+         * The archive is bound to a hash of given
+         * configuration name (trajectory name and
+         * parameters), robot type, model parameters
+         * and scoring version. A file saved with an
+         * other configuration is rejected (throw).
+         */
+        void setFitnessArchive(
+            const std::string& fileName = "",
+            const std::string& configName = "",
+            double quantum = 1e-9);
+
+        /**
+         * Return the fitness archive
+         * (null if disabled). Entries parameters
+         * are prefixed by 1 for simulation scoring
+         * and 0 for inverse dynamics scoring.
+         */
+        const FitnessArchive* fitnessArchive() const;
+
         /**
          * Run the CMA-ES Trajectories optimization
          * with given algorithm configuration.
+         * If isCostBounding is true, inverse dynamics
+         * scoring is aborted as soon as the candidate 
+         * cost exceeds the worst selected candidate
+         * of previous generation. Bounding is disabled
+         * after a restart or a generation where fewer 
+         * than mu candidates have finished.
+         * If isMultiResolution is true, inverse dynamics
+         * scoring starts on a coarse time grid which is
+         * refined as CMA-ES step size decreases. Each 
+         * generation best candidate and the final best
+         * one are rescored at full resolution.
          */
         void runOptimization(
             unsigned int maxIterations,
@@ -300,7 +447,32 @@ class TrajectoryGeneration
             double lambda = -1.0,
             unsigned int elitismLevel = 1,
             unsigned int verboseIterations = 100,
-            bool isForwardSimulationOptimization = false);
+            bool isForwardSimulationOptimization = false,
+            bool isCostBounding = false,
+            bool isMultiResolution = false);
+
+        /**
+         * Refine with L-BFGS the best found parameters
+         * (or the initial ones if none) on the inverse
+         * dynamics score. The starting point is rescored
+         * first since the best score may come from the
+         * forward simulation. The score gradient is computed
+         * by forward finite differences with given step
+         * in normalized parameters space, its evaluations
+         * being run in parallel. Each iteration costs one
+         * scoring per parameter plus the line search ones.
+         * The refinement stops after given iterations or
+         * when the line search fails to decrease the score
+         * (scores are only piecewise smooth). Best found is
+         * updated and saved. The number of scorings
+         * is returned.
+         */
+        unsigned long runRefinement(
+            unsigned int maxIterations,
+            const std::string& filename = "",
+            double diffStep = 1e-4,
+            unsigned int memorySize = 5,
+            unsigned int verboseIterations = 10);
 
         /**
          * Access to best found Trajectories, 
@@ -310,8 +482,44 @@ class TrajectoryGeneration
         const Eigen::VectorXd& bestParameters() const;
         double bestScore() const;
 
+        /**
+         * Return and reset the evaluation
+         * timing statistics cumulated since
+         * last reset
+         */
+        EvaluationStats evaluationStats() const;
+        void resetEvaluationStats();
+
     private:
 
+        /**
+         * Prebuilt models used by one evaluation
+         * at a time. Contexts are reset to their
+         * initial state instead of being rebuilt.
+         * Simulation members are built on first
+         * simulation scoring and the simulation is
+         * restored from its initial state snapshot.
+         * Kinematics caches DOF indexes and leg
+         * jacobian factorizations along scored samples.
+         */
+        struct EvaluationContext {
+            EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+            HumanoidFixedModel model;
+            Eigen::VectorXd modelInitDOF;
+            TrajectoryKinematics kinematics;
+            std::map<std::string, JointModel> joints;
+            std::unique_ptr<HumanoidFixedModel> modelGoal;
+            Eigen::VectorXd modelGoalInitDOF;
+            std::unique_ptr<HumanoidSimulation> sim;
+            HumanoidSimulation::State simInitState;
+            EvaluationContext(
+                RobotType type,
+                const Eigen::MatrixXd& inertiaData,
+                const std::map<std::string, size_t>& inertiaName,
+                const Eigen::MatrixXd& geometryData,
+                const std::map<std::string, size_t>& geometryName);
+        };
+
         /**
          * Humanoid robot type
          */
@@ -324,6 +532,17 @@ class TrajectoryGeneration
          */
         std::string _modelParametersPath;
 
+        /**
+         * Joint, inertia and geometry model
+         * parameters loaded at initialization
+         */
+        Eigen::MatrixXd _jointData;
+        std::map<std::string, size_t> _jointName;
+        Eigen::MatrixXd _inertiaData;
+        std::map<std::string, size_t> _inertiaName;
+        Eigen::MatrixXd _geometryData;
+        std::map<std::string, size_t> _geometryName;
+
         /**
          * Initial parameters for 
          * optimization process
@@ -360,6 +579,126 @@ class TrajectoryGeneration
          * Counter for CMAES progress function
          */
         long _countIteration;
+
+        /**
+         * Checkpoint file name (empty if disabled), 
+         * saving period, CMA-ES state and whether
+         * the state is loaded to be warm restarted
+         */
+        std::string _checkpointFileName;
+        unsigned int _checkpointIterations;
+        CMAESCheckpoint _checkpoint;
+        bool _isWarmRestart;
+
+        /**
+         * Evaluation farm local workers count,
+         * remote workers addresses, batch size 
+         * and timeout
+         */
+        unsigned int _farmLocalWorkers;
+        std::vector<std::string> _farmRemoteWorkers;
+        unsigned int _farmBatchSize;
+        double _farmTimeout;
+
+        /**
+         * Surrogate pre-screening configuration
+         * and last optimization counters
+         */
+        bool _isSurrogate;
+        double _surrogateControlRatio;
+        double _surrogateMinCorrelation;
+        unsigned long _surrogateEvaluationCount;
+        unsigned long _surrogateSavedCount;
+
+        /**
+         * Fitness archive (null if disabled)
+         * and its file name
+         */
+        std::unique_ptr<FitnessArchive> _archive;
+        std::string _archiveFileName;
+
+        /**
+         * Pool of all built evaluation contexts
+         * and currently unused ones. The pool grows
+         * up to the number of concurrent evaluations
+         * (CMA-ES fitness threads).
+         * Evaluation statistics are protected
+         * by the same mutex.
+         */
+        mutable std::mutex _mutexContexts;
+        mutable std::vector<std::unique_ptr<EvaluationContext>> _contexts;
+        mutable std::vector<EvaluationContext*> _freeContexts;
+        mutable EvaluationStats _stats;
+
+        /**
+         * Retrieve an unused context (built if
+         * none is available) reset to its initial
+         * state with its simulation built if
+         * isSimulation is true. The context 
+         * is given back with releaseContext().
+         * If the setup throws, the context is
+         * returned to the free list.
+         */
+        EvaluationContext* acquireContext(bool isSimulation) const;
+        void releaseContext(EvaluationContext* context,
+            double setupTime, double scoringTime) const;
+
+        /**
+         * Reset given context to its initial
+         * state and build its simulation
+         * if isSimulation is true
+         */
+        void setupContext(
+            EvaluationContext& context, bool isSimulation) const;
+
+        /**
+         * Scoring implementation on
+         * given evaluation context
+         */
+        double scoreTrajectoryContext(
+            EvaluationContext& context,
+            const Eigen::VectorXd& params,
+            const Trajectories& traj,
+            bool verbose,
+            double costLimit,
+            double timeStep) const;
+        double scoreSimulationContext(
+            EvaluationContext& context,
+            const Eigen::VectorXd& params,
+            const Trajectories& traj,
+            bool verbose) const;
+
+        /**
+         * Compute the inverse dynamics score gradient
+         * with respect to given normalized parameters
+         * by forward finite differences from given
+         * score at params. A backward difference is used
+         * for parameters whose forward step is out of
+         * checkParameters() bounds.
+         */
+        Eigen::VectorXd scoreGradient(
+            const Eigen::VectorXd& params,
+            double score,
+            const Eigen::VectorXd& normCoef,
+            double diffStep) const;
+
+        /**
+         * Score an evaluation farm request made of
+         * the simulation flag, the cost limit, the
+         * time step and the (not normalized) parameters
+         */
+        double scoreRequest(const Eigen::VectorXd& request) const;
+
+        /**
+         * Lookup and store in the fitness archive
+         * (if enabled) the cost of given parameters 
+         * for simulation or inverse dynamics scoring
+         */
+        bool archiveLookup(bool isSimulation,
+            const Eigen::VectorXd& params, double& cost) const;
+        void archiveStore(bool isSimulation,
+            const Eigen::VectorXd& params, 
+            double cost, double time) const;
 };
 
 }
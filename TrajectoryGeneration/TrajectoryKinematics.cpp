@@ -0,0 +1,345 @@
+#include <cmath>
+#include "TrajectoryGeneration/TrajectoryKinematics.hpp"
+#include "Model/NamesModel.h"
+#include "Utils/AxisAngle.h"
+#include "Model/RevoluteChain.h"
+
+namespace Leph {
+
+/**
+ * Leg DOF names suffix from
+ * hip yaw to ankle roll
+ */
+static const char* const LegNames[6] = {
+    "hip_yaw", "hip_roll", "hip_pitch",
+    "knee", "ankle_pitch", "ankle_roll",
+};
+
+TrajectoryKinematics::TrajectoryKinematics() :
+    _model(nullptr),
+    _isIndexed(),
+    _indexLegs(),
+    _indexBasePitch(),
+    _indexBaseRoll(),
+    _indexAll(),
+    _support(HumanoidFixedModel::LeftSupportFoot),
+    _isFactorized(),
+    _angles(),
+    _lu(),
+    _factorizationCount(0),
+    _reuseCount(0)
+{
+    reset();
+}
+
+bool TrajectoryKinematics::compute(
+    double t, const Trajectories& traj,
+    HumanoidFixedModel& model,
+    Eigen::VectorXd& dq, Eigen::VectorXd& ddq,
+    double* boundIKDistance)
+{
+    //Compute Cartesian target
+    Eigen::Vector3d trunkPos;
+    Eigen::Vector3d trunkAxis;
+    Eigen::Vector3d footPos;
+    Eigen::Vector3d footAxis;
+    Eigen::Vector3d trunkPosVel;
+    Eigen::Vector3d trunkAxisVel;
+    Eigen::Vector3d footPosVel;
+    Eigen::Vector3d footAxisVel;
+    Eigen::Vector3d trunkPosAcc;
+    Eigen::Vector3d trunkAxisAcc;
+    Eigen::Vector3d footPosAcc;
+    Eigen::Vector3d footAxisAcc;
+    bool isDoubleSupport;
+    HumanoidFixedModel::SupportFoot supportFoot;
+    TrajectoriesTrunkFootPos(t, traj,
+        trunkPos, trunkAxis, footPos, footAxis);
+    TrajectoriesTrunkFootVel(t, traj,
+        trunkPosVel, trunkAxisVel, footPosVel, footAxisVel);
+    TrajectoriesTrunkFootAcc(t, traj,
+        trunkPosAcc, trunkAxisAcc, footPosAcc, footAxisAcc);
+    TrajectoriesSupportFootState(t, traj,
+        isDoubleSupport, supportFoot);
+    //Compute DOF positions with analytical LegIK
+    Eigen::Matrix3d trunkRotation = AxisToMatrix(trunkAxis);
+    bool isSuccess = model.trunkFootIK(
+        supportFoot,
+        trunkPos,
+        trunkRotation,
+        footPos,
+        AxisToMatrix(footAxis),
+        boundIKDistance);
+    if (!isSuccess) {
+        return false;
+    }
+    buildIndexes(model, supportFoot);
+    //Legs are swapped in the chains
+    if (supportFoot != _support) {
+        _support = supportFoot;
+        _isFactorized[SupportChain] = false;
+        _isFactorized[FlyingChain] = false;
+    }
+    size_t indexSupport =
+        (supportFoot == HumanoidFixedModel::LeftSupportFoot) ? 0 : 1;
+    size_t indexFlying = 1 - indexSupport;
+
+    //Retrieve legs angles
+    const Eigen::VectorXd& q = model.get().getDOFVect();
+    Vector6d anglesSupport;
+    Vector6d anglesFlying;
+    for (size_t i=0;i<6;i++) {
+        anglesSupport(i) = q(_indexLegs[indexSupport][indexSupport][i]);
+        anglesFlying(i) = q(_indexLegs[indexSupport][indexFlying][i]);
+    }
+    //Compute legs joints axes and
+    //centers in trunk frame
+    Matrix36d axesSupport;
+    Matrix36d centersSupport;
+    Eigen::Vector3d tipSupport;
+    Matrix36d axesFlying;
+    Matrix36d centersFlying;
+    Eigen::Vector3d tipFlying;
+    model.get().legGeometry(indexSupport == 0,
+        anglesSupport, axesSupport, centersSupport, tipSupport);
+    model.get().legGeometry(indexFlying == 0,
+        anglesFlying, axesFlying, centersFlying, tipFlying);
+    //The support chain goes from support foot (ankle roll)
+    //to the trunk. Joints move the trunk with
+    //respect to the support foot in reversed direction.
+    Matrix36d axesChain;
+    Matrix36d centersChain;
+    for (size_t i=0;i<6;i++) {
+        axesChain.col(i) = -axesSupport.col(5-i);
+        centersChain.col(i) = centersSupport.col(5-i);
+    }
+
+    //Compute trunk and flying foot jacobians
+    //in trunk frame. They only depend on legs angles.
+    Matrix6d jacSupport = RevoluteChainJacobian(
+        axesChain, centersChain, Eigen::Vector3d::Zero());
+    Matrix6d jacFlying = RevoluteChainJacobian(
+        axesFlying, centersFlying, tipFlying);
+    bool isSupportValid = factorize(
+        SupportChain, anglesSupport, jacSupport);
+    bool isFlyingValid = factorize(
+        FlyingChain, anglesFlying, jacFlying);
+
+    dq = Eigen::VectorXd::Zero(model.get().sizeDOF());
+    ddq = Eigen::VectorXd::Zero(model.get().sizeDOF());
+    //Return null velocity and acceleration
+    //in case of near singular jacobian
+    if (isSupportValid && isFlyingValid) {
+        //Axis differentiation is converted in proper angular
+        //velocity and acceleration
+        Eigen::Vector3d trunkAngularVel =
+            AxisDiffToAngularDiff(trunkAxis, trunkAxisVel);
+        Eigen::Vector3d footAngularVel =
+            AxisDiffToAngularDiff(footAxis, footAxisVel);
+        Eigen::Vector3d trunkAngularAcc =
+            AxisDiffToAngularDiff(trunkAxis, trunkAxisAcc);
+        Eigen::Vector3d footAngularAcc =
+            AxisDiffToAngularDiff(footAxis, footAxisAcc);
+        //Support foot to trunk frame rotation
+        Eigen::Matrix3d rotationT = trunkRotation.transpose();
+
+        //Trunk velocity and relative flying foot
+        //velocity with respect to the trunk
+        //(see HumanoidFixedModel::trunkFootIKVel())
+        Eigen::Vector3d relPos = trunkRotation*tipFlying;
+        Eigen::Vector3d relVel =
+            footPosVel - trunkPosVel
+            - trunkAngularVel.cross(relPos);
+        Vector6d trunkVel;
+        trunkVel.segment<3>(0) = rotationT*trunkAngularVel;
+        trunkVel.segment<3>(3) = rotationT*trunkPosVel;
+        Vector6d footVel;
+        footVel.segment<3>(0) =
+            rotationT*(footAngularVel - trunkAngularVel);
+        footVel.segment<3>(3) = rotationT*relVel;
+        //Compute legs joints velocities
+        Vector6d dqSupport = solve(SupportChain, trunkVel);
+        Vector6d dqFlying = solve(FlyingChain, footVel);
+
+        //Trunk acceleration and relative flying foot
+        //acceleration with respect to the trunk
+        //(see HumanoidFixedModel::trunkFootIKAcc())
+        Vector6d trunkAcc;
+        trunkAcc.segment<3>(0) = rotationT*trunkAngularAcc;
+        trunkAcc.segment<3>(3) = rotationT*trunkPosAcc;
+        Vector6d footAcc;
+        footAcc.segment<3>(0) =
+            rotationT*(footAngularAcc - trunkAngularAcc);
+        footAcc.segment<3>(3) = rotationT*(
+            footPosAcc
+            - trunkPosAcc
+            - trunkAngularAcc.cross(relPos)
+            - trunkAngularVel.cross(trunkAngularVel.cross(relPos))
+            - 2.0*trunkAngularVel.cross(relVel));
+        //Compute legs joints accelerations
+        //ddq = J(q)^-1*(acc - dJ*dq)
+        Vector6d ddqSupport = solve(SupportChain,
+            trunkAcc - RevoluteChainBias(axesChain, centersChain,
+                Eigen::Vector3d::Zero(), dqSupport));
+        Vector6d ddqFlying = solve(FlyingChain,
+            footAcc - RevoluteChainBias(axesFlying, centersFlying,
+                tipFlying, dqFlying));
+
+        //Assign computed velocities and accelerations
+        for (size_t i=0;i<6;i++) {
+            size_t indexS = _indexLegs[indexSupport][indexSupport][5-i];
+            size_t indexF = _indexLegs[indexSupport][indexFlying][i];
+            dq(indexS) = dqSupport(i);
+            ddq(indexS) = ddqSupport(i);
+            dq(indexF) = dqFlying(i);
+            ddq(indexF) = ddqFlying(i);
+        }
+    }
+
+    //If available, assign base Pitch/Roll DOFs
+    if (traj.exist("base_pitch")) {
+        size_t index = _indexBasePitch[indexSupport];
+        model.get().setDOF(index, traj.get("base_pitch").pos(t));
+        dq(index) = traj.get("base_pitch").vel(t);
+        ddq(index) = traj.get("base_pitch").acc(t);
+    }
+    if (traj.exist("base_roll")) {
+        size_t index = _indexBaseRoll[indexSupport];
+        model.get().setDOF(index, traj.get("base_roll").pos(t));
+        dq(index) = traj.get("base_roll").vel(t);
+        ddq(index) = traj.get("base_roll").acc(t);
+    }
+
+    return true;
+}
+
+bool TrajectoryKinematics::computeAll(
+    const std::vector<double>& times,
+    const Trajectories& traj,
+    HumanoidFixedModel& model,
+    Eigen::MatrixXd& q,
+    Eigen::MatrixXd& dq,
+    Eigen::MatrixXd& ddq,
+    std::vector<bool>& isSuccess,
+    Eigen::VectorXd* boundIKDistances)
+{
+    size_t size = times.size();
+    q = Eigen::MatrixXd::Zero(NamesDOFAll.size(), size);
+    dq = Eigen::MatrixXd::Zero(NamesDOFAll.size(), size);
+    ddq = Eigen::MatrixXd::Zero(NamesDOFAll.size(), size);
+    isSuccess.assign(size, false);
+    if (boundIKDistances != nullptr) {
+        *boundIKDistances = Eigen::VectorXd::Zero(size);
+    }
+
+    bool isAllSuccess = true;
+    Eigen::VectorXd dqSample;
+    Eigen::VectorXd ddqSample;
+    for (size_t k=0;k<size;k++) {
+        double boundIKDistance = 0.0;
+        bool isSampleSuccess = compute(
+            times[k], traj, model,
+            dqSample, ddqSample, &boundIKDistance);
+        if (boundIKDistances != nullptr) {
+            (*boundIKDistances)(k) = boundIKDistance;
+        }
+        if (!isSampleSuccess) {
+            isAllSuccess = false;
+            continue;
+        }
+        //Copy in fixed DOF order since
+        //index depends on support foot model
+        size_t indexSupport =
+            (model.getSupportFoot() == HumanoidFixedModel::LeftSupportFoot)
+            ? 0 : 1;
+        const std::vector<size_t>& indexAll = _indexAll[indexSupport];
+        const Eigen::VectorXd& qSample = model.get().getDOFVect();
+        for (size_t i=0;i<indexAll.size();i++) {
+            q(i, k) = qSample(indexAll[i]);
+            dq(i, k) = dqSample(indexAll[i]);
+            ddq(i, k) = ddqSample(indexAll[i]);
+        }
+        isSuccess[k] = true;
+    }
+
+    return isAllSuccess;
+}
+
+unsigned long TrajectoryKinematics::factorizationCount() const
+{
+    return _factorizationCount;
+}
+unsigned long TrajectoryKinematics::reuseCount() const
+{
+    return _reuseCount;
+}
+
+void TrajectoryKinematics::reset()
+{
+    _model = nullptr;
+    for (size_t i=0;i<2;i++) {
+        _isIndexed[i] = false;
+        _indexAll[i].clear();
+        _isFactorized[i] = false;
+    }
+}
+
+void TrajectoryKinematics::buildIndexes(
+    HumanoidFixedModel& model,
+    HumanoidFixedModel::SupportFoot support)
+{
+    if (&model != _model) {
+        reset();
+        _model = &model;
+    }
+    size_t indexSupport =
+        (support == HumanoidFixedModel::LeftSupportFoot) ? 0 : 1;
+    if (_isIndexed[indexSupport]) {
+        return;
+    }
+
+    //The current model is the one
+    //of given support foot
+    const HumanoidModel& current = model.get();
+    for (size_t i=0;i<6;i++) {
+        _indexLegs[indexSupport][0][i] =
+            current.getDOFIndex(std::string("left_") + LegNames[i]);
+        _indexLegs[indexSupport][1][i] =
+            current.getDOFIndex(std::string("right_") + LegNames[i]);
+    }
+    _indexBasePitch[indexSupport] = current.getDOFIndex("base_pitch");
+    _indexBaseRoll[indexSupport] = current.getDOFIndex("base_roll");
+    _indexAll[indexSupport].clear();
+    for (const std::string& name : NamesDOFAll) {
+        _indexAll[indexSupport].push_back(current.getDOFIndex(name));
+    }
+    _isIndexed[indexSupport] = true;
+}
+
+bool TrajectoryKinematics::factorize(
+    Chain chain,
+    const Vector6d& angles,
+    const Matrix6d& jac)
+{
+    if (_isFactorized[chain] && angles == _angles[chain]) {
+        _reuseCount++;
+    } else {
+        _lu[chain].compute(jac);
+        _angles[chain] = angles;
+        _isFactorized[chain] = true;
+        _factorizationCount++;
+    }
+
+    //Check for near singular jacobian
+    return fabs(_lu[chain].determinant()) >= 1e-10;
+}
+
+TrajectoryKinematics::Vector6d TrajectoryKinematics::solve(
+    Chain chain,
+    const Vector6d& vect) const
+{
+    return _lu[chain].solve(vect);
+}
+
+}
+
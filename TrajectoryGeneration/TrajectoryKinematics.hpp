@@ -0,0 +1,165 @@
+#ifndef LEPH_TRAJECTORYKINEMATICS_HPP
+#define LEPH_TRAJECTORYKINEMATICS_HPP
+
+#include <vector>
+#include <Eigen/Dense>
+#include "TrajectoryGeneration/TrajectoryUtils.h"
+#include "Model/HumanoidFixedModel.hpp"
+
+namespace Leph {
+
+/**
+ * TrajectoryKinematics
+ *
+ * Trajectory level equivalent of
+ * TrajectoriesComputeKinematics() meant to be
+ * called on successive time samples.
+ * Leg jacobians are computed analytically from
+ * LegIK geometry (no RBDL jacobian nor DOF name
+ * lookup) and expressed in trunk frame where they
+ * only depend on leg angles. Their factorizations
+ * are shared by velocity and acceleration and reused
+ * from previous sample when leg angles are unchanged
+ * (static phases). Results are exact: factorizations
+ * are never reused on changed angles.
+ */
+class TrajectoryKinematics
+{
+    public:
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        /**
+         * Initialization
+         */
+        TrajectoryKinematics();
+
+        /**
+         * Same as TrajectoriesComputeKinematics().
+         * The DOF positions are assigned to given
+         * model and DOF velocities and accelerations
+         * to given dq and ddq.
+         * False is returned if inverse kinematics fails.
+         */
+        bool compute(
+            double t, const Trajectories& traj,
+            HumanoidFixedModel& model,
+            Eigen::VectorXd& dq, Eigen::VectorXd& ddq,
+            double* boundIKDistance = nullptr);
+
+        /**
+         * Compute the kinematics at all given times
+         * into contiguous arrays with one column per
+         * time and rows following NamesDOFAll order.
+         * Columns of failed inverse kinematics are
+         * set to zero and the corresponding isSuccess
+         * flag to false. If not null, boundIKDistances
+         * is assigned the IK bound distance of each time.
+         * False is returned if any inverse kinematics fails.
+         */
+        bool computeAll(
+            const std::vector<double>& times,
+            const Trajectories& traj,
+            HumanoidFixedModel& model,
+            Eigen::MatrixXd& q,
+            Eigen::MatrixXd& dq,
+            Eigen::MatrixXd& ddq,
+            std::vector<bool>& isSuccess,
+            Eigen::VectorXd* boundIKDistances = nullptr);
+
+        /**
+         * Return the number of computed
+         * and reused factorizations
+         */
+        unsigned long factorizationCount() const;
+        unsigned long reuseCount() const;
+
+        /**
+         * Drop cached index tables
+         * and factorizations
+         */
+        void reset();
+
+    private:
+
+        /**
+         * Fixed size typedef
+         */
+        typedef Eigen::Matrix<double, 6, 1> Vector6d;
+        typedef Eigen::Matrix<double, 6, 6> Matrix6d;
+        typedef Eigen::Matrix<double, 3, 6> Matrix36d;
+
+        /**
+         * Support and flying
+         * leg chain index
+         */
+        enum Chain {
+            SupportChain = 0,
+            FlyingChain = 1,
+        };
+
+        /**
+         * Model whose DOF indexes are cached
+         */
+        const HumanoidFixedModel* _model;
+
+        /**
+         * For each support foot (left, right),
+         * cached model DOF indexes of left and right
+         * legs (hip yaw to ankle roll), of base pitch
+         * and roll and of all NamesDOFAll
+         */
+        bool _isIndexed[2];
+        size_t _indexLegs[2][2][6];
+        size_t _indexBasePitch[2];
+        size_t _indexBaseRoll[2];
+        std::vector<size_t> _indexAll[2];
+
+        /**
+         * Support foot and leg angles of
+         * cached factorizations of support and
+         * flying chain jacobians in trunk frame
+         */
+        HumanoidFixedModel::SupportFoot _support;
+        bool _isFactorized[2];
+        Vector6d _angles[2];
+        Eigen::PartialPivLU<Matrix6d> _lu[2];
+
+        /**
+         * Factorizations counters
+         */
+        unsigned long _factorizationCount;
+        unsigned long _reuseCount;
+
+        /**
+         * Build DOF index tables for
+         * given support foot if needed
+         */
+        void buildIndexes(
+            HumanoidFixedModel& model,
+            HumanoidFixedModel::SupportFoot support);
+
+        /**
+         * Factorize given chain jacobian or reuse
+         * previous factorization if leg angles are
+         * unchanged. Return false if the jacobian
+         * is near singular.
+         */
+        bool factorize(
+            Chain chain,
+            const Vector6d& angles,
+            const Matrix6d& jac);
+
+        /**
+         * Solve given chain jacobian system
+         * with cached factorization
+         */
+        Vector6d solve(
+            Chain chain,
+            const Vector6d& vect) const;
+};
+
+}
+
+#endif
+
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <iomanip>
 #include <stdexcept>
 #include <iostream>
@@ -17,7 +18,14 @@ namespace Leph {
  *
  * Simple header container for mapping
  * name to parameters for CMA-ES optimization
- * and especially trajectory generation
+ * and especially trajectory generation.
+ * Parameter values are stored in a dense layout
+ * indexed by slot with aliases resolved at
+ * definition. Slots are never moved, so slot
+ * accessors resolved once by name remain valid
+ * and avoid any name lookup in fitness evaluation.
+ * Once frozen, parameters and optimized flags
+ * can no longer be defined or changed.
  */
 class TrajectoryParameters
 {
@@ -28,10 +36,31 @@ class TrajectoryParameters
          */
         TrajectoryParameters() :
             _countOptimized(0),
-            _container()
+            _container(),
+            _values(),
+            _isOptimized(),
+            _indexes(),
+            _isFrozen(false)
         {
         }
 
+        /**
+         * Slot of undefined parameters
+         * always evaluated to zero
+         */
+        static const size_t ZeroSlot = (size_t)-1;
+
+        /**
+         * Compiled slots of cartesian state
+         * prefix_[pos|vel|acc]_[trunk|foot]_[pos|axis]_[x|y|z]
+         * in trajectoriesAssign() order:
+         * pos, vel, acc trunk pos, pos, vel, acc trunk axis,
+         * pos, vel, acc foot pos and pos, vel, acc foot axis
+         */
+        struct CartesianSlots {
+            size_t slots[12][3];
+        };
+
         /**
          * Define the new given name as parameter
          * with given value and flag isOptimized
@@ -41,6 +70,7 @@ class TrajectoryParameters
             double value = 0.0, 
             bool isOptimized = false)
         {
+            checkFrozen();
             //Check parameter exists
             if (isDefined(name)) {
                 throw std::logic_error(
@@ -50,10 +80,15 @@ class TrajectoryParameters
             //Create parameters
             _container[name] = Parameter();
             _container.at(name).name = name;
-            _container.at(name).isOptimized = isOptimized;
-            _container.at(name).defaultValue = value;
+            _container.at(name).slot = _values.size();
             _container.at(name).alias = "";
-            computeIndex();
+            _values.push_back(value);
+            _isOptimized.push_back(isOptimized);
+            _indexes.push_back((size_t)-1);
+            //Only optimized parameters shift indexes
+            if (isOptimized) {
+                computeIndex();
+            }
         }
 
         /**
@@ -65,6 +100,7 @@ class TrajectoryParameters
             const std::string& name,
             const std::string& alias)
         {
+            checkFrozen();
             //Check parameter exists
             if (isDefined(name)) {
                 throw std::logic_error(
@@ -76,13 +112,12 @@ class TrajectoryParameters
                     "TrajectoryParameters alias not exist: " 
                     + alias);
             }
-            //Create parameters
+            //Create parameters sharing
+            //the (resolved) alias slot
             _container[name] = Parameter();
             _container.at(name).name = name;
-            _container.at(name).isOptimized = false;
-            _container.at(name).defaultValue = 0.0;
+            _container.at(name).slot = _container.at(alias).slot;
             _container.at(name).alias = alias;
-            computeIndex();
         }
 
         /**
@@ -112,9 +147,12 @@ class TrajectoryParameters
         inline void optimize(
             const std::string& name, bool isOptimized) 
         {
-            const std::string& alias = resolveAlias(name);
-            _container.at(alias).isOptimized = isOptimized;
-            computeIndex();
+            size_t index = slot(name);
+            if (_isOptimized[index] != isOptimized) {
+                checkFrozen();
+                _isOptimized[index] = isOptimized;
+                computeIndex();
+            }
         }
 
         /**
@@ -125,8 +163,7 @@ class TrajectoryParameters
         inline double& set(
             const std::string& name)
         {
-            const std::string& alias = resolveAlias(name);
-            return _container.at(alias).defaultValue;
+            return _values[slot(name)];
         }
         
         /**
@@ -141,13 +178,10 @@ class TrajectoryParameters
         {
             if (!isDefined(name)) {
                 add(name, 0.0, isOptimized);
-                return _container.at(name).defaultValue;
             } else {
-                const std::string& alias = resolveAlias(name);
-                _container.at(alias).isOptimized = isOptimized;
-                computeIndex();
-                return _container.at(alias).defaultValue;
+                optimize(name, isOptimized);
             }
+            return _values[slot(name)];
         }
 
         /**
@@ -159,9 +193,9 @@ class TrajectoryParameters
             //Build and assign the vector
             Eigen::VectorXd params = 
                 Eigen::VectorXd::Zero(_countOptimized);
-            for (const auto& it : _container) {
-                if (it.second.isOptimized) {
-                    params(it.second.index) = it.second.defaultValue;
+            for (size_t i=0;i<_values.size();i++) {
+                if (_isOptimized[i]) {
+                    params(_indexes[i]) = _values[i];
                 }
             }
 
@@ -180,36 +214,37 @@ class TrajectoryParameters
             Eigen::VectorXd coefs = 
                 Eigen::VectorXd::Ones(_countOptimized);
             for (const auto& it : _container) {
-                if (it.second.isOptimized) {
+                size_t index = _indexes[it.second.slot];
+                if (it.second.alias == "" && _isOptimized[it.second.slot]) {
                     if (
                         it.first.find("time_ratio") != std::string::npos
                     ) {
-                        coefs(it.second.index) = 1.0;
+                        coefs(index) = 1.0;
                     } else if (
                         it.first.find("time_length") != std::string::npos
                     ) {
-                        coefs(it.second.index) = 3.0;
+                        coefs(index) = 3.0;
                     } else if (
                         it.first.find("pos_trunk_pos_z") != std::string::npos
                     ) {
-                        coefs(it.second.index) = 0.28;
+                        coefs(index) = 0.28;
                     } else if (
                         it.first.find("pos_trunk_pos_x") != std::string::npos ||
                         it.first.find("pos_trunk_pos_y") != std::string::npos
                     ) {
-                        coefs(it.second.index) = 0.01;
+                        coefs(index) = 0.01;
                     } else if (
                         it.first.find("vel_trunk_pos_x") != std::string::npos ||
                         it.first.find("vel_trunk_pos_y") != std::string::npos ||
                         it.first.find("vel_trunk_pos_z") != std::string::npos
                     ) {
-                        coefs(it.second.index) = 0.05;
+                        coefs(index) = 0.05;
                     } else if (
                         it.first.find("acc_trunk_pos_x") != std::string::npos ||
                         it.first.find("acc_trunk_pos_y") != std::string::npos ||
                         it.first.find("acc_trunk_pos_z") != std::string::npos
                     ) {
-                        coefs(it.second.index) = 2.0;
+                        coefs(index) = 2.0;
                     } else if (
                         it.first.find("pos_trunk_axis_x") != std::string::npos ||
                         it.first.find("pos_trunk_axis_y") != std::string::npos ||
@@ -218,7 +253,7 @@ class TrajectoryParameters
                         it.first.find("pos_foot_axis_y") != std::string::npos ||
                         it.first.find("pos_foot_axis_z") != std::string::npos
                     ) {
-                        coefs(it.second.index) = 1.0;
+                        coefs(index) = 1.0;
                     } else if (
                         it.first.find("vel_trunk_axis_x") != std::string::npos ||
                         it.first.find("vel_trunk_axis_y") != std::string::npos ||
@@ -227,7 +262,7 @@ class TrajectoryParameters
                         it.first.find("vel_foot_axis_y") != std::string::npos ||
                         it.first.find("vel_foot_axis_z") != std::string::npos
                     ) {
-                        coefs(it.second.index) = 3.0;
+                        coefs(index) = 3.0;
                     } else if (
                         it.first.find("acc_trunk_axis_x") != std::string::npos ||
                         it.first.find("acc_trunk_axis_y") != std::string::npos ||
@@ -236,28 +271,28 @@ class TrajectoryParameters
                         it.first.find("acc_foot_axis_y") != std::string::npos ||
                         it.first.find("acc_foot_axis_z") != std::string::npos
                     ) {
-                        coefs(it.second.index) = 30.0;
+                        coefs(index) = 30.0;
                     } else if (
                         it.first.find("pos_foot_pos_x") != std::string::npos ||
                         it.first.find("pos_foot_pos_y") != std::string::npos ||
                         it.first.find("pos_foot_pos_z") != std::string::npos
                     ) {
-                        coefs(it.second.index) = 0.1;
+                        coefs(index) = 0.1;
                     } else if (
                         it.first.find("vel_foot_pos_x") != std::string::npos ||
                         it.first.find("vel_foot_pos_y") != std::string::npos ||
                         it.first.find("vel_foot_pos_z") != std::string::npos
                     ) {
-                        coefs(it.second.index) = 2.0;
+                        coefs(index) = 2.0;
                     } else if (
                         it.first.find("acc_foot_pos_x") != std::string::npos ||
                         it.first.find("acc_foot_pos_y") != std::string::npos ||
                         it.first.find("acc_foot_pos_z") != std::string::npos
                     ) {
-                        coefs(it.second.index) = 10.0;
+                        coefs(index) = 10.0;
                     } else {
                         //Default coeficient
-                        coefs(it.second.index) = 1.0;
+                        coefs(index) = 1.0;
                     }
                 }
             }
@@ -274,14 +309,7 @@ class TrajectoryParameters
             const std::string& name, 
             const Eigen::VectorXd& parameters) const
         {
-            const std::string& alias = resolveAlias(name);
-            //Get from container or vector
-            const Parameter& p = _container.at(alias);
-            if (p.isOptimized) {
-                return parameters(p.index);
-            } else {
-                return p.defaultValue;
-            }
+            return get(slot(name), parameters);
         }
         
         /**
@@ -291,10 +319,7 @@ class TrajectoryParameters
         inline double get(
             const std::string& name) const
         {
-            const std::string& alias = resolveAlias(name);
-            //Get from container or vector
-            const Parameter& p = _container.at(alias);
-            return p.defaultValue;
+            return _values[slot(name)];
         }
         
         /**
@@ -309,60 +334,97 @@ class TrajectoryParameters
             const std::string& name, 
             const Eigen::VectorXd& parameters) const
         {
-            //Build name
-            std::string nameX = name + "_x";
-            std::string nameY = name + "_y";
-            std::string nameZ = name + "_z";
-            
-            //Build vector
-            Eigen::Vector3d vect(0.0, 0.0, 0.0);
-            
-            //Check if elements exist
-            if (isDefined(nameX)) {
-                //Retrieve default value or parameter
-                const std::string& aliasX = resolveAlias(nameX);
-                const Parameter& pX = _container.at(aliasX);
-                if (pX.isOptimized) {
-                    vect.x() = parameters(pX.index);
-                } else {
-                    vect.x() = pX.defaultValue;
-                }
+            return Eigen::Vector3d(
+                get(slotOptional(name + "_x"), parameters),
+                get(slotOptional(name + "_y"), parameters),
+                get(slotOptional(name + "_z"), parameters));
+        }
+
+        /**
+         * Return the slot of given parameter
+         * name (alias are resolved)
+         */
+        inline size_t slot(
+            const std::string& name) const
+        {
+            checkName(name);
+            return _container.at(name).slot;
+        }
+
+        /**
+         * Return the slot of given parameter
+         * name or ZeroSlot if it does not exist
+         */
+        inline size_t slotOptional(
+            const std::string& name) const
+        {
+            auto it = _container.find(name);
+            if (it == _container.end()) {
+                return ZeroSlot;
             } else {
-                //Zero if not exist
-                vect.x() = 0.0;
+                return it->second.slot;
             }
-            
-            //Check if elements exist
-            if (isDefined(nameY)) {
-                //Retrieve default value or parameter
-                const std::string& aliasY = resolveAlias(nameY);
-                const Parameter& pY = _container.at(aliasY);
-                if (pY.isOptimized) {
-                    vect.y() = parameters(pY.index);
-                } else {
-                    vect.y() = pY.defaultValue;
-                }
+        }
+
+        /**
+         * Retrieve the given parameter slot either
+         * from unoptimized value of from given
+         * parameters vector. ZeroSlot is zero.
+         */
+        inline double get(
+            size_t slot,
+            const Eigen::VectorXd& parameters) const
+        {
+            if (slot == ZeroSlot) {
+                return 0.0;
+            } else if (_isOptimized[slot]) {
+                return parameters(_indexes[slot]);
             } else {
-                //Zero if not exist
-                vect.y() = 0.0;
+                return _values[slot];
             }
-            
-            //Check if elements exist
-            if (isDefined(nameZ)) {
-                //Retrieve default value or parameter
-                const std::string& aliasZ = resolveAlias(nameZ);
-                const Parameter& pZ = _container.at(aliasZ);
-                if (pZ.isOptimized) {
-                    vect.z() = parameters(pZ.index);
-                } else {
-                    vect.z() = pZ.defaultValue;
+        }
+
+        /**
+         * Build and return the slots of
+         * cartesian state with given prefix.
+         * Missing data are set to ZeroSlot.
+         */
+        inline CartesianSlots cartesianSlots(
+            const std::string& prefix) const
+        {
+            static const char* names[12] = {
+                "_pos_trunk_pos", "_vel_trunk_pos", "_acc_trunk_pos",
+                "_pos_trunk_axis", "_vel_trunk_axis", "_acc_trunk_axis",
+                "_pos_foot_pos", "_vel_foot_pos", "_acc_foot_pos",
+                "_pos_foot_axis", "_vel_foot_axis", "_acc_foot_axis"};
+            static const char* axis[3] = {"_x", "_y", "_z"};
+            CartesianSlots cartesian;
+            for (size_t i=0;i<12;i++) {
+                for (size_t j=0;j<3;j++) {
+                    cartesian.slots[i][j] = slotOptional(
+                        prefix + names[i] + axis[j]);
                 }
-            } else {
-                //Zero if not exist
-                vect.z() = 0.0;
             }
+            return cartesian;
+        }
+
+        /**
+         * Freeze the parameters layout.
+         * Defining parameters or changing
+         * optimized flags then throws.
+         * Values can still be assigned.
+         */
+        inline void freeze()
+        {
+            _isFrozen = true;
+        }
 
-            return vect;
+        /**
+         * Return true if the layout is frozen
+         */
+        inline bool isFrozen() const
+        {
+            return _isFrozen;
         }
 
         /**
@@ -373,16 +435,17 @@ class TrajectoryParameters
             std::ostream& os = std::cout) const
         {
             for (const auto& it : _container) {
+                size_t index = it.second.slot;
                 os << "[" << std::setw(40) << it.first << ":";
-                if (it.second.isOptimized) {
-                    os << std::setw(3) << it.second.index << "] ";
+                if (it.second.alias == "" && _isOptimized[index]) {
+                    os << std::setw(3) << _indexes[index] << "] ";
                 } else {
                     os << std::setw(5) << "] ";
                 }
                 if (it.second.alias != "") {
                     os << it.second.alias;
                 } else {
-                    os << it.second.defaultValue;
+                    os << _values[index];
                 }
                 os << std::endl;
             }
@@ -411,30 +474,34 @@ class TrajectoryParameters
             bool doInverse = false,
             bool doMirror = false) const
         {
-            Eigen::Vector3d posTrunkPos = 
-                getVect(prefix + "_pos_trunk_pos", vect);
-            Eigen::Vector3d velTrunkPos = 
-                getVect(prefix + "_vel_trunk_pos", vect);
-            Eigen::Vector3d accTrunkPos = 
-                getVect(prefix + "_acc_trunk_pos", vect);
-            Eigen::Vector3d posTrunkAxis = 
-                getVect(prefix + "_pos_trunk_axis", vect);
-            Eigen::Vector3d velTrunkAxis = 
-                getVect(prefix + "_vel_trunk_axis", vect);
-            Eigen::Vector3d accTrunkAxis = 
-                getVect(prefix + "_acc_trunk_axis", vect);
-            Eigen::Vector3d posFootPos = 
-                getVect(prefix + "_pos_foot_pos", vect);
-            Eigen::Vector3d velFootPos = 
-                getVect(prefix + "_vel_foot_pos", vect);
-            Eigen::Vector3d accFootPos = 
-                getVect(prefix + "_acc_foot_pos", vect);
-            Eigen::Vector3d posFootAxis = 
-                getVect(prefix + "_pos_foot_axis", vect);
-            Eigen::Vector3d velFootAxis = 
-                getVect(prefix + "_vel_foot_axis", vect);
-            Eigen::Vector3d accFootAxis = 
-                getVect(prefix + "_acc_foot_axis", vect);
+            trajectoriesAssign(traj, time, 
+                cartesianSlots(prefix), vect, doInverse, doMirror);
+        }
+
+        /**
+         * Same as trajectoriesAssign() with
+         * precompiled cartesian slots
+         */
+        void trajectoriesAssign(
+            Trajectories& traj,
+            double time,
+            const CartesianSlots& cartesian,
+            const Eigen::VectorXd& vect,
+            bool doInverse = false,
+            bool doMirror = false) const
+        {
+            Eigen::Vector3d posTrunkPos = getVect(cartesian.slots[0], vect);
+            Eigen::Vector3d velTrunkPos = getVect(cartesian.slots[1], vect);
+            Eigen::Vector3d accTrunkPos = getVect(cartesian.slots[2], vect);
+            Eigen::Vector3d posTrunkAxis = getVect(cartesian.slots[3], vect);
+            Eigen::Vector3d velTrunkAxis = getVect(cartesian.slots[4], vect);
+            Eigen::Vector3d accTrunkAxis = getVect(cartesian.slots[5], vect);
+            Eigen::Vector3d posFootPos = getVect(cartesian.slots[6], vect);
+            Eigen::Vector3d velFootPos = getVect(cartesian.slots[7], vect);
+            Eigen::Vector3d accFootPos = getVect(cartesian.slots[8], vect);
+            Eigen::Vector3d posFootAxis = getVect(cartesian.slots[9], vect);
+            Eigen::Vector3d velFootAxis = getVect(cartesian.slots[10], vect);
+            Eigen::Vector3d accFootAxis = getVect(cartesian.slots[11], vect);
             double coef1 = (doInverse ? -1.0 : 1.0);
             double coef2 = (doInverse ? 1.0 : 0.0);
             double coef3 = (doMirror ? -1.0 : 1.0);
@@ -501,9 +568,7 @@ class TrajectoryParameters
          */
         struct Parameter {
             std::string name;
-            bool isOptimized;
-            double defaultValue;
-            size_t index;
+            size_t slot;
             std::string alias;
         };
 
@@ -518,6 +583,20 @@ class TrajectoryParameters
          */
         std::map<std::string, Parameter> _container;
 
+        /**
+         * Dense layout indexed by slot of
+         * default values, optimized flags
+         * and optimized parameters index
+         */
+        std::vector<double> _values;
+        std::vector<bool> _isOptimized;
+        std::vector<size_t> _indexes;
+
+        /**
+         * Is the layout frozen
+         */
+        bool _isFrozen;
+
         /**
          * Throw exception if given parameter name
          * is not defined
@@ -533,35 +612,50 @@ class TrajectoryParameters
         }
 
         /**
-         * Return the parameter name (not alias)
-         * referenced by given name
+         * Throw exception if the
+         * layout is frozen
          */
-        const std::string& resolveAlias(
-            const std::string& name) const
+        void checkFrozen() const
         {
-            checkName(name);
-            const std::string& alias = _container.at(name).alias;
-            if (alias == "") {
-                return name;
-            } else {
-                return resolveAlias(alias);
+            if (_isFrozen) {
+                throw std::logic_error(
+                    "TrajectoryParameters layout is frozen");
             }
         }
 
+        /**
+         * Retrieve the given slots vector either
+         * from unoptimized value of from given
+         * parameters vector
+         */
+        inline Eigen::Vector3d getVect(
+            const size_t slots[3],
+            const Eigen::VectorXd& parameters) const
+        {
+            return Eigen::Vector3d(
+                get(slots[0], parameters),
+                get(slots[1], parameters),
+                get(slots[2], parameters));
+        }
+
         /**
          * Recompute all optimized parameter index
          */
         void computeIndex()
         {
             //Count optimized parameters
-            //and reset index
+            //and reset index in names order
             _countOptimized = 0;
-            for (auto& it : _container) {
-                if (it.second.isOptimized) {
-                    it.second.index = _countOptimized;
+            for (const auto& it : _container) {
+                if (it.second.alias != "") {
+                    continue;
+                }
+                size_t index = it.second.slot;
+                if (_isOptimized[index]) {
+                    _indexes[index] = _countOptimized;
                     _countOptimized++;
                 } else {
-                    it.second.index = (size_t)-1;
+                    _indexes[index] = (size_t)-1;
                 }
             }
         }
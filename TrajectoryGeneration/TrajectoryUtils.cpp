@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "TrajectoryGeneration/TrajectoryUtils.h"
 #include "Utils/AxisAngle.h"
 
@@ -194,6 +195,36 @@ bool TrajectoriesComputeKinematics(
     return true;
 }
 
+std::vector<double> TrajectoriesTimeGrid(
+    const Trajectories& traj, double timeStep)
+{
+    double timeMin = traj.min();
+    double timeMax = traj.max();
+    std::vector<double> times;
+    for (double t=timeMin;t<=timeMax;t+=timeStep) {
+        times.push_back(t);
+    }
+    //Insert splines knots
+    for (const auto& sp : traj.get()) {
+        for (size_t i=0;i<sp.second.size();i++) {
+            double t = sp.second.part(i).min;
+            if (t >= timeMin && t <= timeMax) {
+                times.push_back(t);
+            }
+        }
+    }
+    std::sort(times.begin(), times.end());
+    //Remove too close times
+    std::vector<double> grid;
+    for (size_t i=0;i<times.size();i++) {
+        if (grid.size() == 0 || times[i] - grid.back() > 1e-6) {
+            grid.push_back(times[i]);
+        }
+    }
+
+    return grid;
+}
+
 double DefaultCheckState(
     const Eigen::VectorXd& params,
     double t,
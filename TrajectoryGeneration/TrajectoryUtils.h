@@ -1,6 +1,7 @@
 #ifndef LEPH_TRAJECTORYUTILS_H
 #define LEPH_TRAJECTORYUTILS_H
 
+#include <vector>
 #include "Spline/SmoothSpline.hpp"
 #include "Spline/SplineContainer.hpp"
 #include "Model/HumanoidFixedModel.hpp"
@@ -66,6 +67,16 @@ bool TrajectoriesComputeKinematics(
     Eigen::VectorXd& dq, Eigen::VectorXd& ddq,
     double* boundIKDistance = nullptr);
 
+/**
+ * Build and return the sorted evaluation times
+ * of given trajectories. Times are sampled every
+ * given timeStep from trajectories minimum to 
+ * maximum and all splines knots (parts bounds) 
+ * are also inserted.
+ */
+std::vector<double> TrajectoriesTimeGrid(
+    const Trajectories& traj, double timeStep);
+
 /**
  * Default Cartesian state check function.
  * Return positive cost value
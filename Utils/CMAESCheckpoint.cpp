@@ -0,0 +1,243 @@
+#include <fstream>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include "Utils/CMAESCheckpoint.hpp"
+
+namespace Leph {
+
+/**
+ * Binary file format header
+ */
+static const char CheckpointMagic[8] =
+    {'L', 'E', 'P', 'H', 'C', 'M', 'A', '1'};
+
+/**
+ * Write and read Eigen matrix as
+ * rows, cols and column major data
+ */
+static void writeMatrix(std::ostream& os, const Eigen::MatrixXd& mat)
+{
+    uint64_t rows = mat.rows();
+    uint64_t cols = mat.cols();
+    os.write((const char*)&rows, sizeof(rows));
+    os.write((const char*)&cols, sizeof(cols));
+    os.write((const char*)mat.data(), rows*cols*sizeof(double));
+}
+static Eigen::MatrixXd readMatrix(std::istream& is)
+{
+    uint64_t rows = 0;
+    uint64_t cols = 0;
+    is.read((char*)&rows, sizeof(rows));
+    is.read((char*)&cols, sizeof(cols));
+    if (!is.good()) {
+        throw std::logic_error(
+            "CMAESCheckpoint binary format invalid");
+    }
+    Eigen::MatrixXd mat(rows, cols);
+    is.read((char*)mat.data(), rows*cols*sizeof(double));
+    if (!is.good()) {
+        throw std::logic_error(
+            "CMAESCheckpoint binary format invalid");
+    }
+    return mat;
+}
+
+CMAESCheckpoint::CMAESCheckpoint() :
+    _mean(),
+    _covariance(),
+    _sigma(0.0),
+    _iteration(0),
+    _totalIterations(0),
+    _evaluations(0),
+    _restart(0),
+    _rawIteration(0),
+    _iterationOffset(0),
+    _seed(0),
+    _bestParams(),
+    _bestScore(-1.0),
+    _userData()
+{
+}
+
+bool CMAESCheckpoint::isValid() const
+{
+    return _mean.size() > 0;
+}
+
+void CMAESCheckpoint::update(
+    const libcmaes::CMAParameters<>& cmaparams,
+    const libcmaes::CMASolutions& cmasols)
+{
+    //libcmaes iteration counter is reset on restart
+    unsigned long rawIteration = cmasols.niter();
+    if (rawIteration < _rawIteration) {
+        _restart++;
+        _iterationOffset = 0;
+    }
+    _rawIteration = rawIteration;
+    _iteration = _iterationOffset + rawIteration;
+    _totalIterations++;
+    _evaluations = cmasols.nevals();
+    _mean = cmasols.xmean();
+    _covariance = cmasols.cov();
+    _sigma = cmasols.sigma();
+    _seed = cmaparams.get_seed();
+}
+
+void CMAESCheckpoint::setBest(
+    const Eigen::VectorXd& params, double score)
+{
+    _bestParams = params;
+    _bestScore = score;
+}
+
+void CMAESCheckpoint::setUserData(const Eigen::VectorXd& data)
+{
+    _userData = data;
+}
+const Eigen::VectorXd& CMAESCheckpoint::userData() const
+{
+    return _userData;
+}
+
+const Eigen::VectorXd& CMAESCheckpoint::mean() const
+{
+    return _mean;
+}
+const Eigen::MatrixXd& CMAESCheckpoint::covariance() const
+{
+    return _covariance;
+}
+double CMAESCheckpoint::sigma() const
+{
+    return _sigma;
+}
+unsigned long CMAESCheckpoint::iteration() const
+{
+    return _iteration;
+}
+unsigned long CMAESCheckpoint::totalIterations() const
+{
+    return _totalIterations;
+}
+unsigned long CMAESCheckpoint::evaluations() const
+{
+    return _evaluations;
+}
+unsigned int CMAESCheckpoint::restart() const
+{
+    return _restart;
+}
+uint64_t CMAESCheckpoint::seed() const
+{
+    return _seed;
+}
+const Eigen::VectorXd& CMAESCheckpoint::bestParams() const
+{
+    return _bestParams;
+}
+double CMAESCheckpoint::bestScore() const
+{
+    return _bestScore;
+}
+
+double CMAESCheckpoint::warmRestartSigma() const
+{
+    if (
+        _covariance.rows() == 0 ||
+        _covariance.rows() != _covariance.cols()
+    ) {
+        return _sigma;
+    }
+    return _sigma*std::sqrt(
+        _covariance.trace()/(double)_covariance.rows());
+}
+
+void CMAESCheckpoint::exportBinary(const std::string& fileName) const
+{
+    std::string tmpFileName = fileName + ".tmp";
+    std::ofstream file(tmpFileName, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error(
+            "CMAESCheckpoint unable to write file: "
+            + tmpFileName);
+    }
+
+    uint64_t iteration = _iteration;
+    uint64_t totalIterations = _totalIterations;
+    uint64_t evaluations = _evaluations;
+    uint64_t restart = _restart;
+    file.write(CheckpointMagic, sizeof(CheckpointMagic));
+    file.write((const char*)&iteration, sizeof(iteration));
+    file.write((const char*)&totalIterations, sizeof(totalIterations));
+    file.write((const char*)&evaluations, sizeof(evaluations));
+    file.write((const char*)&restart, sizeof(restart));
+    file.write((const char*)&_seed, sizeof(_seed));
+    file.write((const char*)&_sigma, sizeof(_sigma));
+    file.write((const char*)&_bestScore, sizeof(_bestScore));
+    writeMatrix(file, _mean);
+    writeMatrix(file, _covariance);
+    writeMatrix(file, _bestParams);
+    writeMatrix(file, _userData);
+    file.close();
+    if (!file.good()) {
+        throw std::runtime_error(
+            "CMAESCheckpoint unable to write file: "
+            + tmpFileName);
+    }
+
+    if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+        throw std::runtime_error(
+            "CMAESCheckpoint unable to rename file: "
+            + fileName);
+    }
+}
+
+void CMAESCheckpoint::importBinary(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error(
+            "CMAESCheckpoint unable to read file: "
+            + fileName);
+    }
+
+    char magic[sizeof(CheckpointMagic)];
+    uint64_t iteration = 0;
+    uint64_t totalIterations = 0;
+    uint64_t evaluations = 0;
+    uint64_t restart = 0;
+    file.read(magic, sizeof(magic));
+    file.read((char*)&iteration, sizeof(iteration));
+    file.read((char*)&totalIterations, sizeof(totalIterations));
+    file.read((char*)&evaluations, sizeof(evaluations));
+    file.read((char*)&restart, sizeof(restart));
+    file.read((char*)&_seed, sizeof(_seed));
+    file.read((char*)&_sigma, sizeof(_sigma));
+    file.read((char*)&_bestScore, sizeof(_bestScore));
+    if (
+        !file.good() ||
+        memcmp(magic, CheckpointMagic, sizeof(magic)) != 0
+    ) {
+        throw std::logic_error(
+            "CMAESCheckpoint binary format invalid");
+    }
+    _iteration = iteration;
+    _totalIterations = totalIterations;
+    _evaluations = evaluations;
+    _restart = restart;
+    //Warm restarted iterations are
+    //counted from saved iteration
+    _rawIteration = 0;
+    _iterationOffset = _iteration;
+    _mean = readMatrix(file);
+    _covariance = readMatrix(file);
+    _bestParams = readMatrix(file);
+    _userData = readMatrix(file);
+
+    file.close();
+}
+
+}
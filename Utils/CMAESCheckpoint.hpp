@@ -0,0 +1,151 @@
+#ifndef LEPH_CMAESCHECKPOINT_HPP
+#define LEPH_CMAESCHECKPOINT_HPP
+
+#include <string>
+#include <cstdint>
+#include <Eigen/Dense>
+#include <libcmaes/cmaes.h>
+
+namespace Leph {
+
+/**
+ * CMAESCheckpoint
+ *
+ * Snapshot of a running libcmaes optimization
+ * (distribution mean, covariance and step size,
+ * iteration and restart counters, random seed
+ * and best found candidate) saved into a binary
+ * file in order to warm restart a long optimization.
+ * The evolution paths and the random engine state
+ * are not exposed by libcmaes and are not saved:
+ * a warm restart only reuses the mean, the
+ * covariance folded into an isotropic step size,
+ * the counters and the best candidate, with a
+ * fresh seed. It is not an exact state restore.
+ * Parameters are in CMA-ES (normalized) space.
+ */
+class CMAESCheckpoint
+{
+    public:
+
+        /**
+         * Empty initialization
+         */
+        CMAESCheckpoint();
+
+        /**
+         * Return true if a state
+         * has been assigned or loaded
+         */
+        bool isValid() const;
+
+        /**
+         * Update the state from CMA-ES progress
+         * function arguments. Restarts are detected
+         * from the iteration counter.
+         */
+        void update(
+            const libcmaes::CMAParameters<>& cmaparams,
+            const libcmaes::CMASolutions& cmasols);
+
+        /**
+         * Assign the best candidate
+         * found since the beginning
+         */
+        void setBest(const Eigen::VectorXd& params, double score);
+
+        /**
+         * Set and return optional 
+         * user defined state saved along
+         */
+        void setUserData(const Eigen::VectorXd& data);
+        const Eigen::VectorXd& userData() const;
+
+        /**
+         * Access to saved state
+         */
+        const Eigen::VectorXd& mean() const;
+        const Eigen::MatrixXd& covariance() const;
+        double sigma() const;
+        unsigned long iteration() const;
+        unsigned long totalIterations() const;
+        unsigned long evaluations() const;
+        unsigned int restart() const;
+        uint64_t seed() const;
+        const Eigen::VectorXd& bestParams() const;
+        double bestScore() const;
+
+        /**
+         * Return the isotropic step size
+         * used to warm restart the optimization.
+         * The covariance shape is folded into
+         * the step size as sigma*sqrt(trace(C)/dim)
+         * since libcmaes does not allow to
+         * reinject a covariance matrix.
+         */
+        double warmRestartSigma() const;
+
+        /**
+         * Write the state to given file.
+         * The file is first written under a
+         * temporary name and then renamed so
+         * that an interrupted write never
+         * corrupts previous checkpoint.
+         */
+        void exportBinary(const std::string& fileName) const;
+
+        /**
+         * Load the state from given file
+         */
+        void importBinary(const std::string& fileName);
+
+    private:
+
+        /**
+         * Distribution mean,
+         * covariance and step size
+         */
+        Eigen::VectorXd _mean;
+        Eigen::MatrixXd _covariance;
+        double _sigma;
+
+        /**
+         * Iteration in current restart,
+         * iterations since the beginning,
+         * fitness evaluations and
+         * restart counters
+         */
+        unsigned long _iteration;
+        unsigned long _totalIterations;
+        unsigned long _evaluations;
+        unsigned int _restart;
+
+        /**
+         * Last libcmaes iteration counter and
+         * iteration offset of warm restarted run
+         * (not saved)
+         */
+        unsigned long _rawIteration;
+        unsigned long _iterationOffset;
+
+        /**
+         * Optimization random seed
+         */
+        uint64_t _seed;
+
+        /**
+         * Best found candidate
+         * and associated score
+         */
+        Eigen::VectorXd _bestParams;
+        double _bestScore;
+
+        /**
+         * Optional user state
+         */
+        Eigen::VectorXd _userData;
+};
+
+}
+
+#endif
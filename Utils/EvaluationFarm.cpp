@@ -0,0 +1,643 @@
+#include <stdexcept>
+#include <cstdint>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <netdb.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "Utils/EvaluationFarm.hpp"
+
+namespace Leph {
+
+/**
+ * Blocking write and read of given size
+ * on a socket. Return false on disconnection.
+ */
+static bool writeAll(int fd, const void* data, size_t size)
+{
+    const char* ptr = (const char*)data;
+    while (size > 0) {
+        ssize_t len = send(fd, ptr, size, MSG_NOSIGNAL);
+        if (len < 0 && errno == EINTR) {
+            continue;
+        }
+        if (len <= 0) {
+            return false;
+        }
+        ptr += len;
+        size -= len;
+    }
+    return true;
+}
+static bool readAll(int fd, void* data, size_t size)
+{
+    char* ptr = (char*)data;
+    while (size > 0) {
+        ssize_t len = recv(fd, ptr, size, 0);
+        if (len < 0 && errno == EINTR) {
+            continue;
+        }
+        if (len <= 0) {
+            return false;
+        }
+        ptr += len;
+        size -= len;
+    }
+    return true;
+}
+
+/**
+ * Non blocking read appending available data
+ * to given buffer up to given total size.
+ * Return false on disconnection or error.
+ */
+static bool readAvailable(int fd, std::vector<char>& buffer, size_t size)
+{
+    while (buffer.size() < size) {
+        char data[4096];
+        ssize_t len = recv(fd, data, 
+            std::min(sizeof(data), size - buffer.size()), MSG_DONTWAIT);
+        if (len < 0 && errno == EINTR) {
+            continue;
+        }
+        if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        if (len <= 0) {
+            return false;
+        }
+        buffer.insert(buffer.end(), data, data + len);
+    }
+    return true;
+}
+
+/**
+ * Disable Nagle algorithm on TCP sockets
+ * since batches are small and latency bound
+ */
+static void setNoDelay(int fd)
+{
+    int flag = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+EvaluationFarm::EvaluationFarm(
+    Func func,
+    unsigned int batchSize,
+    double timeout,
+    double failureValue) :
+    _func(func),
+    _batchSize(batchSize),
+    _timeout(timeout),
+    _failureValue(failureValue),
+    _workers(),
+    _spares(),
+    _requests(),
+    _pending(),
+    _nextId(0),
+    _mutex(),
+    _condition(),
+    _thread(),
+    _isRunning(false),
+    _wakeFds{-1, -1},
+    _failureCount(0)
+{
+    if (_batchSize == 0) {
+        throw std::logic_error(
+            "EvaluationFarm invalid batch size");
+    }
+    if (pipe(_wakeFds) != 0) {
+        throw std::runtime_error(
+            "EvaluationFarm pipe failed: "
+            + std::string(strerror(errno)));
+    }
+    fcntl(_wakeFds[0], F_SETFL, O_NONBLOCK);
+    fcntl(_wakeFds[1], F_SETFL, O_NONBLOCK);
+}
+
+EvaluationFarm::~EvaluationFarm()
+{
+    stop();
+    close(_wakeFds[0]);
+    close(_wakeFds[1]);
+}
+
+void EvaluationFarm::addLocalWorkers(
+    unsigned int count, unsigned int spareCount)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_thread.joinable()) {
+        throw std::logic_error(
+            "EvaluationFarm workers must be added before evaluation");
+    }
+    for (unsigned int i=0;i<count;i++) {
+        _workers.push_back(forkWorker());
+    }
+    for (unsigned int i=0;i<spareCount;i++) {
+        _spares.push_back(forkWorker());
+    }
+}
+
+void EvaluationFarm::addTCPWorker(
+    const std::string& host, unsigned int port)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_thread.joinable()) {
+        throw std::logic_error(
+            "EvaluationFarm workers must be added before evaluation");
+    }
+    Worker worker = connectWorker(host, port);
+    if (!worker.isAlive) {
+        throw std::runtime_error(
+            "EvaluationFarm unable to connect: "
+            + host + ":" + std::to_string(port));
+    }
+    _workers.push_back(worker);
+}
+
+size_t EvaluationFarm::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t count = 0;
+    for (const Worker& worker : _workers) {
+        if (worker.isAlive) {
+            count++;
+        }
+    }
+    return count;
+}
+
+unsigned long EvaluationFarm::failureCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _failureCount;
+}
+
+double EvaluationFarm::evaluate(const Eigen::VectorXd& params)
+{
+    return evaluate(std::vector<Eigen::VectorXd>({params})).front();
+}
+
+std::vector<double> EvaluationFarm::evaluate(
+    const std::vector<Eigen::VectorXd>& params)
+{
+    std::vector<Request> requests(params.size());
+    std::vector<size_t> ids(params.size());
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_workers.size() == 0) {
+        throw std::logic_error(
+            "EvaluationFarm no worker");
+    }
+    startThread();
+
+    //Queue the requests and wake up
+    //the dispatch thread
+    for (size_t i=0;i<params.size();i++) {
+        requests[i].params = &(params[i]);
+        requests[i].value = _failureValue;
+        requests[i].isDone = false;
+        ids[i] = _nextId;
+        _nextId++;
+        _requests[ids[i]] = &(requests[i]);
+        _pending.push_back(ids[i]);
+    }
+    char byte = 0;
+    if (write(_wakeFds[1], &byte, 1) < 0) {
+        //Pipe full, dispatch thread is already woken up
+    }
+
+    //Wait for all own results
+    _condition.wait(lock, [&requests]() {
+        for (const Request& request : requests) {
+            if (!request.isDone) {
+                return false;
+            }
+        }
+        return true;
+    });
+    std::vector<double> values(params.size());
+    for (size_t i=0;i<params.size();i++) {
+        _requests.erase(ids[i]);
+        values[i] = requests[i].value;
+    }
+    //Do not silently return failure
+    //values once all workers are dead
+    bool isAnyAlive = false;
+    for (const Worker& worker : _workers) {
+        if (worker.isAlive) {
+            isAnyAlive = true;
+        }
+    }
+    if (!isAnyAlive) {
+        throw std::runtime_error(
+            "EvaluationFarm no worker left alive");
+    }
+
+    return values;
+}
+
+void EvaluationFarm::stop()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_thread.joinable()) {
+        _isRunning = false;
+        char byte = 0;
+        if (write(_wakeFds[1], &byte, 1) < 0) {
+            //Pipe full, dispatch thread is already woken up
+        }
+        lock.unlock();
+        _thread.join();
+        lock.lock();
+    }
+    //Send shutdown message and wait for
+    //local processes termination
+    _workers.insert(_workers.end(), _spares.begin(), _spares.end());
+    _spares.clear();
+    for (Worker& worker : _workers) {
+        if (!worker.isAlive) {
+            continue;
+        }
+        uint64_t header[2] = {0, 0};
+        writeAll(worker.fd, header, sizeof(header));
+        close(worker.fd);
+        if (worker.pid > 0) {
+            waitpid(worker.pid, nullptr, 0);
+        }
+        worker.isAlive = false;
+    }
+    _workers.clear();
+}
+
+void EvaluationFarm::serveTCP(
+    unsigned int port,
+    Func func,
+    double failureValue)
+{
+    int fdListen = socket(AF_INET, SOCK_STREAM, 0);
+    if (fdListen < 0) {
+        throw std::runtime_error(
+            "EvaluationFarm socket failed: "
+            + std::string(strerror(errno)));
+    }
+    int flag = 1;
+    setsockopt(fdListen, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (
+        bind(fdListen, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(fdListen, 16) != 0
+    ) {
+        close(fdListen);
+        throw std::runtime_error(
+            "EvaluationFarm unable to listen on port: "
+            + std::to_string(port));
+    }
+
+    while (true) {
+        int fd = accept(fdListen, nullptr, nullptr);
+        //Reap terminated connection processes
+        while (waitpid(-1, nullptr, WNOHANG) > 0) {
+        }
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            close(fdListen);
+            throw std::runtime_error(
+                "EvaluationFarm accept failed: "
+                + std::string(strerror(errno)));
+        }
+        setNoDelay(fd);
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fdListen);
+            workerLoop(fd, func, failureValue);
+            _exit(0);
+        }
+        close(fd);
+    }
+}
+
+EvaluationFarm::Worker EvaluationFarm::forkWorker()
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        throw std::runtime_error(
+            "EvaluationFarm socketpair failed: "
+            + std::string(strerror(errno)));
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        throw std::runtime_error(
+            "EvaluationFarm fork failed: "
+            + std::string(strerror(errno)));
+    }
+    if (pid == 0) {
+        //Close the other connections so that
+        //each worker only holds its own socket
+        close(fds[0]);
+        close(_wakeFds[0]);
+        close(_wakeFds[1]);
+        for (const Worker& worker : _workers) {
+            if (worker.isAlive) {
+                close(worker.fd);
+            }
+        }
+        for (const Worker& worker : _spares) {
+            close(worker.fd);
+        }
+        workerLoop(fds[1], _func, _failureValue);
+        _exit(0);
+    }
+    close(fds[1]);
+
+    Worker worker;
+    worker.fd = fds[0];
+    worker.pid = pid;
+    worker.host = "";
+    worker.port = 0;
+    worker.isAlive = true;
+    return worker;
+}
+
+EvaluationFarm::Worker EvaluationFarm::connectWorker(
+    const std::string& host, unsigned int port)
+{
+    Worker worker;
+    worker.fd = -1;
+    worker.pid = -1;
+    worker.host = host;
+    worker.port = port;
+    worker.isAlive = false;
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* result = nullptr;
+    std::string service = std::to_string(port);
+    if (getaddrinfo(host.c_str(), service.c_str(), &hints, &result) != 0) {
+        return worker;
+    }
+    for (struct addrinfo* it=result;it!=nullptr;it=it->ai_next) {
+        int fd = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (connect(fd, it->ai_addr, it->ai_addrlen) == 0) {
+            setNoDelay(fd);
+            worker.fd = fd;
+            worker.isAlive = true;
+            break;
+        }
+        close(fd);
+    }
+    freeaddrinfo(result);
+
+    return worker;
+}
+
+void EvaluationFarm::startThread()
+{
+    if (!_thread.joinable()) {
+        _isRunning = true;
+        _thread = std::thread(&EvaluationFarm::dispatchLoop, this);
+    }
+}
+
+void EvaluationFarm::dispatchLoop()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_isRunning) {
+        //Send pending requests to idle workers
+        bool isAnyAlive = false;
+        for (Worker& worker : _workers) {
+            if (worker.isAlive) {
+                isAnyAlive = true;
+            }
+            if (
+                worker.isAlive &&
+                worker.batch.size() == 0 &&
+                _pending.size() > 0
+            ) {
+                sendBatch(worker);
+            }
+        }
+        //No worker left, fail all pending requests
+        if (!isAnyAlive) {
+            while (_pending.size() > 0) {
+                Request* request = _requests.at(_pending.front());
+                request->value = _failureValue;
+                request->isDone = true;
+                _failureCount++;
+                _pending.pop_front();
+            }
+            _condition.notify_all();
+        }
+
+        //Wait for wake up, results or the
+        //nearest batch timeout
+        std::vector<struct pollfd> fds;
+        std::vector<size_t> indexes;
+        fds.push_back({_wakeFds[0], POLLIN, 0});
+        int timeoutMs = -1;
+        auto now = std::chrono::steady_clock::now();
+        for (size_t i=0;i<_workers.size();i++) {
+            if (!_workers[i].isAlive || _workers[i].batch.size() == 0) {
+                continue;
+            }
+            fds.push_back({_workers[i].fd, POLLIN, 0});
+            indexes.push_back(i);
+            if (_timeout >= 0.0) {
+                double elapsed = std::chrono::duration<double>(
+                    now - _workers[i].start).count();
+                int remaining = std::max(0,
+                    (int)std::ceil((_timeout - elapsed)*1000.0));
+                if (timeoutMs < 0 || remaining < timeoutMs) {
+                    timeoutMs = remaining;
+                }
+            }
+        }
+        lock.unlock();
+        int ret = poll(fds.data(), fds.size(), timeoutMs);
+        //Read available results without the mutex so
+        //that requests can still be queued. Workers and 
+        //their batches and buffers are only modified by 
+        //the dispatch thread. Reads are non blocking so 
+        //that a partial reply does not stall timeouts.
+        std::vector<bool> isFailed(indexes.size(), false);
+        for (size_t k=0;ret>0 && k<indexes.size();k++) {
+            Worker& worker = _workers[indexes[k]];
+            if (fds[k+1].revents & (POLLIN | POLLHUP | POLLERR)) {
+                isFailed[k] = !readAvailable(worker.fd, worker.buffer,
+                    worker.batch.size()*sizeof(double));
+            }
+        }
+        lock.lock();
+        if (ret < 0 && errno != EINTR) {
+            throw std::runtime_error(
+                "EvaluationFarm poll failed: "
+                + std::string(strerror(errno)));
+        }
+        if (ret < 0) {
+            continue;
+        }
+
+        //Drain wake up pipe
+        if (fds[0].revents & POLLIN) {
+            char buffer[64];
+            while (read(_wakeFds[0], buffer, sizeof(buffer)) > 0) {
+            }
+        }
+        //Read results and check timeouts
+        now = std::chrono::steady_clock::now();
+        for (size_t k=0;k<indexes.size();k++) {
+            Worker& worker = _workers[indexes[k]];
+            if (isFailed[k]) {
+                failWorker(worker);
+            } else if (
+                worker.buffer.size() == worker.batch.size()*sizeof(double)
+            ) {
+                receiveBatch(worker);
+            } else if (
+                _timeout >= 0.0 &&
+                std::chrono::duration<double>(
+                    now - worker.start).count() >= _timeout
+            ) {
+                failWorker(worker);
+            }
+        }
+        _condition.notify_all();
+    }
+}
+
+void EvaluationFarm::sendBatch(Worker& worker)
+{
+    //Take up to batch size pending
+    //requests of same dimension
+    size_t dim = _requests.at(_pending.front())->params->size();
+    worker.batch.clear();
+    while (
+        _pending.size() > 0 &&
+        worker.batch.size() < _batchSize &&
+        (size_t)_requests.at(_pending.front())->params->size() == dim
+    ) {
+        worker.batch.push_back(_pending.front());
+        _pending.pop_front();
+    }
+
+    //Batch message is the count and dimension
+    //followed by all vectors values
+    std::vector<double> data(worker.batch.size()*dim);
+    for (size_t i=0;i<worker.batch.size();i++) {
+        const Eigen::VectorXd& params =
+            *(_requests.at(worker.batch[i])->params);
+        std::copy(params.data(), params.data() + dim,
+            data.begin() + i*dim);
+    }
+    uint64_t header[2] = {worker.batch.size(), dim};
+    worker.buffer.clear();
+    worker.start = std::chrono::steady_clock::now();
+    if (
+        !writeAll(worker.fd, header, sizeof(header)) ||
+        !writeAll(worker.fd, data.data(), data.size()*sizeof(double))
+    ) {
+        failWorker(worker);
+    }
+}
+
+void EvaluationFarm::receiveBatch(Worker& worker)
+{
+    for (size_t i=0;i<worker.batch.size();i++) {
+        Request* request = _requests.at(worker.batch[i]);
+        memcpy(&(request->value), 
+            worker.buffer.data() + i*sizeof(double), sizeof(double));
+        request->isDone = true;
+    }
+    worker.batch.clear();
+    worker.buffer.clear();
+}
+
+void EvaluationFarm::failWorker(Worker& worker)
+{
+    for (size_t id : worker.batch) {
+        Request* request = _requests.at(id);
+        request->value = _failureValue;
+        request->isDone = true;
+        _failureCount++;
+    }
+    worker.batch.clear();
+    worker.buffer.clear();
+    close(worker.fd);
+    worker.isAlive = false;
+    if (worker.pid > 0) {
+        //No fork while other threads are running,
+        //use an already forked spare worker
+        kill(worker.pid, SIGKILL);
+        waitpid(worker.pid, nullptr, 0);
+        if (_spares.size() > 0) {
+            worker = _spares.back();
+            _spares.pop_back();
+        }
+    } else {
+        worker = connectWorker(worker.host, worker.port);
+    }
+    if (!worker.isAlive) {
+        size_t count = 0;
+        for (const Worker& other : _workers) {
+            if (other.isAlive) {
+                count++;
+            }
+        }
+        std::cerr << "EvaluationFarm worker lost without replacement, "
+            << count << " workers left alive" << std::endl;
+    }
+}
+
+void EvaluationFarm::workerLoop(
+    int fd, Func& func, double failureValue)
+{
+    while (true) {
+        uint64_t header[2];
+        if (!readAll(fd, header, sizeof(header)) || header[0] == 0) {
+            break;
+        }
+        size_t count = header[0];
+        size_t dim = header[1];
+        std::vector<double> data(count*dim);
+        if (!readAll(fd, data.data(), data.size()*sizeof(double))) {
+            break;
+        }
+        std::vector<double> values(count);
+        for (size_t i=0;i<count;i++) {
+            Eigen::VectorXd params =
+                Eigen::Map<Eigen::VectorXd>(data.data() + i*dim, dim);
+            try {
+                values[i] = func(params);
+            } catch (const std::exception&) {
+                values[i] = failureValue;
+            }
+        }
+        if (!writeAll(fd, values.data(), values.size()*sizeof(double))) {
+            break;
+        }
+    }
+    close(fd);
+}
+
+}
+
@@ -0,0 +1,251 @@
+#ifndef LEPH_EVALUATIONFARM_HPP
+#define LEPH_EVALUATIONFARM_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <sys/types.h>
+#include <Eigen/Dense>
+
+namespace Leph {
+
+/**
+ * EvaluationFarm
+ *
+ * Dispatch evaluations of a (fitness) function
+ * on vectors to a pool of worker processes.
+ * Local workers are forked and talk over Unix
+ * socket pairs. Remote workers are reached over
+ * TCP (see serveTCP()) and must run the same
+ * binary on the same architecture.
+ * Concurrent requests (for example from libcmaes
+ * OpenMP fitness threads) are batched per worker.
+ * Each result is returned to its own request so
+ * that values are reassembled in request order
+ * whatever the worker which computed it.
+ * Local workers must be forked before any other
+ * thread (OpenMP) is started. No process is forked
+ * afterwards: a failed local worker is replaced by
+ * a spare worker forked by addLocalWorkers() or is
+ * left dead if none is available. Evaluations 
+ * throw once no worker is left alive.
+ */
+class EvaluationFarm
+{
+    public:
+
+        /**
+         * Evaluated function type
+         */
+        typedef std::function<double(const Eigen::VectorXd&)> Func;
+
+        /**
+         * Initialization with the evaluated function,
+         * the maximum number of vectors sent at once to
+         * a worker, the timeout in seconds of a batch
+         * (negative is infinite) and the value returned
+         * when an evaluation has timed out or failed
+         */
+        EvaluationFarm(
+            Func func,
+            unsigned int batchSize = 1,
+            double timeout = -1.0,
+            double failureValue = 1e10);
+
+        /**
+         * Stop all workers
+         */
+        ~EvaluationFarm();
+
+        /**
+         * Workers and dispatch thread are not copyable
+         */
+        EvaluationFarm(const EvaluationFarm&) = delete;
+        EvaluationFarm& operator=(const EvaluationFarm&) = delete;
+
+        /**
+         * Fork given number of local workers
+         * and of idle spare workers used to
+         * replace failed local workers
+         */
+        void addLocalWorkers(
+            unsigned int count, 
+            unsigned int spareCount = 0);
+
+        /**
+         * Connect to a remote worker
+         * listening at given host and port
+         */
+        void addTCPWorker(const std::string& host, unsigned int port);
+
+        /**
+         * Return the number of alive workers
+         */
+        size_t size() const;
+
+        /**
+         * Return the number of evaluations
+         * which have timed out or failed
+         */
+        unsigned long failureCount() const;
+
+        /**
+         * Evaluate given vector on a worker and return
+         * the function value. Thread safe. Blocking until
+         * the result is received. Throw std::runtime_error
+         * if no worker is left alive.
+         */
+        double evaluate(const Eigen::VectorXd& params);
+
+        /**
+         * Evaluate all given vectors on workers
+         * and return function values in same order
+         */
+        std::vector<double> evaluate(
+            const std::vector<Eigen::VectorXd>& params);
+
+        /**
+         * Stop and disconnect all workers
+         */
+        void stop();
+
+        /**
+         * Run forever a TCP worker server listening
+         * on given port. A process is forked for each
+         * connected farm and evaluates given function.
+         */
+        static void serveTCP(
+            unsigned int port,
+            Func func,
+            double failureValue = 1e10);
+
+    private:
+
+        /**
+         * Worker process connection.
+         * Pid is -1 for remote workers.
+         * Buffer holds the partially 
+         * received batch result.
+         */
+        struct Worker {
+            int fd;
+            pid_t pid;
+            std::string host;
+            unsigned int port;
+            bool isAlive;
+            std::vector<size_t> batch;
+            std::vector<char> buffer;
+            std::chrono::steady_clock::time_point start;
+        };
+
+        /**
+         * Pending evaluation request
+         */
+        struct Request {
+            const Eigen::VectorXd* params;
+            double value;
+            bool isDone;
+        };
+
+        /**
+         * Evaluated function and
+         * dispatch configuration
+         */
+        Func _func;
+        unsigned int _batchSize;
+        double _timeout;
+        double _failureValue;
+
+        /**
+         * Workers pool and idle
+         * local spare workers
+         */
+        std::vector<Worker> _workers;
+        std::vector<Worker> _spares;
+
+        /**
+         * Requests being evaluated indexed by
+         * id and identifiers not yet dispatched
+         */
+        std::map<size_t, Request*> _requests;
+        std::deque<size_t> _pending;
+        size_t _nextId;
+
+        /**
+         * Mutex protecting requests and workers,
+         * condition notified on done requests
+         */
+        mutable std::mutex _mutex;
+        std::condition_variable _condition;
+
+        /**
+         * Dispatch thread, its stop flag and the
+         * self pipe used to wake it up
+         */
+        std::thread _thread;
+        bool _isRunning;
+        int _wakeFds[2];
+
+        /**
+         * Timed out or failed evaluations count
+         */
+        unsigned long _failureCount;
+
+        /**
+         * Fork a new local worker process
+         * or connect to a remote worker
+         */
+        Worker forkWorker();
+        static Worker connectWorker(
+            const std::string& host, unsigned int port);
+
+        /**
+         * Start the dispatch thread if needed
+         */
+        void startThread();
+
+        /**
+         * Dispatch thread main loop
+         */
+        void dispatchLoop();
+
+        /**
+         * Send pending requests to given idle worker.
+         * Called with mutex locked.
+         */
+        void sendBatch(Worker& worker);
+
+        /**
+         * Assign the complete batch result held
+         * in the buffer of given worker to its
+         * requests. Called with mutex locked.
+         */
+        void receiveBatch(Worker& worker);
+
+        /**
+         * Assign failure value to current batch of
+         * given worker, disconnect it and replace it
+         * by a spare (or reconnect) it. A local worker
+         * is never forked again. Called with mutex locked.
+         */
+        void failWorker(Worker& worker);
+
+        /**
+         * Worker process main loop evaluating batches
+         * read from given file descriptor until
+         * shutdown or disconnection
+         */
+        static void workerLoop(
+            int fd, Func& func, double failureValue);
+};
+
+}
+
+#endif
+
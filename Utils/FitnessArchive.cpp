@@ -0,0 +1,241 @@
+#include <fstream>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <functional>
+#include "Utils/FitnessArchive.hpp"
+
+namespace Leph {
+
+/**
+ * Binary file format header
+ */
+static const char ArchiveMagic[8] =
+    {'L', 'E', 'P', 'H', 'F', 'I', 'T', '2'};
+
+/**
+ * Write and read Eigen vector
+ * as size and data
+ */
+static void writeVector(std::ostream& os, const Eigen::VectorXd& vect)
+{
+    uint64_t size = vect.size();
+    os.write((const char*)&size, sizeof(size));
+    os.write((const char*)vect.data(), size*sizeof(double));
+}
+static Eigen::VectorXd readVector(std::istream& is)
+{
+    uint64_t size = 0;
+    is.read((char*)&size, sizeof(size));
+    if (!is.good()) {
+        throw std::logic_error(
+            "FitnessArchive binary format invalid");
+    }
+    Eigen::VectorXd vect(size);
+    is.read((char*)vect.data(), size*sizeof(double));
+    if (!is.good()) {
+        throw std::logic_error(
+            "FitnessArchive binary format invalid");
+    }
+    return vect;
+}
+
+size_t FitnessArchive::KeyHash::operator()(const Key& key) const
+{
+    //Boost like hash combination
+    size_t seed = key.size();
+    std::hash<int64_t> hasher;
+    for (int64_t value : key) {
+        seed ^= hasher(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+FitnessArchive::FitnessArchive(
+    double quantum, uint64_t configHash) :
+    _quantum(quantum),
+    _configHash(configHash),
+    _entries(),
+    _hits(0),
+    _misses(0),
+    _mutex()
+{
+    if (_quantum <= 0.0) {
+        throw std::logic_error(
+            "FitnessArchive invalid quantum");
+    }
+}
+
+uint64_t FitnessArchive::configHash() const
+{
+    return _configHash;
+}
+
+uint64_t FitnessArchive::hashData(
+    const void* data, size_t size, uint64_t hash)
+{
+    const unsigned char* ptr = (const unsigned char*)data;
+    for (size_t i=0;i<size;i++) {
+        hash ^= ptr[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool FitnessArchive::get(
+    const Eigen::VectorXd& params, double& score) const
+{
+    Eigen::VectorXd costs;
+    return get(params, score, costs);
+}
+bool FitnessArchive::get(
+    const Eigen::VectorXd& params,
+    double& score, Eigen::VectorXd& costs) const
+{
+    Key key = buildKey(params);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        _misses++;
+        return false;
+    }
+    _hits++;
+    score = it->second.score;
+    costs = it->second.costs;
+    return true;
+}
+
+void FitnessArchive::set(
+    const Eigen::VectorXd& params,
+    double score,
+    const Eigen::VectorXd& costs,
+    double time)
+{
+    Key key = buildKey(params);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries[key] = {params, score, costs, time};
+}
+
+size_t FitnessArchive::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+unsigned long FitnessArchive::hits() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hits;
+}
+unsigned long FitnessArchive::misses() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _misses;
+}
+
+void FitnessArchive::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+    _hits = 0;
+    _misses = 0;
+}
+
+std::vector<FitnessArchive::Entry> FitnessArchive::entries() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<Entry> container;
+    for (const auto& it : _entries) {
+        container.push_back(it.second);
+    }
+    return container;
+}
+
+void FitnessArchive::exportBinary(const std::string& fileName) const
+{
+    std::string tmpFileName = fileName + ".tmp";
+    std::ofstream file(tmpFileName, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error(
+            "FitnessArchive unable to write file: "
+            + tmpFileName);
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    uint64_t count = _entries.size();
+    file.write(ArchiveMagic, sizeof(ArchiveMagic));
+    file.write((const char*)&_configHash, sizeof(_configHash));
+    file.write((const char*)&count, sizeof(count));
+    for (const auto& it : _entries) {
+        file.write((const char*)&(it.second.score), sizeof(double));
+        file.write((const char*)&(it.second.time), sizeof(double));
+        writeVector(file, it.second.params);
+        writeVector(file, it.second.costs);
+    }
+    file.close();
+    if (!file.good()) {
+        throw std::runtime_error(
+            "FitnessArchive unable to write file: "
+            + tmpFileName);
+    }
+
+    if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+        throw std::runtime_error(
+            "FitnessArchive unable to rename file: "
+            + fileName);
+    }
+}
+
+void FitnessArchive::importBinary(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error(
+            "FitnessArchive unable to read file: "
+            + fileName);
+    }
+
+    char magic[sizeof(ArchiveMagic)];
+    uint64_t configHash = 0;
+    uint64_t count = 0;
+    file.read(magic, sizeof(magic));
+    file.read((char*)&configHash, sizeof(configHash));
+    file.read((char*)&count, sizeof(count));
+    if (
+        !file.good() ||
+        memcmp(magic, ArchiveMagic, sizeof(magic)) != 0
+    ) {
+        throw std::logic_error(
+            "FitnessArchive binary format invalid");
+    }
+    if (configHash != _configHash) {
+        throw std::logic_error(
+            "FitnessArchive configuration mismatch: " 
+            + fileName);
+    }
+    for (size_t i=0;i<count;i++) {
+        Entry entry;
+        file.read((char*)&(entry.score), sizeof(double));
+        file.read((char*)&(entry.time), sizeof(double));
+        entry.params = readVector(file);
+        entry.costs = readVector(file);
+        Key key = buildKey(entry.params);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries[key] = entry;
+    }
+
+    file.close();
+}
+
+FitnessArchive::Key FitnessArchive::buildKey(
+    const Eigen::VectorXd& params) const
+{
+    Key key(params.size());
+    for (size_t i=0;i<(size_t)params.size();i++) {
+        key[i] = (int64_t)std::llround(params(i)/_quantum);
+    }
+    return key;
+}
+
+}
+
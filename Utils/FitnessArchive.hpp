@@ -0,0 +1,157 @@
+#ifndef LEPH_FITNESSARCHIVE_HPP
+#define LEPH_FITNESSARCHIVE_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <Eigen/Dense>
+
+namespace Leph {
+
+/**
+ * FitnessArchive
+ *
+ * Thread safe memoization of fitness evaluations.
+ * Parameter vectors are quantized with a fixed
+ * step and hashed so that identical or nearly
+ * identical candidates (CMA-ES restarts, elitism,
+ * rescoring for display) are served from the
+ * archive. Each entry holds the score, optional
+ * per component costs (or any user vector) and
+ * the evaluation duration.
+ * The archive can be saved to and loaded from
+ * a binary file and its entries used to seed
+ * surrogate models or warm starts.
+ * The file header holds a hash of the evaluation
+ * configuration. Loading a file built with a
+ * different configuration is rejected.
+ */
+class FitnessArchive
+{
+    public:
+
+        /**
+         * Archived evaluation
+         */
+        struct Entry {
+            Eigen::VectorXd params;
+            double score;
+            Eigen::VectorXd costs;
+            double time;
+        };
+
+        /**
+         * Initialization with the parameters
+         * quantization step and the hash of the
+         * evaluation configuration (see hashData())
+         */
+        FitnessArchive(
+            double quantum = 1e-9, 
+            uint64_t configHash = 0);
+
+        /**
+         * Return the configuration hash
+         */
+        uint64_t configHash() const;
+
+        /**
+         * Combine given raw data into given
+         * hash (FNV-1a) and return the result.
+         * Used to build configuration hashes.
+         */
+        static uint64_t hashData(
+            const void* data, size_t size, 
+            uint64_t hash = 14695981039346656037ULL);
+
+        /**
+         * Return true and assign the score (and
+         * costs) if given parameters are archived
+         */
+        bool get(const Eigen::VectorXd& params, double& score) const;
+        bool get(const Eigen::VectorXd& params,
+            double& score, Eigen::VectorXd& costs) const;
+
+        /**
+         * Archive (or overwrite) the evaluation
+         * of given parameters with optional costs
+         * and duration in seconds
+         */
+        void set(
+            const Eigen::VectorXd& params,
+            double score,
+            const Eigen::VectorXd& costs = Eigen::VectorXd(),
+            double time = 0.0);
+
+        /**
+         * Return the number of archived entries
+         * and the number of served and missed
+         * queries since last clear
+         */
+        size_t size() const;
+        unsigned long hits() const;
+        unsigned long misses() const;
+
+        /**
+         * Remove all entries and reset counters
+         */
+        void clear();
+
+        /**
+         * Return a copy of all entries
+         */
+        std::vector<Entry> entries() const;
+
+        /**
+         * Write and load (merge) entries
+         * to and from given binary file.
+         * Throw std::logic_error if the file
+         * configuration hash does not match.
+         */
+        void exportBinary(const std::string& fileName) const;
+        void importBinary(const std::string& fileName);
+
+    private:
+
+        /**
+         * Quantized parameters key and its hash
+         */
+        typedef std::vector<int64_t> Key;
+        struct KeyHash {
+            size_t operator()(const Key& key) const;
+        };
+
+        /**
+         * Quantization step and
+         * configuration hash
+         */
+        double _quantum;
+        uint64_t _configHash;
+
+        /**
+         * Archived entries
+         */
+        std::unordered_map<Key, Entry, KeyHash> _entries;
+
+        /**
+         * Queries counters
+         */
+        mutable unsigned long _hits;
+        mutable unsigned long _misses;
+
+        /**
+         * Mutex protecting entries and counters
+         */
+        mutable std::mutex _mutex;
+
+        /**
+         * Build the key of given parameters
+         */
+        Key buildKey(const Eigen::VectorXd& params) const;
+};
+
+}
+
+#endif
+
@@ -0,0 +1,245 @@
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include "gp.h"
+#include "rprop.h"
+#include "Utils/FitnessSurrogate.hpp"
+
+namespace Leph {
+
+/**
+ * Minimum number of archived evaluations
+ * to fit the regression and of checked
+ * predictions to measure the correlation
+ */
+static const size_t MinFitSize = 10;
+static const size_t MinCheckSize = 5;
+
+/**
+ * Return the ranks of given values
+ */
+static Eigen::VectorXd ranks(const std::vector<double>& values)
+{
+    std::vector<size_t> indexes(values.size());
+    for (size_t i=0;i<values.size();i++) {
+        indexes[i] = i;
+    }
+    std::sort(indexes.begin(), indexes.end(),
+        [&values](size_t a, size_t b) {
+            return values[a] < values[b];
+        });
+    Eigen::VectorXd result(values.size());
+    for (size_t i=0;i<indexes.size();i++) {
+        result(indexes[i]) = i;
+    }
+    return result;
+}
+
+FitnessSurrogate::FitnessSurrogate(
+    unsigned int archiveSize,
+    double confidence,
+    double controlRatio,
+    double minCorrelation) :
+    _archiveSize(archiveSize),
+    _confidence(confidence),
+    _controlRatio(controlRatio),
+    _minCorrelation(minCorrelation),
+    _archiveParams(),
+    _archiveScores(),
+    _checkPredicted(),
+    _checkTrue(),
+    _gp(),
+    _meanScore(0.0),
+    _threshold(-1.0),
+    _isActive(false),
+    _correlation(0.0),
+    _evaluationCount(0),
+    _savedCount(0),
+    _engine(),
+    _mutex()
+{
+    if (_archiveSize < MinFitSize) {
+        throw std::logic_error(
+            "FitnessSurrogate archive size too small");
+    }
+    if (_controlRatio < 0.0 || _controlRatio > 1.0) {
+        throw std::logic_error(
+            "FitnessSurrogate invalid control ratio");
+    }
+}
+
+FitnessSurrogate::~FitnessSurrogate()
+{
+}
+
+bool FitnessSurrogate::isPromising(
+    const Eigen::VectorXd& params,
+    double& predicted)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    double mean;
+    double stdDev;
+    if (
+        !_isActive || _threshold < 0.0 ||
+        !predict(params, mean, stdDev)
+    ) {
+        return true;
+    }
+    if (mean - _confidence*stdDev <= _threshold) {
+        return true;
+    }
+    //Screened out candidates are sometime
+    //evaluated to check the surrogate ranking
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    if (uniform(_engine) < _controlRatio) {
+        return true;
+    }
+    predicted = transformInv(mean);
+    _savedCount++;
+
+    return false;
+}
+
+void FitnessSurrogate::add(
+    const Eigen::VectorXd& params, 
+    double score, 
+    bool isArchived)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _evaluationCount++;
+    if (!isArchived) {
+        return;
+    }
+    double value = transform(score);
+    double mean;
+    double stdDev;
+    if (predict(params, mean, stdDev)) {
+        _checkPredicted.push_back(mean);
+        _checkTrue.push_back(value);
+    }
+    _archiveParams.push_back(params);
+    _archiveScores.push_back(value);
+}
+
+void FitnessSurrogate::seed(const Eigen::VectorXd& params, double score)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _archiveParams.push_back(params);
+    _archiveScores.push_back(transform(score));
+}
+
+void FitnessSurrogate::update(
+    const std::vector<double>& scores,
+    unsigned int selectedCount)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    //Spearman rank correlation between predicted
+    //and true scores of last evaluations
+    if (_checkTrue.size() >= MinCheckSize) {
+        Eigen::VectorXd rankPredicted = ranks(_checkPredicted);
+        Eigen::VectorXd rankTrue = ranks(_checkTrue);
+        rankPredicted.array() -= rankPredicted.mean();
+        rankTrue.array() -= rankTrue.mean();
+        double norm = rankPredicted.norm()*rankTrue.norm();
+        _correlation = (norm > 0.0) ?
+            rankPredicted.dot(rankTrue)/norm : 0.0;
+        _isActive = (_correlation >= _minCorrelation);
+        _checkPredicted.clear();
+        _checkTrue.clear();
+    }
+
+    //Selection threshold is the worst
+    //selected candidate score
+    if (scores.size() > 0 && selectedCount > 0) {
+        std::vector<double> sorted = scores;
+        size_t index = std::min((size_t)selectedCount, sorted.size()) - 1;
+        std::nth_element(sorted.begin(),
+            sorted.begin() + index, sorted.end());
+        _threshold = transform(sorted[index]);
+    }
+
+    //Keep latest evaluations
+    if (_archiveParams.size() > _archiveSize) {
+        size_t count = _archiveParams.size() - _archiveSize;
+        _archiveParams.erase(
+            _archiveParams.begin(), _archiveParams.begin() + count);
+        _archiveScores.erase(
+            _archiveScores.begin(), _archiveScores.begin() + count);
+    }
+    if (_archiveParams.size() < MinFitSize) {
+        _isActive = false;
+        return;
+    }
+
+    //Fit the regression and its hyper parameters
+    //starting from previous ones
+    Eigen::VectorXd hyperParams;
+    if (_gp) {
+        hyperParams = _gp->covf().get_loghyper();
+    }
+    _gp.reset(new libgp::GaussianProcess(
+        _archiveParams.front().size(), "CovSum ( CovSEiso, CovNoise)"));
+    if (hyperParams.size() > 0) {
+        _gp->covf().set_loghyper(hyperParams);
+    }
+    _meanScore = 0.0;
+    for (double value : _archiveScores) {
+        _meanScore += value;
+    }
+    _meanScore /= (double)_archiveScores.size();
+    for (size_t i=0;i<_archiveParams.size();i++) {
+        _gp->add_pattern(_archiveParams[i].data(),
+            _archiveScores[i] - _meanScore);
+    }
+    libgp::RProp rprop;
+    rprop.init();
+    rprop.maximize(_gp.get(), 20, false);
+}
+
+bool FitnessSurrogate::isActive() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _isActive;
+}
+
+double FitnessSurrogate::correlation() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _correlation;
+}
+
+unsigned long FitnessSurrogate::evaluationCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _evaluationCount;
+}
+unsigned long FitnessSurrogate::savedCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _savedCount;
+}
+
+bool FitnessSurrogate::predict(
+    const Eigen::VectorXd& params,
+    double& mean, double& stdDev)
+{
+    if (!_gp) {
+        return false;
+    }
+    mean = _gp->f(params.data()) + _meanScore;
+    stdDev = std::sqrt(std::max(0.0, _gp->var(params.data())));
+    return true;
+}
+
+double FitnessSurrogate::transform(double score)
+{
+    return std::log(1.0 + std::max(0.0, score));
+}
+double FitnessSurrogate::transformInv(double value)
+{
+    return std::exp(value) - 1.0;
+}
+
+}
+
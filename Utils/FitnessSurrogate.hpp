@@ -0,0 +1,187 @@
+#ifndef LEPH_FITNESSSURROGATE_HPP
+#define LEPH_FITNESSSURROGATE_HPP
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <Eigen/Dense>
+
+namespace libgp {
+    class GaussianProcess;
+}
+
+namespace Leph {
+
+/**
+ * FitnessSurrogate
+ *
+ * Gaussian process regression of the fitness
+ * of truly evaluated CMA-ES candidates used to
+ * pre-screen new candidates. A candidate whose
+ * optimistic predicted score (mean minus confidence
+ * times standard deviation) is worse than current
+ * selection threshold is not truly evaluated
+ * and is given its predicted score.
+ * A random fraction of screened out candidates is
+ * still truly evaluated to measure the surrogate
+ * rank correlation. Screening is disabled while
+ * this correlation is too low.
+ * Scores are regressed in log(1+score) space.
+ * Screening and archive insertion are thread safe.
+ */
+class FitnessSurrogate
+{
+    public:
+
+        /**
+         * Initialization with the maximum number of
+         * archived (latest) evaluations used for
+         * regression, the confidence factor on predicted
+         * standard deviation, the ratio of screened
+         * out candidates truly evaluated anyway and the
+         * minimum rank correlation to enable screening
+         */
+        FitnessSurrogate(
+            unsigned int archiveSize = 300,
+            double confidence = 1.0,
+            double controlRatio = 0.2,
+            double minCorrelation = 0.5);
+
+        /**
+         * Needed for libgp forward declaration
+         */
+        ~FitnessSurrogate();
+
+        /**
+         * Return true if the given candidate has
+         * to be truly evaluated. Else, predicted is
+         * set to the score given to the candidate.
+         */
+        bool isPromising(
+            const Eigen::VectorXd& params,
+            double& predicted);
+
+        /**
+         * Archive a truly evaluated candidate score.
+         * If isArchived is false, the evaluation
+         * is only counted (score not comparable
+         * with archived ones).
+         */
+        void add(
+            const Eigen::VectorXd& params, 
+            double score, 
+            bool isArchived = true);
+
+        /**
+         * Archive a previously known evaluation
+         * (not counted as evaluation)
+         */
+        void seed(const Eigen::VectorXd& params, double score);
+
+        /**
+         * Update the selection threshold from given
+         * generation scores and selected candidates
+         * count, the rank correlation from last
+         * generation evaluations and fit the
+         * regression on archived evaluations.
+         * Not thread safe, called between generations.
+         */
+        void update(
+            const std::vector<double>& scores,
+            unsigned int selectedCount);
+
+        /**
+         * Return true if screening is enabled
+         */
+        bool isActive() const;
+
+        /**
+         * Return last measured rank correlation
+         */
+        double correlation() const;
+
+        /**
+         * Return the number of truly evaluated
+         * and of screened out candidates
+         */
+        unsigned long evaluationCount() const;
+        unsigned long savedCount() const;
+
+    private:
+
+        /**
+         * Configuration
+         */
+        unsigned int _archiveSize;
+        double _confidence;
+        double _controlRatio;
+        double _minCorrelation;
+
+        /**
+         * Archived candidates and transformed scores
+         */
+        std::vector<Eigen::VectorXd> _archiveParams;
+        std::vector<double> _archiveScores;
+
+        /**
+         * Predicted and true transformed scores
+         * of candidates evaluated since last update
+         */
+        std::vector<double> _checkPredicted;
+        std::vector<double> _checkTrue;
+
+        /**
+         * Fitted regression (null before the
+         * first fit) and mean transformed score
+         */
+        std::unique_ptr<libgp::GaussianProcess> _gp;
+        double _meanScore;
+
+        /**
+         * Transformed selection threshold
+         * (negative if none), screening state
+         * and last rank correlation
+         */
+        double _threshold;
+        bool _isActive;
+        double _correlation;
+
+        /**
+         * Evaluation counters
+         */
+        unsigned long _evaluationCount;
+        unsigned long _savedCount;
+
+        /**
+         * Random generator for control evaluations
+         */
+        std::mt19937 _engine;
+
+        /**
+         * Mutex protecting regression
+         * (libgp is not thread safe), archive
+         * and counters
+         */
+        mutable std::mutex _mutex;
+
+        /**
+         * Predict mean and standard deviation of
+         * transformed score. Return false if the
+         * regression is not fitted.
+         */
+        bool predict(
+            const Eigen::VectorXd& params,
+            double& mean, double& stdDev);
+
+        /**
+         * Score transformation
+         */
+        static double transform(double score);
+        static double transformInv(double value);
+};
+
+}
+
+#endif
+
@@ -0,0 +1,156 @@
+#include <cmath>
+#include <stdexcept>
+#include "Utils/GaussianAccumulator.hpp"
+#include "Utils/Angle.h"
+
+namespace Leph {
+
+GaussianAccumulator::GaussianAccumulator(
+    size_t dimension,
+    const Eigen::VectorXi& isCircular) :
+    _isCircular(),
+    _haveCircular(false),
+    _count(0),
+    _mean(),
+    _sum2(),
+    _sumCos(),
+    _sumSin(),
+    _unwrapped(),
+    _delta()
+{
+    reset(dimension, isCircular);
+}
+
+void GaussianAccumulator::reset(
+    size_t dimension,
+    const Eigen::VectorXi& isCircular)
+{
+    if (
+        isCircular.size() != 0 &&
+        (size_t)isCircular.size() != dimension
+    ) {
+        throw std::logic_error(
+            "GaussianAccumulator invalid circular dimension");
+    }
+    //Circular initialization
+    _haveCircular = false;
+    if ((size_t)isCircular.size() == dimension) {
+        _isCircular = isCircular;
+        //Normalization
+        for (size_t i=0;i<dimension;i++) {
+            if (_isCircular(i) != 0) {
+                _isCircular(i) = 1;
+                _haveCircular = true;
+            }
+        }
+    } else {
+        _isCircular = Eigen::VectorXi::Zero(dimension);
+    }
+    //Buffers allocation
+    _mean.resize(dimension);
+    _sum2.resize(dimension, dimension);
+    _sumCos.resize(dimension);
+    _sumSin.resize(dimension);
+    _unwrapped.resize(dimension);
+    _delta.resize(dimension);
+    clear();
+}
+
+void GaussianAccumulator::clear()
+{
+    _count = 0;
+    _mean.setZero();
+    _sum2.setZero();
+    _sumCos.setZero();
+    _sumSin.setZero();
+}
+
+void GaussianAccumulator::add(const Eigen::VectorXd& point)
+{
+    if (point.size() != _mean.size()) {
+        throw std::logic_error(
+            "GaussianAccumulator invalid dimension");
+    }
+    //Unwrap circular dimensions around
+    //the circular mean of previous points
+    _unwrapped = point;
+    if (_haveCircular) {
+        for (size_t i=0;i<(size_t)_isCircular.size();i++) {
+            if (_isCircular(i) != 0) {
+                if (_count > 0) {
+                    double reference = std::atan2(_sumSin(i), _sumCos(i));
+                    _unwrapped(i) = reference
+                        + AngleDistance(reference, point(i));
+                }
+                _sumCos(i) += std::cos(point(i));
+                _sumSin(i) += std::sin(point(i));
+            }
+        }
+    }
+    //Welford update
+    _count++;
+    _delta = _unwrapped - _mean;
+    _mean += _delta/(double)_count;
+    _sum2.noalias() += _delta*(_unwrapped - _mean).transpose();
+}
+
+size_t GaussianAccumulator::dimension() const
+{
+    return _mean.size();
+}
+size_t GaussianAccumulator::count() const
+{
+    return _count;
+}
+
+const Eigen::VectorXi& GaussianAccumulator::isCircular() const
+{
+    return _isCircular;
+}
+
+Eigen::VectorXd GaussianAccumulator::mean() const
+{
+    checkCount();
+    Eigen::VectorXd mean = _mean;
+    if (_haveCircular) {
+        for (size_t i=0;i<(size_t)_isCircular.size();i++) {
+            if (_isCircular(i) != 0) {
+                double meanX = (1.0/(double)_count)*_sumCos(i);
+                double meanY = (1.0/(double)_count)*_sumSin(i);
+                mean(i) = std::atan2(meanY, meanX);
+            }
+        }
+    }
+
+    return mean;
+}
+Eigen::MatrixXd GaussianAccumulator::covariance() const
+{
+    checkCount();
+    //Sum of squared differences is moved from
+    //the unwrapped mean to the circular mean
+    Eigen::MatrixXd sum2 = _sum2;
+    if (_haveCircular) {
+        Eigen::VectorXd mean = this->mean();
+        Eigen::VectorXd shift = Eigen::VectorXd::Zero(_mean.size());
+        for (size_t i=0;i<(size_t)_isCircular.size();i++) {
+            if (_isCircular(i) != 0) {
+                shift(i) = AngleDistance(mean(i), _mean(i));
+            }
+        }
+        sum2 += (double)_count*shift*shift.transpose();
+    }
+
+    return (1.0/(double)(_count-1))*sum2;
+}
+
+void GaussianAccumulator::checkCount() const
+{
+    if (_count < 2) {
+        throw std::logic_error(
+            "GaussianAccumulator not enough data points");
+    }
+}
+
+}
+
@@ -0,0 +1,132 @@
+#ifndef LEPH_GAUSSIANACCUMULATOR_HPP
+#define LEPH_GAUSSIANACCUMULATOR_HPP
+
+#include <Eigen/Dense>
+
+namespace Leph {
+
+/**
+ * GaussianAccumulator
+ *
+ * Incremental estimation of multivariate
+ * gaussian mean and covariance (Welford update)
+ * without storing the data points.
+ * Circular dimensions (angle in radian) mean
+ * is the angle of the mean unit vector as in
+ * GaussianDistribution::fit(). Their deviations
+ * are accumulated on angles unwrapped around the
+ * circular mean of the previous points. The
+ * covariance matches the batch estimation when
+ * each unwrapped point lies within PI of the
+ * final circular mean. It is only approximate
+ * when early points are spread around the circle
+ * (for example the first two points on both sides
+ * of PI while the final mean is near zero).
+ */
+class GaussianAccumulator
+{
+    public:
+
+        /**
+         * Initialization with data dimension.
+         * If optional isCircular is
+         * not empty, each non zero value
+         * means that associated dimension
+         * is an angle in radian.
+         */
+        GaussianAccumulator(
+            size_t dimension = 0,
+            const Eigen::VectorXi& isCircular
+                = Eigen::VectorXi());
+
+        /**
+         * Reset the accumulator with
+         * given dimension and circular
+         * configuration
+         */
+        void reset(
+            size_t dimension,
+            const Eigen::VectorXi& isCircular
+                = Eigen::VectorXi());
+
+        /**
+         * Remove all accumulated points
+         * (no allocation is done)
+         */
+        void clear();
+
+        /**
+         * Accumulate given data point
+         */
+        void add(const Eigen::VectorXd& point);
+
+        /**
+         * Return the data dimension and
+         * the number of accumulated points
+         */
+        size_t dimension() const;
+        size_t count() const;
+
+        /**
+         * Access to circular
+         * dimension configuration
+         */
+        const Eigen::VectorXi& isCircular() const;
+
+        /**
+         * Compute and return the estimated mean
+         * and (unbiased) covariance.
+         * At least two points are required.
+         */
+        Eigen::VectorXd mean() const;
+        Eigen::MatrixXd covariance() const;
+
+    private:
+
+        /**
+         * Not null integer for each dimension
+         * where the represented value is an angle.
+         * haveCircular is true if at least one
+         * dimension is an angle.
+         */
+        Eigen::VectorXi _isCircular;
+        bool _haveCircular;
+
+        /**
+         * Number of accumulated points
+         */
+        size_t _count;
+
+        /**
+         * Running mean of unwrapped points
+         * and sum of squared differences
+         * from the running mean
+         */
+        Eigen::VectorXd _mean;
+        Eigen::MatrixXd _sum2;
+
+        /**
+         * Sum of circular dimensions
+         * cosinus and sinus
+         */
+        Eigen::VectorXd _sumCos;
+        Eigen::VectorXd _sumSin;
+
+        /**
+         * Unwrapped point and
+         * deviation buffers
+         */
+        Eigen::VectorXd _unwrapped;
+        Eigen::VectorXd _delta;
+
+        /**
+         * Throw exception if less
+         * than two points are accumulated
+         */
+        void checkCount() const;
+};
+
+}
+
+#endif
+
@@ -11,7 +11,7 @@ GaussianDistribution::GaussianDistribution() :
     _isCircular(),
     _haveCircular(false),
     _choleskyDecomposition(),
-    _determinant(0.0)
+    _logDeterminant(0.0)
 {
 }
 
@@ -24,7 +24,7 @@ GaussianDistribution::GaussianDistribution(
     _isCircular(),
     _haveCircular(false),
     _choleskyDecomposition(),
-    _determinant(0.0)
+    _logDeterminant(0.0)
 {
     //Check size
     if (
@@ -106,12 +106,44 @@ Eigen::VectorXd GaussianDistribution::sample(
 
     return point;
 }
+Eigen::MatrixXd GaussianDistribution::sample(
+    size_t count,
+    std::default_random_engine& engine,
+    bool wrapAngles) const
+{
+    //Draw normal unit vectors. The normal
+    //distribution (which caches values) is
+    //built for each vector as in sample()
+    size_t size = _mean.size();
+    Eigen::MatrixXd points(size, count);
+    for (size_t j=0;j<count;j++) {
+        std::normal_distribution<double> dist(0.0, 1.0);
+        for (size_t i=0;i<size;i++) {
+            points(i, j) = dist(engine);
+        }
+    }
+
+    //Compute the random generated points
+    points = _choleskyDecomposition*points;
+    points.colwise() += _mean;
+    //Angle normalization
+    if (_haveCircular && !wrapAngles) {
+        for (size_t i=0;i<(size_t)_isCircular.size();i++) {
+            if (_isCircular(i) != 0) {
+                for (size_t j=0;j<count;j++) {
+                    points(i, j) = AngleBound(points(i, j));
+                }
+            }
+        }
+    }
+
+    return points;
+}
 
 double GaussianDistribution::probability(
     const Eigen::VectorXd& point,
     bool wrapAngles) const
 {
-    size_t size = _mean.size();
     //Compute distance from mean
     Eigen::VectorXd delta = computeDistanceFromMean(
         point, wrapAngles);
@@ -122,16 +154,13 @@ double GaussianDistribution::probability(
     }
 
     //Compute gaussian probability
-    double tmp1 = -0.5*delta.transpose()*_covarianceInv*delta;
-    double tmp2 = pow(2.0*M_PI, size)*_determinant;
-    return std::exp(tmp1)/std::sqrt(tmp2);
+    return std::exp(computeLogProbability(delta));
 }
 
 double GaussianDistribution::logProbability(
     const Eigen::VectorXd& point,
     bool wrapAngles) const
 {
-    size_t size = _mean.size();
     //Compute distance from mean
     Eigen::VectorXd delta = computeDistanceFromMean(
         point, wrapAngles);
@@ -142,11 +171,52 @@ double GaussianDistribution::logProbability(
     }
 
     //Compute log gaussian probability
-    double tmp1 = delta.transpose()*_covarianceInv*delta;
-    return -0.5*(
-        std::log(_determinant) 
-        + tmp1 
-        + (double)size*std::log(2.0*M_PI));
+    return computeLogProbability(delta);
+}
+Eigen::VectorXd GaussianDistribution::logProbabilities(
+    const Eigen::MatrixXd& points,
+    bool wrapAngles) const
+{
+    size_t size = _mean.size();
+    size_t count = points.cols();
+    if ((size_t)points.rows() != size) {
+        throw std::logic_error(
+            "GaussianDistribution invalid dimension");
+    }
+
+    //Compute distances from mean. Points
+    //outside angle range are flagged.
+    Eigen::MatrixXd deltas(size, count);
+    std::vector<bool> isOutside(count, false);
+    if (_haveCircular) {
+        for (size_t j=0;j<count;j++) {
+            Eigen::VectorXd delta = computeDistanceFromMean(
+                points.col(j), wrapAngles);
+            if (delta.size() == 0) {
+                isOutside[j] = true;
+                deltas.col(j).setZero();
+            } else {
+                deltas.col(j) = delta;
+            }
+        }
+    } else {
+        deltas = points.colwise() - _mean;
+    }
+
+    //Compute log gaussian probabilities 
+    //with a single triangular solve
+    _choleskyDecomposition.triangularView<Eigen::Lower>()
+        .solveInPlace(deltas);
+    double offset = _logDeterminant + (double)size*std::log(2.0*M_PI);
+    Eigen::VectorXd logProbas = 
+        -0.5*(deltas.colwise().squaredNorm().transpose().array() + offset);
+    for (size_t j=0;j<count;j++) {
+        if (isOutside[j]) {
+            logProbas(j) = -1000.0;
+        }
+    }
+
+    return logProbas;
 }
 
 void GaussianDistribution::fit(
@@ -235,6 +305,16 @@ void GaussianDistribution::fit(
     _covariance = (1.0/(double)(data.size()-1))*sum2;
 
 
+    //Update the Cholesky decomposition
+    computeDecomposition();
+}
+void GaussianDistribution::fit(const GaussianAccumulator& accumulator)
+{
+    _mean = accumulator.mean();
+    _covariance = accumulator.covariance();
+    _isCircular = accumulator.isCircular();
+    _haveCircular = (_isCircular.array() != 0).any();
+
     //Update the Cholesky decomposition
     computeDecomposition();
 }
@@ -254,15 +334,25 @@ void GaussianDistribution::computeDecomposition()
         throw std::logic_error(
             "GaussianDistribution Cholesky decomposition error");
     }
-    //Compute the covariance determinant
-    _determinant = 1.0;
-    for (size_t i=0;i<(size_t)_mean.size();i++) {
-        _determinant *= _choleskyDecomposition(i, i);
+    //Compute the covariance log determinant
+    //(the determinant itself can underflow)
+    _logDeterminant = 0.0;
+    for (size_t i=0;i<size;i++) {
+        _logDeterminant += 2.0*std::log(_choleskyDecomposition(i, i));
     }
-    _determinant = pow(_determinant, 2);
-    //Compute the covariance inverse
-    _covarianceInv = llt.solve(
-        Eigen::MatrixXd::Identity(size, size));
+}
+
+double GaussianDistribution::computeLogProbability(
+    const Eigen::VectorXd& delta) const
+{
+    //Mahalanobis distance through 
+    //the Cholesky factor
+    double dist2 = _choleskyDecomposition
+        .triangularView<Eigen::Lower>().solve(delta).squaredNorm();
+    return -0.5*(
+        _logDeterminant 
+        + dist2 
+        + (double)delta.size()*std::log(2.0*M_PI));
 }
 
 Eigen::VectorXd GaussianDistribution::computeDistanceFromMean(
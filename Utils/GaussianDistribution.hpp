@@ -4,6 +4,7 @@
 #include <vector>
 #include <random>
 #include <Eigen/Dense>
+#include "Utils/GaussianAccumulator.hpp"
 
 namespace Leph {
 
@@ -76,6 +77,17 @@ class GaussianDistribution
             std::default_random_engine& engine,
             bool wrapAngles = false) const;
 
+        /**
+         * Sample given number of vectors at once
+         * and return them as matrix columns.
+         * Drawn values are the same as the ones
+         * of successive sample() calls.
+         */
+        Eigen::MatrixXd sample(
+            size_t count,
+            std::default_random_engine& engine,
+            bool wrapAngles = false) const;
+
         /**
          * Return the probability of given
          * vector point and current normal law.
@@ -98,6 +110,15 @@ class GaussianDistribution
             const Eigen::VectorXd& point,
             bool wrapAngles = false) const;
 
+        /**
+         * Return the log-probability of
+         * each column of given matrix
+         * (see logProbability())
+         */
+        Eigen::VectorXd logProbabilities(
+            const Eigen::MatrixXd& points,
+            bool wrapAngles = false) const;
+
         /**
          * Compute the classic estimation of gaussian
          * mean and covariance from given data vectors.
@@ -111,6 +132,13 @@ class GaussianDistribution
             const Eigen::VectorXi& isCircular 
                 = Eigen::VectorXi());
 
+        /**
+         * Assign the mean and covariance estimated
+         * by given incremental accumulator and
+         * its circular configuration
+         */
+        void fit(const GaussianAccumulator& accumulator);
+
     private:
 
         /**
@@ -134,12 +162,6 @@ class GaussianDistribution
         Eigen::VectorXi _isCircular;
         bool _haveCircular;
 
-        /**
-         * The inverse of covariance matrix computed 
-         * through cholesky decomposition
-         */
-        Eigen::MatrixXd _covarianceInv;
-
         /**
          * The left side of the Cholesky
          * decomposition of the covariance matrix
@@ -147,16 +169,23 @@ class GaussianDistribution
         Eigen::MatrixXd _choleskyDecomposition;
 
         /**
-         * The determinant of the 
-         * covariance matrix
+         * The log of the covariance
+         * matrix determinant
          */
-        double _determinant;
+        double _logDeterminant;
 
         /**
          * Compute the covariance decomposition
          */
         void computeDecomposition();
 
+        /**
+         * Return the log-probability from given
+         * non empty distance to the mean
+         */
+        double computeLogProbability(
+            const Eigen::VectorXd& delta) const;
+
         /**
          * Return the signed distance between
          * given point and current mean.
@@ -0,0 +1,110 @@
+#ifndef LEPH_SPSCQUEUE_HPP
+#define LEPH_SPSCQUEUE_HPP
+
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+
+namespace Leph {
+
+/**
+ * SPSCQueue
+ *
+ * Bounded lock free single producer
+ * single consumer queue. Elements are
+ * copy assigned into preallocated slots
+ * (initialized with given value), so no
+ * allocation is done for sized types.
+ */
+template <typename T>
+class SPSCQueue
+{
+    public:
+
+        /**
+         * Initialization with the maximum number
+         * of queued elements and the slots
+         * initial value
+         */
+        SPSCQueue(size_t capacity, const T& value = T()) :
+            _slots(capacity+1, value),
+            _head(0),
+            _tail(0)
+        {
+            if (capacity == 0) {
+                throw std::logic_error(
+                    "SPSCQueue invalid capacity");
+            }
+        }
+
+        /**
+         * Queue is not copyable
+         */
+        SPSCQueue(const SPSCQueue&) = delete;
+        SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+        /**
+         * Producer side.
+         * Append given value and return true
+         * or return false if the queue is full
+         */
+        bool push(const T& value)
+        {
+            size_t tail = _tail.load(std::memory_order_relaxed);
+            size_t next = (tail + 1) % _slots.size();
+            if (next == _head.load(std::memory_order_acquire)) {
+                return false;
+            }
+            _slots[tail] = value;
+            _tail.store(next, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Consumer side.
+         * Assign and remove the oldest value and
+         * return true or return false if empty
+         */
+        bool pop(T& value)
+        {
+            size_t head = _head.load(std::memory_order_relaxed);
+            if (head == _tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            value = _slots[head];
+            _head.store(
+                (head + 1) % _slots.size(),
+                std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Return the maximum number
+         * of queued elements
+         */
+        size_t capacity() const
+        {
+            return _slots.size() - 1;
+        }
+
+    private:
+
+        /**
+         * Ring buffer slots
+         * (one is always empty)
+         */
+        std::vector<T> _slots;
+
+        /**
+         * Next slot to pop (written
+         * by the consumer) and to push
+         * (written by the producer)
+         */
+        std::atomic<size_t> _head;
+        std::atomic<size_t> _tail;
+};
+
+}
+
+#endif
+
@@ -0,0 +1,110 @@
+#ifndef LEPH_TRIPLEBUFFER_HPP
+#define LEPH_TRIPLEBUFFER_HPP
+
+#include <atomic>
+
+namespace Leph {
+
+/**
+ * TripleBuffer
+ *
+ * Lock free single writer single reader
+ * publication of values. The writer fills the
+ * back buffer and publishes it while the reader
+ * holds the front buffer. The last published
+ * buffer waits in the middle slot, so neither
+ * side ever blocks and the reader always gets
+ * the latest published value.
+ * No allocation is done once the buffered type
+ * is sized (all buffers are initialized with
+ * the given value).
+ */
+template <typename T>
+class TripleBuffer
+{
+    public:
+
+        /**
+         * Initialization of all
+         * buffers with given value
+         */
+        TripleBuffer(const T& value = T()) :
+            _buffers{value, value, value},
+            _back(0),
+            _middle(1),
+            _front(2)
+        {
+        }
+
+        /**
+         * Buffers are not copyable
+         */
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        /**
+         * Writer side.
+         * Return the buffer to fill (holding
+         * an older value) and publish it
+         */
+        T& back()
+        {
+            return _buffers[_back];
+        }
+        void publish()
+        {
+            unsigned int old = _middle.exchange(
+                _back | FreshBit, std::memory_order_acq_rel);
+            _back = old & IndexMask;
+        }
+
+        /**
+         * Reader side.
+         * Swap the front buffer with the latest
+         * published one and return true if a value
+         * has been published since last update.
+         * Return the front buffer.
+         */
+        bool update()
+        {
+            if ((_middle.load(std::memory_order_relaxed) & FreshBit) == 0) {
+                return false;
+            }
+            unsigned int old = _middle.exchange(
+                _front, std::memory_order_acq_rel);
+            _front = old & IndexMask;
+            return true;
+        }
+        const T& front() const
+        {
+            return _buffers[_front];
+        }
+
+    private:
+
+        /**
+         * Middle slot index mask and
+         * flag set on publication
+         */
+        static const unsigned int IndexMask = 3;
+        static const unsigned int FreshBit = 4;
+
+        /**
+         * Buffers
+         */
+        T _buffers[3];
+
+        /**
+         * Buffers index owned by the writer,
+         * waiting for the reader and
+         * owned by the reader
+         */
+        unsigned int _back;
+        std::atomic<unsigned int> _middle;
+        unsigned int _front;
+};
+
+}
+
+#endif
+